@@ -37,6 +37,22 @@ public:
 
     bool CanSend() { return is_able_to_send; }
 
+    ///Set the state of the output file writer.
+    void SetWriterStats(unsigned int queueDepth, double latency,
+                        double maxLatency, double stallTime);
+
+    ///Return the number of blocks waiting to be written to disk.
+    unsigned int GetWriteQueueDepth() { return writeQueueDepth; }
+
+    ///Return the mean time to write a block to disk in seconds.
+    double GetWriteLatency() { return writeLatency; }
+
+    ///Return the longest time to write a block to disk in seconds.
+    double GetMaxWriteLatency() { return maxWriteLatency; }
+
+    ///Return the time the readout waited on the disk in seconds.
+    double GetWriteStallTime() { return writeStallTime; }
+
     ///Clear the stats.
     void Clear();
 
@@ -84,6 +100,11 @@ private:
 
     bool is_able_to_send; /// Is StatsHandler able to send on the network?
 
+    unsigned int writeQueueDepth; ///<Blocks waiting to be written to disk.
+    double writeLatency; ///<Mean time to write a block to disk in seconds.
+    double maxWriteLatency; ///<Longest time to write a block to disk in seconds.
+    double writeStallTime; ///<Time the readout waited on the disk in seconds.
+
 };
 
 #endif
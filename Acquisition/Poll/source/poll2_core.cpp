@@ -82,7 +82,7 @@ std::vector<std::string> mod_params = {"MODULE_CSRA", "MODULE_CSRB", "MODULE_FOR
 
 const std::vector<std::string> Poll::runControlCommands_ ({"run", "stop",
                                                            "startacq", "startvme", "stopacq", "stopvme", "timedrun", "acq", "shm", "spill",
-                                                           "hup", "prefix", "fdir", "title", "runnum", "oform", "close", "reboot", "stats",
+                                                           "hup", "prefix", "fdir", "title", "runnum", "oform", "odirect", "close", "reboot", "stats",
                                                            "mca"});
 
 const std::vector<std::string> Poll::paramControlCommands_ ({"dump", "pread",
@@ -477,7 +477,13 @@ int Poll::write_data(word_t *data, unsigned int nWords){
 
     if (!is_quiet) std::cout << "Writing " << nWords << " words.\n";
 
-    return output_file.Write((char*)data, nWords);
+    int retval = output_file.Write((char*)data, nWords);
+
+    //The data is written by background threads, report how far behind the disk is.
+    statsHandler->SetWriterStats(output_file.GetWriteQueueDepth(), output_file.GetWriteLatency(),
+                                 output_file.GetMaxWriteLatency(), output_file.GetWriteStallTime());
+
+    return retval;
 }
 
 void Poll::broadcast_data(word_t *data, unsigned int nWords) {
@@ -641,6 +647,7 @@ void Poll::help(){
         std::cout << "   title [runTitle]    - Set the title of the current run (default='PIXIE Data File)\n";
         std::cout << "   runnum [number]     - Set the number of the current run (default=0)\n";
         std::cout << "   oform [0|1|2]       - Set the format of the output file (default=0)\n";
+        std::cout << "   odirect             - Toggle O_DIRECT writes of the output file (default=off)\n";
         std::cout << "   reboot              - Reboot PIXIE crate\n";
         std::cout << "   stats [time]        - Set the time delay between statistics dumps (default=-1)\n";
     }
@@ -1673,6 +1680,11 @@ void Poll::CommandControl(){
                 else{ std::cout << sys_message_head << "Using output file format '" << output_format << "'\n"; }
                 if(output_file.IsOpen()){ std::cout << sys_message_head << "New output format used for new files only! Current file is unchanged.\n"; }
             }
+            else if(cmd == "odirect"){ // Toggle O_DIRECT output
+                output_file.SetDirectIO(!output_file.GetDirectIO());
+                std::cout << sys_message_head << "Toggling O_DIRECT output " << (output_file.GetDirectIO() ? "ON" : "OFF") << "\n";
+                if(output_file.IsOpen()){ std::cout << sys_message_head << "O_DIRECT setting used for new files only! Current file is unchanged.\n"; }
+            }
             else{ std::cout << sys_message_head << "Unknown command '" << cmd << "'\n"; }
         }
         else{ std::cout << sys_message_head << "Unknown command '" << cmd << "'\n"; }
@@ -1890,6 +1902,9 @@ void Poll::UpdateStatus() {
         //Add file size to status
         status << " " << humanReadable(output_file.GetFilesize());
         status << " " << output_file.GetCurrentFilename();
+        //Add the disk writer queue depth and latency
+        status << " Q" << statsHandler->GetWriteQueueDepth();
+        status << " " << std::setprecision(3) << statsHandler->GetWriteLatency() * 1e3 << "ms";
         if (acq_running && !record_data) status << TermColors::Reset;
     }
 
@@ -45,6 +45,11 @@ StatsHandler::StatsHandler(const size_t nCards) {
 
     is_able_to_send = true;
 
+    writeQueueDepth = 0;
+    writeLatency = 0.0;
+    maxWriteLatency = 0.0;
+    writeStallTime = 0.0;
+
     client = new Client();
     if (!client->Init("127.0.0.1", 5556)) {
         is_able_to_send = false;
@@ -163,6 +168,14 @@ void StatsHandler::Dump(void) {
     delete[] message;
 }
 
+void StatsHandler::SetWriterStats(unsigned int queueDepth, double latency,
+                                  double maxLatency, double stallTime) {
+    writeQueueDepth = queueDepth;
+    writeLatency = latency;
+    maxWriteLatency = maxLatency;
+    writeStallTime = stallTime;
+}
+
 double StatsHandler::GetDataRate(size_t mod) {
     if (timeElapsed <= 0) return 0;
     return dataDelta[mod] / timeElapsed;
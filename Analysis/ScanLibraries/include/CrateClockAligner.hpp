@@ -0,0 +1,106 @@
+///@file CrateClockAligner.hpp
+///@brief Measures and corrects the offsets between the clocks of several
+/// Pixie-16 crates
+///@date October 19, 2026
+#ifndef __CRATECLOCKALIGNER_HPP__
+#define __CRATECLOCKALIGNER_HPP__
+
+#include <vector>
+
+///A class that keeps the offset of the clock of every crate with respect to
+/// crate 0. The corrected time of a hit is its time minus the offset of its
+/// crate. An offset is either fixed in the configuration or measured on every
+/// spill from a reference channel that sees the same signal in every crate,
+/// a pulser fanned out to all of them for example. The hits of the reference
+/// channel of a crate are paired with the nearest ones of crate 0, within the
+/// match window, and the offset of the spill is the median of the time
+/// differences. The first offset of a measured crate comes from the first
+/// reference hits of both crates, so the crates have to see the first pulse.
+class CrateClockAligner {
+public:
+    ///Default constructor
+    CrateClockAligner() : window_(100) {}
+
+    ///Default destructor
+    ~CrateClockAligner() {}
+
+    ///Set the number of crates, crate 0 is the reference clock
+    ///@param[in] a : The parameter that we are going to set
+    void SetNumberOfCrates(const unsigned int &a) { crates_.resize(a); }
+
+    ///@return The number of crates
+    unsigned int GetNumberOfCrates() const { return (unsigned int) crates_.size(); }
+
+    ///Fix the offset of a crate
+    ///@param[in] crate : The crate number
+    ///@param[in] offset : The offset in clock ticks
+    ///@throw out_of_range if the crate does not exist
+    void SetFixedOffset(const unsigned int &crate, const double &offset);
+
+    ///Measure the offset of a crate from a reference channel. Crate 0 needs
+    /// a reference channel if any other crate is measured.
+    ///@param[in] crate : The crate number
+    ///@param[in] module : The module number in the crate
+    ///@param[in] channel : The channel number
+    ///@throw out_of_range if the crate does not exist
+    void SetReferenceChannel(const unsigned int &crate, const unsigned int &module, const unsigned int &channel);
+
+    ///Set the largest difference between two paired reference hits, after
+    /// the previous offset was applied
+    ///@param[in] a : The window in clock ticks
+    void SetMatchWindow(const double &a) { window_ = a; }
+
+    ///@return True if the channel is the reference channel of its crate
+    ///@param[in] crate : The crate number
+    ///@param[in] module : The module number in the crate
+    ///@param[in] channel : The channel number
+    bool IsReference(const unsigned int &crate, const unsigned int &module, const unsigned int &channel) const {
+        return crate < crates_.size() && crates_[crate].isMeasured && crates_[crate].module == module &&
+               crates_[crate].channel == channel;
+    }
+
+    ///Record the raw time of a hit of the reference channel of a crate
+    ///@param[in] crate : The crate number
+    ///@param[in] time : The time in clock ticks, without the offset
+    void AddReferenceTime(const unsigned int &crate, const double &time) { crates_.at(crate).times.push_back(time); }
+
+    ///Measure the offsets with the reference hits of the spill and forget them
+    void EndSpill();
+
+    ///@return The offset of a crate in clock ticks
+    ///@param[in] crate : The crate number
+    double GetOffset(const unsigned int &crate) const { return crates_.at(crate).offset; }
+
+    ///@return The change of the offset of a crate at the last spill
+    ///@param[in] crate : The crate number
+    double GetDrift(const unsigned int &crate) const { return crates_.at(crate).drift; }
+
+    ///@return The number of reference hits paired at the last spill
+    ///@param[in] crate : The crate number
+    unsigned int GetNumMatched(const unsigned int &crate) const { return crates_.at(crate).numMatched; }
+
+    ///@return True if the offset of the crate is measured
+    ///@param[in] crate : The crate number
+    bool IsMeasured(const unsigned int &crate) const { return crates_.at(crate).isMeasured; }
+
+private:
+    ///The clock of a crate
+    struct Crate {
+        Crate() : offset(0), drift(0), isMeasured(false), hasOffset(false), module(0), channel(0), numMatched(0) {}
+
+        double offset; ///< The offset of the clock in ticks
+        double drift; ///< The change of the offset at the last spill
+        bool isMeasured; ///< True if the offset is measured from the reference channel
+        bool hasOffset; ///< True once the offset is fixed or was measured once
+        unsigned int module; ///< The module of the reference channel
+        unsigned int channel; ///< The reference channel
+        unsigned int numMatched; ///< The number of pairs at the last spill
+        std::vector<double> times; ///< The reference hits of the spill
+    };
+
+    double window_; ///< The match window in clock ticks
+    std::vector<Crate> crates_; ///< The crates, crate 0 first
+    std::vector<double> differences_; ///< The time differences of the pairs, kept to avoid allocations
+};
+
+#endif //__CRATECLOCKALIGNER_HPP__
@@ -0,0 +1,68 @@
+///@file LoadShedder.hpp
+///@brief Decides how much of the analysis an online scan switches off to
+/// keep up with the spills it receives
+///@date October 19, 2026
+#ifndef __LOADSHEDDER_HPP__
+#define __LOADSHEDDER_HPP__
+
+///A class that measures the time taken to process every spill against a
+/// budget and picks a degradation level from it. Level 0 runs the full
+/// analysis, every level above it switches off more of it, which stages those
+/// are is up to the scan. When the spills take longer than the budget the
+/// excess piles up as a backlog; once the backlog exceeds the budget of a
+/// spill the level is raised. A spill that was lost raises the level at once.
+/// The level is lowered again after the backlog is gone and the spills take
+/// less than LOWER_LOAD of the budget. After every change the level is held for
+/// HOLD_SPILLS spills (twice that before lowering), so that the measurement
+/// settles and the level does not flip back and forth.
+class LoadShedder {
+public:
+    ///Default constructor, the shedding is disabled
+    LoadShedder() : budget_(0), maxLevel_(0) { Reset(); }
+
+    ///Sets the budget and the number of levels
+    ///@param[in] seconds : The time that the processing of a spill may take
+    ///@param[in] maxLevel : The highest degradation level, 0 disables the
+    /// shedding
+    void SetBudget(const double &seconds, const unsigned int &maxLevel);
+
+    ///@return True if a budget and at least one level were set
+    bool IsEnabled() const { return budget_ > 0 && maxLevel_ > 0; }
+
+    ///Adds the measurement of a spill
+    ///@param[in] seconds : The time taken to process the spill
+    ///@param[in] dropped : True if the spill, or a part of it, was lost
+    ///@return True if the level changed
+    bool Update(const double &seconds, const bool &dropped);
+
+    ///Goes back to the full analysis and forgets the measurements
+    void Reset();
+
+    ///@return The current degradation level, 0 for the full analysis
+    unsigned int GetLevel() const { return level_; }
+
+    ///@return The highest degradation level
+    unsigned int GetMaxLevel() const { return maxLevel_; }
+
+    ///@return The smoothed processing time of the spills over the budget
+    double GetLoad() const { return load_; }
+
+    ///@return The processing time in seconds that the scan is behind the
+    /// budget
+    double GetBacklog() const { return backlog_; }
+
+    static const unsigned int HOLD_SPILLS = 5; //!< Spills a level is held for at least
+    static const double LOWER_LOAD; //!< The load under which the level is lowered
+    static const double SMOOTHING; //!< The weight of the last spill in the load
+
+private:
+    double budget_; //!< The processing time allowed per spill in seconds
+    unsigned int maxLevel_; //!< The highest degradation level
+    unsigned int level_; //!< The current degradation level
+    double load_; //!< The smoothed processing time over the budget
+    double backlog_; //!< The processing time in excess of the budget
+    unsigned long numSpills_; //!< The number of spills measured
+    unsigned long sinceChange_; //!< The number of spills since the level changed
+};
+
+#endif //__LOADSHEDDER_HPP__
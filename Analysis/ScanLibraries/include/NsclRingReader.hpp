@@ -0,0 +1,104 @@
+///@file NsclRingReader.hpp
+///@brief Reads the ring items of NSCLDAQ .evt files and stitches the Pixie-16
+/// module FIFO fragments into spills
+///@date October 19, 2026
+#ifndef __NSCLRINGREADER_HPP__
+#define __NSCLRINGREADER_HPP__
+
+#include <istream>
+#include <string>
+#include <vector>
+
+///A class that reads an NSCLDAQ .evt file in large blocks and walks the ring
+/// items in place. The NSCLDAQ readout chops the FIFO of every module into
+/// several PHYSICS_EVENT ring items. The payloads are copied once, straight
+/// from the block into a spill buffer that is reused for the whole file, and
+/// every module gets the two word header (length and module number) that
+/// Unpacker::ReadSpill expects. All other ring items are skipped.
+class NsclRingReader {
+public:
+    ///Default constructor
+    ///@param[in] blockSize : The number of bytes read from the file at once
+    NsclRingReader(const size_t &blockSize = 8388608);
+
+    ///Default destructor
+    ~NsclRingReader() {}
+
+    ///Read ring items until a spill is complete.
+    ///@param[in] file : The file to read from
+    ///@param[out] nWords : The number of words in the spill, including the
+    /// end of spill delimiter
+    ///@return A pointer to the first word of the spill, it stays valid until
+    /// the next call. NULL if the file holds no more spills.
+    unsigned int *Read(std::istream *file, unsigned int &nWords);
+
+    ///Forget the state of the previous file
+    void Reset();
+
+    ///@return The number of bytes of the file that were walked
+    unsigned long long GetBytesRead() const { return bytesRead_; }
+
+    ///@return The number of ring items that were read
+    unsigned long long GetNumRingItems() const { return numRingItems_; }
+
+    ///@return The number of module FIFO fragments stitched into spills
+    unsigned long long GetNumFragments() const { return numFragments_; }
+
+    ///@return The number of spills that were completed
+    unsigned long long GetNumSpills() const { return numSpills_; }
+
+    ///Toggle debug mode
+    ///@param[in] a : The value that we are going to set
+    void SetDebugMode(const bool &a = true) { debug_ = a; }
+
+    ///Set the number of modules in the crate. Every spill gets a buffer for
+    /// every module, empty ones included. If unset, the spills are padded up
+    /// to the highest module that was seen in the file.
+    ///@param[in] a : The parameter that we are going to set
+    void SetNumModules(const unsigned int &a) { numModules_ = a; }
+
+private:
+    static const unsigned int PHYSICS_EVENT = 30; ///< The ring item type of the Pixie-16 data
+    static const unsigned int END_OF_SPILL = 9999; ///< The module number that ends a spill
+    static const size_t NO_MODULE = (size_t) -1; ///< No module is being filled
+
+    std::vector<char> block_; ///< The block of the file that is being walked
+    size_t begin_; ///< Position of the next ring item in the block
+    size_t end_; ///< Number of valid bytes in the block
+    bool eof_; ///< True once the end of the file was reached
+
+    std::vector<unsigned int> spill_; ///< The spill that is being assembled
+    size_t moduleStart_; ///< Position of the header of the module being filled
+    unsigned int currentModule_; ///< The module that is being filled
+    unsigned int lastFragment_; ///< Number of words of the last fragment
+    unsigned int maxModule_; ///< The highest module that was seen
+    unsigned int numModules_; ///< Number of modules in the crate, 0 if unknown
+    bool debug_; ///< True if debugging information is printed
+
+    unsigned long long bytesRead_; ///< Number of bytes of the file that were walked
+    unsigned long long numRingItems_; ///< Number of ring items that were read
+    unsigned long long numFragments_; ///< Number of fragments added to spills
+    unsigned long long numSpills_; ///< Number of spills that were completed
+
+    ///Make sure that the block holds a number of unread bytes, reading more
+    /// of the file if necessary.
+    ///@param[in] file : The file to read from
+    ///@param[in] size : The number of bytes that are needed
+    ///@return false if the file ends before
+    bool Fill(std::istream *file, const size_t &size);
+
+    ///Start the buffer of a module, adding empty buffers for the modules
+    /// in between.
+    ///@param[in] module : The module number
+    void StartModule(const unsigned int &module);
+
+    ///Write the length of the module that is being filled into its header
+    void CloseModule();
+
+    ///Close the last module, pad the empty modules and add the delimiter.
+    ///@param[out] nWords : The number of words in the spill
+    ///@return A pointer to the first word of the spill
+    unsigned int *FinishSpill(unsigned int &nWords);
+};
+
+#endif //__NSCLRINGREADER_HPP__
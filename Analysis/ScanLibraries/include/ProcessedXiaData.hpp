@@ -15,13 +15,13 @@
 class ProcessedXiaData : public XiaData {
 public:
     /// Default constructor.
-    ProcessedXiaData() {}
+    ProcessedXiaData() : traceLoaded_(false) {}
 
     ///Constructor taking the base class as an argument so that we can set
-    /// the trace information properly
+    /// the trace information properly. The samples of the trace are only
+    /// copied over when the trace is first asked for.
     ///@param[in] evt : The event that we are going to assign here.
-    ProcessedXiaData(XiaData &evt) : XiaData(evt) {
-        trace_ = evt.GetTrace();
+    ProcessedXiaData(XiaData &evt) : XiaData(evt), traceLoaded_(false) {
         trace_.SetIsSaturated(evt.IsSaturated());
         walkCorrectedTime_ = 0;
     };
@@ -36,10 +36,25 @@ public:
     double GetHighResTimeInNs() const { return highResTimeInNs_; }
 
     ///@return A constant reference to the trace.
-    const Trace &GetTrace() const { return trace_; }
+    const Trace &GetTrace() const {
+        LoadTrace();
+        return trace_;
+    }
 
     ///@return An editable trace.
-    Trace &GetTrace() { return trace_; }
+    Trace &GetTrace() {
+        LoadTrace();
+        return trace_;
+    }
+
+    ///@return The results of the trace analysis without copying over the
+    /// samples. The samples may or may not be in the trace.
+    Trace &GetTraceResults() { return trace_; }
+
+    ///@return The number of samples in the trace, without copying them.
+    unsigned int GetTraceLength() const {
+        return traceLoaded_ ? (unsigned int) trace_.size() : XiaData::GetTraceLength();
+    }
 
     ///@return The Walk corrected time of the channel
     double GetWalkCorrectedTime() const { return walkCorrectedTime_; }
@@ -62,14 +77,29 @@ public:
 
     ///Sets the trace appropriately
     ///@param[in] a : The trace that we want to set
-    void SetTrace(const std::vector<unsigned int> &a) { trace_ = a; }
+    void SetTrace(const std::vector<unsigned int> &a) {
+        trace_ = a;
+        traceLoaded_ = true;
+    }
 
     ///Set the Walk corrected time
     ///@param [in] a : the walk corrected time */
     void SetWalkCorrectedTime(const double &a) { walkCorrectedTime_ = a; }
 
+    ///Copies the samples of the trace from the raw data the first time they
+    /// are needed. The analysis results already stored in trace_ are kept.
+    /// The copy is not thread safe, the traces of an event are loaded before
+    /// its processors run concurrently.
+    void LoadTrace() const {
+        if (traceLoaded_)
+            return;
+        CopyTrace(trace_);
+        traceLoaded_ = true;
+    }
+
 private:
-    Trace trace_; ///< A Trace object to handle the Trace related stuff.
+    mutable Trace trace_; ///< A Trace object to handle the Trace related stuff.
+    mutable bool traceLoaded_; ///< True once the samples were copied into trace_
 
     bool isIgnored_; ///< True if we ignore this event.
     bool isValidData_; ///< True if the energy and High Res time are valid.
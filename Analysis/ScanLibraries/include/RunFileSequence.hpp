@@ -0,0 +1,99 @@
+///@file RunFileSequence.hpp
+///@brief The list of input files of a run that are scanned one after the
+/// other as a single stream
+///@date October 19, 2026
+#ifndef __RUNFILESEQUENCE_HPP__
+#define __RUNFILESEQUENCE_HPP__
+
+#include <atomic>
+#include <deque>
+#include <string>
+#include <thread>
+
+#include <stdint.h>
+
+///A class that holds the files of a run that are still to be scanned. poll2
+/// rolls a run over into run_NNN-1, run_NNN-2, ... when a file reaches the
+/// maximum size, the files are kept in that order. While a file is scanned a
+/// background thread reads the beginning of the next one, so that it is in
+/// the page cache of the kernel when the scan gets to it and the disk does
+/// not idle at the boundary.
+class RunFileSequence {
+public:
+    ///Default constructor
+    RunFileSequence() : stop_(false), numPrefetched_(0), maxPrefetchBytes_(DEFAULT_PREFETCH_BYTES) {}
+
+    ///Destructor, stops the prefetch
+    ~RunFileSequence() { StopPrefetch(); }
+
+    ///Adds files to the end of the sequence. The list is separated by commas,
+    /// every entry is a file name, a glob pattern or @ followed by the name of
+    /// a text file that has one name or pattern per line (lines starting with #
+    /// are skipped). The files matching a pattern are sorted in the order of
+    /// poll2, see IsBefore.
+    ///@param[in] list : The list of files
+    ///@throw invalid_argument if a pattern matches no file or a list cannot
+    /// be read
+    void Add(const std::string &list);
+
+    ///Takes the next file of the sequence and starts to prefetch the one
+    /// after it
+    ///@return The name of the file, empty if there are no files left
+    std::string Next();
+
+    ///Drops the files up to and including a file, used to continue a run from
+    /// one of its files
+    ///@param[in] name : The name of the file
+    ///@return False if the file is not in the sequence, nothing is dropped then
+    bool SkipPast(const std::string &name);
+
+    ///Drops the files that were not scanned yet and stops the prefetch
+    void Clear();
+
+    ///@return True if no files are left
+    bool IsEmpty() const { return files_.empty(); }
+
+    ///@return The number of files that were not scanned yet
+    size_t GetNumFiles() const { return files_.size(); }
+
+    ///@return The number of bytes read ahead so far
+    uint64_t GetNumPrefetchedBytes() const { return numPrefetched_; }
+
+    ///Sets the number of bytes read ahead from the beginning of the next file,
+    /// 0 disables the prefetch
+    ///@param[in] a : The parameter that we are going to set
+    void SetMaxPrefetchBytes(const uint64_t &a) { maxPrefetchBytes_ = a; }
+
+    ///Orders the files of a run like poll2 writes them : run_012, run_012-1,
+    /// run_012-2, ..., run_012-10, run_013. Numbers in the names compare by
+    /// value, so run_999 comes before run_1000.
+    ///@param[in] a : The first file name
+    ///@param[in] b : The second file name
+    ///@return True if a comes before b
+    static bool IsBefore(const std::string &a, const std::string &b);
+
+    static const uint64_t DEFAULT_PREFETCH_BYTES = 1073741824; //!< Read ahead 1 GB of the next file by default
+
+private:
+    ///Reads the beginning of a file and throws the data away, called by the
+    /// prefetch thread
+    ///@param[in] name : The name of the file
+    ///@param[in] maxBytes : The number of bytes to read at most
+    void Prefetch(const std::string name, const uint64_t maxBytes);
+
+    ///Adds the files matching a glob pattern in the order of IsBefore
+    ///@param[in] pattern : The name or the pattern
+    ///@throw invalid_argument if no file matches
+    void AddPattern(const std::string &pattern);
+
+    ///Stops the prefetch thread and waits for it
+    void StopPrefetch();
+
+    std::deque<std::string> files_; //!< The files that were not scanned yet
+    std::thread prefetch_; //!< Reads ahead the next file
+    std::atomic<bool> stop_; //!< Set to stop the prefetch thread
+    std::atomic<uint64_t> numPrefetched_; //!< The number of bytes read ahead
+    uint64_t maxPrefetchBytes_; //!< The number of bytes read ahead from every file
+};
+
+#endif //__RUNFILESEQUENCE_HPP__
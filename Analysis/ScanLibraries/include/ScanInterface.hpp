@@ -13,6 +13,7 @@
 #ifndef SCANINTERFACE_HPP
 #define SCANINTERFACE_HPP
 
+#include <chrono>
 #include <deque>
 #include <map>
 #include <string>
@@ -22,6 +23,9 @@
 #include <getopt.h>
 
 #include "hribf_buffers.h"
+#include "NsclRingReader.hpp"
+#include "LoadShedder.hpp"
+#include "RunFileSequence.hpp"
 #include "XiaData.hpp"
 
 #define SCAN_VERSION "1.2.29"
@@ -29,6 +33,10 @@
 
 class Server;
 
+class StateReader;
+
+class StateWriter;
+
 class Terminal;
 
 class Unpacker;
@@ -112,6 +120,18 @@ public:
     /// Return the header string used to prefix output messages.
     std::string GetMessageHeader() { return msgHeader; }
 
+    /// Return the number of complete spills received.
+    unsigned long GetNumSpillsReceived() const { return num_spills_recvd; }
+
+    /// Return the number of spills from shared memory that were dropped because a chunk went missing.
+    unsigned long GetNumSpillsDropped() const { return num_spills_dropped; }
+
+    /// Return the degradation level of the analysis of an online scan, 0 for the full analysis.
+    unsigned int GetLoadLevel() const { return shedder.GetLevel(); }
+
+    /// Return the number of events from shared memory that were processed with a degraded analysis.
+    unsigned long GetNumDegradedEvents() const { return num_degraded_events; }
+
     /// Return the name of the program.
     std::string GetProgramName() { return progName; }
 
@@ -121,6 +141,9 @@ public:
     /// \return The name of the output file that doesn't include the path
     std::string GetOutputFilename() { return outputFilename_; }
 
+    /// \return The path of the input file that is scanned, empty in shm mode
+    std::string GetInputPath() const { return input_path; }
+
     /// @return The path for the output file
     std::string GetOutputPath() { return outputPath_; }
 
@@ -186,6 +209,13 @@ protected:
       */
     void AddOption(optionExt opt_);
 
+    /** Display a message in the status line of the terminal, or on the
+      * current line of the output in batch mode.
+      * \param[in]  status_ The message to display.
+      * \return Nothing.
+      */
+    void SetStatus(const std::string &status_);
+
     /** ExtraCommands is used to send command strings to classes derived
       * from ScanInterface. If ScanInterface receives an unrecognized
       * command from the user, it will pass it on to the derived class.
@@ -258,6 +288,39 @@ protected:
       */
     virtual void Notify(const std::string &code_ = "") {}
 
+    /** Add the state of the derived class (e.g. its histograms) to a
+      * checkpoint, after the state of the unpacker. Called between two spills.
+      * Does nothing useful by default.
+      * \param[in] writer The archive of the checkpoint. Not used by default.
+      * \return Nothing.
+      */
+    virtual void SaveState(StateWriter &writer) {}
+
+    /** Load the state written by SaveState when a scan is resumed. Called
+      * after Initialize and before the first spill.
+      * Does nothing useful by default.
+      * \param[in] reader The archive of the checkpoint. Not used by default.
+      * \return Nothing.
+      */
+    virtual void LoadState(StateReader &reader) {}
+
+    /** Enable the load shedding of a shared memory scan. When the processing
+      * of the spills takes longer than the budget, the analysis is degraded
+      * one level at a time through SetLoadLevel, see LoadShedder.
+      * \param[in] budget_ The time in seconds that the processing of a spill may take.
+      * \param[in] num_levels_ The number of degradation levels, 0 disables the shedding.
+      * \return Nothing.
+      */
+    void SetLoadShedding(const double &budget_, const unsigned int &num_levels_);
+
+    /** Switch the analysis to a degradation level. Called between two spills
+      * of a shared memory scan when the level changes.
+      * Does nothing useful by default.
+      * \param[in] level_ The degradation level, 0 restores the full analysis. Not used by default.
+      * \return Nothing.
+      */
+    virtual void SetLoadLevel(const unsigned int &level_) {}
+
     ///Print a help message for the provided argument
     ///@param[in] arg : The argument that we've asked about
     ///@param[in] help : A brief message about the argument.
@@ -284,13 +347,23 @@ private:
     std::string outputPath_;
 
     int max_spill_size; /// Maximum size of a spill to read.
-    int file_format; /// Input file format to use (0=.ldf, 1=.pld, 2=.root, 3=.evt).
+    int file_format; /// Input file format to use (0=.ldf, 1=.pld, 2=.root, 3=.evt, 4=.evcache).
 
     unsigned long num_spills_recvd; /// The total number of good spills received from either the input file or shared memory.
+    unsigned long num_spills_dropped; /// The number of incomplete spills from shared memory that were not processed.
+    unsigned long num_degraded_events; /// The number of events from shared memory processed with a degraded analysis.
+    LoadShedder shedder; /// Picks the degradation level of a shared memory scan from the processing time of the spills.
     unsigned long file_start_offset; /// The first word in the file at which to start scanning.
 
     bool write_counts; /// Set to true if raw channel counts are to be written to file.
 
+    double checkpoint_period; /// The minimum number of seconds between two checkpoints, 0 if they are disabled.
+    bool resume_mode; /// Set to true if the scan resumes from the checkpoint of the output file.
+    unsigned int num_checkpoints; /// The number of checkpoints written.
+    double checkpoint_seconds; /// The total number of seconds spent writing checkpoints.
+    std::chrono::steady_clock::time_point scan_start_time; /// When the scan of the input file started.
+    std::chrono::steady_clock::time_point next_checkpoint_time; /// The earliest time of the next checkpoint.
+
     bool total_stopped; /// Set to true if when the scan finishes.
     bool is_running; /// Set to true if the acqusition is running.
     bool is_verbose; /// Set to true if the user wishes verbose information to be displayed.
@@ -306,6 +379,14 @@ private:
 
     Server *poll_server; /// Poll2 shared memory server.
 
+    std::string input_path; /// Path of the main input binary data file.
+    RunFileSequence run_files; /// The input files given with --run that follow the current one.
+    bool run_mode; /// Set to true if the input files were given with --run.
+    unsigned int num_files_scanned; /// The number of files of the run scanned to their end.
+    double run_megabytes; /// The size of the files of the run scanned to their end.
+    double run_seconds; /// The time spent on the files of the run scanned to their end.
+    std::chrono::steady_clock::time_point file_start_time; /// When the scan of the current input file started.
+    unsigned long file_start_spills; /// The number of spills received before the current input file.
     std::ifstream input_file; /// Main input binary data file.
     std::streampos file_length; /// Main input file length (in bytes).
 
@@ -313,10 +394,23 @@ private:
 
     PLD_header pldHead; /// PLD style HEAD buffer handler.
     PLD_data pldData; /// PLD style DATA buffer handler.
+
+    /// The .pld file of one of the crates merged with the main input file.
+    struct CrateInput {
+        std::ifstream file; /// The input file of the crate.
+        std::streampos start; /// The position of the first spill in the file.
+        PLD_header head; /// PLD style HEAD buffer handler.
+        PLD_data data; /// PLD style DATA buffer handler.
+        bool good; /// False once the file has no more spills.
+    };
+
+    std::vector<std::string> crate_filenames; /// The input files of crates 1, 2, ... given with --crates.
+    std::vector<CrateInput *> crate_inputs; /// The open input files of crates 1, 2, ...
     DIR_buffer dirbuff; /// HRIBF DIR buffer handler.
     HEAD_buffer headbuff; /// HRIBF HEAD buffer handler.
     DATA_buffer databuff; /// HRIBF DATA buffer handler.
     EOF_buffer eofbuff; /// HRIBF EOF buffer handler.
+    NsclRingReader ringReader; /// NSCLDAQ ring item handler.
 
     Terminal *term; /// ncurses terminal used for displaying output and handling user input.
 
@@ -333,7 +427,34 @@ private:
     bool rewind(const unsigned long &offset_ = 0);
 
     /// Open a new binary input file for reading.
-    bool open_input_file(const std::string &fname_);
+    bool open_input_file(const std::string &fname_, const bool &next_in_run_ = false);
+
+    /// Read the next length prefixed block of an event cache.
+    bool read_cache_block(std::string &block_);
+
+    /// Print the throughput of the current input file and open the next file of the run.
+    bool next_run_file();
+
+    /// Open the input files of the other crates, called by open_input_file.
+    bool open_crate_files();
+
+    /// Close the input files of the other crates.
+    void close_crate_files();
+
+    /// Read the next spill of every other crate and merge them with the spill of crate 0.
+    void read_crate_spills(unsigned int *data);
+
+    /// Measure a spill from shared memory against the budget and change the degradation level if needed.
+    void update_load_level(const double &seconds_, const bool &dropped_);
+
+    /// Return the name of the checkpoint file, written next to the output file.
+    std::string get_checkpoint_filename();
+
+    /// Write a checkpoint if one is due, called between two spills.
+    void write_checkpoint();
+
+    /// Load the checkpoint of the output file and move the input file to the spill that follows it.
+    bool read_checkpoint();
 
     ///Sets output Filename and path that were passed using the -o flag.
     ///@param[in] a : The parameter that we are going to set
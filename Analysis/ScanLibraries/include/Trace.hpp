@@ -23,11 +23,17 @@
 class Trace : public std::vector<unsigned int> {
 public:
     ///Default constructor
-    Trace() : std::vector<unsigned int>() {}
+    Trace() : std::vector<unsigned int>(), isSaturated_(false), hasValidWaveformAnalysis_(false),
+              hasValidTimingAnalysis_(false), phase_(0), qdc_(0), tailRatio_(0), tau_(0), filteredBaseline_(0),
+              numTriggers_(0) {}
 
-    ///An automatic conversion for the trace
+    ///An automatic conversion for the trace, the results of the analysis
+    /// start out empty
     ///@param [in] x : the trace to store in the class
-    Trace(const std::vector<unsigned int> &x) : std::vector<unsigned int>(x) {}
+    Trace(const std::vector<unsigned int> &x) : std::vector<unsigned int>(x), isSaturated_(false),
+                                                 hasValidWaveformAnalysis_(false), hasValidTimingAnalysis_(false),
+                                                 phase_(0), qdc_(0), tailRatio_(0), tau_(0), filteredBaseline_(0),
+                                                 numTriggers_(0) {}
 
     ///@return Returns a std::pair<double,double> containing the average and
     /// standard deviation of the baseline as the .first and .second
@@ -0,0 +1,133 @@
+///@file TriggeredEventBuilder.hpp
+///@brief Builds events around trigger channels with a coincidence window per
+/// detector
+///@date October 19, 2026
+#ifndef __TRIGGEREDEVENTBUILDER_HPP__
+#define __TRIGGEREDEVENTBUILDER_HPP__
+
+#include <deque>
+#include <ostream>
+#include <string>
+#include <vector>
+
+class XiaData;
+
+///A class that builds the events of a spill around the hits of the trigger
+/// channels instead of the first hit. Every channel has a window, the time
+/// it may come before (pre) and after (post) the trigger. A hit inside the
+/// window of a trigger joins its event, a trigger that joined the event of an
+/// earlier trigger does not open an event of its own. The hits that are in no
+/// window are deleted. Window 0 is used by the channels that have no window,
+/// it is empty unless it is changed with SetDefaultWindow. The channels are
+/// numbered as in XiaData::GetId, the times are in filter clock ticks as
+/// XiaData::GetTimeSansCfd.
+class TriggeredEventBuilder {
+public:
+    ///Default constructor
+    TriggeredEventBuilder();
+
+    ///Default destructor, deletes the hits of the spill that were not given
+    /// to an event.
+    ~TriggeredEventBuilder();
+
+    ///Adds a window
+    ///@param[in] name : The name of the window, used in the summary
+    ///@param[in] pre : The time a hit may come before the trigger
+    ///@param[in] post : The time a hit may come after the trigger
+    ///@return The number of the window
+    ///@throw invalid_argument if pre or post is negative
+    unsigned int AddWindow(const std::string &name, const double &pre, const double &post);
+
+    ///Sets the window used by the channels that have no window
+    ///@param[in] pre : The time a hit may come before the trigger
+    ///@param[in] post : The time a hit may come after the trigger
+    ///@throw invalid_argument if pre or post is negative
+    void SetDefaultWindow(const double &pre, const double &post);
+
+    ///Sets the window of a channel
+    ///@param[in] id : The channel, as in XiaData::GetId
+    ///@param[in] window : The number returned by AddWindow
+    ///@throw out_of_range if the window does not exist
+    void SetWindow(const unsigned int &id, const unsigned int &window);
+
+    ///Makes a channel a trigger
+    ///@param[in] id : The channel, as in XiaData::GetId
+    void SetTrigger(const unsigned int &id);
+
+    ///@return True if the channel is a trigger
+    ///@param[in] id : The channel, as in XiaData::GetId
+    bool IsTrigger(const unsigned int &id) const { return id < triggers_.size() && triggers_[id]; }
+
+    ///@return True if at least one channel is a trigger
+    bool HasTriggers() const { return numTriggers_ > 0; }
+
+    ///Takes the hits of a spill, the lists are left empty. The hits of the
+    /// previous spill that were not given to an event are rejected.
+    ///@param[in] lists : The time sorted lists of hits of every module
+    void Start(std::vector<std::deque<XiaData *> > &lists);
+
+    ///Builds the next event. The hits before the trigger that can no longer
+    /// be in an event are rejected, after the last event all the remaining
+    /// hits are.
+    ///@param[out] event : Receives the hits of the event, the caller owns them
+    ///@param[out] triggerTime : Receives the time of the trigger in clock ticks
+    ///@return False if there are no more triggers in the spill
+    bool Next(std::deque<XiaData *> &event, double &triggerTime);
+
+    ///@return The number of windows, including the default one
+    unsigned int GetNumWindows() const { return (unsigned int) windows_.size(); }
+
+    ///@return The name of a window
+    ///@param[in] window : The number of the window
+    const std::string &GetWindowName(const unsigned int &window) const { return windows_.at(window).name; }
+
+    ///@return The number of hits a window gave to an event
+    ///@param[in] window : The number of the window
+    unsigned long GetNumAdmitted(const unsigned int &window) const { return windows_.at(window).admitted; }
+
+    ///@return The number of hits of a window that were in no event
+    ///@param[in] window : The number of the window
+    unsigned long GetNumRejected(const unsigned int &window) const { return windows_.at(window).rejected; }
+
+    ///@return The number of events that were built
+    unsigned long GetNumEvents() const { return numEvents_; }
+
+    ///Writes the admitted and rejected hits of every window
+    ///@param[in] out : The stream to write to
+    void Print(std::ostream &out) const;
+
+private:
+    ///The coincidence window of some channels
+    struct Window {
+        std::string name; ///< The name of the window
+        double pre; ///< The time a hit may come before the trigger
+        double post; ///< The time a hit may come after the trigger
+        unsigned long admitted; ///< The hits given to an event
+        unsigned long rejected; ///< The hits in no event
+    };
+
+    ///@return The window of a channel
+    ///@param[in] id : The channel
+    Window &GetWindow(const unsigned int &id) { return windows_[id < channelWindows_.size() ? channelWindows_[id] : 0]; }
+
+    ///Finds the widest pre and post of all the windows
+    void UpdateLimits();
+
+    ///Counts a hit as rejected and deletes it
+    ///@param[in] hit : The position of the hit in hits_
+    void Reject(const size_t &hit);
+
+    std::vector<Window> windows_; ///< The windows, the default one first
+    std::vector<unsigned int> channelWindows_; ///< The window of every channel
+    std::vector<bool> triggers_; ///< True for the trigger channels
+    unsigned int numTriggers_; ///< The number of trigger channels
+    double maxPre_; ///< The widest pre of all the windows
+    double maxPost_; ///< The widest post of all the windows
+    unsigned long numEvents_; ///< The number of events that were built
+
+    std::vector<XiaData *> hits_; ///< The hits of the spill in time order, NULL once they were used
+    size_t low_; ///< The first hit that may still join an event
+    size_t next_; ///< The next hit that may be a trigger
+};
+
+#endif //__TRIGGEREDEVENTBUILDER_HPP__
@@ -18,6 +18,8 @@
 #include <string>
 #include <vector>
 
+#include "CrateClockAligner.hpp"
+#include "TriggeredEventBuilder.hpp"
 #include "XiaListModeDataMask.hpp"
 
 #ifndef MAX_PIXIE_MOD
@@ -31,6 +33,10 @@ class XiaData;
 
 class ScanMain;
 
+class StateReader;
+
+class StateWriter;
+
 class Unpacker {
 public:
     /// Default constructor.
@@ -74,6 +80,16 @@ public:
 
     void InitializeDataMask(const std::string &firmware, const unsigned int &frequency = 0);
 
+    /** \return the mask used to decode the buffers of a module
+      * \param[in] vsn The module number.
+      * \throw invalid_argument if the module has no firmware or frequency.
+      */
+    XiaListModeDataMask GetDataMask(const unsigned int &vsn) const;
+
+    /// Return the number of modules in the configuration file, 0 if the
+    /// firmware and frequency were given for all modules at once.
+    unsigned int GetNumModules() const { return maskMap_.empty() ? 0 : maskMap_.rbegin()->first + 1; }
+
     /** ReadSpill is responsible for constructing a list of pixie16 events from
       * a raw data spill. This method performs sanity checks on the spill and
       * calls ReadBuffer in order to construct the event list.
@@ -84,6 +100,101 @@ public:
       */
     bool ReadSpill(unsigned int *data, unsigned int nWords, bool is_verbose = true);
 
+    /** Reads the spill of one crate. With a single crate this is ReadSpill.
+      * With several crates the events are kept until MergeSpills is called
+      * with the spill of every crate, and the errors only clear the events
+      * of this crate. The traces of those events no longer refer to data, so
+      * the buffer may be reused for the next crate.
+      * \param[in]  data       Pointer to an array of unsigned ints containing the spill data.
+      * \param[in]  nWords     The number of words in the array.
+      * \param[in]  crate      The crate number, from 0 to GetNumberOfCrates() - 1.
+      * \param[in]  is_verbose Toggle the verbosity flag on/off.
+      * \return True if the spill was read successfully and false otherwise.
+      */
+    bool ReadCrateSpill(unsigned int *data, unsigned int nWords, const unsigned int &crate, bool is_verbose = true);
+
+    /** Corrects the times of every crate with the offsets measured on this
+      * spill, then builds and processes the events of all the crates as a
+      * single time ordered stream. The merge rate and the offsets are
+      * reported on every spill.
+      * \return Nothing.
+      */
+    void MergeSpills();
+
+    /** Sets the number of crates that are read, one input per crate. 1 by
+      * default.
+      * \param[in] a : The number of crates
+      */
+    void SetNumberOfCrates(const unsigned int &a) { aligner_.SetNumberOfCrates(a > 0 ? a : 1); }
+
+    /// Return the number of crates that are read.
+    unsigned int GetNumberOfCrates() const { return aligner_.GetNumberOfCrates(); }
+
+    /** Reads the clock offsets of the crates from the /Configuration/Crates
+      * node. Every Crate has a number and either a fixed offset in clock
+      * ticks, or the module and channel of a reference signal that all the
+      * crates see. The window attribute is the largest difference of two
+      * paired reference hits, the tolerance the largest drift of an offset
+      * during a spill before a warning. Call SetNumberOfCrates first, crates
+      * that are not read are ignored.
+      * \param[in] config : The configuration file
+      * \throw IOException if a Crate has no number
+      * \throw invalid_argument if a crate is measured but crate 0 has no reference
+      */
+    void InitializeCrates(const std::string &config);
+
+    /// Return the object that keeps the clock offsets of the crates.
+    const CrateClockAligner &GetClockAligner() const { return aligner_; }
+
+    /// Return the hits per second merged by the last call of MergeSpills.
+    double GetMergeRate() const { return mergeRate_; }
+
+    /** Toggles the trigger-centred event building on / off. When it is on
+      * the events are opened by the trigger channels and hold the hits that
+      * are in the window of their channel, see TriggeredEventBuilder. The
+      * event width is not used.
+      * \param[in] a : True to build the events around the triggers
+      */
+    void SetTriggeredMode(const bool &a) { isTriggered_ = a; }
+
+    /// Return true if the events are built around the trigger channels.
+    bool IsTriggeredMode() const { return isTriggered_; }
+
+    /// Return the object that holds the triggers and the windows of the channels.
+    TriggeredEventBuilder *GetTriggeredEventBuilder() { return &triggered_; }
+
+    /** Writes the counters and the times that are kept from one spill to
+      * the next, for the checkpoints of the scan. The events of a spill are
+      * all built and processed when ReadSpill returns, so nothing else is
+      * pending between two spills. Derived classes add the state of their
+      * analysis.
+      * \param[in] writer The archive of the state.
+      * \return Nothing.
+      */
+    virtual void SaveState(StateWriter &writer) const;
+
+    /** Reads the state written by SaveState.
+      * \param[in] reader The archive of the state.
+      * \return Nothing.
+      */
+    virtual void LoadState(StateReader &reader);
+
+    /** Checks that a cache of calibrated events may be replayed by this
+      * unpacker. Unpackers that do not write such caches refuse them.
+      * \param[in] header The header block of the cache.
+      * \return True if the cache may be replayed.
+      */
+    virtual bool OpenEventCache(const std::string &header) { return false; }
+
+    /** Processes the events of a spill that were read from a cache of
+      * calibrated events instead of being built from the raw data. Unused by
+      * default.
+      * \param[in] data Pointer to the bytes of the spill block.
+      * \param[in] size The number of bytes in the block.
+      * \return Nothing.
+      */
+    virtual void ReplayEventCache(const char *data, const size_t &size) {}
+
     /** Write all recorded channel counts to a file.
       * \return Nothing.
       */
@@ -101,13 +212,19 @@ public:
 
 protected:
     bool debug_mode; ///< True if debug mode is set.
-    std::vector<std::deque<XiaData *>> eventList; ///< The list of all events in a spill.
+    std::vector<std::deque<XiaData *>> eventList; ///< The events of a spill, at crate * (MAX_PIXIE_MOD + 1) + module.
     double eventWidth_; ///< The width of the raw event in pixie clock ticks
     XiaListModeDataMask mask_; ///< Object providing the masks necessary to decode the data.
     std::map<unsigned int, std::pair<std::string, unsigned int> > maskMap_;///< Maps firmware/frequency to module number
     unsigned int maxModuleNumberInFile_; ///< The maximum module number that we've encountered in the data file.
     std::deque<XiaData *> rawEvent; ///< The list of all events in the event window.
     bool running; ///< True if the scan is running.
+    CrateClockAligner aligner_; ///< The clock offsets of the crates.
+    unsigned int currentCrate_; ///< The crate of the spill that is read.
+    double driftTolerance_; ///< The drift of an offset in clock ticks above which we warn.
+    double mergeRate_; ///< The hits per second merged by the last MergeSpills.
+    bool isTriggered_; ///< True if the events are built around the trigger channels.
+    TriggeredEventBuilder triggered_; ///< Builds the events around the trigger channels.
 
     /** Process all events in the event list.
       * \param[in]  addr_ Pointer to a ScanInterface object. Unused by default.
@@ -122,6 +239,30 @@ protected:
       */
     virtual void RawStats(XiaData *event_) {}
 
+    /** Sets the times of an event that was replayed from a cache and
+      * counts it as a raw event, so that the Get*Time methods give the same
+      * values as during the scan that wrote the cache.
+      * \param[in] first The first recorded event time.
+      * \param[in] eventStart The start time of the event.
+      * \param[in] realStart The time of the first hit of the event.
+      * \param[in] realStop The time of the last hit of the event.
+      * \return Nothing.
+      */
+    void SetReplayedEvent(const double &first, const double &eventStart, const double &realStart,
+                          const double &realStop) {
+        firstTime = first;
+        eventStartTime = eventStart;
+        realStartTime = realStart;
+        realStopTime = realStop;
+        numRawEvt++;
+    }
+
+    /** Called by ReadSpill after all of the events of a full spill were
+      * processed. Unused by default.
+      * \return Nothing.
+      */
+    virtual void EndSpill() {}
+
     /** Called form ReadSpill. Scan the current spill and construct a list of
       * events which fired by obtaining the module, channel, trace, etc. of the
       * timestamped event. This method will construct the event list for
@@ -132,6 +273,15 @@ protected:
       */
     int ReadBuffer(unsigned int *buf, const unsigned int &vsn);
 
+    /** \return the mask used to decode the buffers of a module of a crate.
+      * The module c * (MAX_PIXIE_MOD + 1) + vsn of the configuration is used
+      * if it exists, module vsn otherwise.
+      * \param[in] crate The crate number.
+      * \param[in] vsn The module number in the crate.
+      * \throw invalid_argument if the module has no firmware or frequency.
+      */
+    const XiaListModeDataMask &GetCrateDataMask(const unsigned int &crate, const unsigned int &vsn);
+
 private:
     unsigned int TOTALREAD; /// Maximum number of data words to read.
     unsigned int maxWords; /// Maximum number of data words for revision D.
@@ -155,6 +305,11 @@ private:
       */
     bool BuildRawEvent();
 
+    /** Builds the raw event around the next trigger of the spill.
+      * \return True if there was a trigger left and false otherwise.
+      */
+    bool BuildTriggeredEvent();
+
     /** Push an event into the event list.
       * \param[in]  event_ The XiaData to push onto the back of the event list.
       * \return True if the XiaData's module number is valid and false otherwise.
@@ -183,6 +338,26 @@ private:
       * \return True if the eventList is empty, and false otherwise.
       */
     bool IsEmpty();
+
+    /** Sorts, builds and processes the events of the spill, then clears the
+      * event list and calls EndSpill.
+      * \return Nothing.
+      */
+    void ProcessSpill();
+
+    /** Copies the traces of the events of one crate out of the spill
+      * buffer, so that the buffer can be reused while the events wait for the
+      * spills of the other crates.
+      * \param[in] crate The crate number.
+      * \return Nothing.
+      */
+    void DetachTraces(const unsigned int &crate);
+
+    /** Deletes the events of one crate from the event list.
+      * \param[in] crate The crate number.
+      * \return Nothing.
+      */
+    void ClearCrate(const unsigned int &crate);
 };
 
 #endif
@@ -6,6 +6,8 @@
 
 #include <vector>
 
+#include <cstddef>
+
 /*! \brief A pixie16 channel event
  *
  * All data is grouped together into channels.  For each pixie16 channel that
@@ -138,8 +140,23 @@ public:
     ///@return the QDC recorded on the module
     std::vector<unsigned int> GetQdc() const { return qdc_; }
 
-    ///@return The trace that was sampled on the module
-    std::vector<unsigned int> GetTrace() const { return trace_; }
+    ///@return The trace that was sampled on the module. A trace that is
+    /// still only a view into the spill buffer (see SetTraceSamples) is
+    /// widened to 32 bit samples on the first call.
+    const std::vector<unsigned int> &GetTrace() const {
+        if (traceSamples_)
+            WidenTrace();
+        return trace_;
+    }
+
+    ///@return The number of samples in the trace, without decoding it.
+    unsigned int GetTraceLength() const { return traceSamples_ ? traceLength_ : (unsigned int) trace_.size(); }
+
+    ///@brief Copies the trace into a vector, widening the samples straight
+    /// from the spill buffer if the trace was not decoded yet. Unlike GetTrace
+    /// this does not keep a decoded copy of the trace here.
+    ///@param[out] a : The vector that will hold the trace
+    void CopyTrace(std::vector<unsigned int> &a) const;
 
     ///@brief Sets the baseline recorded on the module if the energy sums
     /// were recorded in the data stream
@@ -222,7 +239,31 @@ public:
 
     ///@brief Sets the trace recorded on board
     ///@param[in] a : The value to set
-    void SetTrace(const std::vector<unsigned int> &a) { trace_ = a; }
+    void SetTrace(const std::vector<unsigned int> &a) {
+        trace_ = a;
+        traceSamples_ = NULL;
+        traceLength_ = 0;
+    }
+
+    ///@brief Sets the trace to a view of the 16 bit samples in the spill
+    /// buffer. The samples are only widened when somebody asks for the
+    /// trace, so the buffer must stay valid as long as this object (or a copy
+    /// of it) may do so. The unpacker processes the events of a spill before
+    /// its buffer is reused, or detaches the traces when it keeps the events.
+    ///@param[in] samples : The first sample in the spill buffer
+    ///@param[in] length : The number of samples
+    void SetTraceSamples(const unsigned short *samples, const unsigned int &length) {
+        trace_.clear();
+        traceSamples_ = length > 0 ? samples : NULL;
+        traceLength_ = length;
+    }
+
+    ///@brief Copies the samples set with SetTraceSamples out of the spill
+    /// buffer, the buffer may be reused afterwards.
+    void DetachTrace() const {
+        if (traceSamples_)
+            WidenTrace();
+    }
 
     ///@brief Sets the flag for channels generated on-board
     ///@param[in] a : True if we this channel was generated on-board
@@ -255,7 +296,12 @@ private:
 
     std::vector<unsigned int> eSums_;///Energy sums recorded by the module
     std::vector<unsigned int> qdc_; ///QDCs recorded by the module
-    std::vector<unsigned int> trace_; /// ADC trace capture.
+    mutable std::vector<unsigned int> trace_; /// ADC trace capture.
+    mutable const unsigned short *traceSamples_; /// Samples in the spill buffer that were not decoded yet
+    unsigned int traceLength_; /// Number of samples at traceSamples_
+
+    ///Widens the samples in the spill buffer into trace_ and drops the view.
+    void WidenTrace() const;
 };
 
 #endif
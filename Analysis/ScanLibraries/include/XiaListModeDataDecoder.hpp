@@ -23,7 +23,8 @@ public:
     ///Main decoding method
     ///@param[in] buf : Pointer to the beginning of the data buffer.
     ///@param[in] mask : The mask set that we need to decode the data
-    ///@return A vector containing all of the decoded XiaData events.
+    ///@return A vector containing all of the decoded XiaData events. Their
+    /// traces point into buf, which needs to outlive them.
     std::vector<XiaData *> DecodeBuffer(unsigned int *buf,
                                         const XiaListModeDataMask &mask);
 
@@ -87,9 +88,11 @@ public:
     unsigned int DecodeWordThree(const unsigned int &word, XiaData &data,
                                  const XiaListModeDataMask &mask);
 
-    ///Method to decode word three from the header.
-    ///@param[in] word : The word that we need to decode
+    ///Method to attach the trace to the event. The samples are left in the
+    /// buffer and only widened when the trace is used.
+    ///@param[in] buf : Pointer to the first word of the trace
     ///@param[in] data : The XiaData object that we are going to fill.
+    ///@param[in] traceLength : The number of samples in the trace
     void DecodeTrace(unsigned int *buf, XiaData &data,
                      const unsigned int &traceLength);
 };
@@ -0,0 +1,78 @@
+///@file CrateClockAligner.cpp
+///@brief Measures and corrects the offsets between the clocks of several
+/// Pixie-16 crates
+///@date October 19, 2026
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#include <cmath>
+
+#include "CrateClockAligner.hpp"
+
+using namespace std;
+
+void CrateClockAligner::SetFixedOffset(const unsigned int &crate, const double &offset) {
+    if (crate >= crates_.size())
+        throw out_of_range("CrateClockAligner::SetFixedOffset - Crate " + to_string(crate) + " does not exist.");
+    crates_[crate].offset = offset;
+    crates_[crate].isMeasured = false;
+    crates_[crate].hasOffset = true;
+}
+
+void CrateClockAligner::SetReferenceChannel(const unsigned int &crate, const unsigned int &module,
+                                            const unsigned int &channel) {
+    if (crate >= crates_.size())
+        throw out_of_range("CrateClockAligner::SetReferenceChannel - Crate " + to_string(crate) + " does not exist.");
+    crates_[crate].module = module;
+    crates_[crate].channel = channel;
+    crates_[crate].isMeasured = true;
+    crates_[crate].hasOffset = crate == 0;
+}
+
+///Both lists of reference hits are sorted, so the nearest hit of crate 0 is
+/// found by walking the two lists together.
+void CrateClockAligner::EndSpill() {
+    if (crates_.empty())
+        return;
+
+    vector<double> &reference = crates_[0].times;
+    sort(reference.begin(), reference.end());
+
+    for (unsigned int c = 1; c < crates_.size(); c++) {
+        Crate &crate = crates_[c];
+        crate.drift = 0;
+        crate.numMatched = 0;
+        if (!crate.isMeasured || crate.times.empty() || reference.empty()) {
+            crate.times.clear();
+            continue;
+        }
+        sort(crate.times.begin(), crate.times.end());
+
+        if (!crate.hasOffset) {
+            crate.offset = crate.times.front() - reference.front();
+            crate.hasOffset = true;
+        }
+
+        differences_.clear();
+        vector<double>::const_iterator nearest = reference.begin();
+        for (vector<double>::const_iterator it = crate.times.begin(); it != crate.times.end(); it++) {
+            double time = *it - crate.offset;
+            while (nearest + 1 != reference.end() && fabs(*(nearest + 1) - time) <= fabs(*nearest - time))
+                nearest++;
+            if (fabs(*nearest - time) <= window_)
+                differences_.push_back(*it - *nearest);
+        }
+        crate.times.clear();
+
+        crate.numMatched = (unsigned int) differences_.size();
+        if (differences_.empty())
+            continue;
+
+        vector<double>::iterator middle = differences_.begin() + differences_.size() / 2;
+        nth_element(differences_.begin(), middle, differences_.end());
+        crate.drift = *middle - crate.offset;
+        crate.offset = *middle;
+    }
+    reference.clear();
+}
@@ -0,0 +1,49 @@
+///@file LoadShedder.cpp
+///@brief Decides how much of the analysis an online scan switches off to
+/// keep up with the spills it receives
+///@date October 19, 2026
+#include <algorithm>
+
+#include "LoadShedder.hpp"
+
+using namespace std;
+
+const unsigned int LoadShedder::HOLD_SPILLS;
+const double LoadShedder::LOWER_LOAD = 0.5;
+const double LoadShedder::SMOOTHING = 0.3;
+
+void LoadShedder::SetBudget(const double &seconds, const unsigned int &maxLevel) {
+    budget_ = seconds;
+    maxLevel_ = maxLevel;
+    Reset();
+}
+
+void LoadShedder::Reset() {
+    level_ = 0;
+    load_ = 0;
+    backlog_ = 0;
+    numSpills_ = 0;
+    sinceChange_ = 0;
+}
+
+bool LoadShedder::Update(const double &seconds, const bool &dropped) {
+    if (!IsEnabled())
+        return false;
+
+    double load = seconds / budget_;
+    load_ = numSpills_ == 0 ? load : SMOOTHING * load + (1 - SMOOTHING) * load_;
+    backlog_ = max(0.0, backlog_ + seconds - budget_);
+    numSpills_++;
+    sinceChange_++;
+
+    unsigned int previous = level_;
+    if (level_ < maxLevel_ && (dropped || (sinceChange_ >= HOLD_SPILLS && load_ > 1 && backlog_ > budget_)))
+        level_++;
+    else if (level_ > 0 && !dropped && sinceChange_ >= 2 * HOLD_SPILLS && backlog_ == 0 && load_ < LOWER_LOAD)
+        level_--;
+
+    if (level_ == previous)
+        return false;
+    sinceChange_ = 0;
+    return true;
+}
@@ -0,0 +1,191 @@
+///@file NsclRingReader.cpp
+///@brief Reads the ring items of NSCLDAQ .evt files and stitches the Pixie-16
+/// module FIFO fragments into spills
+///@date October 19, 2026
+#include <algorithm>
+#include <iostream>
+
+#include <cstring>
+
+#include "NsclRingReader.hpp"
+
+using namespace std;
+
+const unsigned int NsclRingReader::PHYSICS_EVENT;
+const unsigned int NsclRingReader::END_OF_SPILL;
+const size_t NsclRingReader::NO_MODULE;
+
+NsclRingReader::NsclRingReader(const size_t &blockSize) : block_(blockSize), numModules_(0), debug_(false) {
+    Reset();
+}
+
+void NsclRingReader::Reset() {
+    begin_ = end_ = 0;
+    eof_ = false;
+    spill_.clear();
+    moduleStart_ = NO_MODULE;
+    currentModule_ = lastFragment_ = maxModule_ = 0;
+    bytesRead_ = numRingItems_ = numFragments_ = numSpills_ = 0;
+}
+
+bool NsclRingReader::Fill(std::istream *file, const size_t &size) {
+    if (end_ - begin_ >= size)
+        return true;
+    if (eof_)
+        return false;
+
+    //Move the part of the ring item that we already have to the front
+    size_t remaining = end_ - begin_;
+    if (remaining != 0 && begin_ != 0)
+        memmove(&block_[0], &block_[begin_], remaining);
+    begin_ = 0;
+    end_ = remaining;
+
+    if (block_.size() < size)
+        block_.resize(size);
+
+    file->read(&block_[end_], block_.size() - end_);
+    end_ += file->gcount();
+    if (!file->good())
+        eof_ = true;
+
+    return end_ - begin_ >= size;
+}
+
+void NsclRingReader::StartModule(const unsigned int &module) {
+    unsigned int first = spill_.empty() ? 0 : currentModule_ + 1;
+    for (unsigned int i = first; i < module; i++) {
+        spill_.push_back(2);
+        spill_.push_back(i);
+    }
+
+    moduleStart_ = spill_.size();
+    spill_.push_back(2);
+    spill_.push_back(module);
+    currentModule_ = module;
+    maxModule_ = max(maxModule_, module);
+}
+
+void NsclRingReader::CloseModule() {
+    spill_[moduleStart_] = (unsigned int) (spill_.size() - moduleStart_);
+    if (debug_)
+        cout << "debug: module fifo " << currentModule_ << " completed with " << spill_[moduleStart_]
+             << " words" << endl;
+}
+
+unsigned int *NsclRingReader::FinishSpill(unsigned int &nWords) {
+    CloseModule();
+
+    unsigned int lastModule = numModules_ != 0 ? numModules_ - 1 : maxModule_;
+    for (unsigned int i = currentModule_ + 1; i <= lastModule; i++) {
+        spill_.push_back(2);
+        spill_.push_back(i);
+    }
+    spill_.push_back(2);
+    spill_.push_back(END_OF_SPILL);
+
+    moduleStart_ = NO_MODULE;
+    numSpills_++;
+    if (debug_)
+        cout << "debug: spill completion detected, " << spill_.size() << " words" << endl;
+
+    nWords = (unsigned int) spill_.size();
+    return &spill_[0];
+}
+
+unsigned int *NsclRingReader::Read(std::istream *file, unsigned int &nWords) {
+    //The spill that we returned last time is no longer needed
+    if (moduleStart_ == NO_MODULE)
+        spill_.clear();
+
+    while (Fill(file, 8)) {
+        // ring item size is self inclusive
+        unsigned int itemSize, itemType;
+        memcpy(&itemSize, &block_[begin_], 4);
+        memcpy(&itemType, &block_[begin_ + 4], 4);
+
+        if (itemSize < 8) {
+            cout << "NsclRingReader::Read - Found a ring item of " << itemSize
+                 << " bytes, likely corrupted data. Skipping the rest of the file." << endl;
+            eof_ = true;
+            begin_ = end_;
+            break;
+        }
+        if (!Fill(file, itemSize)) {
+            cout << "NsclRingReader::Read - The file ends in the middle of a ring item of " << itemSize
+                 << " bytes." << endl;
+            begin_ = end_;
+            break;
+        }
+
+        const char *item = &block_[begin_];
+
+        // PHYSICS_EVENT of pre-sort ring has no body header, everything else is skipped
+        unsigned int bodyHeaderSize = 1;
+        if (itemType == PHYSICS_EVENT && itemSize >= 12)
+            memcpy(&bodyHeaderSize, item + 8, 4);
+        if (itemType != PHYSICS_EVENT || bodyHeaderSize != 0 || itemSize < 20) {
+            if (debug_)
+                cout << "debug: skipping a ring item of type " << itemType << endl;
+            begin_ += itemSize;
+            bytesRead_ += itemSize;
+            numRingItems_++;
+            continue;
+        }
+
+        // skip two words inserted by NSCLDAQ, the rest is raw pixie list-mode data
+        const char *payload = item + 20;
+        unsigned int nBytes = itemSize - 20;
+        unsigned int numWords = nBytes / 4;
+
+        //Peek at the first pixie event to find the module number
+        int module = -1;
+        if (nBytes >= 32) {
+            unsigned int header;
+            memcpy(&header, payload, 4);
+            // this is revision specific!! has to be changed for RevH
+            module = (int) ((header >> 4) & 0xf) - 2; // modnum is slotnum - 2
+            if (module < 0)
+                cout << "NsclRingReader::Read - Invalid slot number (got " << module
+                     << "), likely corrupted data" << endl;
+        } else
+            cout << "NsclRingReader::Read - The data size of this ring item is too small (" << nBytes
+                 << " bytes), likely corrupted data" << endl;
+
+        if (module < 0) {
+            begin_ += itemSize;
+            bytesRead_ += itemSize;
+            numRingItems_++;
+            continue;
+        }
+
+        //A lower module, or a longer fragment of the same module after a
+        // short one, starts the next spill. The ring item stays in the block
+        // until the next call.
+        if (moduleStart_ != NO_MODULE && ((unsigned int) module < currentModule_ ||
+                                          ((unsigned int) module == currentModule_ && lastFragment_ < numWords)))
+            return FinishSpill(nWords);
+
+        if (moduleStart_ == NO_MODULE || (unsigned int) module > currentModule_) {
+            if (moduleStart_ != NO_MODULE)
+                CloseModule();
+            StartModule(module);
+        }
+
+        size_t position = spill_.size();
+        spill_.resize(position + numWords);
+        memcpy(&spill_[position], payload, numWords * 4);
+        lastFragment_ = numWords;
+        numFragments_++;
+
+        begin_ += itemSize;
+        bytesRead_ += itemSize;
+        numRingItems_++;
+    }
+
+    if (moduleStart_ != NO_MODULE)
+        return FinishSpill(nWords);
+
+    nWords = 0;
+    return NULL;
+}
@@ -0,0 +1,184 @@
+///@file RunFileSequence.cpp
+///@brief The list of input files of a run that are scanned one after the
+/// other as a single stream
+///@date October 19, 2026
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include <cctype>
+#include <cstdlib>
+
+#include <fcntl.h>
+#include <glob.h>
+#include <unistd.h>
+
+#include "RunFileSequence.hpp"
+
+using namespace std;
+
+///The size of the blocks read by the prefetch thread
+static const size_t prefetchBlockSize = 4194304;
+
+///Splits a file name into the name without the extension and the number of
+/// the poll2 rollover, 0 for the first file of a run
+static void SplitRollover(const string &name, string &stem, unsigned long &part) {
+    size_t slash = name.find_last_of('/');
+    size_t dot = name.find_last_of('.');
+    stem = dot != string::npos && (slash == string::npos || dot > slash) ? name.substr(0, dot) : name;
+
+    part = 0;
+    size_t dash = stem.find_last_of('-');
+    if (dash != string::npos && dash + 1 < stem.size() &&
+        stem.find_first_not_of("0123456789", dash + 1) == string::npos) {
+        part = strtoul(stem.c_str() + dash + 1, NULL, 10);
+        stem.erase(dash);
+    }
+}
+
+///@return The end of the digits that start at i
+static size_t EndOfNumber(const string &a, size_t i) {
+    while (i < a.size() && isdigit((unsigned char) a[i]))
+        i++;
+    return i;
+}
+
+///Compares two strings character by character, except for numbers that are
+/// compared by value
+///@return -1, 0 or 1 if a is before, the same as or after b
+static int CompareNatural(const string &a, const string &b) {
+    size_t i = 0, j = 0;
+    while (i < a.size() && j < b.size()) {
+        if (isdigit((unsigned char) a[i]) && isdigit((unsigned char) b[j])) {
+            size_t iEnd = EndOfNumber(a, i), jEnd = EndOfNumber(b, j);
+            while (i + 1 < iEnd && a[i] == '0')
+                i++;
+            while (j + 1 < jEnd && b[j] == '0')
+                j++;
+            if (iEnd - i != jEnd - j)
+                return iEnd - i < jEnd - j ? -1 : 1;
+            int result = a.compare(i, iEnd - i, b, j, jEnd - j);
+            if (result != 0)
+                return result < 0 ? -1 : 1;
+            i = iEnd;
+            j = jEnd;
+        } else {
+            if (a[i] != b[j])
+                return a[i] < b[j] ? -1 : 1;
+            i++;
+            j++;
+        }
+    }
+    if (a.size() - i == b.size() - j)
+        return 0;
+    return a.size() - i < b.size() - j ? -1 : 1;
+}
+
+bool RunFileSequence::IsBefore(const string &a, const string &b) {
+    string stemA, stemB;
+    unsigned long partA, partB;
+    SplitRollover(a, stemA, partA);
+    SplitRollover(b, stemB, partB);
+
+    int result = CompareNatural(stemA, stemB);
+    if (result != 0)
+        return result < 0;
+    if (partA != partB)
+        return partA < partB;
+    return a < b;
+}
+
+void RunFileSequence::AddPattern(const string &pattern) {
+    glob_t matches;
+    int result = glob(pattern.c_str(), 0, NULL, &matches);
+    if (result != 0) {
+        globfree(&matches);
+        throw invalid_argument("RunFileSequence::AddPattern - No file matches \"" + pattern + "\".");
+    }
+
+    vector<string> names(matches.gl_pathv, matches.gl_pathv + matches.gl_pathc);
+    globfree(&matches);
+    sort(names.begin(), names.end(), IsBefore);
+    files_.insert(files_.end(), names.begin(), names.end());
+}
+
+void RunFileSequence::Add(const string &list) {
+    stringstream entries(list);
+    string entry;
+    while (getline(entries, entry, ',')) {
+        if (entry.empty())
+            continue;
+        if (entry[0] != '@') {
+            AddPattern(entry);
+            continue;
+        }
+
+        ifstream file(entry.substr(1).c_str());
+        if (!file.good())
+            throw invalid_argument("RunFileSequence::Add - Could not read the list " + entry.substr(1) + ".");
+        string line;
+        while (getline(file, line)) {
+            size_t first = line.find_first_not_of(" \t\r");
+            if (first == string::npos || line[first] == '#')
+                continue;
+            AddPattern(line.substr(first, line.find_last_not_of(" \t\r") - first + 1));
+        }
+    }
+}
+
+string RunFileSequence::Next() {
+    StopPrefetch();
+    if (files_.empty())
+        return "";
+
+    string name = files_.front();
+    files_.pop_front();
+    if (!files_.empty() && maxPrefetchBytes_ > 0)
+        prefetch_ = thread(&RunFileSequence::Prefetch, this, files_.front(), maxPrefetchBytes_);
+    return name;
+}
+
+bool RunFileSequence::SkipPast(const string &name) {
+    deque<string>::iterator it = find(files_.begin(), files_.end(), name);
+    if (it == files_.end())
+        return false;
+    StopPrefetch();
+    files_.erase(files_.begin(), it + 1);
+    return true;
+}
+
+void RunFileSequence::Clear() {
+    StopPrefetch();
+    files_.clear();
+}
+
+///The data is read with plain reads rather than only posix_fadvise, which
+/// the kernel is free to ignore. The reads go through the page cache, so the
+/// scan finds the data there; the buffer itself is reused.
+void RunFileSequence::Prefetch(const string name, const uint64_t maxBytes) {
+    int descriptor = open(name.c_str(), O_RDONLY);
+    if (descriptor < 0)
+        return;
+    posix_fadvise(descriptor, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    vector<char> buffer(prefetchBlockSize);
+    uint64_t numRead = 0;
+    while (!stop_ && numRead < maxBytes) {
+        ssize_t size = read(descriptor, buffer.data(), (size_t) min((uint64_t) buffer.size(), maxBytes - numRead));
+        if (size <= 0)
+            break;
+        numRead += size;
+        numPrefetched_ += size;
+    }
+    close(descriptor);
+}
+
+void RunFileSequence::StopPrefetch() {
+    if (!prefetch_.joinable())
+        return;
+    stop_ = true;
+    prefetch_.join();
+    stop_ = false;
+}
@@ -10,11 +10,14 @@
  * \author C. R. Thornsberry, S. V. Paulauskas
  * \date Feb. 12th, 2016
  */
+#include <algorithm>
+#include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <sstream>
 #include <thread>
 
+#include <cstdio>
 #include <cstring>
 
 #include <unistd.h>
@@ -23,11 +26,21 @@
 #include "Unpacker.hpp"
 #include "poll2_socket.h"
 #include "CTerminal.h"
+#include "StateArchive.hpp"
 
 #include "ScanInterface.hpp"
 
 using namespace std;
 
+/// Marks the start and the end of a checkpoint file.
+static const char checkpointMagic[8] = {'P', 'A', 'A', 'S', 'S', 'C', 'K', 'P'};
+
+/// The version of the checkpoint files, increased when their content changes.
+static const uint32_t checkpointVersion = 1;
+
+/// The largest fraction of the scan time that may be spent on checkpoints.
+static const double maxCheckpointFraction = 0.05;
+
 void start_run_control(ScanInterface *main_) {
     main_->RunControl();
 }
@@ -127,6 +140,11 @@ void ScanInterface::start_scan() {
     else if (is_running)
         cout << " Already running.\n";
     else {
+        if (scan_start_time == chrono::steady_clock::time_point()) {
+            scan_start_time = chrono::steady_clock::now();
+            next_checkpoint_time = scan_start_time + chrono::duration_cast<chrono::steady_clock::duration>(
+                    chrono::duration<double>(checkpoint_period));
+        }
         unpacker_->Run();
         is_running = true;
         total_stopped = false;
@@ -196,20 +214,201 @@ bool ScanInterface::rewind(const unsigned long &offset_/*=0*/) {
     // Move to the first word in the file.
     cout << " Seeking to word no. " << offset_ << " in file\n";
     input_file.seekg(offset_ * 4, input_file.beg);
+
+    // The header of an event cache is not a spill.
+    string header;
+    if (file_format == 4 && offset_ == 0) {
+        input_file.seekg(8, input_file.beg);
+        read_cache_block(header);
+    }
     cout << " Input file is now at " << input_file.tellg() << " bytes\n";
 
+    // The other crates have no common word numbering, they start over.
+    for (vector<CrateInput *>::iterator it = crate_inputs.begin(); it != crate_inputs.end(); it++) {
+        (*it)->file.clear();
+        (*it)->file.seekg((*it)->start);
+        (*it)->data.Reset();
+        (*it)->good = true;
+    }
+
     // Notify that the user has rewound to the start of the file.
     Notify("REWIND_FILE");
 
     return true;
 }
 
+/** The checkpoint of a scan is named after the output file, e.g. out.his
+  * and out.ckpt for "-o out".
+  * \return The name of the checkpoint file.
+  */
+string ScanInterface::get_checkpoint_filename() {
+    return outputPath_ + outputFilename_ + ".ckpt";
+}
+
+/** Save the position in the input file and the state of the unpacker and of
+  * the derived class. Only called between two spills, where no event is half
+  * built. The checkpoint is written to a temporary file which then replaces
+  * the previous one, so that an interrupted write never loses it. A
+  * checkpoint is skipped until the one before it takes less than
+  * maxCheckpointFraction of the time since, which bounds their cost when the
+  * state is large and the period short.
+  * \return Nothing.
+  */
+void ScanInterface::write_checkpoint() {
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    if (checkpoint_period <= 0 || (file_format != 1 && file_format != 4) || start < next_checkpoint_time)
+        return;
+
+    string filename = get_checkpoint_filename();
+    string temporary = filename + ".tmp";
+    uint64_t numBytes = 0;
+    try {
+        ofstream file(temporary.c_str(), ios::binary | ios::trunc);
+        StateWriter writer(file);
+        writer.WriteBytes(checkpointMagic, sizeof(checkpointMagic));
+        writer.Write(checkpointVersion);
+        writer.Write(input_path);
+        writer.Write((uint64_t) file_length);
+        writer.Write((uint64_t) input_file.tellg());
+        writer.Write((uint64_t) num_spills_recvd);
+        unpacker_->SaveState(writer);
+        SaveState(writer);
+        writer.WriteBytes(checkpointMagic, sizeof(checkpointMagic));
+        numBytes = writer.GetNumBytes();
+
+        file.close();
+        if (file.fail())
+            throw IOException("ScanInterface::write_checkpoint - Could not close " + temporary + ".");
+        if (rename(temporary.c_str(), filename.c_str()) != 0)
+            throw IOException("ScanInterface::write_checkpoint - Could not replace " + filename + ".");
+    } catch (exception &ex) {
+        remove(temporary.c_str());
+        cout << "\n" << msgHeader << ex.what() << "\n";
+        cout << msgHeader << "No further checkpoints are written.\n";
+        checkpoint_period = 0;
+        return;
+    }
+
+    chrono::steady_clock::time_point stop = chrono::steady_clock::now();
+    double seconds = chrono::duration<double>(stop - start).count();
+    num_checkpoints++;
+    checkpoint_seconds += seconds;
+
+    double wait = max(checkpoint_period, seconds / maxCheckpointFraction);
+    next_checkpoint_time = stop + chrono::duration_cast<chrono::steady_clock::duration>(
+            chrono::duration<double>(wait));
+
+    double scanSeconds = chrono::duration<double>(stop - scan_start_time).count();
+    cout << "\n" << msgHeader << "Checkpoint " << num_checkpoints << " at spill " << num_spills_recvd << ": "
+         << numBytes / 1048576.0 << " MB in " << seconds << " s (" << 100 * checkpoint_seconds / scanSeconds
+         << "% of the scan time)\n";
+}
+
+/** Load the checkpoint written by an earlier scan of the same input file.
+  * The histograms must be declared and the input file open, the scan
+  * continues with the spill that follows the checkpoint.
+  * \return True upon success and false otherwise.
+  */
+bool ScanInterface::read_checkpoint() {
+    string filename = get_checkpoint_filename();
+    if (file_format != 1 && file_format != 4) {
+        cout << msgHeader << "Only the scans of .pld and .evcache files can be resumed.\n";
+        return false;
+    }
+
+    ifstream file(filename.c_str(), ios::binary);
+    if (!file.good()) {
+        cout << msgHeader << "There is no checkpoint " << filename << " to resume from.\n";
+        return false;
+    }
+
+    try {
+        StateReader reader(file);
+        char magic[sizeof(checkpointMagic)];
+        reader.ReadBytes(magic, sizeof(magic));
+        if (memcmp(magic, checkpointMagic, sizeof(magic)) != 0)
+            throw IOException("ScanInterface::read_checkpoint - " + filename + " is not a checkpoint.");
+        if (reader.Get<uint32_t>() != checkpointVersion)
+            throw IOException("ScanInterface::read_checkpoint - " + filename + " was written by another version.");
+
+        // The checkpoint of a run may be in one of the later files.
+        string path = reader.Get<string>();
+        if (path != input_path && run_mode && run_files.SkipPast(path) && !open_input_file(path))
+            throw IOException("ScanInterface::read_checkpoint - Could not open " + path + ".");
+        if (reader.Get<uint64_t>() != (uint64_t) file_length)
+            throw IOException("ScanInterface::read_checkpoint - The checkpoint was written for " + path
+                              + ", which has another length than " + input_path + ".");
+        uint64_t offset = reader.Get<uint64_t>();
+        uint64_t numSpills = reader.Get<uint64_t>();
+
+        unpacker_->LoadState(reader);
+        LoadState(reader);
+
+        reader.ReadBytes(magic, sizeof(magic));
+        if (memcmp(magic, checkpointMagic, sizeof(magic)) != 0)
+            throw IOException("ScanInterface::read_checkpoint - The end of " + filename + " is missing.");
+
+        input_file.seekg(offset, input_file.beg);
+        num_spills_recvd = numSpills;
+        cout << msgHeader << "Resuming from " << filename << " after spill " << num_spills_recvd << " ("
+             << 100.0 * offset / file_length << "% of the file).\n";
+    } catch (exception &ex) {
+        cout << msgHeader << ex.what() << "\n";
+        cout << msgHeader << "Failed to resume the scan!\n";
+        return false;
+    }
+
+    return true;
+}
+
+/** Read the next block of an event cache, a 32 bit length followed by the
+  * bytes of the block.
+  * \param[out] block_ Receives the bytes of the block.
+  * \return True if a whole block was read and false at the end of the file.
+  */
+bool ScanInterface::read_cache_block(string &block_) {
+    uint32_t size;
+    if (!input_file.read((char *) &size, sizeof(size)))
+        return false;
+    block_.resize(size);
+    if (size != 0 && !input_file.read(&block_[0], size)) {
+        cout << msgHeader << "The event cache ends with an incomplete block!\n";
+        return false;
+    }
+    return true;
+}
+
+/** Called by the run control thread at the end of every file of a run given
+  * with --run. The scan goes on with the next file without being stopped, so
+  * the unpacker keeps its state and the derived class sees one stream of
+  * spills. The file after the next one is read ahead in the background.
+  * \return True if the next file was opened and false at the end of the run.
+  */
+bool ScanInterface::next_run_file() {
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - file_start_time).count();
+    double megabytes = file_length / 1048576.0;
+    num_files_scanned++;
+    run_megabytes += megabytes;
+    run_seconds += seconds;
+    cout << msgHeader << "File " << num_files_scanned << " of the run (" << input_path << "): " << megabytes
+         << " MB and " << num_spills_recvd - file_start_spills << " spills in " << seconds << " s ("
+         << megabytes / seconds << " MB/s), " << run_files.GetNumFiles() << " files left.\n";
+
+    for (string name = run_files.Next(); !name.empty(); name = run_files.Next()) {
+        if (open_input_file(name, true))
+            return true;
+        cout << msgHeader << "Skipping " << name << ", which could not be opened.\n";
+    }
+    return false;
+}
+
 /** Open a new binary input file for reading.
   * \param[in]  fname_ Input filename to open for reading.
+  * \param[in]  next_in_run_ Set by the run control thread to switch to the next file of a run while the scan is running.
   * \return True upon successfully opening the file and false otherwise.
   */
-bool ScanInterface::open_input_file(const string &fname_) {
-    if (is_running) {
+bool ScanInterface::open_input_file(const string &fname_, const bool &next_in_run_/*=false*/) {
+    if (is_running && !next_in_run_) {
         cout << " ERROR! Unable to open input file while scan is running.\n";
         return false;
     } else if (shm_mode) {
@@ -229,12 +428,15 @@ bool ScanInterface::open_input_file(const string &fname_) {
         file_format = 1;
     } else if (extension == "evt") { // NSCLDAQ presort ring buffer format
         file_format = 3;
+    } else if (extension == "evcache") { // Calibrated events cached by an earlier scan
+        file_format = 4;
     } else {
         cout << " ERROR! Invalid file format '" << extension << "'\n";
         cout << "  The current valid data formats are:\n";
         cout << "   ldf - list data format (HRIBF)\n";
         cout << "   pld - pixie list data format\n";
         cout << "   evt - NSCLDAQ presort ring buffer format\n";
+        cout << "   evcache - calibrated events cached by an earlier scan\n";
         return false;
     }
 
@@ -247,6 +449,7 @@ bool ScanInterface::open_input_file(const string &fname_) {
     file_open = true;
 
     // Load the input file.
+    input_path = fname_;
     input_file.open(fname_.c_str(), ios::binary);
     if (!input_file.is_open() || !input_file.good()) {
         cout << " ERROR! Failed to open input file '" << fname_ << "'! Check that the path is correct.\n";
@@ -300,15 +503,127 @@ bool ScanInterface::open_input_file(const string &fname_) {
             cout << endl;
         } else if (file_format == 3) {
             // just skip "header" information for now...
+        } else if (file_format == 4) {
+            // The cache may only be replayed with the configuration that wrote it.
+            char magic[8];
+            string header;
+            if (!input_file.read(magic, sizeof(magic)) || memcmp(magic, "PAASSEVC", sizeof(magic)) != 0
+                || !read_cache_block(header) || !unpacker_->OpenEventCache(header)) {
+                cout << " ERROR! Unable to replay the event cache '" << fname_ << "'.\n";
+                input_file.close();
+                file_open = false;
+                return false;
+            }
+            finfo.push_back("Format", "Event cache");
         }
     }
 
+    if (!crate_filenames.empty() && !open_crate_files()) {
+        input_file.close();
+        file_open = false;
+        return false;
+    }
+
     // Notify that the user has loaded a new file.
     Notify("LOAD_FILE");
 
     return true;
 }
 
+/** Open the .pld files of crates 1, 2, ... and read their HEAD buffers.
+  * The largest spill of all the crates is used for the spill buffer.
+  * \return True upon successfully opening every file and false otherwise.
+  */
+bool ScanInterface::open_crate_files() {
+    close_crate_files();
+
+    if (file_format != 1) {
+        cout << " ERROR! Merging several crates is only supported for pld files.\n";
+        return false;
+    }
+
+    for (vector<string>::iterator it = crate_filenames.begin(); it != crate_filenames.end(); it++) {
+        CrateInput *input = new CrateInput();
+        crate_inputs.push_back(input);
+
+        input->file.open(it->c_str(), ios::binary);
+        if (!input->file.is_open() || !input->file.good() || !input->head.Read(&input->file)) {
+            cout << " ERROR! Failed to open the input file '" << *it << "' of crate " << crate_inputs.size()
+                 << "! Check that the path is correct.\n";
+            close_crate_files();
+            return false;
+        }
+        input->start = input->file.tellg();
+        input->good = true;
+
+        if ((int) input->head.GetMaxSpillSize() > max_spill_size)
+            max_spill_size = input->head.GetMaxSpillSize();
+
+        cout << " Crate " << crate_inputs.size() << " : " << *it << " (run " << input->head.GetRunNumber() << ")\n";
+    }
+    return true;
+}
+
+void ScanInterface::close_crate_files() {
+    for (vector<CrateInput *>::iterator it = crate_inputs.begin(); it != crate_inputs.end(); it++) {
+        if ((*it)->file.is_open())
+            (*it)->file.close();
+        delete *it;
+    }
+    crate_inputs.clear();
+}
+
+/** The spills of the crates are read in step with the spills of crate 0, the
+  * crate that ran out of spills first is left out of the merge. Every crate
+  * is read into the same buffer, ReadCrateSpill copies the traces of the
+  * crates out of it until MergeSpills processes them.
+  * \param[in]  data The spill buffer, the spill of crate 0 was already read from it.
+  * \return Nothing.
+  */
+void ScanInterface::read_crate_spills(unsigned int *data) {
+    unsigned int nBytes;
+    int word1 = 2, word2 = 9999;
+    for (unsigned int i = 0; i < crate_inputs.size(); i++) {
+        CrateInput *input = crate_inputs[i];
+        if (!input->good)
+            continue;
+        if (!input->data.Read(&input->file, (char *) data, nBytes, 4 * max_spill_size, false)) {
+            cout << msgHeader << "Reached the end of the input file of crate " << i + 1 << ".\n";
+            input->good = false;
+            continue;
+        }
+        memcpy(&data[(nBytes / 4)], (char *) &word1, 4);
+        memcpy(&data[(nBytes / 4) + 1], (char *) &word2, 4);
+        unpacker_->ReadCrateSpill(data, nBytes / 4 + 2, i + 1, is_verbose);
+    }
+    unpacker_->MergeSpills();
+}
+
+/** The level starts at the full analysis. Only the spills received from
+  * shared memory are measured, the scans of files never shed load.
+  */
+void ScanInterface::SetLoadShedding(const double &budget_, const unsigned int &num_levels_) {
+    shedder.SetBudget(budget_, num_levels_);
+    if (shedder.IsEnabled())
+        cout << msgHeader << "Shedding load in " << num_levels_ << " level(s) when a spill from shared memory takes "
+             << "more than " << budget_ * 1e3 << " ms to process.\n";
+}
+
+void ScanInterface::update_load_level(const double &seconds_, const bool &dropped_) {
+    unsigned int previous = shedder.GetLevel();
+    if (!shedder.Update(seconds_, dropped_))
+        return;
+    cout << msgHeader << (shedder.GetLevel() > previous ? "Degrading" : "Restoring") << " the analysis to level "
+         << shedder.GetLevel() << " of " << shedder.GetMaxLevel() << " (load " << shedder.GetLoad()
+         << ", backlog " << shedder.GetBacklog() * 1e3 << " ms" << (dropped_ ? ", spill lost" : "") << ").\n";
+    SetLoadLevel(shedder.GetLevel());
+}
+
+void ScanInterface::SetStatus(const std::string &status_) {
+    if (!batch_mode) { term->SetStatus(status_); }
+    else { cout << "\r" << status_ << flush; }
+}
+
 /** Add a command line option to the option list.
   * \param[in]  opt_ The option to add to the list.
   * \return Nothing.
@@ -380,6 +695,18 @@ ScanInterface::ScanInterface() {
 
     file_start_offset = 0;
     num_spills_recvd = 0;
+    num_spills_dropped = 0;
+    num_degraded_events = 0;
+
+    checkpoint_period = 0;
+    resume_mode = false;
+    run_mode = false;
+    num_files_scanned = 0;
+    run_megabytes = 0;
+    run_seconds = 0;
+    file_start_spills = 0;
+    num_checkpoints = 0;
+    checkpoint_seconds = 0;
 
     total_stopped = true;
     write_counts = false;
@@ -406,8 +733,12 @@ ScanInterface::ScanInterface() {
     //Setup all the arguments that are known to the program.
     baseOpts = {
             optionExt("batch", no_argument, NULL, 'b', "", "Run in batch mode (i.e. with no command line)"),
+            optionExt("checkpoint", required_argument, NULL, 0, "<seconds>",
+                      "Save the state of a .pld scan at most every <seconds>, so that it can be resumed"),
             optionExt("config", required_argument, NULL, 'c', "<path>", "Specify path to setup to use for scan"),
             optionExt("counts", no_argument, NULL, 0, "", "Write all recorded channel counts to a file"),
+            optionExt("crates", required_argument, NULL, 0, "<file,...>",
+                      "Specifies the .pld files of crates 1, 2, ... that are merged with the input file, not with --shm"),
             optionExt("debug", no_argument, NULL, 0, "", "Enable readout debug mode"),
             optionExt("dry-run", no_argument, NULL, 0, "", "Extract spills from file, but do no processing"),
             optionExt("fast-fwd", required_argument, NULL, 0, "<word>",
@@ -421,6 +752,10 @@ ScanInterface::ScanInterface() {
             optionExt("output", required_argument, NULL, 'o', "<filename>",
                       "Specifies the name of the output file. Default is \"out\""),
             optionExt("quiet", no_argument, NULL, 'q', "", "Toggle off verbosity flag"),
+            optionExt("resume", no_argument, NULL, 0, "", "Resume the scan from the last checkpoint of the output file"),
+            optionExt("run", required_argument, NULL, 0, "<file,...>",
+                      "Scan the files as one run, in poll2 rollover order. Takes file names, glob patterns and "
+                      "@<list> files with one name or pattern per line"),
             optionExt("shm", no_argument, NULL, 's', "", "Enable shared memory readout"),
             optionExt("version", no_argument, NULL, 'v', "", "Display version information")
     };
@@ -472,7 +807,12 @@ void ScanInterface::RunControl() {
             IdleTask();
             usleep(1);
             continue;
-        } else if (shm_mode) {
+        }
+
+        file_start_time = chrono::steady_clock::now();
+        file_start_spills = num_spills_recvd;
+
+        if (shm_mode) {
             cout << endl;
             unsigned int data[250000]; // Array for storing spill data. Larger than any RevF spill should be.
             unsigned int *shm_data = new unsigned int[maxShmSizeL]; // Array to store the temporary shm data (~16 kB)
@@ -484,6 +824,7 @@ void ScanInterface::RunControl() {
             unsigned int nTotalWords;
 
             bool full_spill = false;
+            bool lost_chunk = false;
 
             while (true) {
                 if (kill_all == true) {
@@ -500,6 +841,7 @@ void ScanInterface::RunControl() {
                 total_chunks = -1;
                 nTotalWords = 0;
                 full_spill = true;
+                lost_chunk = false;
 
                 if (!poll_server->Select(dummy)) {
                     if (!batch_mode) {
@@ -547,6 +889,7 @@ void ScanInterface::RunControl() {
                             cout << "debug: Found chunk " << current_chunk << " but expected chunk "
                                  << previous_chunk + 1 << endl;
                         }
+                        lost_chunk = true;
                         break;
                     }
 
@@ -567,6 +910,9 @@ void ScanInterface::RunControl() {
                 stringstream status;
                 status << "\033[0;32m" << "[RECV] " << "\033[0m" << nTotalWords
                        << " words";
+                if (shedder.IsEnabled())
+                    status << " | SHED " << shedder.GetLevel() << "/" << shedder.GetMaxLevel() << ", "
+                           << num_degraded_events << " degraded events";
                 if (!batch_mode) { term->SetStatus(status.str()); }
                 else { cout << "\r" << status.str(); }
 
@@ -577,12 +923,22 @@ void ScanInterface::RunControl() {
                     int word1 = 2, word2 = 9999;
                     memcpy(&data[nTotalWords], (char *) &word1, 4);
                     memcpy(&data[nTotalWords + 1], (char *) &word2, 4);
+                    chrono::steady_clock::time_point spill_start = chrono::steady_clock::now();
+                    unsigned int num_events = unpacker_->GetNumRawEvents();
                     unpacker_->ReadSpill(data, nTotalWords + 2, is_verbose);
+                    if (shedder.GetLevel() > 0)
+                        num_degraded_events += unpacker_->GetNumRawEvents() - num_events;
+                    if (shedder.IsEnabled())
+                        update_load_level(chrono::duration<double>(chrono::steady_clock::now() - spill_start).count(),
+                                          lost_chunk);
                     IdleTask();
+                } else if (!full_spill && shedder.IsEnabled()) {
+                    update_load_level(0, true);
                 }
 
                 if (!full_spill) {
                     cout << msgHeader << "Not processing spill fragment!\n";
+                    num_spills_dropped++;
                 } else { num_spills_recvd++; }
             }
 
@@ -709,9 +1065,14 @@ void ScanInterface::RunControl() {
                     memcpy(&data[(nBytes / 4)], (char *) &word1, 4);
                     memcpy(&data[(nBytes / 4) + 1], (char *) &word2, 4);
                     unpacker_->ReadSpill(data, nBytes / 4 + 2, is_verbose);
+                    if (!crate_inputs.empty())
+                        read_crate_spills(data);
                     IdleTask();
                 }
                 num_spills_recvd++;
+
+                if (!dry_run_mode)
+                    write_checkpoint();
             }
 
             if (eofbuff.ReadHeader(&input_file)) {
@@ -727,14 +1088,52 @@ void ScanInterface::RunControl() {
             } else { cout << endl << endl; }
         } else if (file_format == 2) {
             if (debug_mode) cout << "debug: file_format == 2: root (not implemented)" << endl;
+        } else if (file_format == 4) {
+            if (debug_mode) cout << "debug: file_format == 4: evcache" << endl;
+
+            // Every block holds the calibrated events of one spill.
+            string block;
+            while (true) {
+                if (kill_all == true) {
+                    break;
+                } else if (!is_running) {
+                    IdleTask();
+                    usleep(100000); //0.1 seconds
+                    continue;
+                }
+
+                if (!read_cache_block(block)) { break; }
+
+                stringstream status;
+                status << "\033[0;32m" << "[READ] " << "\033[0m" << block.size() << " bytes ("
+                       << 100 * input_file.tellg() / file_length << "%)";
+                if (!batch_mode) { term->SetStatus(status.str()); }
+                else { cout << "\r" << status.str(); }
+
+                if (!dry_run_mode) {
+                    unpacker_->ReplayEventCache(block.data(), block.size());
+                    IdleTask();
+                }
+                num_spills_recvd++;
+
+                if (!dry_run_mode)
+                    write_checkpoint();
+            }
+
+            if (!batch_mode) {
+                term->SetStatus("\033[0;33m[IDLE]\033[0m Finished scanning file.");
+            } else { cout << endl << endl; }
         }
         else if (file_format == 3) {
             if (debug_mode) cout << "debug: file_format == 3: evt" << endl;
 
-            std::vector<unsigned int> spillbuf; // spill buffer
-            std::vector<unsigned int> modfifo; // module fifo
-            int prevmodn = 0;
-            unsigned int prevnBytes = 0;
+            unsigned int *spill;
+            unsigned int nWords;
+
+            // Reset the ring reader to default values.
+            ringReader.Reset();
+            ringReader.SetDebugMode(debug_mode);
+            ringReader.SetNumModules(unpacker_->GetNumModules());
 
             while (true) {
                 if (kill_all == true) {
@@ -745,127 +1144,29 @@ void ScanInterface::RunControl() {
                     continue;
                 }
 
-                if (!input_file.is_open() || !input_file.good()) { break; }
-                std::vector<unsigned int> modfifofrag; // module fifo fragment, this is needed because module fifo data is chopped into multiple ring items
-                unsigned int nBytes = 0; // module fifo data fragment size in bytes
-                // ring item size is self inclusive
-                unsigned int ringitemsize = 0;
-                unsigned int ringitemtype;
-                unsigned int bodyhdrsize = 0;
-                input_file.read((char *) &ringitemsize, 4); // ring item size (in bytes) self inclusive
-                input_file.read((char *) &ringitemtype, 4); // 30 for PHYSICS_EVENTS
-                if (ringitemtype == 30) {
-                    input_file.read((char *) &bodyhdrsize, 4);
-                    if (bodyhdrsize == 0) { // PHYSICS_EVENT of pre-sort ring has no body header
-                        if (debug_mode) std::cout << "debug: got a PHYSICS_EVENT item (ring item type " << ringitemtype << ")" << std::endl;
-                        // skip two words inserted by NSCLDAQ
-                        input_file.seekg(8, input_file.cur);
-                        nBytes = ringitemsize-20;
-                        // this is raw pixie list-mode data
-                        modfifofrag.resize(nBytes/4);
-                        input_file.read((char *) modfifofrag.data(), nBytes);
-                    } else { // if body header size is NOT zero, it's NOT a PHYSICS_EVENT we are looking for
-                        if (debug_mode) std::cout << "debug: got a PHYSICS_EVENT item (ring item type " << ringitemtype << ") but non-zero body header size" << std::endl;
-                        // most likely bodyhdrsize == 20 but it doesn't matter, just skip the rest
-                        input_file.seekg(ringitemsize-12, input_file.cur);
-                    }
-                } else {
-                    if (debug_mode) std::cout << "debug: got a non-PHYSICS_EVENT item (ring item type " << ringitemtype << "), skipping..." << std::endl;
-                    input_file.seekg(ringitemsize-8, input_file.cur);
-                    if(input_file.eof()) break;
-                }
-
-                if (nBytes == 0) { continue; }
+                if ((spill = ringReader.Read(&input_file, nWords)) == NULL) { break; }
 
                 stringstream status;
-                status << "\033[0;32m" << "[READ] " << "\033[0m" << nBytes / 4 << " words ("
-                       << 100 * input_file.tellg() / file_length << "%)";
+                status << "\033[0;32m" << "[READ] " << "\033[0m" << nWords << " words ("
+                       << 100 * ringReader.GetBytesRead() / file_length << "%)";
                 if (!batch_mode) { term->SetStatus(status.str()); }
                 else { cout << "\r" << status.str(); }
 
                 if (debug_mode) {
-                    cout << "debug: Retrieved *partial* module fifo data of " << nBytes << " bytes (" << nBytes / 4 << " words)\n";
-                    cout << "debug: Read up to word number " << input_file.tellg() / 4 << " in input file\n";
+                    cout << "debug: Retrieved spill of " << nWords << " words\n";
+                    cout << "debug: Read up to word number " << ringReader.GetBytesRead() / 4 << " in input file\n";
                 }
 
                 if (!dry_run_mode) {
-                    int modn = 9999;
-                    // peek the first pixie event
-                    // a bit of sanity check + module (slot) number extraction
-                    if (nBytes >= 32) { // there's one pixie event at least
-                        unsigned int pixhead1 = modfifofrag[0];
-                        // this is revision specific!! has to be changed for RevH
-                        modn = (pixhead1 >> 4) & 0xf;
-                        modn -= 2; // modnum is slotnum - 2
-                        if (debug_mode) {
-                            std::cout << "debug: first pixie event header in this module fifo fragment 0x"  << std::setfill('0') << std::setw(8) << std::right << std::hex << pixhead1;
-                            std::cout << " (module number " << std::dec << modn << ")" << std::endl;
-                        }
-                        if (modn < 0) {
-                            std::cout << "invalid slot number (got" << modn << "), likely corrupted data" << std::endl;
-                            continue;
-                        }
-                    } else {
-                        std::cout << "data size of this ring item is too small (" << nBytes << " bytes), likely corrupted data" << std::endl;
-                        continue;
-                    }
-
-                    // detect completion of module fifo
-                    if (prevmodn < modn) {
-                        if (debug_mode) std::cout << "debug: module fifo completion detected" << std::endl;
-                        spillbuf.push_back(modfifo.size()+2); // number of words (including this header)
-                        spillbuf.push_back(prevmodn);
-                        spillbuf.insert(spillbuf.end(), modfifo.begin(), modfifo.end());
-                        if(prevmodn != modn-1){
-                           int diff = modn-prevmodn-1;
-                           for(int i=0; i<diff; i++){
-                              spillbuf.push_back(2); // number of words (including this header)
-                              spillbuf.push_back(prevmodn+i+1);
-                           }
-                        }
-                        modfifo.clear();
-                    }
-                    // detect completion of a spill
-                    // second condition is for systems where only one module is present
-                    else if ( (prevmodn > modn) || (prevmodn == modn && prevnBytes < nBytes)){
-                        if (debug_mode) std::cout << "debug: spill completion detected" << std::endl;
-                        spillbuf.push_back(modfifo.size()+2); // number of words (including this header)
-                        spillbuf.push_back(prevmodn);
-                        spillbuf.insert(spillbuf.end(), modfifo.begin(), modfifo.end());
-                        if(prevmodn != 12){
-                           int diff = 12-prevmodn;
-                           for(int i=0; i<diff; i++){
-                              spillbuf.push_back(2); // number of words (including this header)
-                              spillbuf.push_back(prevmodn+i+1);
-                           }
-                        }
-                        // spill delimiter
-                        spillbuf.push_back(2);
-                        spillbuf.push_back(9999);
-                        unpacker_->ReadSpill(spillbuf.data(), spillbuf.size(), is_verbose);
-                        IdleTask();
-                        num_spills_recvd++;
-                        spillbuf.clear();
-                        modfifo.clear();
-                    }
-
-                    modfifo.insert(modfifo.end(), modfifofrag.begin(), modfifofrag.begin()+nBytes/4);
-                    prevnBytes = nBytes;
-                    prevmodn = modn;
+                    unpacker_->ReadSpill(spill, nWords, is_verbose);
+                    IdleTask();
                 }
+                num_spills_recvd++;
             }
 
-            if (!dry_run_mode) {
-                if (debug_mode) std::cout << "debug: closing out last spill" << std::endl;
-                if (spillbuf.size()>0 || modfifo.size()>0) {
-                    spillbuf.push_back(modfifo.size()+2); // number of words (including this header)
-                    spillbuf.push_back(prevmodn);
-                    spillbuf.insert(spillbuf.end(), modfifo.begin(), modfifo.end());
-                    spillbuf.push_back(2);
-                    spillbuf.push_back(9999);
-                    unpacker_->ReadSpill(spillbuf.data(), spillbuf.size(), is_verbose);
-                    num_spills_recvd++;
-                }
+            if (debug_mode) {
+                cout << "debug: Read " << ringReader.GetNumRingItems() << " ring items, "
+                     << ringReader.GetNumFragments() << " module fifo fragments\n";
             }
 
             if (!batch_mode) {
@@ -873,6 +1174,10 @@ void ScanInterface::RunControl() {
             } else { cout << endl << endl; }
         }
 
+        // Go on with the next file of the run without stopping the scan.
+        if (run_mode && !kill_all && next_run_file())
+            continue;
+
         // Notify that the scan has completed.
         Notify("SCAN_COMPLETE");
 
@@ -979,7 +1284,7 @@ void ScanInterface::CmdControl() {
             if (p_args > 0) {
                 if (!open_input_file(arguments.at(0))) {
                     cout << msgHeader << "Failed to open input file!\n";
-                }
+                } else { run_files.Clear(); } // A file loaded by hand ends the run given with --run.
             } else {
                 cout << msgHeader
                           << "Invalid number of parameters to 'file'\n";
@@ -1027,6 +1332,8 @@ bool ScanInterface::Setup(int argc, char *argv[], Unpacker *unpacker/*=NULL*/) {
     dry_run_mode = false;
     shm_mode = false;
     num_spills_recvd = 0;
+    num_spills_dropped = 0;
+    num_degraded_events = 0;
     unsigned int samplingFrequency = 0;
     string firmware = "";
     string input_filename = "";
@@ -1057,16 +1364,29 @@ bool ScanInterface::Setup(int argc, char *argv[], Unpacker *unpacker/*=NULL*/) {
     while ((retval = getopt_long(argc, argv, optstr.c_str(), longOpts.data(),
                                  &idx)) != -1) {
         if (retval == 0x0) { // Long option
-            if (strcmp("config", longOpts[idx].name) == 0) {
+            if (strcmp("checkpoint", longOpts[idx].name) == 0) {
+                checkpoint_period = atof(optarg);
+            } else if (strcmp("config", longOpts[idx].name) == 0) {
                 setup_filename = optarg;
             } else if (strcmp("counts", longOpts[idx].name) == 0) {
                 write_counts = true;
+            } else if (strcmp("crates", longOpts[idx].name) == 0) {
+                stringstream list(optarg);
+                string name;
+                while (getline(list, name, ','))
+                    if (!name.empty())
+                        crate_filenames.push_back(name);
             } else if (strcmp("debug", longOpts[idx].name) == 0) {
                 debug_mode = true;
             } else if (strcmp("dry-run", longOpts[idx].name) == 0) {
                 dry_run_mode = true;
             } else if (strcmp("fast-fwd", longOpts[idx].name) == 0) {
                 file_start_offset = atoll(optarg);
+            } else if (strcmp("resume", longOpts[idx].name) == 0) {
+                resume_mode = true;
+            } else if (strcmp("run", longOpts[idx].name) == 0) {
+                run_files.Add(optarg);
+                run_mode = true;
             } else if (strcmp("frequency", longOpts[idx].name) == 0)
                 samplingFrequency = (unsigned int) stoi(optarg);
             else if (strcmp("firmware", longOpts[idx].name) == 0)
@@ -1148,6 +1468,27 @@ bool ScanInterface::Setup(int argc, char *argv[], Unpacker *unpacker/*=NULL*/) {
         throw invalid_argument("ScanInterface::Setup - Firmware/Frequency Flags or Config file are not set properly. "
                                        "Cannot Initialize Data Mask.");
 
+    if ((checkpoint_period > 0 || resume_mode) && (shm_mode || !crate_filenames.empty() || file_start_offset != 0))
+        throw invalid_argument("ScanInterface::Setup - Checkpoints are only supported for a single .pld input file "
+                                       "read from its start, not with --shm, --crates or --fast-fwd.");
+
+    //! Shared memory delivers the spills of one crate, the spills of more crates
+    //! would never be merged and pile up in the unpacker.
+    if (shm_mode && !crate_filenames.empty())
+        throw invalid_argument("ScanInterface::Setup - The files of --crates can not be combined with --shm.");
+
+    if (run_mode) {
+        if (shm_mode || !crate_filenames.empty() || !input_filename.empty())
+            throw invalid_argument("ScanInterface::Setup - The files of a --run can not be combined with --shm, "
+                                           "--crates or --input.");
+        cout << msgHeader << "Scanning a run of " << run_files.GetNumFiles() << " files.\n";
+        input_filename = run_files.Next();
+    }
+
+    unpacker_->SetNumberOfCrates((unsigned int) crate_filenames.size() + 1);
+    if (setup_filename != "")
+        unpacker_->InitializeCrates(setup_filename);
+
     if (debug_mode)
         unpacker_->SetDebugMode();
 
@@ -1199,6 +1540,13 @@ bool ScanInterface::Setup(int argc, char *argv[], Unpacker *unpacker/*=NULL*/) {
     if (!shm_mode && !input_filename.empty()) {
         cout << msgHeader << "Using filename " << input_filename << ".\n";
         if (open_input_file(input_filename)) {
+            if (checkpoint_period > 0 && file_format != 1 && file_format != 4)
+                cout << msgHeader << "Checkpoints are only written for .pld and .evcache files.\n";
+
+            // Continue from the last checkpoint, the histograms are already declared.
+            if (resume_mode && !read_checkpoint())
+                return false;
+
             // Start the scan.
             start_scan();
         } else { cout << msgHeader << "Failed to load input file!\n"; }
@@ -1270,9 +1618,17 @@ bool ScanInterface::Close() {
     //Reprint the leader as the carriage was returned
     cout << "Running " << progName << " v" << SCAN_VERSION << " (" << SCAN_DATE << ")\n";
     cout << msgHeader << "Retrieved " << num_spills_recvd << " spills!\n";
+    if (num_files_scanned > 0) {
+        cout << msgHeader << "Scanned " << num_files_scanned << " files of the run: " << run_megabytes << " MB in "
+             << run_seconds << " s (" << run_megabytes / run_seconds << " MB/s), "
+             << run_files.GetNumPrefetchedBytes() / 1048576.0 << " MB read ahead.\n";
+    }
+    if (num_checkpoints > 0)
+        cout << msgHeader << "Wrote " << num_checkpoints << " checkpoints in " << checkpoint_seconds << " s.\n";
 
     if (input_file.good())
         input_file.close();
+    close_crate_files();
 
     // Clean up detector driver
     cout << "\n" << msgHeader << "Cleaning up...\n";
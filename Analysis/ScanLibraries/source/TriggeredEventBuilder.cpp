@@ -0,0 +1,147 @@
+///@file TriggeredEventBuilder.cpp
+///@brief Builds events around trigger channels with a coincidence window per
+/// detector
+///@date October 19, 2026
+#include <algorithm>
+#include <iomanip>
+#include <stdexcept>
+
+#include "TriggeredEventBuilder.hpp"
+#include "XiaData.hpp"
+
+using namespace std;
+
+///The windows are in filter clock ticks, so the hits are sorted by the time
+/// without the CFD, GetTime is in ADC samples that depend on the module.
+static bool CompareTimeSansCfd(const XiaData *lhs, const XiaData *rhs) {
+    return lhs->GetTimeSansCfd() < rhs->GetTimeSansCfd();
+}
+
+TriggeredEventBuilder::TriggeredEventBuilder() : numTriggers_(0), maxPre_(0), maxPost_(0), numEvents_(0), low_(0),
+                                                 next_(0) {
+    Window window = {"default", 0, 0, 0, 0};
+    windows_.push_back(window);
+}
+
+TriggeredEventBuilder::~TriggeredEventBuilder() {
+    for (vector<XiaData *>::iterator it = hits_.begin(); it != hits_.end(); it++)
+        delete *it;
+}
+
+unsigned int TriggeredEventBuilder::AddWindow(const std::string &name, const double &pre, const double &post) {
+    if (pre < 0 || post < 0)
+        throw invalid_argument("TriggeredEventBuilder::AddWindow - The window \"" + name + "\" must have a positive "
+                "pre and post.");
+    Window window = {name, pre, post, 0, 0};
+    windows_.push_back(window);
+    UpdateLimits();
+    return (unsigned int) windows_.size() - 1;
+}
+
+void TriggeredEventBuilder::SetDefaultWindow(const double &pre, const double &post) {
+    if (pre < 0 || post < 0)
+        throw invalid_argument("TriggeredEventBuilder::SetDefaultWindow - The window must have a positive pre and "
+                                       "post.");
+    windows_[0].pre = pre;
+    windows_[0].post = post;
+    UpdateLimits();
+}
+
+void TriggeredEventBuilder::SetWindow(const unsigned int &id, const unsigned int &window) {
+    if (window >= windows_.size())
+        throw out_of_range("TriggeredEventBuilder::SetWindow - Window " + to_string(window) + " does not exist.");
+    if (id >= channelWindows_.size())
+        channelWindows_.resize(id + 1, 0);
+    channelWindows_[id] = window;
+}
+
+void TriggeredEventBuilder::SetTrigger(const unsigned int &id) {
+    if (id >= triggers_.size())
+        triggers_.resize(id + 1, false);
+    if (!triggers_[id])
+        numTriggers_++;
+    triggers_[id] = true;
+}
+
+void TriggeredEventBuilder::UpdateLimits() {
+    maxPre_ = maxPost_ = 0;
+    for (vector<Window>::const_iterator it = windows_.begin(); it != windows_.end(); it++) {
+        maxPre_ = max(maxPre_, it->pre);
+        maxPost_ = max(maxPost_, it->post);
+    }
+}
+
+void TriggeredEventBuilder::Reject(const size_t &hit) {
+    GetWindow(hits_[hit]->GetId()).rejected++;
+    delete hits_[hit];
+    hits_[hit] = NULL;
+}
+
+///The lists are already sorted, so the sort of the whole spill is mostly
+/// merging runs.
+void TriggeredEventBuilder::Start(std::vector<std::deque<XiaData *> > &lists) {
+    for (size_t i = low_; i < hits_.size(); i++)
+        if (hits_[i])
+            Reject(i);
+    hits_.clear();
+    low_ = next_ = 0;
+
+    for (vector<deque<XiaData *> >::iterator it = lists.begin(); it != lists.end(); it++) {
+        hits_.insert(hits_.end(), it->begin(), it->end());
+        it->clear();
+    }
+    stable_sort(hits_.begin(), hits_.end(), &CompareTimeSansCfd);
+}
+
+///A hit that is more than the widest pre before a trigger is too early for
+/// this trigger and all the later ones, so it is rejected as soon as low_
+/// passes it. A hit between low_ and the widest post after the trigger that
+/// is outside of its own window stays for the next trigger.
+bool TriggeredEventBuilder::Next(std::deque<XiaData *> &event, double &triggerTime) {
+    while (next_ < hits_.size() && (!hits_[next_] || !IsTrigger(hits_[next_]->GetId())))
+        next_++;
+
+    if (next_ == hits_.size()) {
+        for (; low_ < hits_.size(); low_++)
+            if (hits_[low_])
+                Reject(low_);
+        hits_.clear();
+        low_ = next_ = 0;
+        return false;
+    }
+
+    triggerTime = hits_[next_]->GetTimeSansCfd();
+
+    for (; low_ < next_; low_++) {
+        if (!hits_[low_])
+            continue;
+        if (hits_[low_]->GetTimeSansCfd() >= triggerTime - maxPre_)
+            break;
+        Reject(low_);
+    }
+
+    for (size_t i = low_; i < hits_.size(); i++) {
+        if (!hits_[i])
+            continue;
+        double dtime = hits_[i]->GetTimeSansCfd() - triggerTime;
+        if (dtime > maxPost_)
+            break;
+        Window &window = GetWindow(hits_[i]->GetId());
+        if (dtime < -window.pre || dtime > window.post)
+            continue;
+        window.admitted++;
+        event.push_back(hits_[i]);
+        hits_[i] = NULL;
+    }
+
+    numEvents_++;
+    return true;
+}
+
+void TriggeredEventBuilder::Print(std::ostream &out) const {
+    out << "Triggered events : " << numEvents_ << " events\n";
+    out << setw(24) << left << "  Window" << setw(14) << right << "Admitted" << setw(14) << "Rejected" << "\n";
+    for (vector<Window>::const_iterator it = windows_.begin(); it != windows_.end(); it++)
+        out << "  " << setw(22) << left << it->name << setw(14) << right << it->admitted << setw(14) << it->rejected
+            << "\n";
+}
@@ -10,13 +10,17 @@
  * \date February 12, 2016
  */
 #include <algorithm>
+#include <chrono>
 #include <fstream>
 #include <iostream>
 #include <limits>
 
+#include <cmath>
 #include <cstring>
 
 #include "Exceptions.hpp"
+#include "ScanLog.hpp"
+#include "StateArchive.hpp"
 #include "Unpacker.hpp"
 #include "XiaData.hpp"
 #include "XiaListModeDataDecoder.hpp"
@@ -80,8 +84,8 @@ bool Unpacker::BuildRawEvent() {
 
             if (mod > MAX_PIXIE_MOD ||
                 chan > MAX_PIXIE_CHAN) { // Skip this channel
-                cout << "BuildRawEvent: Encountered non-physical Pixie ID (mod = "
-                     << mod << ", chan = " << chan << ")\n";
+                SCAN_LOG(ScanLog::WARNING, "BuildRawEvent: Encountered non-physical Pixie ID (mod = %.0f, chan = %.0f)",
+                         mod, chan);
                 delete current_event;
                 iter->pop_front();
                 continue;
@@ -91,8 +95,8 @@ bool Unpacker::BuildRawEvent() {
 
             // Check for backwards time-skip. This is un-handled currently and needs fixed CRT!!!
             if (currtime < eventStartTime)
-                cout << "BuildRawEvent: Detected backwards time-skip from start=" << eventStartTime << " to "
-                     << current_event->GetTimeSansCfd() << "???\n";
+                SCAN_LOG(ScanLog::WARNING, "BuildRawEvent: Detected backwards time-skip from start=%.0f to %.0f???",
+                         eventStartTime, currtime);
 
             // If the time difference between the current and previous event is
             // larger than the event width, finalize the current event, otherwise
@@ -125,19 +129,54 @@ bool Unpacker::BuildRawEvent() {
     return true;
 }
 
+///The hits that are not in the window of a trigger never reach the raw event,
+/// so they are neither processed nor counted by RawStats.
+bool Unpacker::BuildTriggeredEvent() {
+    if (!rawEvent.empty())
+        ClearRawEvent();
+
+    double triggerTime;
+    if (!triggered_.Next(rawEvent, triggerTime))
+        return false;
+
+    realStartTime = realStopTime = triggerTime;
+    for (deque<XiaData *>::iterator it = rawEvent.begin(); it != rawEvent.end(); it++) {
+        double currtime = (*it)->GetTimeSansCfd();
+        if (currtime < realStartTime)
+            realStartTime = currtime;
+        if (currtime > realStopTime)
+            realStopTime = currtime;
+    }
+
+    if (numRawEvt == 0) {
+        firstTime = realStartTime;
+        std::cout << "BuildTriggeredEvent: First event time is " << firstTime << " clock ticks.\n";
+    }
+    eventStartTime = realStartTime;
+
+    for (deque<XiaData *>::iterator it = rawEvent.begin(); it != rawEvent.end(); it++)
+        RawStats(*it);
+
+    numRawEvt++;
+
+    return true;
+}
+
 /** Push an event into the event list.
   * \param[in]  event_ The XiaData to push onto the back of the event list.
   * \return True if the XiaData's module number is valid and false otherwise. */
 bool Unpacker::AddEvent(XiaData *event_) {
-    if (event_->GetModuleNumber() > MAX_PIXIE_MOD)
+    if (event_->GetModuleNumber() > MAX_PIXIE_MOD || event_->GetCrateNumber() >= aligner_.GetNumberOfCrates())
         return false;
 
+    unsigned int index = event_->GetCrateNumber() * (MAX_PIXIE_MOD + 1) + event_->GetModuleNumber();
+
     // Check for the need to add a new deque to the event list.
-    if (event_->GetModuleNumber() + 1 > (unsigned int) eventList.size())
-        while (eventList.size() < event_->GetModuleNumber() + 1)
+    if (index + 1 > (unsigned int) eventList.size())
+        while (eventList.size() < index + 1)
             eventList.push_back(std::deque<XiaData *>());
 
-    eventList.at(event_->GetModuleNumber()).push_back(event_);
+    eventList.at(index).push_back(event_);
 
     return true;
 }
@@ -150,6 +189,12 @@ void Unpacker::ClearEventList() {
         clearDeque((*iter));
 }
 
+///Delete the events of one crate, the spills of the other crates are kept.
+void Unpacker::ClearCrate(const unsigned int &crate) {
+    for (unsigned int i = crate * (MAX_PIXIE_MOD + 1); i < (crate + 1) * (MAX_PIXIE_MOD + 1) && i < eventList.size(); i++)
+        clearDeque(eventList[i]);
+}
+
 /** Clear all events in the raw event list. WARNING! This method will delete all events in the
   * event list. This could cause seg faults if the events are used elsewhere.
   * \return Nothing. */
@@ -193,29 +238,45 @@ void Unpacker::ProcessRawEvent() {
 /// channel, trace, etc. of the timestamped event. This method will construct the event list for later processing.
 ///@param[in] buf : Pointer to an array of unsigned ints containing raw buffer data.
 ///@return The number of XiaDatas read from the buffer.
+///The modules of crate c are numbered c * (MAX_PIXIE_MOD + 1) + vsn in the
+/// configuration, as in XiaData::GetId. If that module is not in the
+/// configuration the mask of module vsn is used, the crates usually share
+/// their firmware.
 int Unpacker::ReadBuffer(unsigned int *buf, const unsigned int &vsn) {
     static XiaListModeDataDecoder decoder;
 
+    std::vector<XiaData *> decodedList = decoder.DecodeBuffer(buf, GetCrateDataMask(currentCrate_, vsn));
+    for (vector<XiaData *>::iterator it = decodedList.begin(); it != decodedList.end(); it++) {
+        (*it)->SetCrateNumber(currentCrate_);
+        if (aligner_.IsReference(currentCrate_, (*it)->GetModuleNumber(), (*it)->GetChannelNumber()))
+            aligner_.AddReferenceTime(currentCrate_, (*it)->GetTimeSansCfd());
+        if (!AddEvent(*it))
+            delete *it;
+    }
+    return (int) decodedList.size();
+}
+
+const XiaListModeDataMask &Unpacker::GetCrateDataMask(const unsigned int &crate, const unsigned int &vsn) {
     if (maskMap_.size() != 0) {
-        auto found = maskMap_.find(vsn);
+        auto found = maskMap_.find(crate * (MAX_PIXIE_MOD + 1) + vsn);
+        if (found == maskMap_.end())
+            found = maskMap_.find(vsn);
         if(found == maskMap_.end())
-            throw invalid_argument("Unpacker::ReadBuffer - Unable to locate VSN = " + to_string(vsn)
+            throw invalid_argument("Unpacker::GetCrateDataMask - Unable to locate VSN = " + to_string(vsn)
                                    + " in the maskMap. Ensure that it's defined in your configuration file!");
         mask_.SetFirmware((*found).second.first);
         mask_.SetFrequency((*found).second.second);
     }
-
-    std::vector<XiaData *> decodedList = decoder.DecodeBuffer(buf, mask_);
-    for (vector<XiaData *>::iterator it = decodedList.begin(); it != decodedList.end(); it++)
-        AddEvent(*it);
-    return (int) decodedList.size();
+    return mask_;
 }
 
 Unpacker::Unpacker() : debug_mode(false), eventWidth_(62), running(true),
+                       currentCrate_(0), driftTolerance_(1), mergeRate_(0), isTriggered_(false),
                        TOTALREAD(1000000), // Maximum number of data words to read.
                        maxWords(131072), // Maximum number of data words for revision D.
                        numRawEvt(0), // Count of raw events read from file.
                        firstTime(0), eventStartTime(0), realStartTime(0), realStopTime(0) {
+    aligner_.SetNumberOfCrates(1);
 
     for (unsigned int i = 0; i <= MAX_PIXIE_MOD; i++)
         for (unsigned int j = 0; j <= MAX_PIXIE_CHAN; j++)
@@ -225,6 +286,8 @@ Unpacker::Unpacker() : debug_mode(false), eventWidth_(62), running(true),
 Unpacker::~Unpacker() {
     ClearRawEvent();
     ClearEventList();
+    if (isTriggered_)
+        triggered_.Print(cout);
 }
 
 void Unpacker::InitializeDataMask(const std::string &firmware, const unsigned int &frequency) {
@@ -258,6 +321,17 @@ void Unpacker::InitializeDataMask(const std::string &firmware, const unsigned in
     }
 }
 
+XiaListModeDataMask Unpacker::GetDataMask(const unsigned int &vsn) const {
+    if (maskMap_.size() == 0)
+        return mask_;
+
+    auto found = maskMap_.find(vsn);
+    if (found == maskMap_.end())
+        throw invalid_argument("Unpacker::GetDataMask - Unable to locate VSN = " + to_string(vsn)
+                               + " in the maskMap. Ensure that it's defined in your configuration file!");
+    return XiaListModeDataMask((*found).second.first, (*found).second.second);
+}
+
 /** ReadSpill is responsible for constructing a list of pixie16 events from
   * a raw data spill. This method performs sanity checks on the spill and
   * calls ReadBuffer in order to construct the event list.
@@ -267,6 +341,16 @@ void Unpacker::InitializeDataMask(const std::string &firmware, const unsigned in
   * \return True if the spill was read successfully and false otherwise.
   */
 bool Unpacker::ReadSpill(unsigned int *data, unsigned int nWords, bool is_verbose/*=true*/) {
+    return ReadCrateSpill(data, nWords, 0, is_verbose);
+}
+
+bool Unpacker::ReadCrateSpill(unsigned int *data, unsigned int nWords, const unsigned int &crate,
+                              bool is_verbose/*=true*/) {
+    if (crate >= aligner_.GetNumberOfCrates())
+        throw invalid_argument("Unpacker::ReadCrateSpill - Crate " + to_string(crate) + " was not set with "
+                                       "SetNumberOfCrates.");
+    currentCrate_ = crate;
+
     const unsigned int maxVsn = 14; // No more than 14 pixie modules per crate
     unsigned int nWords_read = 0;
 
@@ -325,7 +409,7 @@ bool Unpacker::ReadSpill(unsigned int *data, unsigned int nWords, bool is_verbos
                 if (is_verbose)
                     cout << "ReadSpill: MISSING BUFFER " << lastVsn + 1 << ", lastVsn = " << lastVsn << ", vsn = "
                          << vsn << ", lenrec = " << lenRec << endl;
-                ClearEventList();
+                ClearCrate(crate);
                 fullSpill = false; // WHY WAS THIS TRUE!?!? CRT
             }
 
@@ -342,7 +426,7 @@ bool Unpacker::ReadSpill(unsigned int *data, unsigned int nWords, bool is_verbos
                 if (retval == -100) {
                     if (is_verbose)
                         cout << "ReadSpill:  Remove list " << lastVsn << " " << vsn << endl;
-                    ClearEventList();
+                    ClearCrate(crate);
                 }
                 return false;
             } else if (retval > 0) {
@@ -395,19 +479,13 @@ bool Unpacker::ReadSpill(unsigned int *data, unsigned int nWords, bool is_verbos
     // If there are events to process, continue
     if (numEvents > 0) {
         if (fullSpill) { // if full spill process events
-            // Sort the vector of pointers eventlist according to time
-            //double lastTimestamp = (*(eventList.rbegin()))->time;
-
-            // Sort the event list in time
-            TimeSort();
-
-            // Once the vector of pointers eventlist is sorted based on time,
-            // begin the event processing in ScanList().
-            // ScanList will also clear the event list for us.
-            while (BuildRawEvent())
-                ProcessRawEvent();
-
-            ClearEventList();
+            // With several crates the events wait for the spills of the
+            // other crates, MergeSpills processes them. The buffer is reused
+            // for the next crate, so the traces may not point into it.
+            if (aligner_.GetNumberOfCrates() == 1)
+                ProcessSpill();
+            else
+                DetachTraces(crate);
 
             // Once the eventlist has been scanned, reset the number
             // of events to zero and update the event counter
@@ -421,19 +499,150 @@ bool Unpacker::ReadSpill(unsigned int *data, unsigned int nWords, bool is_verbos
         } else {
             if (is_verbose)
                 cout << "ReadSpill: Spill split between buffers" << endl;
-            ClearEventList(); // This tosses out all events read into the deque so far
+            ClearCrate(crate); // This tosses out all events read into the deque so far
             return false;
         }
     } else if (retval != -10) {
         if (is_verbose)
             cout << "ReadSpill: bad buffer, numEvents = " << numEvents << endl;
-        ClearEventList(); // This tosses out all events read into the deque so far
+        ClearCrate(crate); // This tosses out all events read into the deque so far
         return false;
     }
 
     return true;
 }
 
+void Unpacker::DetachTraces(const unsigned int &crate) {
+    for (unsigned int i = crate * (MAX_PIXIE_MOD + 1); i < (crate + 1) * (MAX_PIXIE_MOD + 1) && i < eventList.size(); i++)
+        for (deque<XiaData *>::iterator it = eventList[i].begin(); it != eventList[i].end(); it++)
+            (*it)->DetachTrace();
+}
+
+void Unpacker::ProcessSpill() {
+    // Sort the event list in time
+    TimeSort();
+
+    // Once the vector of pointers eventlist is sorted based on time,
+    // begin the event processing in ScanList().
+    // ScanList will also clear the event list for us.
+    if (isTriggered_) {
+        unsigned long events = triggered_.GetNumEvents();
+        triggered_.Start(eventList);
+        while (BuildTriggeredEvent())
+            ProcessRawEvent();
+        SCAN_LOG(ScanLog::INFO, "ProcessSpill: Built %.0f events around the triggers of the spill",
+                 triggered_.GetNumEvents() - events);
+    } else {
+        while (BuildRawEvent())
+            ProcessRawEvent();
+    }
+
+    ClearEventList();
+    EndSpill();
+}
+
+///The deques of the event list are sorted in time, one per module of every
+/// crate, and BuildRawEvent always takes the earliest front. Once the times
+/// of the crates are corrected this is a k-way merge of all the modules, so
+/// the crates do not need to be copied into a single list.
+void Unpacker::MergeSpills() {
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+    aligner_.EndSpill();
+
+    // The offsets are in filter clock ticks, as GetTimeSansCfd. GetTime is
+    // in ADC samples, a module converts one tick to as many samples as the
+    // time of a hit at tick 1.
+    XiaData tick;
+    tick.SetEventTimeLow(1);
+
+    unsigned long numHits = 0;
+    for (unsigned int i = 0; i < eventList.size(); i++) {
+        numHits += eventList[i].size();
+        unsigned int crate = i / (MAX_PIXIE_MOD + 1);
+        double offset = aligner_.GetOffset(crate);
+        if (offset == 0 || eventList[i].empty())
+            continue;
+        double samples = offset * XiaListModeDataDecoder::CalculateTimeInSamples(
+                GetCrateDataMask(crate, i % (MAX_PIXIE_MOD + 1)), tick).second;
+        for (deque<XiaData *>::iterator it = eventList[i].begin(); it != eventList[i].end(); it++) {
+            (*it)->SetTime((*it)->GetTime() - samples);
+            (*it)->SetTimeSansCfd((*it)->GetTimeSansCfd() - offset);
+        }
+    }
+
+    ProcessSpill();
+
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    mergeRate_ = elapsed > 0 ? numHits / elapsed : 0;
+    SCAN_LOG(ScanLog::INFO, "MergeSpills: Merged %.0f hits from %.0f crates at %.4g hits/s", numHits,
+             aligner_.GetNumberOfCrates(), mergeRate_);
+
+    for (unsigned int crate = 1; crate < aligner_.GetNumberOfCrates(); crate++) {
+        if (!aligner_.IsMeasured(crate))
+            continue;
+        SCAN_LOG(ScanLog::INFO, "MergeSpills: Crate %.0f is offset by %.1f clock ticks, drift %.2f ticks", crate,
+                 aligner_.GetOffset(crate), aligner_.GetDrift(crate));
+        if (aligner_.GetNumMatched(crate) == 0)
+            SCAN_LOG(ScanLog::WARNING, "MergeSpills: No reference hits of crate %.0f were paired with crate 0, "
+                    "keeping the offset of %.1f clock ticks", crate, aligner_.GetOffset(crate));
+        else if (fabs(aligner_.GetDrift(crate)) > driftTolerance_)
+            SCAN_LOG(ScanLog::WARNING, "MergeSpills: The offset of crate %.0f drifted by %.2f clock ticks to %.1f",
+                     crate, aligner_.GetDrift(crate), aligner_.GetOffset(crate));
+    }
+}
+
+void Unpacker::InitializeCrates(const std::string &config) {
+    pugi::xml_node node = XmlInterface::get(config)->GetDocument()->child("Configuration").child("Crates");
+    if (!node || aligner_.GetNumberOfCrates() == 1)
+        return;
+
+    aligner_.SetMatchWindow(node.attribute("window").as_double(100));
+    driftTolerance_ = node.attribute("tolerance").as_double(1);
+
+    unsigned int crateCounter = 0;
+    bool isMeasured = false;
+    for (pugi::xml_node crate = node.child("Crate"); crate; crate = crate.next_sibling("Crate"), crateCounter++) {
+        if (crate.attribute("number").empty())
+            throw IOException("Unpacker::InitializeCrates - Unable to read the \"number\" attribute from the "
+                                      "crate in position #" + to_string(crateCounter) + "(0 counting)");
+        unsigned int number = crate.attribute("number").as_uint();
+        if (number >= aligner_.GetNumberOfCrates())
+            continue;
+
+        if (!crate.attribute("module").empty() && !crate.attribute("channel").empty()) {
+            aligner_.SetReferenceChannel(number, crate.attribute("module").as_uint(),
+                                         crate.attribute("channel").as_uint());
+            isMeasured |= number != 0;
+        } else if (number != 0)
+            aligner_.SetFixedOffset(number, crate.attribute("offset").as_double(0));
+    }
+
+    if (isMeasured && !aligner_.IsMeasured(0))
+        throw invalid_argument("Unpacker::InitializeCrates - The offsets of the crates are measured, but crate 0 "
+                                       "has no reference channel.");
+}
+
+void Unpacker::SaveState(StateWriter &writer) const {
+    writer.Write(numRawEvt);
+    writer.Write(firstTime);
+    writer.Write(eventStartTime);
+    writer.Write(realStartTime);
+    writer.Write(realStopTime);
+    writer.Write(maxModuleNumberInFile_);
+    writer.WriteBytes(channel_counts, sizeof(channel_counts));
+}
+
+void Unpacker::LoadState(StateReader &reader) {
+    reader.Read(numRawEvt);
+    reader.Read(firstTime);
+    reader.Read(eventStartTime);
+    reader.Read(realStartTime);
+    reader.Read(realStopTime);
+    reader.Read(maxModuleNumberInFile_);
+    reader.ReadBytes(channel_counts, sizeof(channel_counts));
+}
+
 /** Write all recorded channel counts to a file.
   * \return Nothing.
   */
@@ -20,4 +20,18 @@ void XiaData::Clear() {
     eSums_.clear();
     qdc_.clear();
     trace_.clear();
+    traceSamples_ = NULL;
+    traceLength_ = 0;
+}
+
+void XiaData::CopyTrace(std::vector<unsigned int> &a) const {
+    if (traceSamples_)
+        a.assign(traceSamples_, traceSamples_ + traceLength_);
+    else
+        a.assign(trace_.begin(), trace_.end());
+}
+
+void XiaData::WidenTrace() const {
+    trace_.assign(traceSamples_, traceSamples_ + traceLength_);
+    traceSamples_ = NULL;
 }
\ No newline at end of file
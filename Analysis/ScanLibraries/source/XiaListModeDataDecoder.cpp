@@ -12,6 +12,7 @@
 #include <cmath>
 
 #include "HelperEnumerations.hpp"
+#include "ScanLog.hpp"
 #include "XiaListModeDataDecoder.hpp"
 
 using namespace std;
@@ -37,7 +38,6 @@ vector<XiaData *> XiaListModeDataDecoder::DecodeBuffer(unsigned int *buf, const
     if (bufLen == emptyBufferLength)
         return vector<XiaData *>();
 
-    stringstream msg;
     vector<XiaData *> events;
     static unsigned int numSkippedBuffers = 0;
 
@@ -96,18 +96,8 @@ vector<XiaData *> XiaListModeDataDecoder::DecodeBuffer(unsigned int *buf, const
                 break;
             default:
                 numSkippedBuffers++;
-                cerr << "XiaListModeDataDecoder::ReadBuffer : We encountered "
-                        "an unrecognized header length (" << headerLength
-                     << "). " << endl
-                     << "Skipped " << numSkippedBuffers
-                     << " buffers in the file." << endl
-                     << "Unexpected header length: " << headerLength << endl
-                     << "ReadBuffer:   Buffer " << modNum << " of length "
-                     << bufLen << endl
-                     << "ReadBuffer:   CRATE:SLOT(MOD):CHAN "
-                     << data->GetCrateNumber() << ":"
-                     << data->GetSlotNumber() << "(" << modNum << "):"
-                     << data->GetChannelNumber() << endl;
+                SCAN_LOG(ScanLog::WARNING, "XiaListModeDataDecoder::ReadBuffer : Unrecognized header length (%.0f) "
+                        "in module %.0f. Skipped %.0f buffers in the file.", headerLength, modNum, numSkippedBuffers);
                 return vector<XiaData *>();
         }
 
@@ -203,12 +193,9 @@ vector<XiaData *> XiaListModeDataDecoder::DecodeBuffer(unsigned int *buf, const
         // should be.
         if (traceLength / 2 + headerLength != eventLength) {
             numSkippedBuffers++;
-            cerr << "XiaListModeDataDecoder::ReadBuffer : Event"
-                    "length (" << eventLength << ") does not correspond to "
-                         "header length (" << headerLength
-                 << ") and trace length ("
-                 << traceLength / 2 << "). Skipped a total of "
-                 << numSkippedBuffers << " buffers in this file." << endl;
+            SCAN_LOG(ScanLog::WARNING, "XiaListModeDataDecoder::ReadBuffer : Event length (%.0f) does not "
+                    "correspond to header length (%.0f) and trace length (%.0f).", eventLength, headerLength,
+                     traceLength / 2);
             return vector<XiaData *>();
         } else //Advance the buffer past the header and to the trace
             buf += headerLength;
@@ -282,15 +269,9 @@ unsigned int XiaListModeDataDecoder::DecodeWordThree(const unsigned int &word, X
 }
 
 void XiaListModeDataDecoder::DecodeTrace(unsigned int *buf, XiaData &data, const unsigned int &traceLength) {
-    vector<unsigned int> tmp;
-    // sbuf points to the beginning of trace data
-    unsigned short *sbuf = (unsigned short *) buf;
-
-    // Read the trace data (2-bytes per sample, i.e. 2 samples per word)
-    for (unsigned int k = 0; k < traceLength; k++)
-        tmp.push_back((unsigned int &&) sbuf[k]);
-
-    data.SetTrace(tmp);
+    // The trace data are 2-bytes per sample, i.e. 2 samples per word. They
+    // are only widened when the trace is actually used.
+    data.SetTraceSamples((const unsigned short *) buf, traceLength);
 }
 
 pair<double, double> XiaListModeDataDecoder::CalculateTimeInSamples(const XiaListModeDataMask &mask,
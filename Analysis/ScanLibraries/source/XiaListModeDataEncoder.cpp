@@ -62,7 +62,7 @@ std::vector<unsigned int> XiaListModeDataEncoder::EncodeXiaData(
     }
 
     ///Trace comes last since it comes after the header.
-    if (data.GetTrace().size() != 0) {
+    if (data.GetTraceLength() != 0) {
         vector<unsigned int> tmp = EncodeTrace(data.GetTrace(),
                                                mask.GetTraceMask());
         header.insert(header.end(), tmp.begin(), tmp.end());
@@ -84,7 +84,7 @@ unsigned int XiaListModeDataEncoder::EncodeWordZero(
     if (data.GetQdc().size() != 0)
         headerLength += 8;
     unsigned int eventLength =
-            (unsigned int) ceil(data.GetTrace().size() * 0.5) + headerLength;
+            (unsigned int) ceil(data.GetTraceLength() * 0.5) + headerLength;
 
     unsigned int word = 0;
     word |= data.GetChannelNumber() & mask.GetChannelNumberMask().first;
@@ -127,7 +127,7 @@ unsigned int XiaListModeDataEncoder::EncodeWordThree(
     word |= (unsigned int) data.GetEnergy() & mask.GetEventEnergyMask().first;
     word |= (data.IsSaturated() << mask.GetTraceOutOfRangeFlagMask()
             .second) & mask.GetTraceOutOfRangeFlagMask().first;
-    word |= (data.GetTrace().size() << mask.GetTraceLengthMask().second) &
+    word |= (data.GetTraceLength() << mask.GetTraceLengthMask().second) &
             mask.GetTraceLengthMask().first;
     return word;
 }
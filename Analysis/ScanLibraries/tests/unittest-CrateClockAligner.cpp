@@ -0,0 +1,80 @@
+///@file unittest-CrateClockAligner.cpp
+///@brief A program that will execute unit tests on CrateClockAligner
+///@date October 19, 2026
+#include <stdexcept>
+
+#include <UnitTest++.h>
+
+#include "CrateClockAligner.hpp"
+
+using namespace std;
+
+///Adds the same pulser to both crates, crate 1 is late by offset and one of
+/// its pulses is missing
+void AddPulser(CrateClockAligner &aligner, const double &start, const double &offset) {
+    for (unsigned int i = 0; i < 20; i++) {
+        aligner.AddReferenceTime(0, start + i * 1000.);
+        if (i != 7)
+            aligner.AddReferenceTime(1, start + i * 1000. + offset);
+    }
+}
+
+TEST(Test_FixedOffset) {
+    CrateClockAligner aligner;
+    aligner.SetNumberOfCrates(3);
+    aligner.SetFixedOffset(2, -25.);
+    aligner.EndSpill();
+
+    CHECK_EQUAL(0., aligner.GetOffset(0));
+    CHECK_EQUAL(0., aligner.GetOffset(1));
+    CHECK_EQUAL(-25., aligner.GetOffset(2));
+    CHECK(!aligner.IsMeasured(2));
+    CHECK_THROW(aligner.SetFixedOffset(3, 1.), out_of_range);
+}
+
+TEST(Test_MeasuredOffset) {
+    CrateClockAligner aligner;
+    aligner.SetNumberOfCrates(2);
+    aligner.SetReferenceChannel(0, 0, 15);
+    aligner.SetReferenceChannel(1, 2, 15);
+    aligner.SetMatchWindow(50.);
+
+    CHECK(aligner.IsReference(1, 2, 15));
+    CHECK(!aligner.IsReference(1, 0, 15));
+
+    //The first spill finds the offset from the first pulses
+    AddPulser(aligner, 1.e6, 123456.);
+    aligner.EndSpill();
+    CHECK_EQUAL(123456., aligner.GetOffset(1));
+    CHECK_EQUAL(19u, aligner.GetNumMatched(1));
+
+    //The next spill follows a drift of 3 ticks, with some noise hits in crate 1
+    AddPulser(aligner, 2.e6, 123459.);
+    aligner.AddReferenceTime(1, 2.e6 + 123459. + 500.);
+    aligner.EndSpill();
+    CHECK_EQUAL(123459., aligner.GetOffset(1));
+    CHECK_EQUAL(3., aligner.GetDrift(1));
+    CHECK_EQUAL(19u, aligner.GetNumMatched(1));
+}
+
+TEST(Test_OutOfWindow) {
+    CrateClockAligner aligner;
+    aligner.SetNumberOfCrates(2);
+    aligner.SetReferenceChannel(0, 0, 15);
+    aligner.SetReferenceChannel(1, 0, 15);
+    aligner.SetMatchWindow(10.);
+
+    AddPulser(aligner, 0., 40.);
+    aligner.EndSpill();
+
+    //A jump larger than the window keeps the previous offset
+    AddPulser(aligner, 1.e6, 300.);
+    aligner.EndSpill();
+    CHECK_EQUAL(40., aligner.GetOffset(1));
+    CHECK_EQUAL(0u, aligner.GetNumMatched(1));
+    CHECK_EQUAL(0., aligner.GetDrift(1));
+}
+
+int main(int argv, char *argc[]) {
+    return (UnitTest::RunAllTests());
+}
@@ -0,0 +1,68 @@
+///@file unittest-LoadShedder.cpp
+///@brief A program that will execute unit tests on LoadShedder
+///@date October 19, 2026
+#include <UnitTest++.h>
+
+#include "LoadShedder.hpp"
+
+using namespace std;
+
+TEST(Test_Disabled) {
+    LoadShedder shedder;
+    CHECK(!shedder.IsEnabled());
+    CHECK(!shedder.Update(10.0, true));
+    CHECK_EQUAL(0u, shedder.GetLevel());
+
+    shedder.SetBudget(0.1, 0);
+    CHECK(!shedder.IsEnabled());
+}
+
+TEST(Test_RaiseAndLower) {
+    LoadShedder shedder;
+    shedder.SetBudget(0.1, 2);
+    CHECK(shedder.IsEnabled());
+
+    //The spills take twice the budget, the level is raised once per hold
+    for (unsigned int i = 1; i < LoadShedder::HOLD_SPILLS; i++)
+        CHECK(!shedder.Update(0.2, false));
+    CHECK(shedder.Update(0.2, false));
+    CHECK_EQUAL(1u, shedder.GetLevel());
+    for (unsigned int i = 0; i < 3 * LoadShedder::HOLD_SPILLS; i++)
+        shedder.Update(0.2, false);
+    CHECK_EQUAL(2u, shedder.GetLevel());
+    CHECK(shedder.GetBacklog() > 1.0);
+
+    //The level is only lowered once the backlog is gone
+    unsigned int numSpills = 0;
+    while (shedder.GetLevel() == 2 && numSpills++ < 100)
+        shedder.Update(0.01, false);
+    CHECK_EQUAL(1u, shedder.GetLevel());
+    CHECK_EQUAL(0.0, shedder.GetBacklog());
+    CHECK(numSpills > 15);
+
+    for (unsigned int i = 1; i < 2 * LoadShedder::HOLD_SPILLS; i++)
+        CHECK(!shedder.Update(0.01, false));
+    CHECK(shedder.Update(0.01, false));
+    CHECK_EQUAL(0u, shedder.GetLevel());
+}
+
+TEST(Test_DroppedSpill) {
+    LoadShedder shedder;
+    shedder.SetBudget(0.1, 3);
+    CHECK(shedder.Update(0.01, true));
+    CHECK_EQUAL(1u, shedder.GetLevel());
+    CHECK(shedder.Update(0.01, true));
+    CHECK_EQUAL(2u, shedder.GetLevel());
+
+    //Spills well within the budget do not lower the level before the hold
+    CHECK(!shedder.Update(0.01, false));
+    CHECK_EQUAL(2u, shedder.GetLevel());
+
+    shedder.Reset();
+    CHECK_EQUAL(0u, shedder.GetLevel());
+    CHECK_EQUAL(0.0, shedder.GetLoad());
+}
+
+int main(int argv, char *argc[]) {
+    return (UnitTest::RunAllTests());
+}
@@ -0,0 +1,169 @@
+///@file unittest-NsclRingReader.cpp
+///@brief A program that will execute unit tests on NsclRingReader
+///@date October 19, 2026
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <UnitTest++.h>
+
+#include "NsclRingReader.hpp"
+
+using namespace std;
+
+///Appends a word to the file
+void AddWord(string &file, const unsigned int &word) {
+    file.append((const char *) &word, 4);
+}
+
+///Appends a ring item that is not a PHYSICS_EVENT
+void AddOtherItem(string &file, const unsigned int &type) {
+    AddWord(file, 16);
+    AddWord(file, type);
+    AddWord(file, 0);
+    AddWord(file, 0);
+}
+
+///Appends a PHYSICS_EVENT holding a fragment of a module fifo. The first
+/// word looks like a pixie header from the slot of the module, the other
+/// words count up from first.
+vector<unsigned int> AddFragment(string &file, const unsigned int &module, const unsigned int &numWords,
+                                 const unsigned int &first) {
+    vector<unsigned int> words;
+    words.push_back((module + 2) << 4);
+    for (unsigned int i = 1; i < numWords; i++)
+        words.push_back(first + i);
+
+    AddWord(file, 20 + numWords * 4);
+    AddWord(file, 30);
+    AddWord(file, 0); //No body header
+    AddWord(file, numWords * 4 + 8);
+    AddWord(file, 0);
+    for (unsigned int i = 0; i < numWords; i++)
+        AddWord(file, words[i]);
+    return words;
+}
+
+///Appends the header of a module buffer and its words to a spill
+void AddModule(vector<unsigned int> &spill, const unsigned int &module, const vector<unsigned int> &words) {
+    spill.push_back(words.size() + 2);
+    spill.push_back(module);
+    spill.insert(spill.end(), words.begin(), words.end());
+}
+
+///Reads the next spill into a vector
+vector<unsigned int> ReadSpill(NsclRingReader &reader, istream &input) {
+    unsigned int nWords;
+    unsigned int *spill = reader.Read(&input, nWords);
+    if (!spill)
+        return vector<unsigned int>();
+    return vector<unsigned int>(spill, spill + nWords);
+}
+
+TEST(Test_Stitching) {
+    string file;
+    AddOtherItem(file, 1);
+
+    //Spill 1 : module 0 in three fragments, module 2 in one
+    vector<unsigned int> mod0 = AddFragment(file, 0, 20, 100);
+    vector<unsigned int> tmp = AddFragment(file, 0, 20, 200);
+    mod0.insert(mod0.end(), tmp.begin(), tmp.end());
+    AddOtherItem(file, 20);
+    tmp = AddFragment(file, 0, 9, 300);
+    mod0.insert(mod0.end(), tmp.begin(), tmp.end());
+    vector<unsigned int> mod2 = AddFragment(file, 2, 12, 400);
+
+    //Spill 2 : module 1 only
+    vector<unsigned int> mod1 = AddFragment(file, 1, 30, 500);
+
+    //Spill 3 : a longer fragment of the same module starts a new spill
+    vector<unsigned int> mod1b = AddFragment(file, 1, 40, 600);
+    AddOtherItem(file, 2);
+
+    vector<unsigned int> spill1, spill2, spill3;
+    AddModule(spill1, 0, mod0);
+    AddModule(spill1, 1, vector<unsigned int>());
+    AddModule(spill1, 2, mod2);
+    AddModule(spill1, 3, vector<unsigned int>());
+    AddModule(spill1, 9999, vector<unsigned int>());
+
+    AddModule(spill2, 0, vector<unsigned int>());
+    AddModule(spill2, 1, mod1);
+    AddModule(spill2, 2, vector<unsigned int>());
+    AddModule(spill2, 3, vector<unsigned int>());
+    AddModule(spill2, 9999, vector<unsigned int>());
+
+    AddModule(spill3, 0, vector<unsigned int>());
+    AddModule(spill3, 1, mod1b);
+    AddModule(spill3, 2, vector<unsigned int>());
+    AddModule(spill3, 3, vector<unsigned int>());
+    AddModule(spill3, 9999, vector<unsigned int>());
+
+    //A tiny block so that the ring items straddle the blocks
+    NsclRingReader reader(24);
+    reader.SetNumModules(4);
+    istringstream input(file);
+
+    CHECK(spill1 == ReadSpill(reader, input));
+    CHECK(spill2 == ReadSpill(reader, input));
+    CHECK(spill3 == ReadSpill(reader, input));
+    CHECK(ReadSpill(reader, input).empty());
+
+    CHECK_EQUAL(3u, reader.GetNumSpills());
+    CHECK_EQUAL(6u, reader.GetNumFragments());
+    CHECK_EQUAL(9u, reader.GetNumRingItems());
+    CHECK_EQUAL(file.size(), reader.GetBytesRead());
+}
+
+TEST(Test_Padding) {
+    string file;
+    vector<unsigned int> mod3 = AddFragment(file, 3, 10, 0);
+    vector<unsigned int> mod0 = AddFragment(file, 0, 10, 0);
+
+    //Without the number of modules we pad up to the highest module seen
+    vector<unsigned int> spill;
+    AddModule(spill, 0, vector<unsigned int>());
+    AddModule(spill, 1, vector<unsigned int>());
+    AddModule(spill, 2, vector<unsigned int>());
+    AddModule(spill, 3, mod3);
+    AddModule(spill, 9999, vector<unsigned int>());
+
+    NsclRingReader reader;
+    istringstream input(file);
+    CHECK(spill == ReadSpill(reader, input));
+
+    spill.clear();
+    AddModule(spill, 0, mod0);
+    AddModule(spill, 1, vector<unsigned int>());
+    AddModule(spill, 2, vector<unsigned int>());
+    AddModule(spill, 3, vector<unsigned int>());
+    AddModule(spill, 9999, vector<unsigned int>());
+    CHECK(spill == ReadSpill(reader, input));
+}
+
+TEST(Test_CorruptedItems) {
+    string file;
+    //Too short for a pixie event and from an invalid slot
+    AddFragment(file, 0, 4, 0);
+    string badSlot;
+    AddFragment(badSlot, 0, 10, 0);
+    badSlot[20] = 0;
+    file += badSlot;
+    vector<unsigned int> mod0 = AddFragment(file, 0, 10, 0);
+    //The file ends in the middle of a ring item
+    AddFragment(file, 1, 10, 0);
+    file.resize(file.size() - 8);
+
+    vector<unsigned int> spill;
+    AddModule(spill, 0, mod0);
+    AddModule(spill, 9999, vector<unsigned int>());
+
+    NsclRingReader reader(64);
+    istringstream input(file);
+    CHECK(spill == ReadSpill(reader, input));
+    CHECK(ReadSpill(reader, input).empty());
+}
+
+int main(int argv, char *argc[]) {
+    return (UnitTest::RunAllTests());
+}
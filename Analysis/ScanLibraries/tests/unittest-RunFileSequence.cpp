@@ -0,0 +1,94 @@
+///@file unittest-RunFileSequence.cpp
+///@brief A program that will execute unit tests on RunFileSequence
+///@date October 19, 2026
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include <cstdlib>
+#include <cstdio>
+
+#include <unistd.h>
+
+#include <UnitTest++.h>
+
+#include "RunFileSequence.hpp"
+
+using namespace std;
+
+///Makes a directory with the files of two runs that rolled over, written in
+/// an order that differs from the one of poll2
+string MakeRunDirectory() {
+    char name[] = "/tmp/unittest-RunFileSequence-XXXXXX";
+    string directory = string(mkdtemp(name)) + "/";
+    const char *files[] = {"run_012-10.pld", "run_012-2.pld", "run_012.pld", "run_012-1.pld", "run_1000.pld",
+                           "run_999.pld"};
+    for (unsigned int i = 0; i < 6; i++)
+        ofstream(directory + files[i]) << string(1000 * (i + 1), 'x');
+    return directory;
+}
+
+TEST(Test_IsBefore) {
+    CHECK(RunFileSequence::IsBefore("run_012.pld", "run_012-1.pld"));
+    CHECK(RunFileSequence::IsBefore("run_012-2.pld", "run_012-10.pld"));
+    CHECK(RunFileSequence::IsBefore("run_012-10.pld", "run_013.pld"));
+    CHECK(RunFileSequence::IsBefore("run_999.ldf", "run_1000.ldf"));
+    CHECK(!RunFileSequence::IsBefore("run_012-1.pld", "run_012.pld"));
+    CHECK(!RunFileSequence::IsBefore("run_012.pld", "run_012.pld"));
+}
+
+TEST(Test_GlobAndList) {
+    string directory = MakeRunDirectory();
+
+    RunFileSequence sequence;
+    sequence.Add(directory + "run_012*.pld");
+    CHECK_EQUAL(4u, sequence.GetNumFiles());
+    CHECK_EQUAL(directory + "run_012.pld", sequence.Next());
+    CHECK_EQUAL(directory + "run_012-1.pld", sequence.Next());
+    CHECK_EQUAL(directory + "run_012-2.pld", sequence.Next());
+    CHECK_EQUAL(directory + "run_012-10.pld", sequence.Next());
+    CHECK(sequence.IsEmpty());
+    CHECK_EQUAL("", sequence.Next());
+
+    ofstream(directory + "list.txt") << "# The last runs\n  " << directory << "run_1000.pld\n\n"
+                                     << directory << "run_9*.pld\n";
+    sequence.Add(directory + "run_012-1.pld,@" + directory + "list.txt");
+    CHECK_EQUAL(3u, sequence.GetNumFiles());
+    CHECK_EQUAL(directory + "run_012-1.pld", sequence.Next());
+    CHECK_EQUAL(directory + "run_1000.pld", sequence.Next());
+    CHECK_EQUAL(directory + "run_999.pld", sequence.Next());
+
+    CHECK_THROW(sequence.Add(directory + "run_5*.pld"), invalid_argument);
+    CHECK_THROW(sequence.Add("@" + directory + "missing.txt"), invalid_argument);
+
+    system(("rm -rf " + directory).c_str());
+}
+
+TEST(Test_PrefetchAndSkip) {
+    string directory = MakeRunDirectory();
+
+    RunFileSequence sequence;
+    sequence.Add(directory + "run_012*.pld");
+    CHECK(!sequence.SkipPast(directory + "run_013.pld"));
+    CHECK(sequence.SkipPast(directory + "run_012-1.pld"));
+    CHECK_EQUAL(2u, sequence.GetNumFiles());
+
+    //The next file, run_012-10.pld, is read ahead up to the limit
+    sequence.SetMaxPrefetchBytes(600);
+    CHECK_EQUAL(directory + "run_012-2.pld", sequence.Next());
+    for (unsigned int i = 0; i < 500 && sequence.GetNumPrefetchedBytes() < 600; i++)
+        usleep(10000);
+    CHECK_EQUAL(600u, sequence.GetNumPrefetchedBytes());
+    CHECK_EQUAL(directory + "run_012-10.pld", sequence.Next());
+    CHECK_EQUAL(600u, sequence.GetNumPrefetchedBytes());
+
+    sequence.Add(directory + "run_1000.pld");
+    sequence.Clear();
+    CHECK(sequence.IsEmpty());
+
+    system(("rm -rf " + directory).c_str());
+}
+
+int main(int argv, char *argc[]) {
+    return (UnitTest::RunAllTests());
+}
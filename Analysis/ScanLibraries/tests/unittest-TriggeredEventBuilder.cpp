@@ -0,0 +1,106 @@
+///@file unittest-TriggeredEventBuilder.cpp
+///@brief A program that will execute unit tests on TriggeredEventBuilder
+///@date October 19, 2026
+#include <deque>
+#include <stdexcept>
+#include <vector>
+
+#include <UnitTest++.h>
+
+#include "TriggeredEventBuilder.hpp"
+#include "XiaData.hpp"
+
+using namespace std;
+
+///Adds a hit of a channel of module 0 to the list
+void AddHit(vector<deque<XiaData *> > &lists, const unsigned int &channel, const double &time) {
+    XiaData *hit = new XiaData();
+    hit->SetSlotNumber(2);
+    hit->SetChannelNumber(channel);
+    hit->SetTimeSansCfd(time);
+    hit->SetTime(time);
+    lists[0].push_back(hit);
+}
+
+///Deletes the hits of an event
+void ClearEvent(deque<XiaData *> &event) {
+    for (deque<XiaData *>::iterator it = event.begin(); it != event.end(); it++)
+        delete *it;
+    event.clear();
+}
+
+TEST(Test_NegativeWindow) {
+    TriggeredEventBuilder builder;
+    CHECK_THROW(builder.AddWindow("ge", -1, 10), invalid_argument);
+    CHECK_THROW(builder.SetDefaultWindow(0, -1), invalid_argument);
+    CHECK_THROW(builder.SetWindow(0, 1), out_of_range);
+}
+
+TEST(Test_Windows) {
+    //Channel 0 is the trigger with a short window, channel 1 is a slow
+    // detector with a wide asymmetric window and channel 2 uses the default.
+    TriggeredEventBuilder builder;
+    unsigned int fast = builder.AddWindow("fast", 2, 2);
+    unsigned int slow = builder.AddWindow("slow", 10, 50);
+    builder.SetDefaultWindow(0, 5);
+    builder.SetWindow(0, fast);
+    builder.SetWindow(1, slow);
+    builder.SetTrigger(0);
+    CHECK(builder.HasTriggers());
+
+    vector<deque<XiaData *> > lists(1);
+    AddHit(lists, 2, 10); //noise before the first trigger
+    AddHit(lists, 1, 95); //slow, 5 before the trigger
+    AddHit(lists, 0, 100); //trigger
+    AddHit(lists, 0, 101); //second trigger inside the first event
+    AddHit(lists, 2, 103); //default, inside
+    AddHit(lists, 2, 108); //default, too late
+    AddHit(lists, 1, 140); //slow, inside
+    AddHit(lists, 0, 1000); //lone trigger
+    AddHit(lists, 1, 2000); //noise after the last trigger
+    builder.Start(lists);
+    CHECK(lists[0].empty());
+
+    deque<XiaData *> event;
+    double triggerTime;
+    CHECK(builder.Next(event, triggerTime));
+    CHECK_EQUAL(100., triggerTime);
+    CHECK_EQUAL(5u, event.size());
+    ClearEvent(event);
+
+    CHECK(builder.Next(event, triggerTime));
+    CHECK_EQUAL(1000., triggerTime);
+    CHECK_EQUAL(1u, event.size());
+    ClearEvent(event);
+
+    CHECK(!builder.Next(event, triggerTime));
+    CHECK(event.empty());
+
+    CHECK_EQUAL(2u, builder.GetNumEvents());
+    CHECK_EQUAL(3u, builder.GetNumAdmitted(fast));
+    CHECK_EQUAL(0u, builder.GetNumRejected(fast));
+    CHECK_EQUAL(2u, builder.GetNumAdmitted(slow));
+    CHECK_EQUAL(1u, builder.GetNumRejected(slow));
+    CHECK_EQUAL(1u, builder.GetNumAdmitted(0));
+    CHECK_EQUAL(2u, builder.GetNumRejected(0));
+}
+
+TEST(Test_NoTrigger) {
+    TriggeredEventBuilder builder;
+    builder.SetDefaultWindow(10, 10);
+    builder.SetTrigger(5);
+
+    vector<deque<XiaData *> > lists(1);
+    AddHit(lists, 2, 10);
+    AddHit(lists, 3, 12);
+    builder.Start(lists);
+
+    deque<XiaData *> event;
+    double triggerTime;
+    CHECK(!builder.Next(event, triggerTime));
+    CHECK_EQUAL(2u, builder.GetNumRejected(0));
+}
+
+int main(int argv, char *argc[]) {
+    return (UnitTest::RunAllTests());
+}
@@ -0,0 +1,83 @@
+///@file unittest-Unpacker.cpp
+///@brief A program that will execute unit tests on the spill handling of the
+/// Unpacker
+///@date October 19, 2026
+#include <algorithm>
+#include <map>
+#include <vector>
+
+#include <UnitTest++.h>
+
+#include "HelperEnumerations.hpp"
+#include "Unpacker.hpp"
+#include "UnitTestSampleData.hpp"
+#include "XiaData.hpp"
+#include "XiaListModeDataEncoder.hpp"
+
+using namespace std;
+using namespace DataProcessing;
+
+///An unpacker that keeps the traces of the events that it processes
+class TraceUnpacker : public Unpacker {
+public:
+    map<unsigned int, vector<unsigned int> > traces; //!< The traces by crate
+
+private:
+    void ProcessRawEvent() {
+        for (deque<XiaData *>::iterator it = rawEvent.begin(); it != rawEvent.end(); it++)
+            traces[(*it)->GetCrateNumber()] = (*it)->GetTrace();
+        Unpacker::ProcessRawEvent();
+    }
+};
+
+///Encodes a spill of module 0 with a single hit and the end of spill record
+vector<unsigned int> EncodeSpill(const vector<unsigned int> &trace, const unsigned int &time) {
+    XiaData data;
+    data.SetEnergy(1000);
+    data.SetSlotNumber(2);
+    data.SetChannelNumber(3);
+    data.SetEventTimeLow(time);
+    data.SetTrace(trace);
+
+    vector<unsigned int> hit = XiaListModeDataEncoder().EncodeXiaData(data, R30474, 250);
+    vector<unsigned int> spill;
+    spill.push_back(hit.size() + 2);
+    spill.push_back(0);
+    spill.insert(spill.end(), hit.begin(), hit.end());
+    spill.push_back(2);
+    spill.push_back(9999);
+    return spill;
+}
+
+///The spills of all the crates are read into the same buffer, the traces of
+/// the first crate have to survive the spill of the second one.
+TEST(Test_MergeSpillsWithTraces) {
+    const vector<unsigned int> &trace0 = unittest_trace_variables::trace;
+    vector<unsigned int> trace1(trace0.rbegin(), trace0.rend());
+    vector<unsigned int> spill0 = EncodeSpill(trace0, 1000);
+    vector<unsigned int> spill1 = EncodeSpill(trace1, 1010);
+
+    TraceUnpacker unpacker;
+    unpacker.InitializeDataMask("R30474", 250);
+    unpacker.SetNumberOfCrates(2);
+
+    vector<unsigned int> buffer(spill0.size());
+    copy(spill0.begin(), spill0.end(), buffer.begin());
+    CHECK(unpacker.ReadCrateSpill(&buffer[0], spill0.size(), 0, false));
+    CHECK(unpacker.traces.empty());
+
+    copy(spill1.begin(), spill1.end(), buffer.begin());
+    CHECK(unpacker.ReadCrateSpill(&buffer[0], spill1.size(), 1, false));
+    fill(buffer.begin(), buffer.end(), 0);
+    unpacker.MergeSpills();
+
+    CHECK_EQUAL(2u, unpacker.traces.size());
+    CHECK_EQUAL(trace0.size(), unpacker.traces[0].size());
+    CHECK_EQUAL(trace1.size(), unpacker.traces[1].size());
+    CHECK_ARRAY_EQUAL(trace0, unpacker.traces[0], trace0.size());
+    CHECK_ARRAY_EQUAL(trace1, unpacker.traces[1], trace1.size());
+}
+
+int main(int argv, char *argc[]) {
+    return (UnitTest::RunAllTests());
+}
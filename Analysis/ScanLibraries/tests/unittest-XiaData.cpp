@@ -219,6 +219,40 @@ TEST(Test_Equality) {
         CHECK(lhs == rhs);
 }
 
+///The samples are only widened when the trace is asked for
+TEST(Test_LazyTrace) {
+        lhs.Clear();
+        vector<unsigned short> samples(trace.begin(), trace.end());
+        lhs.SetTraceSamples(&samples[0], samples.size());
+        CHECK_EQUAL(trace.size(), lhs.GetTraceLength());
+
+        vector<unsigned int> copy;
+        lhs.CopyTrace(copy);
+        CHECK_ARRAY_EQUAL(trace, copy, trace.size());
+
+        //! Widening drops the view into the samples
+        CHECK_ARRAY_EQUAL(trace, lhs.GetTrace(), trace.size());
+        samples[0] = 0;
+        CHECK_EQUAL(trace[0], lhs.GetTrace()[0]);
+        CHECK_EQUAL(trace.size(), lhs.GetTraceLength());
+
+        //! A detached trace no longer depends on the samples
+        lhs.SetTraceSamples(&samples[0], samples.size());
+        lhs.DetachTrace();
+        samples[1] = 0;
+        CHECK_EQUAL(trace[1], lhs.GetTrace()[1]);
+        CHECK_EQUAL(trace.size(), lhs.GetTraceLength());
+
+        lhs.SetTraceSamples(&samples[0], samples.size());
+        lhs.SetTrace(trace);
+        CHECK_ARRAY_EQUAL(trace, lhs.GetTrace(), trace.size());
+
+        lhs.SetTraceSamples(&samples[0], samples.size());
+        lhs.Clear();
+        CHECK_EQUAL(0u, lhs.GetTraceLength());
+        CHECK(lhs.GetTrace().empty());
+}
+
 TEST(Test_LessThanOperator) {
         lhs.Clear(); rhs.Clear();
         lhs.SetTime(ts);
@@ -80,6 +80,13 @@ public:
       */
     virtual void Notify(const std::string &code_ = "");
 
+    /** Show the display latency, the number of frames displayed and skipped
+      * and the number of dropped spills on the status line. Called by the scan
+      * thread after every spill, the update is limited to once per second.
+      * \return Nothing.
+      */
+    virtual void IdleTask();
+
 private:
     ScopeUnpacker *unpacker_;
     unsigned int numAvgWaveforms_;
@@ -93,7 +100,7 @@ private:
     bool performFit_;
     bool performCfd_;
 
-    time_t last_trace; ///< The time of the last trace.
+    time_t last_status; ///< The time of the last status line update.
 
     std::string saveFile_; ///< The name of the file to save a trace.
 };
@@ -5,10 +5,15 @@
 #ifndef PIXIESUITE_SCOPEUNPACKER_HPP
 #define PIXIESUITE_SCOPEUNPACKER_HPP
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 #include "CrystalBallFunction.hpp"
 #include "CsiFunction.hpp"
 #include "EmCalTimingFunction.hpp"
-#include "ProcessedXiaData.hpp"
 #include "SiPmtFastTimingFunction.hpp"
 #include "Unpacker.hpp"
 #include "VandleTimingFunction.hpp"
@@ -25,7 +30,12 @@ class TProfile;
 
 class TCanvas;
 
-///Class that handles unpacking data and process for use with scope.
+///Class that handles unpacking data and process for use with scope. The scan
+/// thread only copies the waveforms of the channel of interest into a fixed
+/// buffer and keeps their running sum. Every complete set of waveforms is
+/// handed over to a display thread that owns the ROOT objects, draws and fits
+/// at most once per delay and never blocks the scan. If the display is busy
+/// the newest set replaces the one that is waiting.
 class ScopeUnpacker : public Unpacker {
 public:
     /// Default constructor.
@@ -42,23 +52,23 @@ public:
 
     int GetThreshHigh() { return threshHigh_; }
 
-    bool PerformCfd() { return performCfd_; }
+    bool PerformCfd();
 
-    bool PerformFit() { return performFit_; }
+    bool PerformFit();
 
-    void SetCfdFraction(const double &a) { cfdF_ = a; }
+    void SetCfdFraction(const double &a);
 
-    void SetCfdDelay(const unsigned int &a) { cfdD_ = a; }
+    void SetCfdDelay(const unsigned int &a);
 
-    void SetCfdShift(const unsigned int &a) { cfdL_ = a; }
+    void SetCfdShift(const unsigned int &a);
 
     void SetChannelNumber(const unsigned int &a) { chan_ = a; }
 
     void SetDelayInSeconds(const unsigned int &a) { delayInSeconds_ = a; }
 
-    void SetFitLow(const unsigned int &a) { fitLow_ = a; }
+    void SetFitLow(const unsigned int &a);
 
-    void SetFitHigh(const unsigned int &a) { fitHigh_ = a; }
+    void SetFitHigh(const unsigned int &a);
 
     void SetModuleNumber(const unsigned int &a) { mod_ = a; }
 
@@ -66,33 +76,49 @@ public:
 
     void SetNumberTracesToAverage(const unsigned int &a) { numAvgWaveforms_ = a; }
 
-    void SetPerformCfd(const bool &a) { performCfd_ = a; }
+    void SetPerformCfd(const bool &a);
 
-    void SetPerformFit(const bool &a) { performFit_ = a; }
+    void SetPerformFit(const bool &a);
 
-    void SetResetGraph(const bool &a) { resetGraph_ = a; }
+    void SetResetGraph(const bool &a);
 
-    void SetSaveFile(const std::string &a) { saveFile_ = a; }
+    void SetSaveFile(const std::string &a);
 
     void SetThreshLow(const int &a) { threshLow_ = a; }
 
     void SetThreshHigh(const int &a) { threshHigh_ = a; }
 
+    ///Toggle the y-axis of the canvas between linear and log.
+    ///@return True if the y-axis is now in log mode.
+    bool ToggleLogy();
+
     bool SelectFittingFunction(const std::string &func);
 
     void ClearEvents();
 
+    ///@return The time in ms from the capture of the last displayed set of
+    /// waveforms to the end of its drawing.
+    double GetDisplayLatency() const { return displayLatency_; }
+
+    ///@return The number of sets of waveforms that were displayed
+    unsigned int GetNumTracesDisplayed() const { return numTracesDisplayed_; }
+
+    ///@return The number of sets of waveforms that were replaced by a newer
+    /// one before the display got to them.
+    unsigned long GetNumSkipped() const { return numSkipped_; }
+
 private:
-    unsigned int mod_; ///< The module of the signal of interest.
-    unsigned int chan_; ///< The channel of the signal of interest.
-    unsigned int threshLow_;
-    unsigned int threshHigh_;
-    unsigned int numAvgWaveforms_;
-    unsigned int delayInSeconds_; /// The number of seconds to wait between drawing traces.
-    unsigned int numTracesDisplayed_; ///< The number of displayed traces.
+    //Read by the scan and display threads while the commands change them
+    std::atomic<unsigned int> mod_; ///< The module of the signal of interest.
+    std::atomic<unsigned int> chan_; ///< The channel of the signal of interest.
+    std::atomic<unsigned int> threshLow_;
+    std::atomic<unsigned int> threshHigh_;
+    std::atomic<unsigned int> numAvgWaveforms_;
+    std::atomic<unsigned int> delayInSeconds_; /// The number of seconds to wait between drawing traces.
+    std::atomic<unsigned int> numTracesDisplayed_; ///< The number of displayed traces.
     unsigned int numEvents_; /// The number of waveforms to store.
 
-    //Parameters for the CFD
+    //The parameters of the plot are guarded by plotMutex_
     bool performCfd_;
     double cfdF_;
     int cfdD_;
@@ -100,7 +126,6 @@ private:
 
     std::string saveFile_;
 
-    //Parameters for the Fitting
     bool performFit_;
     int fitLow_;
     int fitHigh_;
@@ -111,8 +136,6 @@ private:
     bool singleCapture_;
     bool init;
 
-    time_t last_trace; ///< The time of the last trace.
-
     TGraph *graph; ///< The TGraph for plotting traces.
     TLine *cfdLine;
     TF1 *cfdPol3;
@@ -128,23 +151,46 @@ private:
     VandleTimingFunction *vandleTimingFunction_;
 
     std::vector<int> x_vals;
-    std::deque<ProcessedXiaData *> chanEvents_; ///<The buffer of waveforms to be plotted.
+
+    ///A set of waveforms for one display update
+    struct WaveformFrame {
+        unsigned int length; ///< The number of samples of every waveform
+        unsigned int numWaveforms; ///< The number of waveforms in the frame
+        std::vector<unsigned int> samples; ///< The waveforms one after the other
+        std::vector<double> sum; ///< The sum of the waveforms sample by sample
+        std::chrono::steady_clock::time_point completed; ///< When the last waveform was added
+    };
+
+    WaveformFrame capture_; ///< The frame being filled by the scan thread
+    WaveformFrame pending_; ///< The newest complete frame, waiting for the display
+    WaveformFrame display_; ///< The frame being drawn by the display thread
+    bool hasPending_; ///< True if pending_ holds a frame that was not drawn
+    std::mutex pendingMutex_; ///< Guards pending_ and hasPending_
+    std::condition_variable pendingCondition_; ///< Wakes the display thread
+    std::mutex plotMutex_; ///< Guards the ROOT objects, the canvas and the fit parameters
+    std::thread displayThread_; ///< Draws and fits the frames
+    std::atomic<bool> stopDisplay_; ///< Set to end the display thread
+    std::atomic<bool> clearRequested_; ///< Set to drop the frame being filled
+    std::atomic<unsigned long> numSkipped_; ///< Frames replaced before they were drawn
+    std::atomic<double> displayLatency_; ///< Latency of the last drawn frame in ms
 
     void ResetGraph(const unsigned int &size);
 
+    ///Add a waveform to the frame being filled and hand the frame to the
+    /// display thread when it holds numAvgWaveforms_ waveforms.
+    ///@param[in] trace : The waveform
+    void Capture(const std::vector<unsigned int> &trace);
+
+    ///The loop of the display thread
+    void DisplayLoop();
+
     /** Process all events in the event list.
       * \param[in]  addr_ Pointer to a ScanInterface object.
       * \return Nothing.
       */
     void ProcessRawEvent();
 
-    /** Process all channel events read in from the rawEvent.
-      * This method should only be called from skeletonUnpacker::ProcessRawEvent().
-      * \return True if events were processed and false otherwise.
-      */
-    bool ProcessEvents();
-
-    /// Plot the current event.
+    /// Plot the frame held by the display thread.
     void Plot();
 };
 
@@ -2,9 +2,10 @@
 ///@brief
 ///@author C. R. Thornsberry, S. V. Paulauskas, and K. Smith
 ///@date May 19, 2017
+#include <iostream>
 #include <limits>
+#include <sstream>
 
-#include "RootInterface.hpp"
 #include "ScopeScanner.hpp"
 
 using namespace std;
@@ -16,6 +17,7 @@ ScopeScanner::ScopeScanner(ScopeUnpacker *unpacker) {
     acqRun_ = true;
     init = false;
     running = true;
+    last_status = 0;
 
     //We setup the commands that ScopeScanner knows about.
     auxillaryKnownArgumentMap_.insert(make_pair("set", "Usage : set <module> <channel> | "
@@ -30,7 +32,7 @@ ScopeScanner::ScopeScanner(ScopeUnpacker *unpacker) {
     auxillaryKnownArgumentMap_.insert(make_pair("save", "Usage : save <fileName> | "
             "Save the next trace to the specified file name. Do not provide the extension!"));
     auxillaryKnownArgumentMap_.insert(make_pair("delay", "Usage: delay <val> | "
-            "Set the delay between drawing traces in seconds. Default = 1 s)."));
+            "Set the minimum time between drawing traces in seconds. Default = 1 s)."));
     auxillaryKnownArgumentMap_.insert(make_pair("log", "Toggle log/linear mode on the y-axis."));
     auxillaryKnownArgumentMap_.insert(make_pair("clear", "Clear all stored traces and start over."));
 }
@@ -51,6 +53,19 @@ bool ScopeScanner::Initialize(string prefix_) {
     return init = true;
 }
 
+void ScopeScanner::IdleTask() {
+    time_t now = time(NULL);
+    if (now == last_status)
+        return;
+    last_status = now;
+
+    stringstream status;
+    status << "M" << unpacker_->GetModuleNumber() << "C" << unpacker_->GetChannelNumber() << " | displayed "
+           << unpacker_->GetNumTracesDisplayed() << ", skipped " << unpacker_->GetNumSkipped() << ", latency "
+           << (int) unpacker_->GetDisplayLatency() << " ms | dropped spills " << GetNumSpillsDropped();
+    SetStatus(status.str());
+}
+
 /** Receive various status notifications from the scan.
   * \param[in] code_ The notification code passed from ScanInterface methods.
   * \return Nothing.
@@ -199,13 +214,10 @@ bool ScopeScanner::ExtraCommands(const string &cmd_, vector<string> &args_) {
             cout << msgHeader << " -SYNTAX- delay <time>\n";
         }
     } else if (cmd_ == "log") {
-        if (RootInterface::get()->GetCanvas()->GetLogy()) {
-            RootInterface::get()->GetCanvas()->SetLogy(0);
-            cout << msgHeader << "y-axis set to linear.\n";
-        } else {
-            RootInterface::get()->GetCanvas()->SetLogy(1);
+        if (unpacker_->ToggleLogy())
             cout << msgHeader << "y-axis set to log.\n";
-        }
+        else
+            cout << msgHeader << "y-axis set to linear.\n";
     } else if (cmd_ == "clear") {
         unpacker_->ClearEvents();
         cout << msgHeader << "Event deque cleared.\n";
@@ -2,7 +2,6 @@
 ///@brief Unpacker class for scope program
 ///@author C. R. Thornsberry, S. V. Paulauskas, and K. Smith
 ///@date May 19, 2017
-#include <deque>
 #include <fstream>
 #include <vector>
 
@@ -20,24 +19,28 @@
 #include <TLine.h>
 #include <TProfile.h>
 #include <TPaveStats.h>
+#include <TROOT.h>
 
 #include "HelperFunctions.hpp"
 #include "RootInterface.hpp"
 #include "ScopeUnpacker.hpp"
+#include "XiaData.hpp"
 
 using namespace std;
 using namespace TraceFunctions;
 
 /// Default constructor.
 ScopeUnpacker::ScopeUnpacker(const unsigned int &mod/*=0*/, const unsigned int &chan/*=0*/) : Unpacker() {
+    //The display thread draws and fits while the command thread may touch the canvas
+    ROOT::EnableThreadSafety();
+
     saveFile_ = "";
     mod_ = mod;
     chan_ = chan;
     threshLow_ = 0;
     threshHigh_ = numeric_limits<unsigned int>::max();
     resetGraph_ = false;
-
-    time(&last_trace);
+    singleCapture_ = false;
 
     performFit_ = false;
     performCfd_ = false;
@@ -70,9 +73,21 @@ ScopeUnpacker::ScopeUnpacker(const unsigned int &mod/*=0*/, const unsigned int &
 
     //Display Fit Stats: Fit Values, Errors, and ChiSq.
     gStyle->SetOptFit(111);
+
+    capture_.length = capture_.numWaveforms = 0;
+    hasPending_ = false;
+    stopDisplay_ = false;
+    clearRequested_ = false;
+    numSkipped_ = 0;
+    displayLatency_ = 0;
+    displayThread_ = thread(&ScopeUnpacker::DisplayLoop, this);
 }
 
 ScopeUnpacker::~ScopeUnpacker() {
+    stopDisplay_ = true;
+    pendingCondition_.notify_one();
+    displayThread_.join();
+
     delete graph;
     delete cfdLine;
     delete cfdPol3;
@@ -109,7 +124,71 @@ void ScopeUnpacker::ResetGraph(const unsigned int &size) {
     resetGraph_ = false;
 }
 
+bool ScopeUnpacker::PerformCfd() {
+    lock_guard<mutex> lock(plotMutex_);
+    return performCfd_;
+}
+
+bool ScopeUnpacker::PerformFit() {
+    lock_guard<mutex> lock(plotMutex_);
+    return performFit_;
+}
+
+void ScopeUnpacker::SetCfdFraction(const double &a) {
+    lock_guard<mutex> lock(plotMutex_);
+    cfdF_ = a;
+}
+
+void ScopeUnpacker::SetCfdDelay(const unsigned int &a) {
+    lock_guard<mutex> lock(plotMutex_);
+    cfdD_ = a;
+}
+
+void ScopeUnpacker::SetCfdShift(const unsigned int &a) {
+    lock_guard<mutex> lock(plotMutex_);
+    cfdL_ = a;
+}
+
+void ScopeUnpacker::SetFitLow(const unsigned int &a) {
+    lock_guard<mutex> lock(plotMutex_);
+    fitLow_ = a;
+}
+
+void ScopeUnpacker::SetFitHigh(const unsigned int &a) {
+    lock_guard<mutex> lock(plotMutex_);
+    fitHigh_ = a;
+}
+
+void ScopeUnpacker::SetPerformCfd(const bool &a) {
+    lock_guard<mutex> lock(plotMutex_);
+    performCfd_ = a;
+}
+
+void ScopeUnpacker::SetPerformFit(const bool &a) {
+    lock_guard<mutex> lock(plotMutex_);
+    performFit_ = a;
+}
+
+void ScopeUnpacker::SetResetGraph(const bool &a) {
+    lock_guard<mutex> lock(plotMutex_);
+    resetGraph_ = a;
+}
+
+void ScopeUnpacker::SetSaveFile(const std::string &a) {
+    lock_guard<mutex> lock(plotMutex_);
+    saveFile_ = a;
+}
+
+bool ScopeUnpacker::ToggleLogy() {
+    lock_guard<mutex> lock(plotMutex_);
+    TCanvas *canvas = RootInterface::get()->GetCanvas();
+    canvas->SetLogy(!canvas->GetLogy());
+    canvas->Update();
+    return canvas->GetLogy() != 0;
+}
+
 bool ScopeUnpacker::SelectFittingFunction(const std::string &func) {
+    lock_guard<mutex> lock(plotMutex_);
     if (func == "crystalball" || func == "cb") {
         crystalBallFunction_ = new CrystalBallFunction();
         fittingFunction_ = new TF1("func", crystalBallFunction_, 0., 1.e6, 6);
@@ -144,56 +223,106 @@ void ScopeUnpacker::ProcessRawEvent() {
 
     // Fill the processor event deques with events
     while (!rawEvent.empty()) {
-        if (!running)
-            break;
-
         //Get the first event in the FIFO.
         current_event = rawEvent.front();
         rawEvent.pop_front();
 
-        // Safety catches for null event or empty ->GetTrace().
-        if (!current_event || current_event->GetTrace().empty())
+        // Safety catches for null event or an event that we do not look at.
+        if (!current_event || !running || current_event->GetModuleNumber() != mod_ ||
+            current_event->GetChannelNumber() != chan_ || current_event->GetTraceLength() == 0) {
+            delete current_event;
             continue;
+        }
 
-        if (current_event->GetModuleNumber() != mod_ &&
-            current_event->GetChannelNumber() != chan_)
-            continue;
+        const vector<unsigned int> &trace = current_event->GetTrace();
+        try {
+            pair<unsigned int, double> maximum = FindMaximum(trace, trace.size());
+            if (maximum.second >= threshLow_ && (threshHigh_ <= threshLow_ || maximum.second <= threshHigh_))
+                Capture(trace);
+        } catch (range_error &ex) {}
 
-        pair<double, double> baseline = CalculateBaseline(current_event->GetTrace(), make_pair(0, 10));
-        pair<double, double> maximum = FindMaximum(current_event->GetTrace(), current_event->GetTrace().size());
-        double qdc = CalculateQdc(current_event->GetTrace(), make_pair(5, 15));
+        delete current_event;
+    }
+}
 
-        if (maximum.second < threshLow_ || (threshHigh_ > threshLow_ && maximum.second > threshHigh_)) {
-            delete current_event;
-            continue;
-        }
+void ScopeUnpacker::Capture(const std::vector<unsigned int> &trace) {
+    unsigned int length = (unsigned int) trace.size();
+    if (clearRequested_.exchange(false) || length != capture_.length) {
+        capture_.length = length;
+        capture_.numWaveforms = 0;
+    }
 
-        //Convert the XiaData object into a ProcessedXiaData object
-        ProcessedXiaData *channel_event = new ProcessedXiaData(*current_event);
+    //The buffers keep their size, frames only start over.
+    if (capture_.numWaveforms == 0)
+        capture_.sum.assign(length, 0.0);
+    size_t offset = (size_t) capture_.numWaveforms * length;
+    if (capture_.samples.size() < offset + length)
+        capture_.samples.resize(offset + length);
+    copy(trace.begin(), trace.end(), capture_.samples.begin() + offset);
+    for (unsigned int i = 0; i < length; i++)
+        capture_.sum[i] += trace[i];
+    capture_.numWaveforms++;
+
+    if (capture_.numWaveforms < max(1u, numAvgWaveforms_.load()))
+        return;
 
-        channel_event->GetTrace().SetBaseline(baseline);
-        channel_event->GetTrace().SetMax(maximum);
-        channel_event->GetTrace().SetQdc(qdc);
+    capture_.completed = chrono::steady_clock::now();
+    {
+        lock_guard<mutex> lock(pendingMutex_);
+        if (hasPending_)
+            numSkipped_++;
+        swap(capture_, pending_);
+        hasPending_ = true;
+    }
+    pendingCondition_.notify_one();
 
-        //Push the channel event into the deque.
-        chanEvents_.push_back(channel_event);
+    capture_.length = length;
+    capture_.numWaveforms = 0;
 
-        // Handle the individual XiaData.
-        if (chanEvents_.size() >= numAvgWaveforms_)
-            ProcessEvents();
+    //If this is a single capture we stop the plotting.
+    if (singleCapture_)
+        running = false;
+}
+
+void ScopeUnpacker::DisplayLoop() {
+    chrono::steady_clock::time_point lastDraw;
+    bool hasDrawn = false;
+
+    while (!stopDisplay_) {
+        bool draw = false;
+        {
+            //Bound the refresh rate, the frame waits and may still be replaced
+            auto ready = [&]() {
+                return hasPending_ && (!hasDrawn || chrono::steady_clock::now() - lastDraw >=
+                                                    chrono::seconds(delayInSeconds_.load()));
+            };
+            unique_lock<mutex> lock(pendingMutex_);
+            pendingCondition_.wait_for(lock, chrono::milliseconds(100), [&]() { return stopDisplay_ || ready(); });
+            if (ready()) {
+                swap(pending_, display_);
+                hasPending_ = false;
+                draw = true;
+            }
+        }
+
+        lock_guard<mutex> lock(plotMutex_);
+        if (draw && !stopDisplay_) {
+            Plot();
+            lastDraw = chrono::steady_clock::now();
+            hasDrawn = true;
+            displayLatency_ = chrono::duration<double, milli>(lastDraw - display_.completed).count();
+        }
+        RootInterface::get()->IdleTask();
     }
 }
 
 void ScopeUnpacker::Plot() {
     static float histAxis[2][2];
 
-    if (chanEvents_.size() < numAvgWaveforms_)
+    unsigned long traceSize = display_.length;
+    if (traceSize == 0 || display_.numWaveforms == 0)
         return;
 
-    unsigned long traceSize = chanEvents_.front()->GetTrace().size();
-
-    ResetGraph(traceSize);
-
     if (traceSize != x_vals.size())
         resetGraph_ = true;
 
@@ -206,40 +335,44 @@ void ScopeUnpacker::Plot() {
         }
     }
 
-    if (numAvgWaveforms_ == 1) {
-        Trace trc = chanEvents_.front()->GetTrace();
-        int index = 0;
-        for (size_t i = 0; i < traceSize; ++i, index++)
-            graph->SetPoint(index, x_vals[i], trc.at(i));
+    //The first waveform and the average of the frame
+    vector<unsigned int> trc(display_.samples.begin(), display_.samples.begin() + traceSize);
+    vector<double> avg(display_.sum.begin(), display_.sum.begin() + traceSize);
+    for (vector<double>::iterator it = avg.begin(); it != avg.end(); it++)
+        *it /= display_.numWaveforms;
+
+    pair<double, double> baseline(0, 0);
+    pair<unsigned int, double> maximum(0, 0);
+    double qdc = 0;
+    try {
+        baseline = CalculateBaseline(avg, make_pair(0, 10));
+        maximum = FindMaximum(avg, avg.size());
+        qdc = CalculateQdc(avg, make_pair(5, 15));
+    } catch (range_error &ex) {}
+
+    if (display_.numWaveforms == 1) {
+        for (size_t i = 0; i < traceSize; ++i)
+            graph->SetPoint(i, x_vals[i], trc.at(i));
 
         RootInterface::get()->UpdateZoom();
 
         graph->Draw("AP0");
 
-        float lowVal = (trc.GetMaxInfo().first - fitLow_);
-        float highVal = (trc.GetMaxInfo().first + fitHigh_);
-
-//        if (performCfd_ && trc.GetTraceSansBaseline().size() != 0) {
-//            PolynomialCfd cfd;
-//            double phase = cfd.CalculatePhase(trc.GetTraceSansBaseline(),
-//                                              make_pair(cfdF_, cfdD_),
-//                                              trc.GetMaxInfo(),
-//                                              trc.GetBaselineInfo());
-//            cout << "Unpacker::Plot - CFD Phase = " << phase << endl;
-//        }
+        float lowVal = (maximum.first - fitLow_);
+        float highVal = (maximum.first + fitHigh_);
 
         if (performFit_) {
-            fittingFunction_->SetParameters(trc.GetMaxInfo().first, 0.5 * trc.GetQdc(), 0.4, 0.1, 4);
-            fittingFunction_->FixParameter(fittingFunction_->GetParNumber("baseline"), trc.GetBaselineInfo().first);
+            fittingFunction_->SetParameters(maximum.first, 0.5 * qdc, 0.4, 0.1, 4);
+            fittingFunction_->FixParameter(fittingFunction_->GetParNumber("baseline"), baseline.first);
             graph->Fit(fittingFunction_, "WRQ", "", lowVal, highVal);
         }
     } else {
         //For multiple events with make a 2D histogram and plot the profile on top.
         //Determine the maximum and minimum values of the events.
-        for (unsigned int i = 0; i < numAvgWaveforms_; i++) {
-            ProcessedXiaData *evt = chanEvents_.at(i);
-            float evtMin = *min_element(evt->GetTrace().begin(), evt->GetTrace().end());
-            float evtMax = *max_element(evt->GetTrace().begin(), evt->GetTrace().end());
+        for (unsigned int i = 0; i < display_.numWaveforms; i++) {
+            vector<unsigned int>::const_iterator begin = display_.samples.begin() + i * traceSize;
+            float evtMin = *min_element(begin, begin + traceSize);
+            float evtMax = *max_element(begin, begin + traceSize);
             evtMin -= fabs(0.1 * evtMax);
             evtMax += fabs(0.1 * evtMax);
             if (evtMin < histAxis[1][0]) histAxis[1][0] = evtMin;
@@ -254,12 +387,9 @@ void ScopeUnpacker::Plot() {
                       histAxis[1][0], histAxis[1][1]);
 
         //Fill the histogram
-        for (unsigned int i = 0; i < numAvgWaveforms_; i++) {
-            ProcessedXiaData *evt = chanEvents_.at(i);
-            for (size_t i = 0; i < evt->GetTrace().size(); ++i) {
-                hist->Fill(x_vals[i], evt->GetTrace()[i]);
-            }
-        }
+        for (unsigned int i = 0; i < display_.numWaveforms; i++)
+            for (size_t j = 0; j < traceSize; ++j)
+                hist->Fill(x_vals[j], display_.samples[i * traceSize + j]);
 
         prof = hist->ProfileX("AvgPulse");
         prof->SetLineColor(kRed);
@@ -269,8 +399,8 @@ void ScopeUnpacker::Plot() {
         double highVal = prof->GetBinCenter(prof->GetMaximumBin() + fitHigh_);
 
         if (performFit_) {
-            fittingFunction_->SetParameters(lowVal, 0.5 * chanEvents_.front()->GetTrace().GetQdc(), 0.3, 0.1);
-            fittingFunction_->FixParameter(4, chanEvents_.front()->GetTrace().GetBaselineInfo().first);
+            fittingFunction_->SetParameters(lowVal, 0.5 * qdc, 0.3, 0.1);
+            fittingFunction_->FixParameter(4, baseline.first);
             hist->Fit(fittingFunction_, "WRQ", "", lowVal, highVal);
         }
 
@@ -298,57 +428,16 @@ void ScopeUnpacker::Plot() {
         f.Close();
 
         ofstream ascii((saveFile_ + ".dat").c_str());
-        vector<unsigned int> trc = chanEvents_.front()->GetTrace();
         for (vector<unsigned int>::iterator it = trc.begin(); it != trc.end(); it++)
             ascii << int(it - trc.begin()) << " " << *it << endl;
         saveFile_ = "";
     }
 
-    // Remove the events from the deque.
-    for (unsigned int i = 0; i < numAvgWaveforms_; i++) {
-        delete chanEvents_.front();
-        chanEvents_.pop_front();
-    }
-
     numTracesDisplayed_++;
 }
 
-/** Process all channel events read in from the rawEvent.
-  * This method should only be called from skeletonUnpacker::ProcessRawEvent().
-  * \return True if events were processed and false otherwise.
-  */
-bool ScopeUnpacker::ProcessEvents() {
-    //Check if we have delayed the plotting enough
-    time_t cur_time;
-    time(&cur_time);
-    while (difftime(cur_time, last_trace) < delayInSeconds_) {
-        //If in shm mode and the plotting time has not allotted the events are
-        // cleared and this function is aborted.
-//        if (ShmMode()) {
-//            ClearEvents();
-//            return false;
-//        } else {
-//            IdleTask();
-        time(&cur_time);
-//        }
-    }
-
-    //When we have the correct number of waveforms we plot them.
-    Plot();
-
-    //If this is a single capture we stop the plotting.
-    if (singleCapture_)
-        running = false;
-
-    //Update the time.
-    time(&last_trace);
-
-    return true;
-}
-
 void ScopeUnpacker::ClearEvents() {
-    while (!chanEvents_.empty()) {
-        delete chanEvents_.front();
-        chanEvents_.pop_front();
-    }
+    clearRequested_ = true;
+    lock_guard<mutex> lock(pendingMutex_);
+    hasPending_ = false;
 }
@@ -0,0 +1,63 @@
+///@file FilterOptimizerInterface.hpp
+///@brief Scan interface of the trapezoidal filter optimizer
+///@date October 19, 2026
+#ifndef __FILTEROPTIMIZERINTERFACE_HPP__
+#define __FILTEROPTIMIZERINTERFACE_HPP__
+
+#include <string>
+#include <vector>
+
+#include "ScanInterface.hpp"
+
+class FilterOptimizerUnpacker;
+
+///Reads the grid of filter parameters from the command line, scans the file
+/// to collect the traces and runs the optimizer once the scan is complete.
+class FilterOptimizerInterface : public ScanInterface {
+public:
+    ///Default constructor.
+    ///@param[in] unpacker : The unpacker collecting the traces
+    FilterOptimizerInterface(FilterOptimizerUnpacker *unpacker);
+
+    ///Destructor.
+    ~FilterOptimizerInterface() {}
+
+    ///Handle the terminal commands of the optimizer.
+    ///@param[in] cmd_ The command to interpret.
+    ///@param[out] args_ Vector or arguments to the user command.
+    ///@return True if the command was recognized and false otherwise.
+    bool ExtraCommands(const std::string &cmd_, std::vector<std::string> &args_);
+
+    ///Read the grid of filter parameters from the command line.
+    ///@throw invalid_argument if a range can not be parsed
+    void ExtraArguments();
+
+    ///Add the command line options of the optimizer.
+    void ArgHelp();
+
+    ///Print a linux style usage message to the screen.
+    ///@param[in] name_ The name of the program.
+    void SyntaxStr(char *name_);
+
+    ///Receive various status notifications from the scan, the optimizer runs
+    /// when the scan is complete.
+    ///@param[in] code_ The notification code passed from ScanInterface methods.
+    void Notify(const std::string &code_ = "");
+
+private:
+    FilterOptimizerUnpacker *optimizerUnpacker_; ///< The unpacker collecting the traces
+    unsigned int numThreads_; ///< The number of threads, 0 for all cores
+    bool hasRun_; ///< True once the grid was evaluated
+
+    ///Sweep the grid and print the results
+    void Optimize();
+
+    ///Parse a range of the form min[:max:step]
+    ///@param[in] option : The name of the option, used in the error
+    ///@param[in] range : The range to parse
+    ///@return The values in the range
+    ///@throw invalid_argument if the range is malformed
+    std::vector<double> ParseRange(const std::string &option, const std::string &range);
+};
+
+#endif //__FILTEROPTIMIZERINTERFACE_HPP__
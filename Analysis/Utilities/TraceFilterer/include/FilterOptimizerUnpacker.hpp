@@ -0,0 +1,49 @@
+///@file FilterOptimizerUnpacker.hpp
+///@brief Collects the traces of one channel for the trapezoidal filter
+/// optimizer
+///@date October 19, 2026
+#ifndef __FILTEROPTIMIZERUNPACKER_HPP__
+#define __FILTEROPTIMIZERUNPACKER_HPP__
+
+#include "TrapFilterOptimizer.hpp"
+#include "Unpacker.hpp"
+
+///Class that hands the traces of the channel of interest to the optimizer
+/// until the sample is complete.
+class FilterOptimizerUnpacker : public Unpacker {
+public:
+    ///Default constructor.
+    FilterOptimizerUnpacker() : Unpacker(), mod_(0), chan_(0), maxTraces_(20000) {}
+
+    ///Destructor.
+    ~FilterOptimizerUnpacker() {}
+
+    ///@return The optimizer holding the traces
+    TrapFilterOptimizer *GetOptimizer() { return &optimizer_; }
+
+    ///@return True once the sample holds the requested number of traces
+    bool IsFull() const { return optimizer_.GetNumTraces() >= maxTraces_; }
+
+    ///Set the module and channel of interest
+    ///@param[in] mod : The module number
+    ///@param[in] chan : The channel number
+    void SetChannel(const unsigned int &mod, const unsigned int &chan) {
+        mod_ = mod;
+        chan_ = chan;
+    }
+
+    ///Set the number of traces in the sample
+    ///@param[in] a : The parameter that we are going to set
+    void SetMaxTraces(const unsigned int &a) { maxTraces_ = a; }
+
+private:
+    unsigned int mod_; ///< The module of the signal of interest
+    unsigned int chan_; ///< The channel of the signal of interest
+    unsigned int maxTraces_; ///< The number of traces in the sample
+    TrapFilterOptimizer optimizer_; ///< The optimizer holding the traces
+
+    ///Process all events in the event list.
+    void ProcessRawEvent();
+};
+
+#endif //__FILTEROPTIMIZERUNPACKER_HPP__
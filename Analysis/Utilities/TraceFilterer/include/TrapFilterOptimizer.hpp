@@ -0,0 +1,125 @@
+///@file TrapFilterOptimizer.hpp
+///@brief Sweeps a grid of trapezoidal filter parameters over a sample of
+/// traces to find the settings with the best energy resolution
+///@date October 19, 2026
+#ifndef __TRAPFILTEROPTIMIZER_HPP__
+#define __TRAPFILTEROPTIMIZER_HPP__
+
+#include <vector>
+
+#include "TrapFilterParameters.hpp"
+
+///A class that holds a sample of traces and evaluates every combination of
+/// trigger and energy filter parameters on them. Every trace is stored as its
+/// running sum, so any window sum of the trace costs two lookups. The trigger
+/// filter is then O(N) per trace regardless of the risetime and the energy
+/// filter O(1). The trigger search is done once per trigger setting and shared
+/// by all energy settings. Both steps are spread over a pool of threads.
+///
+/// The filters follow TraceFilter : the first crossing of the trigger filter
+/// above threshold is the trigger, and a trace that crosses again after
+/// dropping below threshold is piled up. The baseline is averaged up to the
+/// trigger risetime + 5 samples before the trigger, and the energy is the
+/// tau corrected sum of the rise, gap and fall windows starting 10 samples
+/// before the energy risetime.
+class TrapFilterOptimizer {
+public:
+    ///The performance of one combination of filter parameters
+    struct Result {
+        TrapFilterParameters trigger; ///< Risetime, flattop (ns) and threshold (ADC units)
+        TrapFilterParameters energy; ///< Risetime, flattop and tau (ns)
+        double centroid; ///< The median energy in the peak window
+        double fwhm; ///< The FWHM of the peak, from the median absolute deviation
+        unsigned int numInPeak; ///< Number of traces in the peak window
+        unsigned int numPileup; ///< Number of traces with more than one trigger
+        unsigned int numRejected; ///< Number of traces that could not be filtered
+
+        ///@return The FWHM relative to the centroid, negative if no peak
+        double GetResolution() const { return centroid > 0 && fwhm > 0 ? fwhm / centroid : -1; }
+    };
+
+    ///Default constructor
+    ///@param[in] nsPerSample : The number of ns per sample of the ADC
+    TrapFilterOptimizer(const double &nsPerSample = 4);
+
+    ///Default destructor
+    ~TrapFilterOptimizer() {}
+
+    ///Add a trace to the sample
+    ///@param[in] trace : The samples of the trace
+    void AddTrace(const std::vector<unsigned int> &trace);
+
+    ///Add a trigger filter setting to the grid
+    ///@param[in] a : The risetime and flattop in ns, the threshold in ADC units
+    void AddTriggerParameters(const TrapFilterParameters &a) { trigger_.push_back(a); }
+
+    ///Add an energy filter setting to the grid
+    ///@param[in] a : The risetime, flattop and tau in ns
+    void AddEnergyParameters(const TrapFilterParameters &a) { energy_.push_back(a); }
+
+    ///@return The number of traces in the sample
+    unsigned int GetNumTraces() const { return (unsigned int) sums_.size(); }
+
+    ///@return The number of parameter combinations in the grid
+    unsigned int GetNumSettings() const { return (unsigned int) (trigger_.size() * energy_.size()); }
+
+    ///Evaluate every combination of trigger and energy parameters.
+    ///@param[in] numThreads : The number of threads used, 0 for the number of
+    /// cores
+    ///@return The results sorted from the best to the worst resolution, the
+    /// settings without a peak come last.
+    std::vector<Result> Optimize(unsigned int numThreads = 0) const;
+
+    ///Set the number of ns per sample of the ADC
+    ///@param[in] a : The parameter that we are going to set
+    void SetNsPerSample(const double &a) { nsPerSample_ = a; }
+
+    ///Set the window around the peak used for the resolution. By default all
+    /// energies are used, which only makes sense for a single peak.
+    ///@param[in] low : The lowest energy of the window
+    ///@param[in] high : The highest energy of the window
+    void SetPeakWindow(const double &low, const double &high) {
+        low_ = low;
+        high_ = high;
+    }
+
+private:
+    ///The position of the first trigger and the number of triggers in a trace
+    struct Triggers {
+        unsigned int position; ///< Position of the first trigger
+        unsigned int number; ///< Number of triggers, 0 if none was found
+    };
+
+    double nsPerSample_; ///< The number of ns per sample
+    double low_; ///< Low edge of the peak window
+    double high_; ///< High edge of the peak window
+    static const unsigned int MIN_IN_PEAK = 10; ///< Fewest traces in the window to measure the peak
+
+    std::vector<std::vector<double> > sums_; ///< The running sums of the traces
+    std::vector<TrapFilterParameters> trigger_; ///< The trigger filter grid
+    std::vector<TrapFilterParameters> energy_; ///< The energy filter grid
+
+    ///@return The length of a filter window in samples
+    ///@param[in] ns : The length in ns
+    unsigned int ToSamples(const double &ns) const;
+
+    ///Find the triggers of every trace for a trigger setting
+    ///@param[in] pars : The trigger filter setting
+    ///@param[out] triggers : The triggers of every trace
+    void FindTriggers(const TrapFilterParameters &pars, std::vector<Triggers> &triggers) const;
+
+    ///Compute the energies of every trace and the resolution of the peak
+    ///@param[in] trigger : The trigger filter setting
+    ///@param[in] energy : The energy filter setting
+    ///@param[in] triggers : The triggers found with the trigger setting
+    ///@return The performance of the setting
+    Result Evaluate(const TrapFilterParameters &trigger, const TrapFilterParameters &energy,
+                    const std::vector<Triggers> &triggers) const;
+
+    ///Measure the centroid and the width of the peak in the window
+    ///@param[in] energies : The energies of the traces
+    ///@param[out] result : Receives the centroid, FWHM and counts
+    void MeasurePeak(const std::vector<double> &energies, Result &result) const;
+};
+
+#endif //__TRAPFILTEROPTIMIZER_HPP__
@@ -0,0 +1,196 @@
+///@file FilterOptimizerInterface.cpp
+///@brief Scan interface of the trapezoidal filter optimizer
+///@date October 19, 2026
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#include "FilterOptimizerInterface.hpp"
+#include "FilterOptimizerUnpacker.hpp"
+#include "StringManipulationFunctions.hpp"
+
+using namespace std;
+
+namespace {
+    ///Index of the options in userOpts, in the order they are added by ArgHelp
+    enum OptionIndex {
+        MOD, CHAN, TRACES, THREADS, TRISE, TFLAT, THRESH, ERISE, EFLAT, TAU, PEAK, NS_PER_SAMPLE
+    };
+
+    ///Writes one line of the result table
+    void WriteResult(ostream &out, const TrapFilterOptimizer::Result &result) {
+        out << setw(8) << result.trigger.GetRisetime() << setw(8) << result.trigger.GetFlattop()
+            << setw(8) << result.trigger.GetT() << setw(8) << result.energy.GetRisetime()
+            << setw(8) << result.energy.GetFlattop() << setw(10) << result.energy.GetT()
+            << setw(12) << result.centroid << setw(10) << result.fwhm << setw(9) << 100 * result.GetResolution()
+            << setw(8) << result.numInPeak << setw(8) << result.numPileup << setw(8) << result.numRejected << endl;
+    }
+
+    ///Writes the header of the result table
+    void WriteHeader(ostream &out) {
+        out << setw(8) << "trise" << setw(8) << "tflat" << setw(8) << "thresh" << setw(8) << "erise"
+            << setw(8) << "eflat" << setw(10) << "tau" << setw(12) << "centroid" << setw(10) << "fwhm"
+            << setw(9) << "res(%)" << setw(8) << "peak" << setw(8) << "pileup" << setw(8) << "reject" << endl;
+    }
+}
+
+FilterOptimizerInterface::FilterOptimizerInterface(FilterOptimizerUnpacker *unpacker) :
+        ScanInterface(), optimizerUnpacker_(unpacker), numThreads_(0), hasRun_(false) {
+    auxillaryKnownArgumentMap_.insert(make_pair("optimize", "Sweep the grid over the traces collected so far."));
+}
+
+bool FilterOptimizerInterface::ExtraCommands(const string &cmd_, vector<string> &args_) {
+    if (cmd_ == "optimize")
+        Optimize();
+    else
+        return false;
+    return true;
+}
+
+vector<double> FilterOptimizerInterface::ParseRange(const std::string &option, const std::string &range) {
+    vector<string> tokens = StringManipulation::TokenizeString(range, ":");
+    vector<double> values;
+    try {
+        for (vector<string>::iterator it = tokens.begin(); it != tokens.end(); it++)
+            values.push_back(stod(*it));
+    } catch (exception &ex) {
+        values.clear();
+    }
+
+    if (values.size() == 1)
+        return values;
+    if (values.size() != 3 || values[2] <= 0 || values[1] < values[0])
+        throw invalid_argument("FilterOptimizerInterface::ParseRange - The range \"" + range + "\" of --" + option +
+                               " is not of the form min[:max:step].");
+
+    vector<double> result;
+    for (double value = values[0]; value <= values[1] + 1e-9 * values[2]; value += values[2])
+        result.push_back(value);
+    return result;
+}
+
+void FilterOptimizerInterface::ExtraArguments() {
+    unsigned int mod = userOpts.at(MOD).active ? stoul(userOpts.at(MOD).argument) : 0;
+    unsigned int chan = userOpts.at(CHAN).active ? stoul(userOpts.at(CHAN).argument) : 0;
+    optimizerUnpacker_->SetChannel(mod, chan);
+    if (userOpts.at(TRACES).active)
+        optimizerUnpacker_->SetMaxTraces(stoul(userOpts.at(TRACES).argument));
+    if (userOpts.at(THREADS).active)
+        numThreads_ = stoul(userOpts.at(THREADS).argument);
+
+    TrapFilterOptimizer *optimizer = optimizerUnpacker_->GetOptimizer();
+    double nsPerSample = 1000. / unpacker_->GetDataMask(mod).GetFrequency();
+    if (userOpts.at(NS_PER_SAMPLE).active)
+        nsPerSample = stod(userOpts.at(NS_PER_SAMPLE).argument);
+    optimizer->SetNsPerSample(nsPerSample);
+
+    vector<vector<double> > ranges;
+    const char *defaults[] = {"100", "0", "20", "1000:8000:1000", "0:1000:200", "50000"};
+    for (unsigned int i = TRISE; i <= TAU; i++)
+        ranges.push_back(ParseRange(userOpts.at(i).name, userOpts.at(i).active ? userOpts.at(i).argument :
+                                                         defaults[i - TRISE]));
+
+    for (vector<double>::iterator l = ranges[0].begin(); l != ranges[0].end(); l++)
+        for (vector<double>::iterator g = ranges[1].begin(); g != ranges[1].end(); g++)
+            for (vector<double>::iterator t = ranges[2].begin(); t != ranges[2].end(); t++)
+                optimizer->AddTriggerParameters(TrapFilterParameters(*l, *g, *t));
+    for (vector<double>::iterator l = ranges[3].begin(); l != ranges[3].end(); l++)
+        for (vector<double>::iterator g = ranges[4].begin(); g != ranges[4].end(); g++)
+            for (vector<double>::iterator t = ranges[5].begin(); t != ranges[5].end(); t++)
+                optimizer->AddEnergyParameters(TrapFilterParameters(*l, *g, *t));
+
+    if (userOpts.at(PEAK).active) {
+        vector<string> tokens = StringManipulation::TokenizeString(userOpts.at(PEAK).argument, ":");
+        if (tokens.size() != 2)
+            throw invalid_argument("FilterOptimizerInterface::ExtraArguments - The peak window \"" +
+                                   userOpts.at(PEAK).argument + "\" is not of the form low:high.");
+        optimizer->SetPeakWindow(stod(tokens[0]), stod(tokens[1]));
+    }
+
+    cout << msgHeader << "Collecting the traces of M" << mod << "C" << chan << " at " << nsPerSample
+         << " ns/sample for " << optimizer->GetNumSettings() << " filter settings.\n";
+}
+
+void FilterOptimizerInterface::ArgHelp() {
+    AddOption(optionExt("mod", required_argument, NULL, 0, "<module>", "Module of signal of interest (default=0)."));
+    AddOption(optionExt("chan", required_argument, NULL, 0, "<channel>",
+                        "Channel of signal of interest (default=0)."));
+    AddOption(optionExt("traces", required_argument, NULL, 0, "<number>",
+                        "Number of traces in the sample (default=20000)."));
+    AddOption(optionExt("threads", required_argument, NULL, 0, "<number>",
+                        "Number of threads (default=number of cores)."));
+    AddOption(optionExt("trise", required_argument, NULL, 0, "<min[:max:step]>",
+                        "Trigger risetimes in ns (default=100)."));
+    AddOption(optionExt("tflat", required_argument, NULL, 0, "<min[:max:step]>",
+                        "Trigger flattops in ns (default=0)."));
+    AddOption(optionExt("thresh", required_argument, NULL, 0, "<min[:max:step]>",
+                        "Trigger thresholds in ADC units (default=20)."));
+    AddOption(optionExt("erise", required_argument, NULL, 0, "<min[:max:step]>",
+                        "Energy risetimes in ns (default=1000:8000:1000)."));
+    AddOption(optionExt("eflat", required_argument, NULL, 0, "<min[:max:step]>",
+                        "Energy flattops in ns (default=0:1000:200)."));
+    AddOption(optionExt("tau", required_argument, NULL, 0, "<min[:max:step]>",
+                        "Decay constants in ns (default=50000)."));
+    AddOption(optionExt("peak", required_argument, NULL, 0, "<low:high>",
+                        "Energy window of the peak used for the resolution (default=all energies)."));
+    AddOption(optionExt("ns-per-sample", required_argument, NULL, 0, "<ns>",
+                        "Sampling period of the traces (default=from the frequency)."));
+}
+
+void FilterOptimizerInterface::SyntaxStr(char *name_) {
+    cout << " usage: " << string(name_) << " [options]\n";
+}
+
+void FilterOptimizerInterface::Optimize() {
+    TrapFilterOptimizer *optimizer = optimizerUnpacker_->GetOptimizer();
+    if (optimizer->GetNumTraces() == 0) {
+        cout << msgHeader << "No traces were collected for the channel of interest.\n";
+        return;
+    }
+
+    cout << msgHeader << "Sweeping " << optimizer->GetNumSettings() << " filter settings over "
+         << optimizer->GetNumTraces() << " traces.\n";
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    vector<TrapFilterOptimizer::Result> results = optimizer->Optimize(numThreads_);
+    cout << msgHeader << "Done in " << chrono::duration<double>(chrono::steady_clock::now() - start).count()
+         << " s.\n";
+
+    stringstream table;
+    table << fixed << setprecision(2);
+    WriteHeader(table);
+    for (vector<TrapFilterOptimizer::Result>::iterator it = results.begin(); it != results.end(); it++)
+        WriteResult(table, *it);
+
+    //Only the best settings go to the terminal, the whole table to the file
+    string line;
+    for (unsigned int i = 0; i < 11 && getline(table, line); i++)
+        cout << line << endl;
+
+    if (!GetOutputFilename().empty()) {
+        ofstream output(GetOutputFilename().c_str());
+        if (output.good()) {
+            output << table.str();
+            cout << msgHeader << "Wrote the results of all settings to " << GetOutputFilename() << ".\n";
+        } else
+            cout << msgHeader << "Unable to open " << GetOutputFilename() << "!\n";
+    }
+    hasRun_ = true;
+}
+
+void FilterOptimizerInterface::Notify(const string &code_/*=""*/) {
+    if (code_ == "SCAN_COMPLETE") {
+        cout << msgHeader << "Scan complete.\n";
+        if (!hasRun_)
+            Optimize();
+    } else if (code_ == "START_SCAN") {}
+    else if (code_ == "STOP_SCAN") {}
+    else if (code_ == "LOAD_FILE") {
+        cout << msgHeader << "File loaded.\n";
+    } else if (code_ == "REWIND_FILE") {}
+    else {
+        cout << msgHeader << "Unknown notification code '" << code_ << "'!\n";
+    }
+}
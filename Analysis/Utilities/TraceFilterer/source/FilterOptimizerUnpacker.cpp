@@ -0,0 +1,25 @@
+///@file FilterOptimizerUnpacker.cpp
+///@brief Collects the traces of one channel for the trapezoidal filter
+/// optimizer
+///@date October 19, 2026
+#include "FilterOptimizerUnpacker.hpp"
+#include "XiaData.hpp"
+
+void FilterOptimizerUnpacker::ProcessRawEvent() {
+    XiaData *current_event = NULL;
+
+    while (!rawEvent.empty()) {
+        current_event = rawEvent.front();
+        rawEvent.pop_front();
+
+        if (!current_event)
+            continue;
+
+        //The traces of the other channels are never decoded
+        if (!IsFull() && current_event->GetModuleNumber() == mod_ && current_event->GetChannelNumber() == chan_ &&
+            current_event->GetTraceLength() != 0)
+            optimizer_.AddTrace(current_event->GetTrace());
+
+        delete current_event;
+    }
+}
@@ -0,0 +1,194 @@
+///@file TrapFilterOptimizer.cpp
+///@brief Sweeps a grid of trapezoidal filter parameters over a sample of
+/// traces to find the settings with the best energy resolution
+///@date October 19, 2026
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include <cmath>
+
+#include "TrapFilterOptimizer.hpp"
+
+using namespace std;
+
+namespace {
+    ///Call a function for every index in [0, size) from a pool of threads
+    template<typename Function>
+    void ParallelFor(const size_t &size, unsigned int numThreads, Function function) {
+        if (numThreads == 0)
+            numThreads = max(1u, thread::hardware_concurrency());
+        numThreads = (unsigned int) min((size_t) numThreads, size);
+
+        atomic<size_t> next(0);
+        auto worker = [&]() {
+            for (size_t i = next++; i < size; i = next++)
+                function(i);
+        };
+
+        vector<thread> threads;
+        for (unsigned int i = 1; i < numThreads; i++)
+            threads.push_back(thread(worker));
+        worker();
+        for (vector<thread>::iterator it = threads.begin(); it != threads.end(); it++)
+            it->join();
+    }
+
+    ///Orders the results from the best to the worst resolution. The settings
+    /// that keep less than half as many traces in the peak as the best one
+    /// come after the others, a narrow peak of a few traces means nothing.
+    class CompareResolution {
+    public:
+        CompareResolution(const unsigned int &maxInPeak) : maxInPeak_(maxInPeak) {}
+
+        bool operator()(const TrapFilterOptimizer::Result &lhs, const TrapFilterOptimizer::Result &rhs) const {
+            bool lhsValid = IsValid(lhs), rhsValid = IsValid(rhs);
+            if (lhsValid != rhsValid)
+                return lhsValid;
+            if (lhs.GetResolution() < 0 || rhs.GetResolution() < 0)
+                return lhs.GetResolution() > rhs.GetResolution();
+            return lhs.GetResolution() < rhs.GetResolution();
+        }
+
+    private:
+        unsigned int maxInPeak_;
+
+        bool IsValid(const TrapFilterOptimizer::Result &a) const {
+            return a.GetResolution() > 0 && 2 * a.numInPeak >= maxInPeak_;
+        }
+    };
+}
+
+TrapFilterOptimizer::TrapFilterOptimizer(const double &nsPerSample) : nsPerSample_(nsPerSample), low_(0), high_(0) {}
+
+void TrapFilterOptimizer::AddTrace(const std::vector<unsigned int> &trace) {
+    sums_.push_back(vector<double>(trace.size() + 1, 0.0));
+    vector<double> &sum = sums_.back();
+    for (size_t i = 0; i < trace.size(); i++)
+        sum[i + 1] = sum[i] + trace[i];
+}
+
+unsigned int TrapFilterOptimizer::ToSamples(const double &ns) const {
+    return (unsigned int) ceil(ns / nsPerSample_ - 1e-9);
+}
+
+void TrapFilterOptimizer::FindTriggers(const TrapFilterParameters &pars, std::vector<Triggers> &triggers) const {
+    unsigned int l = ToSamples(pars.GetRisetime()), g = ToSamples(pars.GetFlattop());
+    double threshold = pars.GetT() * l;
+
+    triggers.resize(sums_.size());
+    for (size_t t = 0; t < sums_.size(); t++) {
+        const vector<double> &sum = sums_[t];
+        Triggers &trig = triggers[t];
+        trig.position = trig.number = 0;
+        if (l == 0)
+            continue;
+
+        //The filter is compared to the threshold before dividing by the risetime
+        bool isAbove = false;
+        for (size_t i = 2 * l + g; i < sum.size(); i++) {
+            double filter = (sum[i] - sum[i - l]) - (sum[i - l - g] - sum[i - 2 * l - g]);
+            if (filter >= threshold) {
+                if (!isAbove) {
+                    if (trig.number == 0)
+                        trig.position = (unsigned int) (i - 1);
+                    trig.number++;
+                }
+                isAbove = true;
+            } else
+                isAbove = false;
+        }
+    }
+}
+
+TrapFilterOptimizer::Result TrapFilterOptimizer::Evaluate(const TrapFilterParameters &trigger,
+                                                          const TrapFilterParameters &energy,
+                                                          const std::vector<Triggers> &triggers) const {
+    Result result;
+    result.trigger = trigger;
+    result.energy = energy;
+    result.numPileup = result.numRejected = 0;
+
+    unsigned int tl = ToSamples(trigger.GetRisetime());
+    unsigned int l = ToSamples(energy.GetRisetime()), g = ToSamples(energy.GetFlattop());
+    double beta = exp(-nsPerSample_ / energy.GetT());
+    double cg = 1 - beta;
+    double ctmp = 1 - pow(beta, (double) l);
+    double c0 = -(cg / ctmp) * pow(beta, (double) l), c2 = cg / ctmp;
+    //Without a decay constant the filter is the difference of the sums
+    if (std::isnan(c0) || std::isnan(c2) || ctmp == 0) {
+        cg = 0;
+        c0 = -1.0 / l;
+        c2 = 1.0 / l;
+    }
+
+    vector<double> energies;
+    energies.reserve(sums_.size());
+    for (size_t t = 0; t < sums_.size(); t++) {
+        const vector<double> &sum = sums_[t];
+        const Triggers &trig = triggers[t];
+        unsigned int size = (unsigned int) sum.size() - 1;
+
+        if (trig.number == 0 || l == 0 || trig.position <= tl + 5 || trig.position < l + 10 ||
+            trig.position + l + g > size) {
+            result.numRejected++;
+            continue;
+        }
+        if (trig.number > 1) {
+            result.numPileup++;
+            continue;
+        }
+
+        unsigned int offset = trig.position - tl - 5;
+        double baseline = sum[offset] / offset;
+
+        unsigned int p0 = trig.position - l - 10;
+        double rise = sum[p0 + l] - sum[p0] - baseline * l;
+        double gap = sum[p0 + l + g] - sum[p0 + l] - baseline * g;
+        double fall = sum[p0 + 2 * l + g] - sum[p0 + l + g] - baseline * l;
+        energies.push_back(c0 * rise + cg * gap + c2 * fall);
+    }
+
+    MeasurePeak(energies, result);
+    return result;
+}
+
+void TrapFilterOptimizer::MeasurePeak(const std::vector<double> &energies, Result &result) const {
+    result.centroid = result.fwhm = 0;
+
+    vector<double> peak;
+    peak.reserve(energies.size());
+    for (vector<double>::const_iterator it = energies.begin(); it != energies.end(); it++)
+        if (high_ <= low_ || (*it >= low_ && *it <= high_))
+            peak.push_back(*it);
+    result.numInPeak = (unsigned int) peak.size();
+    if (peak.size() < MIN_IN_PEAK)
+        return;
+
+    //The median and the median absolute deviation do not depend on a binning
+    // and ignore the tails, the FWHM of a gaussian is 2.3548 sigma.
+    vector<double>::iterator middle = peak.begin() + peak.size() / 2;
+    nth_element(peak.begin(), middle, peak.end());
+    result.centroid = *middle;
+    for (vector<double>::iterator it = peak.begin(); it != peak.end(); it++)
+        *it = fabs(*it - result.centroid);
+    nth_element(peak.begin(), middle, peak.end());
+    result.fwhm = 2.3548 * 1.4826 * (*middle);
+}
+
+vector<TrapFilterOptimizer::Result> TrapFilterOptimizer::Optimize(unsigned int numThreads) const {
+    vector<vector<Triggers> > triggers(trigger_.size());
+    ParallelFor(trigger_.size(), numThreads, [&](size_t i) { FindTriggers(trigger_[i], triggers[i]); });
+
+    vector<Result> results(GetNumSettings());
+    ParallelFor(results.size(), numThreads, [&](size_t i) {
+        size_t t = i / energy_.size(), e = i % energy_.size();
+        results[i] = Evaluate(trigger_[t], energy_[e], triggers[t]);
+    });
+
+    unsigned int maxInPeak = 0;
+    for (vector<Result>::iterator it = results.begin(); it != results.end(); it++)
+        maxInPeak = max(maxInPeak, it->numInPeak);
+    stable_sort(results.begin(), results.end(), CompareResolution(maxInPeak));
+    return results;
+}
@@ -0,0 +1,31 @@
+///@file filterOptimizer.cpp
+///@brief Finds the trapezoidal filter parameters with the best energy
+/// resolution for one channel
+///@date October 19, 2026
+#include <iostream>
+#include <stdexcept>
+
+#include "FilterOptimizerInterface.hpp"
+#include "FilterOptimizerUnpacker.hpp"
+
+using namespace std;
+
+int main(int argc, char *argv[]) {
+    FilterOptimizerUnpacker unpacker;
+    FilterOptimizerInterface scanner(&unpacker);
+
+    try {
+        scanner.SetProgramName("filterOptimizer");
+        if (!scanner.Setup(argc, argv, &unpacker))
+            return 1;
+    } catch (invalid_argument &invalidArgument) {
+        cout << invalidArgument.what() << endl;
+        return 1;
+    }
+
+    int retval = scanner.Execute();
+
+    scanner.Close();
+
+    return retval;
+}
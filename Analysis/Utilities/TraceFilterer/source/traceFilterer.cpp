@@ -23,25 +23,30 @@
 void Filterer::Filter(float *trace_, const size_t &length_, float *filtered1,
                       const unsigned int &risetime_,
                       const unsigned int &flattop_) {
-    float sum;
-    size_t a1, a2, a3, a4;
+    // Slide both windows along the trace instead of summing them again for
+    // every sample.
+    float sum = 0.0;
+    size_t size = 2 * risetime_ + flattop_;
 
-    for (size_t i = 0; i < 2 * risetime_ + flattop_; i++) {
+    for (size_t i = 0; i < size && i < length_; i++) {
         filtered1[i] = 0;
     }
 
-    for (size_t i = 2 * risetime_ + flattop_; i < length_; i++) {
-        sum = 0.0;
-        a1 = i - (2 * risetime_ + flattop_);
-        a2 = i - (risetime_ + flattop_);
-        a3 = i - risetime_;
-        a4 = i;
-        for (size_t j = a1; j <= a2; j++) {
-            sum += -1 * trace_[j];
-        }
-        for (size_t j = a3; j <= a4; j++) {
-            sum += trace_[j];
-        }
+    if (size == 0 || length_ <= size) { return; }
+
+    for (size_t j = 0; j <= risetime_; j++) {
+        sum += -1 * trace_[j];
+    }
+    for (size_t j = risetime_ + flattop_; j <= size; j++) {
+        sum += trace_[j];
+    }
+    filtered1[size] = sum / risetime_;
+
+    for (size_t i = size + 1; i < length_; i++) {
+        sum += trace_[i - (2 * risetime_ + flattop_) - 1];
+        sum -= trace_[i - (risetime_ + flattop_)];
+        sum -= trace_[i - risetime_ - 1];
+        sum += trace_[i];
         filtered1[i] = sum / risetime_;
     }
 }
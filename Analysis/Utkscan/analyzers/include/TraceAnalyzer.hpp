@@ -87,9 +87,10 @@ protected:
     * \param [in] dammId : The histogram number to define
     * \param [in] xSize : The range of the x-axis
     * \param [in] title : The title for the histogram
+    * \return a handle to the histogram
     */
-    virtual void DeclareHistogram1D(int dammId, int xSize, const char *title) {
-        histo.DeclareHistogram1D(dammId, xSize, title);
+    virtual Histogram1D DeclareHistogram1D(int dammId, int xSize, const char *title) {
+        return histo.DeclareHistogram1D(dammId, xSize, title);
     }
 
     /*! \brief Declares a 2D histogram calls the C++ wrapper for DAMM
@@ -97,9 +98,10 @@ protected:
     * \param [in] xSize : The range of the x-axis
     * \param [in] ySize : The range of the y-axis
     * \param [in] title : The title of the histogram
+    * \return a handle to the histogram
     */
-    virtual void DeclareHistogram2D(int dammId, int xSize, int ySize, const char *title) {
-        histo.DeclareHistogram2D(dammId, xSize, ySize, title);
+    virtual Histogram2D DeclareHistogram2D(int dammId, int xSize, int ySize, const char *title) {
+        return histo.DeclareHistogram2D(dammId, xSize, ySize, title);
     }
 
     /*! \brief Implementation of the plot command to interface with the DAMM
@@ -7,7 +7,6 @@
 
 #include "DammPlotIds.hpp"
 #include "Globals.hpp"
-#include "RandomInterface.hpp"
 #include "TraceFilter.hpp"
 #include "TraceFilterAnalyzer.hpp"
 
@@ -0,0 +1,140 @@
+/*! \file AddbackEngine.hpp
+ *  \brief Time clustering, addback and coincidence pairing of gamma-ray hits
+ *  \date October 19, 2026
+*/
+#ifndef __ADDBACKENGINE_HPP__
+#define __ADDBACKENGINE_HPP__
+
+#include <vector>
+
+//! Class that groups the hits of an event into sub events and adds back the
+//! energies of the detectors that are neighbours. A new sub event starts
+//! whenever the time to the previous hit is larger than the window. The
+//! neighbour map gives the addback group of every detector (e.g. the clover
+//! of a crystal), detectors that are not in the map are their own group.
+//! The hits, the clusters and the pairs live in flat arrays that keep their
+//! capacity, so an engine that is kept between events does not allocate.
+class AddbackEngine {
+public:
+    //! A hit given to the engine
+    struct Hit {
+        double energy; //!< The calibrated energy
+        double time; //!< The time, in the units of the window
+        unsigned int detector; //!< The detector that was hit
+        unsigned int group; //!< The addback group of the detector
+        unsigned int subEvent; //!< The sub event of the hit, set by Build
+        unsigned int index; //!< The index of the hit in the list of the caller
+    };
+
+    //! The sum of the hits of one group, or of the whole sub event
+    struct Cluster {
+        double energy; //!< The summed energy
+        double time; //!< The time of the latest hit
+        double firstTime; //!< The time of the first hit
+        unsigned int multiplicity; //!< The number of hits, 0 if empty
+    };
+
+    //! Two hits or two clusters in coincidence
+    struct Pair {
+        unsigned int first; //!< Index of the first one
+        unsigned int second; //!< Index of the second one
+        double dtime; //!< Time of the second minus the time of the first
+    };
+
+    /** Default constructor */
+    AddbackEngine() : numGroups_(0), window_(0), threshold_(0), numSubEvents_(0) {}
+
+    /** Constructor setting the number of groups and the thresholds
+     * \param [in] numGroups : the number of addback groups
+     * \param [in] window : the largest time between two hits of a sub event
+     * \param [in] threshold : hits with a lower energy are ignored */
+    AddbackEngine(const unsigned int &numGroups, const double &window, const double &threshold = 0) :
+            numGroups_(numGroups), window_(window), threshold_(threshold), numSubEvents_(0) {}
+
+    /** Default destructor */
+    ~AddbackEngine() {}
+
+    /** Sets the addback group of a detector. Detectors in the same group
+     * are neighbours and their energies are added back.
+     * \param [in] detector : the detector number
+     * \param [in] group : the group, it must be smaller than the number of
+     * groups */
+    void SetGroup(const unsigned int &detector, const unsigned int &group);
+
+    /** \param [in] a : the number of addback groups */
+    void SetNumberOfGroups(const unsigned int &a) { numGroups_ = a; }
+
+    /** \param [in] a : the largest time between two hits of a sub event */
+    void SetWindow(const double &a) { window_ = a; }
+
+    /** \param [in] a : hits with a lower energy are ignored */
+    void SetThreshold(const double &a) { threshold_ = a; }
+
+    /** \return The number of addback groups */
+    unsigned int GetNumberOfGroups() const { return numGroups_; }
+
+    /** Removes the hits of the previous event */
+    void Clear();
+
+    /** Adds a hit, hits below threshold are ignored. The hits may be added in
+     * any order.
+     * \param [in] energy : the calibrated energy
+     * \param [in] time : the time in the units of the window
+     * \param [in] detector : the detector number
+     * \param [in] index : the index of the hit in the list of the caller
+     * \throw out_of_range if the group of the detector is not smaller than
+     * the number of groups */
+    void AddHit(const double &energy, const double &time, const unsigned int &detector,
+                const unsigned int &index = 0);
+
+    /** Sorts the hits in time and builds the sub events and the clusters */
+    void Build();
+
+    /** \return The hits sorted in time, after Build */
+    const std::vector<Hit> &GetHits() const { return hits_; }
+
+    /** \return The number of sub events, after Build */
+    unsigned int GetNumSubEvents() const { return numSubEvents_; }
+
+    /** \return The clusters of every group, sub event after sub event. The
+     * cluster of group g in sub event s is at s * GetNumberOfGroups() + g. */
+    const std::vector<Cluster> &GetClusters() const { return clusters_; }
+
+    /** \return The cluster of a group in a sub event
+     * \param [in] subEvent : the sub event
+     * \param [in] group : the addback group */
+    const Cluster &GetCluster(const unsigned int &subEvent, const unsigned int &group) const {
+        return clusters_[subEvent * numGroups_ + group];
+    }
+
+    /** \return The sum of all the hits of a sub event
+     * \param [in] subEvent : the sub event */
+    const Cluster &GetSum(const unsigned int &subEvent) const { return sums_[subEvent]; }
+
+    /** Finds every pair of hits that are at most maxDt apart. Since the hits
+     * are sorted the search stops at the first hit that is too late.
+     * \param [in] maxDt : the largest time difference of a pair
+     * \param [out] pairs : receives the pairs of indices in GetHits(), the
+     * first hit is the earlier one */
+    void FindHitPairs(const double &maxDt, std::vector<Pair> &pairs) const;
+
+    /** Finds every pair of clusters of different groups in the same sub
+     * event that are at most maxDt apart.
+     * \param [in] maxDt : the largest time difference of a pair
+     * \param [out] pairs : receives the pairs of indices in GetClusters(),
+     * the first cluster has the lower group */
+    void FindClusterPairs(const double &maxDt, std::vector<Pair> &pairs) const;
+
+private:
+    unsigned int numGroups_; //!< The number of addback groups
+    double window_; //!< The sub event window
+    double threshold_; //!< The energy threshold of the hits
+    unsigned int numSubEvents_; //!< The number of sub events
+
+    std::vector<unsigned int> groups_; //!< The group of every detector
+    std::vector<Hit> hits_; //!< The hits of the event
+    std::vector<Cluster> clusters_; //!< The clusters of every sub event and group
+    std::vector<Cluster> sums_; //!< The sums of every sub event
+};
+
+#endif //__ADDBACKENGINE_HPP__
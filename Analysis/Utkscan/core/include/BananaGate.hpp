@@ -0,0 +1,133 @@
+/*! \file BananaGate.hpp
+ *  \brief Native banana (polygon) gates loaded from DAMM .ban files
+ *  \date October 19, 2026
+ *
+ * A BananaGate converts a polygon into an edge table once when it is loaded:
+ * for every x channel inside the bounding box it stores the y intervals that
+ * lie inside the polygon. Testing a point then only requires looking at the
+ * intervals of a single column, which is typically one or two, instead of
+ * walking all of the edges of the polygon. The gates are never modified after
+ * loading, so they may be tested from several threads at once.
+*/
+#ifndef __BANANAGATE_HPP__
+#define __BANANAGATE_HPP__
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+//! A single banana gate stored as an edge table
+class BananaGate {
+public:
+    /** Default constructor */
+    BananaGate() : xMin_(0), xMax_(-1), yMin_(0), yMax_(-1), hisId_(0) {};
+
+    /** Constructor taking the vertices of the polygon
+     * \param [in] vertices : the (x,y) channels of the vertices in order. The
+     * polygon is closed automatically. */
+    BananaGate(const std::vector<std::pair<int, int> > &vertices);
+
+    /** Default destructor */
+    ~BananaGate() {};
+
+    /** Test if a point is inside of the gate. A point is inside if a ray in
+     * the +y direction crosses the polygon an odd number of times, so points
+     * on the lower edge are inside and points on the upper edge are not.
+     * \param [in] x : the x channel
+     * \param [in] y : the y channel
+     * \return true if the point is inside of the gate */
+    bool Test(const int &x, const int &y) const {
+        if (x < xMin_ || x > xMax_ || y < yMin_ || y > yMax_)
+            return false;
+        for (unsigned int i = columns_[x - xMin_]; i < columns_[x - xMin_ + 1]; i++)
+            if (y >= intervals_[i].first && y <= intervals_[i].second)
+                return true;
+        return false;
+    }
+
+    /** Test a list of points against the gate
+     * \param [in] points : the (x,y) channels to test
+     * \param [out] result : filled with 1 for the points inside and 0 otherwise
+     * \return the number of points inside of the gate */
+    unsigned int Test(const std::vector<std::pair<int, int> > &points,
+                      std::vector<unsigned char> &result) const;
+
+    /** Compare the gate against a reference implementation for every point
+     * in the bounding box (with a margin of one channel).
+     * \param [in] id : the banana id to pass to the reference
+     * \param [in] reference : the function to compare with, e.g. bantesti_
+     * \param [in] step : only test every step'th channel in x and y
+     * \return the number of points where the two disagree */
+    unsigned long Validate(const int &id,
+                           bool (*reference)(const int &, const int &, const int &),
+                           const int &step = 1) const;
+
+    /** \return the vertices of the polygon */
+    const std::vector<std::pair<int, int> > &GetVertices(void) const {
+        return vertices_;
+    }
+
+    /** \return the histogram the gate was drawn on */
+    int GetHistogramId(void) const { return hisId_; }
+
+    /** Set the histogram the gate was drawn on
+     * \param [in] a : the histogram id */
+    void SetHistogramId(const int &a) { hisId_ = a; }
+
+private:
+    int xMin_; //!< Lowest x channel of the bounding box
+    int xMax_; //!< Highest x channel of the bounding box
+    int yMin_; //!< Lowest y channel of the bounding box
+    int yMax_; //!< Highest y channel of the bounding box
+    int hisId_; //!< Histogram the gate was drawn on
+    std::vector<std::pair<int, int> > vertices_; //!< The polygon
+    std::vector<unsigned int> columns_; //!< First interval of each column
+    std::vector<std::pair<int, int> > intervals_; //!< Inclusive y ranges inside the polygon
+};
+
+//! Singleton holding all of the banana gates loaded from .ban files
+class BananaLibrary {
+public:
+    /** \return Instance is created upon first call */
+    static BananaLibrary *get();
+
+    /** Load all of the bananas from a DAMM .ban file. Bananas with an id that
+     * was already loaded are replaced.
+     * \param [in] file : the name of the file
+     * \return the number of bananas that were loaded
+     * \throw GeneralException if the file cannot be read or is malformed */
+    unsigned int Load(const std::string &file);
+
+    /** Add a gate to the library
+     * \param [in] id : the banana id
+     * \param [in] gate : the gate */
+    void Add(const int &id, const BananaGate &gate);
+
+    /** \return the gate with the given id or NULL if it was not loaded
+     * \param [in] id : the banana id */
+    const BananaGate *Find(const int &id) const {
+        if (id < 0 || (unsigned int) id >= lookup_.size())
+            return NULL;
+        return lookup_[id];
+    }
+
+    /** \return the loaded bananas ordered by id */
+    const std::map<int, BananaGate> &GetGates(void) const { return gates_; }
+
+private:
+    /** Default constructor */
+    BananaLibrary() {};
+
+    BananaLibrary(const BananaLibrary &); //!< Copy constructor
+    BananaLibrary &operator=(BananaLibrary const &);//!< Equality constructor
+    static BananaLibrary *instance;//!< The only instance of BananaLibrary
+
+    std::map<int, BananaGate> gates_; //!< The gates keyed by id
+    std::vector<const BananaGate *> lookup_; //!< Gates indexed by id
+
+    /** Rebuild the id lookup table after the gates changed */
+    void BuildLookup(void);
+};
+
+#endif // __BANANAGATE_HPP__
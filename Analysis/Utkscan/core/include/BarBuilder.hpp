@@ -6,10 +6,17 @@
 #ifndef __BARBUILDER_HPP__
 #define __BARBUILDER_HPP__
 
+#include <map>
+#include <utility>
+#include <vector>
+
 #include "BarDetector.hpp"
 #include "HighResTimingData.hpp"
 
-//! Class that builds bars out of a list of ends
+//! Class that builds bars out of a list of ends. The side and the bar number
+//! of every channel are looked up in a table that is made once from the
+//! DetectorLibrary, and the ends are sorted into flat arrays indexed by the
+//! bar number. A BarBuilder that is kept between events reuses its arrays.
 class BarBuilder {
 public:
     /** Default constructor */
@@ -17,7 +24,7 @@ public:
 
     /** Constructor taking the map of channels to build bars with
      * \param [in] vec : Reference to the vector to build channels with */
-    BarBuilder(const std::vector<ChanEvent *> vec) { list_ = vec; };
+    BarBuilder(const std::vector<ChanEvent *> &vec) { list_ = vec; };
 
     /** Default destructor */
     virtual ~BarBuilder() {};
@@ -25,13 +32,13 @@ public:
     /** Gets the built bar map. If you have used the default constructor
      * you must call the BuildBars method <strong> first </strong>.
      * \return A BarMap of the bars having traces. */
-    BarMap GetBarMap(void) { return (hrtBars_); };
+    const BarMap &GetBarMap(void) const { return (hrtBars_); };
 
     /** Gets the built bar map. If you have used the default constructor
      * you must call the BuildBars method <strong> first </strong>.
      * \return A BarMap of the bars having no traces */
-    std::map<unsigned int, std::pair<double, double> >
-    GetLrtBarMap(void) { return (lrtBars_); };
+    const std::map<unsigned int, std::pair<double, double> > &
+    GetLrtBarMap(void) const { return (lrtBars_); };
 
     /** Builds BarDetectors from the individual channel maps. We make assumptions
 	that the bars are not going to be vastly out of order, such that the 
@@ -42,30 +49,46 @@ public:
     /** Sets the channel list to build bars out of. This list <strong>
      * must </strong> contain both ends of the detector.
      * \param [in] a : The channel list to build bars out of. */
-    void SetChannelList(const std::vector<ChanEvent *> a) { list_ = a; };
+    void SetChannelList(const std::vector<ChanEvent *> &a) { list_ = a; };
 private:
+    //! The sides that a channel can be on
+    enum Side {
+        NO_SIDE = 0, LEFT_SIDE = 1, RIGHT_SIDE = 2
+    };
+
+    //! What the builder needs to know about a channel
+    struct ChannelInfo {
+        unsigned int bar; //!< The bar number
+        unsigned char side; //!< Bitmask of the Sides of the channel
+    };
+
     /** The bar number calculated from the location. We assume here
      * that the bars are located in adjacent slots so that they are always
      * paired in a {0,1} {2,3} {4,5} ... {n,n+1} manner. This is especially
      * true if using a VANDLE firmware (As of 04/22/2016).
      * \param [in] loc : the location of the current event
      * \return The calculated bar number */
-    unsigned int CalcBarNumber(const unsigned int &loc);
+    static unsigned int CalcBarNumber(const unsigned int &loc);
+
+    /** \return The side and bar number of every channel in the
+     * DetectorLibrary indexed by the channel id. Things labeled {left, up,
+     * top} are on the left side and things labeled {right, down, bottom} on
+     * the right. Currently these are the only six recognized end types that
+     * one may have, this can be expanded later if others should arise. The
+     * table is made on the first call. */
+    static const std::vector<ChannelInfo> &GetChannelTable(void);
 
     /** Clears out the data maps from any previously built bars and ends */
     void ClearMaps(void);
 
-    /** Fills the ends of the detector into two separate maps. Things labeled
-     * {left, up,top} are filled into one map, and things labeled {right, down,bottom}
-     * are filled into another map. Currently these are the only six
-     * recognized end types that one may have, this can be expanded later if
-     * others should arise. */
+    /** Fills the ends of the detector into the lefts_ and rights_ arrays. */
     void FillMaps(void);
 
-    BarMap hrtBars_; //!< Map containing bars with high resolution timing..
+    BarMap hrtBars_; //!< Bars with high resolution timing ordered by bar number
     std::map<unsigned int, std::pair<double, double> > lrtBars_; //!<Map with low res bars
-    std::map<unsigned int, unsigned int> lefts_; //!< Map containing the left sides of bars
-    std::map<unsigned int, unsigned int> rights_; //!< Map containing the left sides of bars
+    std::vector<int> lefts_; //!< Index in list_ of the left side of each bar or -1
+    std::vector<int> rights_; //!< Index in list_ of the right side of each bar or -1
+    std::vector<unsigned int> barNumbers_; //!< The bars that have at least one side
     std::vector<ChanEvent *> list_; //!< Vector of events to build bars out of.
 };
 
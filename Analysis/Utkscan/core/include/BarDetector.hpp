@@ -6,14 +6,17 @@
 #ifndef __BARDETECTOR_HPP__
 #define __BARDETECTOR_HPP__
 
+#include <algorithm>
 #include <iostream>
 #include <limits>
-#include <map>
+#include <utility>
+#include <vector>
 
 #include "HighResTimingData.hpp"
 #include "TimingCalibrator.hpp"
 
-//! A class to handle detectors that have two readouts viewing the same volume
+//! A class to handle detectors that have two readouts viewing the same volume.
+//! The two sides are views of the ChanEvents of the current event.
 class BarDetector {
 public:
     /** Default constructor */
@@ -26,12 +29,9 @@ public:
     * \param [in] Right : The right side of the bar
     * \param [in] Left : The left side of the bar
     * \param [in] key : The TimingIdentifier for the bar */
-    BarDetector(HighResTimingData Left, HighResTimingData Right,
-                TimingDefs::TimingIdentifier &key) {
-        left_ = Left;
-        right_ = Right;
-        key_ = key;
-    }
+    BarDetector(const HighResTimingData &Left, const HighResTimingData &Right,
+                const TimingDefs::TimingIdentifier &key) :
+            right_(Right), left_(Left), key_(key) {}
 
     /** \return the true if there was an event in the bar */
     bool GetHasEvent(void) const {
@@ -133,6 +133,29 @@ private:
     TimingDefs::TimingIdentifier key_; //!< The key for the detector 
 };
 
-/** Defines a map to hold Bar Detectors */
-typedef std::map<TimingDefs::TimingIdentifier, BarDetector> BarMap;
+/** Holds Bar Detectors ordered by their TimingIdentifier. The bars are stored
+ * in a flat vector, which is filled in order by the BarBuilder, and the class
+ * keeps the parts of the std::map interface that the processors use. */
+class BarMap : public std::vector<std::pair<TimingDefs::TimingIdentifier, BarDetector> > {
+public:
+    /** \return an iterator to the bar with the given key or end()
+     * \param [in] key : the key to look for */
+    iterator find(const TimingDefs::TimingIdentifier &key) {
+        iterator it = std::lower_bound(begin(), end(), key, KeyLess);
+        return it != end() && it->first == key ? it : end();
+    }
+
+    /** \return an iterator to the bar with the given key or end()
+     * \param [in] key : the key to look for */
+    const_iterator find(const TimingDefs::TimingIdentifier &key) const {
+        const_iterator it = std::lower_bound(begin(), end(), key, KeyLess);
+        return it != end() && it->first == key ? it : end();
+    }
+
+private:
+    /** \return true if the key of the bar is less than key */
+    static bool KeyLess(const value_type &bar, const TimingDefs::TimingIdentifier &key) {
+        return bar.first < key;
+    }
+};
 #endif // __BARDETECTOR_HPP__
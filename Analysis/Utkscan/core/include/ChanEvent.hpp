@@ -36,20 +36,17 @@ public:
     ~ChanEvent() {}
 
     //! \return The channelConfiguration in the map for the channel event
-    const ChannelConfiguration &GetChanID() const {
-        return DetectorLibrary::get()->at(GetModuleNumber(), GetChannelNumber());
-    }
+    const ChannelConfiguration &GetChanID() const { return DetectorLibrary::get()->at(GetId()); }
 
-    /** \return the channel id defined as pixie module # * 16 + channel number */
-    unsigned int GetID() const { return DetectorLibrary::get()->GetIndex(GetModuleNumber(), GetChannelNumber()); }
+    /** \return the channel id defined as (crate # * 13 + pixie module #) * 16 + channel number, the modules of
+     * crate c are numbered from c * 13 in the map */
+    unsigned int GetID() const { return GetId(); }
 
-    ///Equality operator, we only check to see if the module number, channel number, and times are equal.
+    ///Equality operator, we only check to see if the crate number, module number, channel number, and times are
+    /// equal.
     ///@param [in] rhs : the configuration to compare to
-    ///@return true if the module number, channel number, and time are identical
-    bool operator==(const ChanEvent &rhs) const {
-        return GetModuleNumber() == rhs.GetModuleNumber() && GetChannelNumber() == rhs.GetChannelNumber() &&
-                GetTime() == rhs.GetTime();
-    }
+    ///@return true if the crate number, module number, channel number, and time are identical
+    bool operator==(const ChanEvent &rhs) const { return GetId() == rhs.GetId() && GetTime() == rhs.GetTime(); }
 
     ///Not - Equality operator for ChanEvent
     ///@param [in] x : the ChanEvent to compare to
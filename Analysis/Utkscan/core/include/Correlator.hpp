@@ -15,6 +15,7 @@
 #include "DammPlotIds.hpp"
 #include "Globals.hpp"
 #include "LogicProcessor.hpp"
+#include "PixelCorrelator.hpp"
 #include "Plots.hpp"
 #include "RawEvent.hpp"
 
@@ -90,10 +91,13 @@ public:
 /*!
   \brief correlate decays with previous implants
 
-  The class controls the correlations of decays with previous implants.  There
-  are arrays of size MAX_STRIP %x MAX_STRIP that store implants and decays.
+  The class controls the correlations of decays with previous implants.  The
+  last implant and the decays following it are stored for every pixel in
+  PixelCorrelators of size arraySize %x arraySize. Each pixel holds at most
+  decayCapacity decays, and decays older than the correlation time are
+  expired, so the memory used does not grow over the run.
   When an event has been identified as either an implant or decay, its
-  information is placed in the appropriate array based on its pixel location.
+  information is placed in the appropriate buffer based on its pixel location.
   If a decay was identified, it is correlated with a previous implant.  The
   correlator checks to make sure that the time between implants is
   sufficiently long and that the correlation time has not been exceeded
@@ -181,6 +185,25 @@ public:
      * \return true if it is flagged */
     bool IsFlagged(int fch, int bch);
 
+    /** Set the number of neighbouring pixels that are searched for an
+     * implant when a decay occurs in a pixel without one. The default of 0
+     * only correlates decays with implants in the same pixel.
+     * \param [in] a : the search radius in pixels */
+    void SetNeighbourRadius(const unsigned int &a) { neighbourRadius_ = a; }
+
+    /** Print the memory usage and the query statistics of the correlator
+     * \param [in] out : the stream to print to */
+    void PrintStatistics(std::ostream &out) const;
+
+    /** Writes the implants and the decays of every pixel, the flags and the
+     * last events, for the checkpoints of the scan
+     * \param [in] writer : the archive of the state */
+    void SaveState(StateWriter &writer) const;
+
+    /** Reads the state written by SaveState
+     * \param [in] reader : the archive of the state */
+    void LoadState(StateReader &reader);
+
     /** \return The conditions for correlation */
     EConditions GetCondition(void) const {
         return condition;
@@ -203,22 +226,26 @@ private:
     /*! \brief Declares a 1D histogram calls the C++ wrapper for DAMM
     * \param [in] dammId : The histogram number to define
     * \param [in] xSize : The range of the x-axis
-    * \param [in] title : The title for the histogram */
-    virtual void DeclareHistogram1D(int dammId, int xSize, const char *title) {
-        histo.DeclareHistogram1D(dammId, xSize, title);
+    * \param [in] title : The title for the histogram
+    * \return a handle to the histogram */
+    virtual Histogram1D DeclareHistogram1D(int dammId, int xSize, const char *title) {
+        return histo.DeclareHistogram1D(dammId, xSize, title);
     }
 
     /*! \brief Declares a 2D histogram calls the C++ wrapper for DAMM
     * \param [in] dammId : The histogram number to define
     * \param [in] xSize : The range of the x-axis
     * \param [in] ySize : The range of the y-axis
-    * \param [in] title : The title of the histogram */
-    virtual void DeclareHistogram2D(int dammId, int xSize, int ySize,
-                                    const char *title) {
-        histo.DeclareHistogram2D(dammId, xSize, ySize, title);
+    * \param [in] title : The title of the histogram
+    * \return a handle to the histogram */
+    virtual Histogram2D DeclareHistogram2D(int dammId, int xSize, int ySize,
+                                           const char *title) {
+        return histo.DeclareHistogram2D(dammId, xSize, ySize, title);
     }
 
-    static const size_t arraySize = 40; /**< Size of the 2D array to hold the decay lists */
+    static const size_t arraySize = 40; /**< Number of pixels in x and y */
+    static const unsigned int decayCapacity = 32; /**< Maximum number of decays
+                                                     stored after an implant */
 
     static const double minImpTime; /**< The minimum amount of time that must
 				       pass before an implant will be considered
@@ -229,11 +256,24 @@ private:
     static const double fastTime;   /**< Times shorter than this are output as
                                          a fast decay */
 
-    EventInfo *lastImplant;  ///< last implant processed by correlator
-    EventInfo *lastDecay;    ///< last decay procssed by correlator
+    EventInfo lastImplant;  ///< last implant processed by correlator
+    EventInfo lastDecay;    ///< last decay procssed by correlator
 
     EConditions condition;     ///< condition for last processed event
-    CorrelationList decaylist[arraySize][arraySize]; ///< list of event data for a particular pixel since implant
+    unsigned int neighbourRadius_; ///< pixels searched for an implant around a decay
+    PixelCorrelator<EventInfo> implants_; ///< the last implant of every pixel
+    PixelCorrelator<EventInfo> decays_; ///< the decays of every pixel since its implant
+    bool flagged_[arraySize][arraySize]; ///< true if the decay list of a pixel is flagged
+
+    /** \return the decay list of a pixel, starting with its implant
+     * \param [in] fch : the first channel
+     * \param [in] bch : the second channel */
+    CorrelationList GetDecayList(unsigned int fch, unsigned int bch) const;
+
+    /** Clears the implant and the decays of a pixel
+     * \param [in] fch : the first channel
+     * \param [in] bch : the second channel */
+    void ClearPixel(unsigned int fch, unsigned int bch);
 };
 
 #endif // __CORRELATOR_PROCESSOR_HPP_
@@ -50,6 +50,8 @@ namespace dammIds {
         const int D_HAS_TRACE_2 = 1815;//!< Plot for Channels w/ valid waveform analysis 
         const int D_HAS_TRACE_3 = 1816;//!< Plot for Channels w/ valid fit analysis 
         //const int DD_TRACE_MAX_PINGATE = 1817;//!< Plot for Max Value in Trace gated by PIN0 energy
+        const int D_LOAD_LEVEL = 1818;//!< Events per load shedding level of an online scan
+        const int D_DEGRADED_EVENTS = 1819;//!< Degraded events vs scan time in s
     }
 
     /// in PspmtProcessor.cpp
@@ -37,6 +37,8 @@
 #ifndef __DETECTORDRIVER_HPP_
 #define __DETECTORDRIVER_HPP_
 
+#include <algorithm>
+#include <chrono>
 #include <set>
 #include <string>
 #include <utility>
@@ -44,9 +46,13 @@
 
 #include "Calibrator.hpp"
 #include "ChanEvent.hpp"
+#include "CounterRandom.hpp"
+#include "EventSkimmer.hpp"
 #include "Globals.hpp"
 #include "Messenger.hpp"
 #include "Plots.hpp"
+#include "ProcessorScheduler.hpp"
+#include "TraceResultStore.hpp"
 #include "WalkCorrector.hpp"
 
 #ifdef useroot
@@ -72,6 +78,10 @@ class RawEvent;
 
 class EventProcessor;
 
+class StateReader;
+
+class StateWriter;
+
 class TraceAnalyzer;
 
 /*! \brief DetectorDriver controls event processing
@@ -122,8 +132,10 @@ public:
      * calibrations contained in the calibration vector filled during ReadCal()
      * \param [in] chan : the channel to do the calibration on
      * \param [in] rawev : the raw event to write the information into
+     * \param [in] dither : the number in [0, 1) added to the integer energy
+     * of the Pixie, see FillDithers
      * \return an unused integer (maybe change to void) */
-    int ThreshAndCal(ChanEvent *chan, RawEvent &rawev);
+    int ThreshAndCal(ChanEvent *chan, RawEvent &rawev, const double &dither);
 
     /*! Called from PixieStd.cpp during initialization.
      * The calibration file Config.xml is read using the function ReadCal() and
@@ -131,6 +143,30 @@ public:
      * \param [in] rawev : the raw event to initialize with */
     void Init(RawEvent &rawev);
 
+    /** Writes the event counters and the state of every processor for the
+     * checkpoints of the scan, see EventProcessor::SaveState
+     * \param [in] writer : the archive of the state */
+    void SaveState(StateWriter &writer) const;
+
+    /** Reads the state written by SaveState, after Init
+     * \param [in] reader : the archive of the state
+     * \throw GeneralException if the processors are not the ones that were
+     * saved */
+    void LoadState(StateReader &reader);
+
+    /** \return true if a trace analyzer looks at the channel, so that its
+     * trace needs to be decoded. Channels that are unknown, or everything
+     * before Init was called, are assumed to need their trace.
+     * \param [in] id : the channel id as given by ChanEvent::GetID */
+    bool NeedsTrace(const int &id) const {
+        return id < 0 || (size_t) id >= traceMask_.size() || traceMask_[id];
+    }
+
+    /** \return the number of channels whose traces are decoded */
+    size_t GetNumTracesNeeded(void) const {
+        return std::count(traceMask_.begin(), traceMask_.end(), true);
+    }
+
     /*! Plot the raw energies of each channel into the damm spectrum number
      * assigned to it in the map file with an offset as defined in
      * DammPlotIds.hpp
@@ -167,6 +203,32 @@ public:
                          pixieToWallClock.second);
     }
 
+    /** \return the skim of the events, NULL if there is no Skim node in the
+     * configuration */
+    EventSkimmer *GetSkimmer(void) { return skimmer_; }
+
+    /** Sets if the events are replayed from an event cache, their channels
+     * are already calibrated and their traces analyzed then
+     * \param [in] a : true if the events are replayed */
+    void SetIsReplay(const bool &a) { isReplay_ = a; }
+
+    /** \return the store of the trace results, NULL if there is no
+     * TraceResultStore node in the configuration */
+    TraceResultStore *GetTraceResultStore(void) { return traceResults_; }
+
+    /** \return the time in seconds that the processing of a spill of an
+     * online scan may take before the load is shed, 0 if there is no
+     * LoadShedding node in the configuration */
+    double GetLoadBudget(void) const { return loadBudget_; }
+
+    /** \return the number of degradation levels of the LoadShedding node */
+    unsigned int GetNumLoadLevels(void) const { return loadLevels_.size(); }
+
+    /** Switches off the stages of the degradation levels up to and including
+     * a level, and switches the stages of the levels above it on again
+     * \param [in] level : the degradation level, 0 for the full analysis */
+    void SetLoadLevel(const unsigned int &level);
+
     /** \return the list of the Event Processors in the analysis */
     const std::vector<EventProcessor *> &GetProcessors(void) const {
         return vecProcess;
@@ -224,8 +286,29 @@ private:
 
     std::vector<EventProcessor *> vecProcess; /**< vector of processors to handle each event */
 
+    ProcessorScheduler scheduler_; //!< Runs the processors in order of their dependencies
+    unsigned int numThreads_; //!< Number of threads used to run the processors
+
     std::vector<TraceAnalyzer *> vecAnalyzer; /**< object which analyzes traces of channels to extract
                    energy and time information */
+    std::vector<bool> traceMask_; //!< True for the channels which a trace analyzer looks at
+    EventSkimmer *skimmer_; //!< Writes the events passing the skim gates to a new file
+    bool isReplay_; //!< True if the events are replayed from an event cache
+    TraceResultStore *traceResults_; //!< Keeps the trace analysis of the hits of the input file
+
+    //! The stages that a degradation level of the load shedding switches off
+    struct LoadLevel {
+        std::vector<bool> analyzers; //!< True for the analyzers that are skipped
+        std::set<std::string> processors; //!< The names of the processors that are skipped
+        bool plots2D; //!< True if the 2D histograms are not filled
+    };
+
+    std::vector<LoadLevel> loadLevels_; //!< The degradation levels, the first one is level 1
+    double loadBudget_; //!< The processing time in seconds a spill may take
+    unsigned int loadLevel_; //!< The current degradation level
+    std::vector<bool> analyzerSkipped_; //!< True for the analyzers switched off by the current level
+    bool skipsAnalyzers_; //!< True if the current level switches off an analyzer
+    std::chrono::steady_clock::time_point loadStart_; //!< The start of the scan for the degraded events plot
     std::set<std::string> knownDetectors; /**< list of valid detectors that can
                    be used as detector types */
     std::string cfg_; //!< The configuration file to read
@@ -234,31 +317,68 @@ private:
     double firstEventTime_; //!< The time of the first event that passes through the DetectorDriver
     double firstEventTimeinNs_; //!< The time of the first event that passes through the DetectorDriver in ns
     double eventFirstTime_; //!<The Time of the first detector event in the current pixie event
+    std::vector<Histogram1D> rawEnergy_; //!< Raw energy histograms indexed by channel
+    std::vector<Histogram1D> filterEnergy_; //!< Trace filter energy histograms indexed by channel
+    std::vector<Histogram1D> calEnergy_; //!< Calibrated energy histograms indexed by channel
+
+    CounterRandom dither_; //!< Generates the dithers of the energies
+    std::vector<uint64_t> ditherTimes_; //!< The time stamps of the channels of the event
+    std::vector<uint64_t> ditherIds_; //!< The ids of the channels of the event
+    std::vector<double> dithers_; //!< The dithers of the channels of the event
+
+    /** Computes the dither of every channel of the event in one batch. The
+     * dither only depends on the time stamp and the id of the channel, so a
+     * hit gets the same dither whatever the order, the thread or the part of
+     * the file in which it is scanned.
+     * \param [in] rawev : the event */
+    void FillDithers(const RawEvent &rawev);
+
+    /** Reads the degradation levels of an online scan, e.g.
+     * \code
+     * <LoadShedding budget="250">
+     *     <Level analyzers="FittingAnalyzer"/>
+     *     <Level processors="VandleProcessor,DoubleBetaProcessor" plots2d="true"/>
+     * </LoadShedding>
+     * \endcode
+     * The budget is in ms per spill. The analyzers are the names of the
+     * Analyzer nodes, the processors those of the Processor nodes.
+     * \param [in] node : the LoadShedding node
+     * \throw invalid_argument if the budget is not positive or a name is
+     *  not one of an analyzer or a processor */
+    void ParseLoadShedding(const pugi::xml_node &node);
     /*! Declares a 1D histogram calls the C++ wrapper for DAMM
     * \param [in] dammId : The histogram number to define
     * \param [in] xSize : The range of the x-axis
-    * \param [in] title : The title for the histogram */
-    virtual void DeclareHistogram1D(int dammId, int xSize, const char *title) {
+    * \param [in] title : The title for the histogram
+    * \return a handle to the histogram */
+    virtual Histogram1D DeclareHistogram1D(int dammId, int xSize, const char *title) {
         if(Globals::get()->GetDammPlots()){
-            histo.DeclareHistogram1D(dammId, xSize, title);
+            return histo.DeclareHistogram1D(dammId, xSize, title);
         }
+        return Histogram1D();
     }
     /*! \brief Declares a 2D histogram calls the C++ wrapper for DAMM
     * \param [in] dammId : The histogram number to define
     * \param [in] xSize : The range of the x-axis
     * \param [in] ySize : The range of the y-axis
-    * \param [in] title : The title of the histogram */
-    virtual void DeclareHistogram2D(int dammId, int xSize, int ySize,
-                                    const char *title) {
+    * \param [in] title : The title of the histogram
+    * \return a handle to the histogram */
+    virtual Histogram2D DeclareHistogram2D(int dammId, int xSize, int ySize,
+                                           const char *title) {
         if(Globals::get()->GetDammPlots()){
-            histo.DeclareHistogram2D(dammId, xSize, ySize, title);
+            return histo.DeclareHistogram2D(dammId, xSize, ySize, title);
         }
+        return Histogram2D();
     }
     /*! \brief Fills the Logic structure for ROOT output.
      * Because the logic spans pixie events if we fill in the processor it does not get filled into each ROOT entry.
      * So we will fill here in the DetectorDriver utilizing the work that was put into the TreeCorrelator  */
     void FillLogicStruc();
 
+    /*! \brief Loads the banana gates from the .ban file named in the Global
+     * node so that Plots::BananaTest can test them without bantesti_. */
+    void LoadBananas();
+
     std::set<std::string> setProcess; /**< list of processors used in the analysis.
     * This should be identical to vecProcess, but in string form */
 
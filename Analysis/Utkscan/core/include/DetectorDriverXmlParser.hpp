@@ -35,6 +35,9 @@ public:
     ///Returns the Max Root Tree File size (In GB)
     double GetRFileSize(){return rFileSize; }
 
+    ///Returns the number of threads used to run the processors
+    unsigned int GetNumThreads(){return numThreads; }
+
 private:
     ///An instance of the messenger class so that we can output pretty info
     Messenger messenger_;
@@ -60,6 +63,8 @@ private:
     std::pair<bool,std::string> SysRootOut;
 
     double rFileSize;//!<Root File's roll over size.
+
+    unsigned int numThreads;//!<Number of threads used to run the processors.
 };
 
 #endif //PAASS_DETECTORDRIVERXMLPARSER_HPP
@@ -130,6 +130,34 @@ public:
     /** \return the used detectors */
     const std::set<std::string> &GetUsedDetectors(void) const;
 
+    /** Registers a detector summary and adds its id to every channel that
+     * belongs to it. A summary that was already registered keeps its id. The
+     * summaries of the type and of the type and subtype of every channel are
+     * registered when the map is read. This is not thread safe, RawEvent
+     * registers the summaries that processors ask for under its lock.
+     * \param [in] name : the summary, as type, type:subtype or type:subtype:tag
+     * \return the id of the summary */
+    unsigned int RegisterSummary(const std::string &name);
+
+    /** \return the id of a summary, NO_SUMMARY if it was never registered
+     * \param [in] name : the name of the summary */
+    unsigned int GetSummaryId(const std::string &name) const;
+
+    /** \return the number of registered summaries, the ids go from 0 to this */
+    unsigned int GetNumSummaries(void) const { return (unsigned int) summaryNames_.size(); }
+
+    /** \return the name of a summary
+     * \param [in] id : the id of the summary */
+    const std::string &GetSummaryName(const unsigned int &id) const { return summaryNames_.at(id); }
+
+    /** \return the ids of the summaries that a channel belongs to
+     * \param [in] idx : the index of the channel, see ChanEvent::GetID */
+    const std::vector<unsigned int> &GetSummaryIds(const size_type &idx) const {
+        return idx < channelSummaries_.size() ? channelSummaries_[idx] : noSummaries;
+    }
+
+    static const unsigned int NO_SUMMARY = 0xFFFFFFFF; //!< Id returned for summaries that are not registered
+
     typedef std::string mapkey_t; //!< typedef for a mapkey
 
     ///@return A pointer to the Calibrator object containing all of the
@@ -160,9 +188,18 @@ private:
      * \return the constructed map key */
     mapkey_t MakeKey(const std::string &type, const std::string &subtype) const;
 
+    /** Finds the registered summaries that a channel belongs to
+     * \param [in] idx : the index of the channel */
+    void FindSummaries(const size_type &idx);
+
     std::map<mapkey_t, std::set<int>> locations; ///< collection of all used locations for a given type and subtype
     static std::set<int> emptyLocations; ///< dummy locations to return when map key does not exist
 
+    std::map<std::string, unsigned int> summaryIds_; //!< The id of every registered summary
+    std::vector<std::string> summaryNames_; //!< The name of every summary indexed by its id
+    std::vector<std::vector<unsigned int> > channelSummaries_; //!< The summaries of every channel indexed by channel
+    static std::vector<unsigned int> noSummaries; ///< returned for the channels that are not in the library
+
     unsigned int numModules;//!< number of modules
     unsigned int numPhysicalModules; //!< number of physical modules
 
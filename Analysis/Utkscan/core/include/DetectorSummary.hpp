@@ -22,9 +22,13 @@ public:
     DetectorSummary();
 
     ///Constructor taking a string and the full channel list
-    ///@param [in] str : the type to make the summary for
-    ///@param [in] fullList : the full list of channels in the event 
-    DetectorSummary(const std::string &str, const std::vector<ChanEvent *> &fullList);
+    ///@param [in] str : the type to make the summary for, as type, type:subtype or type:subtype:tag
+    ///@param [in] fullList : the full list of channels in the event, the channels that match are added
+    DetectorSummary(const std::string &str, const std::vector<ChanEvent *> &fullList = std::vector<ChanEvent *>());
+
+    ///@return true if a channel belongs to the summary
+    ///@param [in] id : the configuration of the channel
+    bool Matches(const ChannelConfiguration &id) const;
 
     /// Zero the summary 
     void Zero();
@@ -0,0 +1,159 @@
+/*! \file EventCache.hpp
+ *  \brief Writes the built and calibrated events of a scan into a cache file
+ *  that is replayed by later scans instead of the raw data
+ *  \date October 19, 2026
+ *
+ * The cache is configured with an EventCache node in the configuration file,
+ * e.g.
+ * \code
+ * <EventCache output="run_012" path="./" traces="true"/>
+ * \endcode
+ * The file, run_012.evcache, holds every event after the DetectorDriver
+ * calibrated its channels and ran the trace analyzers : the raw values of the
+ * hits, the calibrated energies, the walk corrected and high resolution
+ * times, and the results of the trace analysis. The samples of the traces are
+ * kept unless traces="false", which makes the cache much smaller but leaves
+ * the processors without traces. The output and the path default to those of
+ * the scan.
+ *
+ * Scanning the .evcache file with a configuration that differs in the Map,
+ * the Global node, the Crates or the Analyzers of the DetectorDriver is
+ * refused, since the cached events would not be those of a scan of the raw
+ * data. The Processors, the TreeCorrelator and the gates may change freely.
+ *
+ * The file is "PAASSEVC" followed by blocks, each a 32 bit length and the
+ * bytes of the block. The first block is the header, every other one holds
+ * the events of a spill.
+*/
+#ifndef __EVENTCACHE_HPP__
+#define __EVENTCACHE_HPP__
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+#include "pugixml.hpp"
+
+class ChanEvent;
+class RawEvent;
+class StateReader;
+class StateWriter;
+class Trace;
+
+//! Writes built events into a cache file and reads them back
+class EventCache {
+public:
+    //! The times of an event that the unpacker keeps, see Unpacker
+    struct EventTimes {
+        double eventStart; //!< The start time of the event window
+        double realStart; //!< The time of the first hit of the event
+        double realStop; //!< The time of the last hit of the event
+    };
+
+    /** Constructor that opens the cache file and writes its header
+     * \param [in] node : the EventCache node of the configuration file
+     * \param [in] configuration : the Configuration node, see Hash
+     * \throw IOException if the file could not be opened */
+    EventCache(const pugi::xml_node &node, const pugi::xml_node &configuration);
+
+    /** Destructor, writes the last block and closes the file */
+    ~EventCache();
+
+    /** Sets the first time of the scan, written with every spill
+     * \param [in] a : the first time, see Unpacker::GetFirstTime */
+    void SetFirstTime(const double &a) { firstTime_ = a; }
+
+    /** Adds an event, called after the DetectorDriver processed it
+     * \param [in] rawev : the event
+     * \param [in] times : the times of the event */
+    void Add(const RawEvent &rawev, const EventTimes &times);
+
+    /** Writes the events of the spill that was just processed */
+    void EndSpill(void);
+
+    /** \return the name of the cache file */
+    std::string GetFileName(void) const { return fileName_; }
+
+    /** \return the number of events written */
+    unsigned long GetNumEvents(void) const { return numEvents_; }
+
+    /** \return the number of bytes written */
+    uint64_t GetNumBytes(void) const { return numBytes_; }
+
+    /** Hashes the parts of the configuration that change the cached events
+     * \param [in] configuration : the Configuration node
+     * \return the 64 bit FNV-1a hash of the Map, Global and Crates nodes and
+     *  of the Analyzer nodes of the DetectorDriver */
+    static uint64_t Hash(const pugi::xml_node &configuration);
+
+    /** \return the 64 bit FNV-1a hash of some bytes, shared by the hashes of
+     * the configuration
+     * \param [in] bytes : the bytes to hash */
+    static uint64_t Fnv1a(const std::string &bytes);
+
+    /** Checks that a cache may be replayed with a configuration
+     * \param [in] header : the header block of the cache
+     * \param [in] configuration : the Configuration node
+     * \throw invalid_argument if the cache was written by another version
+     *  or with another configuration */
+    static void CheckHeader(const std::string &header, const pugi::xml_node &configuration);
+
+    /** Reads the first time of the scan at the start of a spill block
+     * \param [in] reader : the archive of the block
+     * \return the first time */
+    static double ReadFirstTime(StateReader &reader);
+
+    /** Reads the next event of a spill block
+     * \param [in] reader : the archive of the block
+     * \param [out] events : receives the channels of the event, the caller
+     *  owns them
+     * \param [out] times : receives the times of the event */
+    static void ReadEvent(StateReader &reader, std::vector<ChanEvent *> &events, EventTimes &times);
+
+    /** Writes a calibrated channel
+     * \param [in] writer : the archive
+     * \param [in] event : the channel
+     * \param [in] traces : true to write the samples of the trace */
+    static void WriteChannel(StateWriter &writer, const ChanEvent &event, const bool &traces);
+
+    /** Reads a channel written by WriteChannel
+     * \param [in] reader : the archive
+     * \return the channel, owned by the caller */
+    static ChanEvent *ReadChannel(StateReader &reader);
+
+    /** Writes the results of the trace analysis, without the samples and
+     * the validity flags, also used by the TraceResultStore
+     * \param [in] writer : the archive
+     * \param [in] trace : the analyzed trace */
+    static void WriteTraceResults(StateWriter &writer, const Trace &trace);
+
+    /** Reads the results written by WriteTraceResults
+     * \param [in] reader : the archive
+     * \param [out] trace : receives the results */
+    static void ReadTraceResults(StateReader &reader, Trace &trace);
+
+    /** Rebuilds the baseline subtracted trace from the samples and the
+     * baseline, as the WaveformAnalyzer computed it
+     * \param [in,out] trace : the trace holding its samples */
+    static void RestoreTraceSansBaseline(Trace &trace);
+
+    static const char MAGIC[8]; //!< The first bytes of a cache file
+    static const uint32_t VERSION = 1; //!< Increased when the format changes
+
+private:
+    std::ofstream file_; //!< The cache file
+    std::string fileName_; //!< The name of the cache file
+    std::string block_; //!< The events of the spill that are not written yet
+    bool traces_; //!< True if the samples of the traces are written
+    double firstTime_; //!< The first time of the scan
+    unsigned long numEvents_; //!< Number of events written
+    uint64_t numBytes_; //!< Number of bytes written
+
+    /** Writes a block with its length
+     * \param [in] block : the bytes of the block */
+    void WriteBlock(const std::string &block);
+};
+
+#endif // __EVENTCACHE_HPP__
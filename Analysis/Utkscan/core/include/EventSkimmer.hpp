@@ -0,0 +1,128 @@
+/*! \file EventSkimmer.hpp
+ *  \brief Writes the raw hits of the events that pass a set of gates into a
+ *  new .pld file
+ *  \date October 19, 2026
+ *
+ * The skim is configured with a Skim node in the configuration file, e.g.
+ * \code
+ * <Skim output="rare" path="./" require="all">
+ *     <Gate detector="pspmt:dynode_high" min="1"/>
+ *     <Gate detector="vandle:small" min="1" emin="10" emax="5000"/>
+ *     <Place name="Beta0" status="true"/>
+ * </Skim>
+ * \endcode
+ * A Gate counts the channels of the event matching "type[:subtype[:tag]]"
+ * whose calibrated energy lies within [emin, emax] and passes if the count is
+ * within [min, max]. A Place passes if the place of the TreeCorrelator has
+ * the requested status after the processors ran. The event is kept if all
+ * (require="all") or any (require="any") of them pass.
+ *
+ * Every hit of a kept event is encoded again with the XiaListModeDataEncoder
+ * into the buffer of the module it was read from. The buffers of a spill are
+ * written out as one spill with a buffer for every module, so the skim can be
+ * scanned with the same configuration file. Spills without any kept event are
+ * not written.
+*/
+#ifndef __EVENTSKIMMER_HPP__
+#define __EVENTSKIMMER_HPP__
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "pugixml.hpp"
+
+#include "hribf_buffers.h"
+#include "XiaListModeDataEncoder.hpp"
+#include "XiaListModeDataMask.hpp"
+
+class Place;
+class RawEvent;
+class XiaData;
+
+//! Selects events with a set of gates and writes their raw hits to a .pld file
+class EventSkimmer {
+public:
+    /** Constructor that reads the gates and opens the output file
+     * \param [in] node : the Skim node of the configuration file
+     * \throw invalid_argument if a gate is malformed or the file could not be
+     *  opened */
+    EventSkimmer(const pugi::xml_node &node);
+
+    /** Destructor, writes the last spill and closes the file */
+    ~EventSkimmer();
+
+    /** Set the mask used to encode the hits of a module
+     * \param [in] vsn : the module number
+     * \param [in] mask : the mask used to decode the buffers of the module */
+    void SetDataMask(const unsigned int &vsn, const XiaListModeDataMask &mask);
+
+    /** Set the number of module buffers written into every spill
+     * \param [in] a : the number of modules in the configuration */
+    void SetNumModules(const unsigned int &a) { numModules_ = a; }
+
+    /** Apply the gates to an event, called after the processors ran and
+     * before the places of the TreeCorrelator are reset.
+     * \param [in] rawev : the processed event
+     * \return true if the event is kept */
+    bool Select(const RawEvent &rawev);
+
+    /** Encode the hits of the event if the last call to Select kept it
+     * \param [in] hits : the raw hits the event was built from */
+    void Add(const std::deque<XiaData *> &hits);
+
+    /** Write the kept hits of the spill that was just processed */
+    void EndSpill(void);
+
+    /** \return the name of the output file */
+    std::string GetFileName(void) { return output_.GetCurrentFilename(); }
+
+    /** \return the number of events that were looked at */
+    unsigned long GetNumEvents(void) const { return numEvents_; }
+
+    /** \return the number of events that were kept */
+    unsigned long GetNumKept(void) const { return numKept_; }
+
+private:
+    ///A gate on the number of channels of a detector in the event
+    struct Gate {
+        std::string type; ///< The detector type
+        std::string subtype; ///< The subtype, empty for any
+        std::string tag; ///< A tag the channels must have, empty for any
+        double emin; ///< Lowest calibrated energy that is counted
+        double emax; ///< Highest calibrated energy that is counted
+        unsigned int min; ///< Lowest number of channels that passes
+        unsigned int max; ///< Highest number of channels that passes
+    };
+
+    ///A gate on the status of a place of the TreeCorrelator
+    struct PlaceGate {
+        std::string name; ///< The name of the place
+        bool status; ///< The status that passes
+        Place *place; ///< The place, looked up with the first event
+    };
+
+    std::vector<Gate> gates_; //!< Gates on the detectors
+    std::vector<PlaceGate> places_; //!< Gates on the places
+    std::vector<unsigned int> counts_; //!< Channels counted for each gate
+    bool requireAll_; //!< True if all gates have to pass, false for any
+
+    std::vector<XiaListModeDataMask> masks_; //!< Masks to encode the hits indexed by module
+    std::vector<std::vector<unsigned int> > modules_; //!< The kept hits of the spill indexed by module
+    std::vector<unsigned int> spill_; //!< The spill that is written to the file
+    unsigned int numModules_; //!< Number of modules in every spill
+    XiaListModeDataEncoder encoder_; //!< Encodes the hits
+    PollOutputFile output_; //!< The .pld file
+
+    bool selected_; //!< True if the last event passed the gates
+    bool hasData_; //!< True if the spill holds any kept hits
+    unsigned long numEvents_; //!< Number of events that were looked at
+    unsigned long numKept_; //!< Number of events that were kept
+    unsigned long numHits_; //!< Number of hits that were written
+
+    /** \return the mask used to encode the hits of a module
+     * \param [in] vsn : the module number */
+    const XiaListModeDataMask &GetDataMask(const unsigned int &vsn);
+};
+
+#endif // __EVENTSKIMMER_HPP__
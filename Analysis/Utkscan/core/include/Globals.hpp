@@ -48,6 +48,9 @@ public:
     ///@return the adc clock in seconds
     double GetAdcClockInSeconds() const { return adcClockInSeconds_; }
 
+    ///@return the DAMM .ban file with the banana gates, empty if none was given
+    std::string GetBananaFile() const { return bananaFile_; }
+
     ///@param[in] freq : The frequency of the module
     ///@return the correct adc clock conversion factor for the given freq
     double GetAdcClockInSeconds(const int &freq) const {
@@ -79,6 +82,9 @@ public:
     ///@return the dammPlots_ bool. True if we are filling DAMM plots on disk
     bool GetDammPlots() const { return dammPlots_; }
 
+    ///@return the path of the input file that is scanned
+    std::string GetInputFileName() const { return inputFilename_; }
+
     ///@return the event size in seconds
     double GetEventLengthInSeconds() const { return eventLengthInSeconds_; }
 
@@ -99,6 +105,15 @@ public:
         }
     }
 
+    ///@return the name of the shared memory segment with the live histograms, empty if disabled
+    std::string GetLiveHistogramsName() const { return liveHistogramsName_; }
+
+    ///@return the minimum number of seconds between publishing the live histograms
+    double GetLiveHistogramsPeriod() const { return liveHistogramsPeriod_; }
+
+    ///@return the path of the socket answering queries for the live histograms, empty if disabled
+    std::string GetLiveHistogramsSocket() const { return liveHistogramsSocket_; }
+
     ///@return returns name of specified output file
     std::string GetOutputFileName() const { return outputFilename_; }
 
@@ -111,6 +126,12 @@ public:
     ///@return rejection regions to exclude from scan.
     std::vector<std::pair<unsigned int, unsigned int> > GetRejectionRegions() const { return reject_; }
 
+    ///@return the DAMM ids of the histograms that are always stored sparse
+    std::vector<unsigned int> GetSparseHistograms() const { return sparseHistograms_; }
+
+    ///@return the size in MB above which 2D histograms are stored sparse, 0 if disabled
+    double GetSparseThresholdInMb() const { return sparseThresholdInMb_; }
+
     ///@return the frequency of the system clock in Hz
     double GetSystemClockFreqInHz() const { return sysClockFreqInHz_; }
 
@@ -142,6 +163,10 @@ public:
     ///@param[in] a : The parameter that we are going to set
     void SetAdcClockInSeconds(const double &a) { adcClockInSeconds_ = a; }
 
+    ///Sets the DAMM .ban file that the banana gates are loaded from.
+    ///@param[in] a : The parameter that we are going to set
+    void SetBananaFile(const std::string &a) { bananaFile_ = a; }
+
     ///Sets the speed Pixie-16 clock in seconds.
     ///@param[in] a : The parameter that we are going to set
     void SetClockInSeconds(const double &a) { clockInSeconds_ = a; }
@@ -166,6 +191,22 @@ public:
     ///@param[in] a : The parameter that we are going to set
     void SetHasRawHistogramsDefined(const bool &a) { hasRawHistogramsDefined_ = a; }
 
+    ///Sets the name of the shared memory segment with the live histograms
+    ///@param[in] a : The parameter that we are going to set
+    void SetLiveHistogramsName(const std::string &a) { liveHistogramsName_ = a; }
+
+    ///Sets the minimum number of seconds between publishing the live histograms
+    ///@param[in] a : The parameter that we are going to set
+    void SetLiveHistogramsPeriod(const double &a) { liveHistogramsPeriod_ = a; }
+
+    ///Sets the path of the socket answering queries for the live histograms
+    ///@param[in] a : The parameter that we are going to set
+    void SetLiveHistogramsSocket(const std::string &a) { liveHistogramsSocket_ = a; }
+
+    ///Sets the input file from the scan interface when a file is opened
+    ///@param[in] a : The parameter that we are going to set
+    void SetInputFileName(const std::string &a) { inputFilename_ = a; }
+
     ///Sets output Filename from scan interface
     ///@param[in] a : The parameter that we are going to set
     void SetOutputFilename(const std::string &a) { outputFilename_ = a; }
@@ -184,6 +225,14 @@ public:
     /// directly from the Map node.
     void SetRevision(const std::string &a) { revision_ = a; }
 
+    ///Sets the DAMM ids of the histograms that are always stored sparse
+    ///@param[in] a : The parameter that we are going to set
+    void SetSparseHistograms(const std::vector<unsigned int> &a) { sparseHistograms_ = a; }
+
+    ///Sets the size in MB above which 2D histograms are stored sparse
+    ///@param[in] a : The parameter that we are going to set
+    void SetSparseThresholdInMb(const double &a) { sparseThresholdInMb_ = a; }
+
     ///Sets the speed of light in a Big VANDLE module.
     ///@param[in] a : The speed of light in units of cm/ns
     void SetVandleBigSpeedOfLight(const double &a) { vandleBigSpeedOfLight_ = a; }
@@ -218,6 +267,7 @@ private:
     const std::map<int, double> adcClockTickToSeconds_ = {{100, 10e-9}, {250, 4e-9}, {500, 2e-9}};      //!< map of frequencies and conversion factors for Adc Ticks->Seconds
     const std::map<int, double> filterClockTickToSeconds_ = {{100, 10e-9}, {250, 8e-9}, {500, 10e-9}};  //!< map of frequencies and conversion factors for Dsp Ticks->Seconds
     double adcClockInSeconds_;                                   //!< adc clock in second
+    std::string bananaFile_;                                     //!< The DAMM .ban file with the banana gates
     double clockInSeconds_;                                      //!< the ACQ clock in seconds
     std::string configFile_;                                     //!< The configuration file
     bool dammPlots_;                                             //!< True if we are filling DAMM plots
@@ -225,9 +275,15 @@ private:
     unsigned int eventLengthInTicks_;                            //!< the size of the events
     double filterClockInSeconds_;                                //!< filter clock in seconds
     bool hasRawHistogramsDefined_;                               //!< True if we are plotting Raw Histograms
+    std::string liveHistogramsName_;                             //!< Shared memory segment with the live histograms
+    double liveHistogramsPeriod_;                                //!< Seconds between publishing the live histograms
+    std::string liveHistogramsSocket_;                           //!< Socket answering queries for the live histograms
+    std::string inputFilename_;                                  //!< The input file that is scanned
     std::string outputFilename_;                                 //!<Output Filename
     std::string outputPath_;                                     //!< The path to additional configuration files
     std::string revision_;                                       //!< the pixie revision
+    std::vector<unsigned int> sparseHistograms_;                 //!< DAMM ids of histograms stored sparse
+    double sparseThresholdInMb_;                                 //!< Size in MB above which 2D histograms are stored sparse
     double sysClockFreqInHz_;                                    //!< frequency of the system clock
     std::vector<std::pair<unsigned int, unsigned int>> reject_;  ///< Rejection regions
     double vandleBigSpeedOfLight_;                               //!< speed of light in big VANDLE bars in cm/ns
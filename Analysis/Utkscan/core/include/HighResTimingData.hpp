@@ -12,17 +12,50 @@
 
 //! Class for holding information for high resolution timing. All times more
 //! precise than the filter time will be in nanoseconds (phase, highResTime).
-class HighResTimingData : public ChanEvent {
+//! The class is a view of a ChanEvent, it does not copy the event (or its
+//! trace), so it may only be used while the event that it was built from
+//! exists, i.e. during the processing of the current event.
+class HighResTimingData {
 public:
-    /** Default constructor */
-    HighResTimingData() {};
+    /** Default constructor, views an empty channel event */
+    HighResTimingData() : evt_(&EmptyEvent()) {};
 
     /** Default destructor */
-    virtual ~HighResTimingData() {};
+    ~HighResTimingData() {};
 
     /** Constructor using the channel event
-    * \param [in] chan : the channel event for grabbing values from */
-    HighResTimingData(ChanEvent &evt) : ChanEvent(evt) {}
+    * \param [in] evt : the channel event for grabbing values from */
+    HighResTimingData(const ChanEvent &evt) : evt_(&evt) {}
+
+    /** \return the channel event that is viewed */
+    const ChanEvent &GetChanEvent() const { return *evt_; }
+
+    /** \return the channel configuration of the event */
+    const ChannelConfiguration &GetChanID() const { return evt_->GetChanID(); }
+
+    /** \return the channel id of the event */
+    unsigned int GetID() const { return evt_->GetID(); }
+
+    /** \return the trace of the event */
+    const Trace &GetTrace() const { return evt_->GetTrace(); }
+
+    /** \return the raw energy of the event */
+    double GetEnergy() const { return evt_->GetEnergy(); }
+
+    /** \return the calibrated energy of the event */
+    double GetCalibratedEnergy() const { return evt_->GetCalibratedEnergy(); }
+
+    /** \return the time of the event */
+    double GetTime() const { return evt_->GetTime(); }
+
+    /** \return the time of the event without the CFD correction */
+    double GetTimeSansCfd() const { return evt_->GetTimeSansCfd(); }
+
+    /** \return the high resolution time of the event in ns */
+    double GetHighResTimeInNs() const { return evt_->GetHighResTimeInNs(); }
+
+    /** \return the walk corrected time of the event */
+    double GetWalkCorrectedTime() const { return evt_->GetWalkCorrectedTime(); }
 
     /** Calculate the energy from the time of flight, using a correction
     * \param [in] tof : The time of flight to use for the calculation in ns
@@ -106,6 +139,14 @@ public:
     }
 
 #endif
+private:
+    const ChanEvent *evt_; //!< The channel event that is viewed
+
+    /** \return the event viewed by default constructed objects */
+    static const ChanEvent &EmptyEvent() {
+        static const ChanEvent empty;
+        return empty;
+    }
 };
 
 /** Defines a map to hold timing data for a channel. */
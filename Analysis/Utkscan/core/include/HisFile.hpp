@@ -13,6 +13,7 @@
 #ifndef HISFILE_H
 #define HISFILE_H
 
+#include <chrono>
 #include <fstream>
 #include <iostream>
 #include <map>
@@ -45,6 +46,12 @@ void set2cc_(const int &dammID, const int &x, const int &y, const int &z);
 #include "Scanor.hpp"
 #endif
 
+class LiveHisWriter;
+
+class StateReader;
+
+class StateWriter;
+
 /// Histogram data storage object
 class HisData {
 public:
@@ -88,6 +95,99 @@ private:
     bool init;
 };
 
+/** Tiled bin storage for a large histogram which is mostly empty. The bins
+ * are kept in tiles of TILE_BINS consecutive bins of the .his file layout,
+ * and a tile is only allocated the first time one of its bins is filled. The
+ * tiles hold the total contents of their bins, so the tiles which changed
+ * since the last write can be copied over the file as they are.
+ */
+class SparseHisData {
+public:
+    static const size_t TILE_BINS = 1024; /// Number of bins in a tile (4 kB)
+
+    /// Constructor for a histogram with total_bins_ bins
+    SparseHisData(size_t total_bins_);
+
+    /// Destructor
+    ~SparseHisData();
+
+    /// Increment a bin by weight_. No range checking!
+    void Add(size_t bin_, unsigned int weight_) {
+        size_t index = bin_ / TILE_BINS;
+        if (!tiles[index])
+            allocate_tile(index);
+        if (is_dirty[index] != dirty_mask)
+            mark_dirty(index);
+        tiles[index][bin_ % TILE_BINS] += weight_;
+    }
+
+    /// Return the contents of a bin. No range checking!
+    unsigned int Get(size_t bin_) const {
+        const unsigned int *tile = tiles[bin_ / TILE_BINS];
+        return (tile ? tile[bin_ % TILE_BINS] : 0);
+    }
+
+    /* Write the tiles which changed since the last call to the file. The
+     * histogram starts offset_ bytes into the file and has 4 (use_int_ ==
+     * true) or 2 byte cells. Returns the number of tiles written.
+     */
+    size_t Write(std::fstream *file_, std::streampos offset_, bool use_int_);
+
+    /* Also keep track of the tiles which changed since the last call to
+     * Copy, for a live image of the histogram. All of the tiles which were
+     * already filled are copied by the next call.
+     */
+    void SetLiveTracking(bool track_);
+
+    /* Copy the tiles which changed since the last call to the live image of
+     * the histogram, which has 4 (use_int_ == true) or 2 byte cells. Returns
+     * the number of tiles copied.
+     */
+    size_t Copy(char *image_, bool use_int_);
+
+    /// Free all of the tiles. The caller is responsible for zeroing the file.
+    void Zero();
+
+    /// Return the bins of a tile, NULL if none of its bins was filled
+    const unsigned int *GetTile(size_t index_) const { return tiles[index_]; }
+
+    /* Set the bins of a tile, used to restore a checkpoint. The tile is
+     * written to the file (and copied to the live image) with the next
+     * flush.
+     */
+    void SetTile(size_t index_, const unsigned int *bins_);
+
+    /// Return the number of tiles which have been allocated
+    size_t GetNumTiles() const { return num_allocated; }
+
+    /// Return the number of tiles needed to cover the whole histogram
+    size_t GetTotalTiles() const { return tiles.size(); }
+
+    /// Return the approximate number of bytes of memory in use
+    size_t GetMemoryUsage() const;
+
+private:
+    std::vector<unsigned int *> tiles; /// Pointers to the tiles, NULL until first filled
+    std::vector<size_t> dirty_tiles; /// Tiles which changed since the last write
+    std::vector<size_t> live_tiles; /// Tiles which changed since the last copy
+    std::vector<unsigned char> is_dirty; /// DIRTY_FILE and DIRTY_LIVE flags of each tile
+    unsigned char dirty_mask; /// The flags of a tile which is in all of the lists
+    size_t total_bins; /// Total number of bins in the histogram
+    size_t num_allocated; /// Number of tiles which have been allocated
+
+    static const unsigned char DIRTY_FILE = 1; /// The tile is in dirty_tiles
+    static const unsigned char DIRTY_LIVE = 2; /// The tile is in live_tiles
+
+    /// Allocate a zeroed tile
+    void allocate_tile(size_t index_);
+
+    /// Add a tile to the lists it is missing from
+    void mark_dirty(size_t index_);
+
+    SparseHisData(const SparseHisData &); /// Copying is not allowed
+    SparseHisData &operator=(const SparseHisData &); /// Copying is not allowed
+};
+
 /// drr entry information
 struct drr_entry {
     unsigned int hisID; /// ID of the histogram
@@ -116,8 +216,14 @@ struct drr_entry {
     unsigned int total_counts; /// Total number of attempted histogram fills
     unsigned int good_counts; /// Total number of actual histogram fills
 
+    SparseHisData *sparse; /// Tiled storage of the bins, NULL if the fills are queued
+    size_t live_index; /// Index of the histogram in the live image (see LiveHisWriter)
+
     /// Default constructor
-    drr_entry() {}
+    drr_entry() : sparse(NULL), live_index(0) {}
+
+    /// Destructor
+    ~drr_entry();
 
     /// Constructor for 1d histogram
     drr_entry(unsigned int hisID_, unsigned short halfWords_,
@@ -339,13 +445,41 @@ private:
     bool existing_file; /// True if the .his file was a previously existing file
     unsigned int Flush_wait; /// Number of fills to wait between Flushes
     unsigned int Flush_count; /// Number of fills since last Flush
+    unsigned int Sparse_wait; /// Number of sparse fills to wait between writing the tiles
+    unsigned int Sparse_count; /// Number of sparse fills since the tiles were last written
     std::vector<fill_queue *> fills_waiting; /// Vector containing list of histograms to be filled
     std::set<unsigned int> failed_fills; /// Vector containing list of histogram fills into an invalid his id
     std::streampos total_his_size; /// Total size of .his file
+    size_t sparse_threshold; /// Size (in bytes) above which 2d histograms are stored sparse
+    int fd; /// Descriptor of the .his file used to resize it and punch holes
+    LiveHisWriter *live; /// Shared memory image of the histograms, NULL unless opened
+    double Live_period; /// Minimum number of seconds between copying the sparse tiles to the live image
+    std::chrono::steady_clock::time_point Live_last; /// Time the sparse tiles were last copied
 
     /// Find the specified .drr entry in the drr list using its histogram id
     drr_entry *find_drr_in_list(unsigned int hisID_);
 
+    /// Write the queued fills to the file
+    void flush_queue();
+
+    /* Write the tiles of the sparse histograms which changed since they were
+     * last written. Every tile that was touched is copied whole, so this is
+     * done much less often than flushing the queued fills.
+     */
+    void flush_sparse();
+
+    /* Grow the .his file to size_ bytes. The file is extended with ftruncate
+     * so that the new histograms are a hole in a sparse file which reads as
+     * zeros, instead of writing the zeros out. Returns false on failure.
+     */
+    bool extend_file(std::streampos size_);
+
+    /* Zero size_ bytes of the .his file starting at offset_ by punching a hole
+     * (or zeroing the range) with fallocate. Falls back to writing zeros if
+     * the file system does not support it. Returns false on failure.
+     */
+    bool zero_range(std::streampos offset_, size_t size_);
+
 public:
     OutputHisFile();
 
@@ -362,6 +496,72 @@ public:
     /// Set the number of fills to wait between file Flushes
     void SetFlushWait(unsigned int wait_) { Flush_wait = wait_; }
 
+    /// Set the number of sparse histogram fills to wait between writing their tiles
+    void SetSparseFlushWait(unsigned int wait_) { Sparse_wait = wait_; }
+
+    /// Return the number of histograms declared
+    size_t GetNumHistograms() const { return drrMap_.size(); }
+
+    /// Return the size of the .his file in bytes
+    std::streampos GetTotalSize() const { return total_his_size; }
+
+    /// Return the number of bytes of the .his file that are allocated on disk
+    size_t GetAllocatedSize() const;
+
+    /* Set the size (in bytes) above which 2d histograms are kept in sparse
+     * tiled storage (see SparseHisData) instead of queueing their fills. Only
+     * affects histograms declared afterwards. Zero disables the threshold.
+     */
+    void SetSparseThreshold(size_t bytes_) { sparse_threshold = bytes_; }
+
+    /// Return the size (in bytes) above which 2d histograms are stored sparse
+    size_t GetSparseThreshold() const { return sparse_threshold; }
+
+    /* Select the sparse tiled storage for a histogram, or switch it back to
+     * queued fills. This is only possible before the histogram is filled.
+     * Returns false if the id is unknown or the histogram was already filled.
+     */
+    bool SetSparse(unsigned int hisID_, bool sparse_ = true);
+
+    /// Return the number of histograms kept in sparse storage
+    size_t GetNumSparse() const;
+
+    /// Return the approximate number of bytes of memory used by the sparse histograms
+    size_t GetSparseMemoryUsage() const;
+
+    /// Return the .drr entry of a histogram, or NULL if the id was not declared
+    drr_entry *FindEntry(unsigned int hisID_);
+
+    /* Count fills which were added straight into the tiles of a sparse
+     * histogram (e.g. through a Histogram1D handle) and write the tiles when
+     * enough of them were made.
+     */
+    void CountSparseFills(unsigned int num_ = 1) {
+        if ((Sparse_count += num_) >= Sparse_wait)
+            flush_sparse();
+    }
+
+    /* Publish the histograms in a POSIX shared memory segment (see
+     * LiveHistograms.hpp) so that viewers can read the current spectra while
+     * the scan runs. Must be called after Finalize and before the first fill.
+     * Queued fills are added to the image as they are made, the tiles of the
+     * sparse histograms are copied by PublishLive. Returns false if the
+     * segment could not be created.
+     */
+    bool OpenLive(const std::string &name_);
+
+    /// Return true if the histograms are published in shared memory
+    bool IsLive() const { return live != NULL; }
+
+    /// Set the minimum number of seconds between copying the sparse tiles to the live image
+    void SetLivePeriod(double seconds_) { Live_period = seconds_; }
+
+    /* Copy the tiles of the sparse histograms which changed to the live
+     * image, at most once per live period unless force_ is set. Must be
+     * called from the thread filling the histograms.
+     */
+    void PublishLive(bool force_ = false);
+
     /* Push back with another histogram entry. This command will also
      * extend the length of the .his file (if possible). DO NOT delete
      * the passed drr_entry after calling. OutputHisFile will handle cleanup.
@@ -393,9 +593,21 @@ public:
     /// Open a new .his file
     bool Open(std::string fname_prefix);
 
-    /// Flush histogram fills to file
+    /// Flush histogram fills and the sparse histograms to file
     void Flush();
 
+    /* Write the contents and the fill counters of every histogram for the
+     * checkpoints of the scan. The queued fills are flushed first, only the
+     * filled tiles of the sparse histograms are written.
+     */
+    void SaveState(StateWriter &writer_);
+
+    /* Restore the histograms written by SaveState. They must have been
+     * declared and finalized as when the state was written, an IOException
+     * is thrown otherwise.
+     */
+    void LoadState(StateReader &reader_);
+
     /// Close the histogram file and write the drr file
     void Close();
 };
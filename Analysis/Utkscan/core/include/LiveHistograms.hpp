@@ -0,0 +1,261 @@
+/*! \file LiveHistograms.hpp
+ *  \brief Publishes the histograms of a running scan in POSIX shared memory
+ *  \date October 19, 2026
+ *
+ * The writer creates a shared memory segment holding a header, a directory
+ * with one LiveHisEntry per histogram and an image of the .his file, i.e. the
+ * bins of every histogram at the same byte offset and with the same cell size
+ * as in the .his file. The analysis thread keeps the image up to date while it
+ * scans, so a viewer can map the segment read-only and look at the current
+ * spectra at any time without forcing the .his file to be flushed.
+ *
+ * Every histogram has its own sequence lock. The writer makes the sequence
+ * number odd before it changes the bins and even again afterwards, and a
+ * reader only accepts a copy of the bins if the sequence number was even and
+ * did not change while it was copying. The writer never waits for a reader.
+ *
+ * The HistogramServer answers a small line based protocol on a local
+ * (Unix domain) socket for clients which would rather not map the segment:
+ *   LIST        -> "OK <n>" followed by n lines "<id> <dim> <nx> <ny> <title>"
+ *   INFO        -> "OK <updates> <unix time of the last update> <pid>"
+ *   GET <id>    -> "OK <id> <dim> <nx> <ny> <nbins>" followed by nbins
+ *                  unsigned 32 bit integers in the byte order of the host
+ *   QUIT        -> closes the connection
+ * and "ERR <message>" if the request could not be answered.
+*/
+#ifndef __LIVEHISTOGRAMS_HPP__
+#define __LIVEHISTOGRAMS_HPP__
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <stdint.h>
+
+//! Header at the start of the shared memory segment
+struct LiveHisHeader {
+    char magic[8]; //!< Always "PAASSHIS"
+    uint32_t version; //!< Version of the layout
+    uint32_t numHistograms; //!< Number of entries in the directory
+    uint64_t dataOffset; //!< Bytes from the start of the segment to the image
+    uint64_t dataSize; //!< Size of the image (and of the .his file) in bytes
+    std::atomic<uint64_t> numUpdates; //!< Number of times the image was published
+    std::atomic<int64_t> lastUpdate; //!< Unix time of the last publication
+    int32_t pid; //!< Process id of the writer
+};
+
+//! Directory entry for a single histogram
+struct LiveHisEntry {
+    std::atomic<uint32_t> sequence; //!< Odd while the bins are being written
+    uint32_t hisID; //!< The DAMM id of the histogram
+    uint16_t hisDim; //!< The number of dimensions
+    uint16_t halfWords; //!< Number of half-words (2 bytes) per cell
+    uint16_t scaled[2]; //!< Number of bins along x and y
+    uint64_t offset; //!< Bytes from the start of the image to the first bin
+    uint64_t totalBins; //!< Total number of bins
+    char title[41]; //!< The title of the histogram
+};
+
+//! Creates the segment and updates the bins from the analysis thread
+class LiveHisWriter {
+public:
+    static const uint32_t VERSION = 1; //!< Version of the segment layout
+
+    /** Default constructor */
+    LiveHisWriter();
+
+    /** Destructor, removes the segment */
+    ~LiveHisWriter();
+
+    /** Declare a histogram, must be called before Open
+     * \param [in] hisID : the DAMM id
+     * \param [in] hisDim : the number of dimensions
+     * \param [in] halfWords : the number of half-words per cell
+     * \param [in] scaledX : the number of bins along x
+     * \param [in] scaledY : the number of bins along y (1 for 1D)
+     * \param [in] offset : the byte offset of the histogram in the .his file
+     * \param [in] title : the title of the histogram
+     * \return the index of the histogram used to update its bins */
+    size_t Declare(const unsigned int &hisID, const unsigned short &hisDim,
+                   const unsigned short &halfWords, const unsigned short &scaledX,
+                   const unsigned short &scaledY, const uint64_t &offset,
+                   const std::string &title);
+
+    /** Create the shared memory segment for the declared histograms. The
+     * image is a sparse file in /dev/shm, so pages of histograms which are
+     * never filled do not use any memory.
+     * \param [in] name : the name of the segment, e.g. "/utkscan"
+     * \param [in] dataSize : the size of the .his file in bytes
+     * \return true if the segment was created */
+    bool Open(const std::string &name, const uint64_t &dataSize);
+
+    /** Unmap and remove the segment */
+    void Close(void);
+
+    /** \return true if the segment is open */
+    bool IsOpen(void) const { return header_ != NULL; }
+
+    /** \return the name of the segment */
+    const std::string &GetName(void) const { return name_; }
+
+    /** \return the size of the segment in bytes */
+    size_t GetSize(void) const { return size_; }
+
+    /** Start changing the bins of a histogram
+     * \param [in] index : the index returned by Declare */
+    void BeginWrite(const size_t &index) {
+        std::atomic<uint32_t> &seq = entries_[index].sequence;
+        seq.store(seq.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    /** Done changing the bins of a histogram
+     * \param [in] index : the index returned by Declare */
+    void EndWrite(const size_t &index) {
+        std::atomic<uint32_t> &seq = entries_[index].sequence;
+        seq.store(seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /** \return a pointer to the first bin of a histogram
+     * \param [in] index : the index returned by Declare */
+    char *GetBins(const size_t &index) { return data_ + entries_[index].offset; }
+
+    /** Increment a bin of a histogram. Short cells wrap around like they do
+     * in the .his file. No range checking!
+     * \param [in] index : the index returned by Declare
+     * \param [in] bin : the global bin
+     * \param [in] weight : the amount to add */
+    void Add(const size_t &index, const size_t &bin, const unsigned int &weight) {
+        BeginWrite(index);
+        if (entries_[index].halfWords == 2)
+            ((uint32_t *) GetBins(index))[bin] += weight;
+        else
+            ((uint16_t *) GetBins(index))[bin] += (uint16_t) weight;
+        EndWrite(index);
+    }
+
+    /** Zero all of the bins of a histogram
+     * \param [in] index : the index returned by Declare */
+    void Zero(const size_t &index);
+
+    /** Mark the image as updated, called after a batch of changes */
+    void Publish(void);
+
+private:
+    std::string name_; //!< Name of the segment
+    size_t size_; //!< Size of the segment in bytes
+    LiveHisHeader *header_; //!< The mapped segment
+    LiveHisEntry *entries_; //!< The directory in the segment
+    char *data_; //!< The image of the .his file in the segment
+    std::vector<LiveHisEntry *> declared_; //!< Histograms declared before Open
+
+    LiveHisWriter(const LiveHisWriter &); //!< Copying is not allowed
+    LiveHisWriter &operator=(const LiveHisWriter &); //!< Copying is not allowed
+};
+
+//! Maps the segment read-only and takes consistent snapshots of the bins
+class LiveHisReader {
+public:
+    /** Default constructor */
+    LiveHisReader();
+
+    /** Destructor */
+    ~LiveHisReader();
+
+    /** Map a segment created by a LiveHisWriter
+     * \param [in] name : the name of the segment
+     * \return false if the segment does not exist or has the wrong layout */
+    bool Open(const std::string &name);
+
+    /** Unmap the segment */
+    void Close(void);
+
+    /** \return true if a segment is mapped */
+    bool IsOpen(void) const { return header_ != NULL; }
+
+    /** \return the number of histograms in the segment */
+    size_t GetNumHistograms(void) const {
+        return header_ ? header_->numHistograms : 0;
+    }
+
+    /** \return the directory entry of a histogram
+     * \param [in] index : the position in the directory */
+    const LiveHisEntry &GetEntry(const size_t &index) const { return entries_[index]; }
+
+    /** \return the directory entry of a histogram, NULL if it does not exist
+     * \param [in] hisID : the DAMM id */
+    const LiveHisEntry *FindEntry(const unsigned int &hisID) const;
+
+    /** \return the number of times the writer published the image */
+    uint64_t GetNumUpdates(void) const;
+
+    /** \return the unix time of the last publication */
+    int64_t GetLastUpdate(void) const;
+
+    /** \return the process id of the writer */
+    int GetWriterPid(void) const { return header_ ? header_->pid : 0; }
+
+    /** Copy a consistent snapshot of the bins of a histogram
+     * \param [in] hisID : the DAMM id
+     * \param [out] bins : the contents of the bins, short cells are widened
+     * \param [in] maxTries : the number of copies to attempt while the writer
+     *  is changing the histogram
+     * \return false if the histogram does not exist or no consistent copy
+     *  could be made */
+    bool Read(const unsigned int &hisID, std::vector<unsigned int> &bins,
+              const unsigned int &maxTries = 1000) const;
+
+private:
+    size_t size_; //!< Size of the mapped segment in bytes
+    const LiveHisHeader *header_; //!< The mapped segment
+    const LiveHisEntry *entries_; //!< The directory in the segment
+    const char *data_; //!< The image of the .his file in the segment
+
+    LiveHisReader(const LiveHisReader &); //!< Copying is not allowed
+    LiveHisReader &operator=(const LiveHisReader &); //!< Copying is not allowed
+};
+
+//! Answers queries for the histograms on a local socket from its own thread
+class HistogramServer {
+public:
+    /** Constructor
+     * \param [in] segment : the name of the shared memory segment
+     * \param [in] socketPath : the path of the Unix domain socket */
+    HistogramServer(const std::string &segment, const std::string &socketPath);
+
+    /** Destructor, stops the server */
+    ~HistogramServer();
+
+    /** Map the segment, bind the socket and start the server thread
+     * \return false if the segment or the socket could not be opened */
+    bool Start(void);
+
+    /** Stop the server thread and remove the socket */
+    void Stop(void);
+
+    /** \return true if the server thread is running */
+    bool IsRunning(void) const { return thread_.joinable(); }
+
+    /** Answer a single request
+     * \param [in] request : the request without the line break
+     * \return the complete response */
+    std::string Process(const std::string &request) const;
+
+private:
+    std::string segment_; //!< Name of the shared memory segment
+    std::string socketPath_; //!< Path of the socket
+    LiveHisReader reader_; //!< The mapped segment
+    int listenFd_; //!< The listening socket
+    std::atomic<bool> stop_; //!< Set to stop the server thread
+    std::thread thread_; //!< The server thread
+
+    /** Accept clients and answer their requests until stopped */
+    void Run(void);
+
+    /** Answer the requests of a single client until it disconnects
+     * \param [in] fd : the connected socket */
+    void Serve(const int &fd);
+};
+
+#endif // __LIVEHISTOGRAMS_HPP__
@@ -0,0 +1,368 @@
+/*! \file PixelCorrelator.hpp
+ *  \brief Time ordered, fixed capacity event buffers for every pixel of a
+ *  segmented detector
+ *  \date October 19, 2026
+ *
+ * Every pixel owns a ring buffer with a fixed number of slots that are
+ * allocated once when the correlator is constructed. The events of a pixel
+ * are kept ordered by time, so the events inside of a time window are found
+ * with a binary search. Events that are older than the correlation window
+ * with respect to the newest event of the pixel are expired automatically
+ * whenever an event is added, and if a pixel is full its oldest event is
+ * dropped. The memory used therefore does not grow over the length of a run.
+*/
+#ifndef __PIXELCORRELATOR_HPP__
+#define __PIXELCORRELATOR_HPP__
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "StateArchive.hpp"
+
+//! A time ordered ring buffer of events for every (x,y) pixel
+template<class T>
+class PixelCorrelator {
+public:
+    //! An event found by a time window query
+    struct Hit {
+        unsigned int x; //!< The x pixel of the event
+        unsigned int y; //!< The y pixel of the event
+        double time; //!< The time of the event
+        T *event; //!< The event
+    };
+
+    /** Constructor
+     * \param [in] sizeX : the number of pixels in x
+     * \param [in] sizeY : the number of pixels in y
+     * \param [in] capacity : the maximum number of events stored per pixel
+     * \param [in] window : events older than this with respect to the newest
+     * event of a pixel are expired, a value <= 0 disables the expiry */
+    PixelCorrelator(const unsigned int &sizeX, const unsigned int &sizeY,
+                    const unsigned int &capacity, const double &window) :
+            sizeX_(sizeX), sizeY_(sizeY), capacity_(std::max(1u, capacity)),
+            window_(window), head_(sizeX * sizeY, 0), size_(sizeX * sizeY, 0),
+            times_(sizeX * sizeY * capacity_), events_(sizeX * sizeY * capacity_),
+            numAdded_(0), numExpired_(0), numOverflows_(0), numQueries_(0),
+            queryTime_(0.0) {}
+
+    /** Default destructor */
+    ~PixelCorrelator() {}
+
+    /** Adds an event to a pixel. Events older than the window are expired
+     * first and the oldest event is dropped if the pixel is full.
+     * \param [in] x : the x pixel
+     * \param [in] y : the y pixel
+     * \param [in] time : the time of the event
+     * \param [in] event : the event to store
+     * \return false if the pixel does not exist */
+    bool Add(const unsigned int &x, const unsigned int &y, const double &time,
+             const T &event) {
+        if (!Contains(x, y))
+            return false;
+        const unsigned int pixel = Index(x, y);
+        unsigned int &num = size_[pixel];
+
+        double newest = num ? std::max(time, Time(pixel, num - 1)) : time;
+        Expire(pixel, newest - window_);
+        if (num == capacity_) {
+            Pop(pixel);
+            numOverflows_++;
+        }
+
+        //! Events usually arrive in order, so this loop rarely runs.
+        unsigned int pos = num;
+        while (pos > 0 && Time(pixel, pos - 1) > time) {
+            unsigned int from = Slot(pixel, pos - 1), to = Slot(pixel, pos);
+            times_[to] = times_[from];
+            events_[to] = events_[from];
+            pos--;
+        }
+        times_[Slot(pixel, pos)] = time;
+        events_[Slot(pixel, pos)] = event;
+        num++;
+        numAdded_++;
+        return true;
+    }
+
+    /** Removes the events of a pixel that are older than a given time
+     * \param [in] x : the x pixel
+     * \param [in] y : the y pixel
+     * \param [in] time : events before this time are removed */
+    void Expire(const unsigned int &x, const unsigned int &y, const double &time) {
+        if (Contains(x, y))
+            Expire(Index(x, y), time);
+    }
+
+    /** Finds the events of a pixel with t0 <= time <= t1
+     * \param [in] x : the x pixel
+     * \param [in] y : the y pixel
+     * \param [in] t0 : the start of the time window
+     * \param [in] t1 : the end of the time window
+     * \param [out] result : the events that were found are appended, ordered
+     * by time
+     * \return the number of events that were found */
+    unsigned int Find(const unsigned int &x, const unsigned int &y,
+                      const double &t0, const double &t1,
+                      std::vector<Hit> &result) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        unsigned int num = Contains(x, y) ? Collect(Index(x, y), t0, t1, result) : 0;
+        EndQuery(start);
+        return num;
+    }
+
+    /** Finds the events with t0 <= time <= t1 in the pixels that are at most
+     * radius pixels away from (x,y) in x and in y, including (x,y) itself.
+     * \param [in] x : the x pixel
+     * \param [in] y : the y pixel
+     * \param [in] radius : the number of neighbouring pixels to search
+     * \param [in] t0 : the start of the time window
+     * \param [in] t1 : the end of the time window
+     * \param [out] result : the events that were found are appended, ordered
+     * by time within each pixel
+     * \return the number of events that were found */
+    unsigned int FindNeighbours(const unsigned int &x, const unsigned int &y,
+                                const unsigned int &radius, const double &t0,
+                                const double &t1, std::vector<Hit> &result) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        unsigned int num = 0;
+        unsigned int xLow = x > radius ? x - radius : 0;
+        unsigned int yLow = y > radius ? y - radius : 0;
+        for (unsigned int i = xLow; i <= x + radius && i < sizeX_; i++)
+            for (unsigned int j = yLow; j <= y + radius && j < sizeY_; j++)
+                num += Collect(Index(i, j), t0, t1, result);
+        EndQuery(start);
+        return num;
+    }
+
+    /** Removes all of the events from a pixel
+     * \param [in] x : the x pixel
+     * \param [in] y : the y pixel */
+    void Clear(const unsigned int &x, const unsigned int &y) {
+        if (Contains(x, y))
+            size_[Index(x, y)] = 0;
+    }
+
+    /** Removes all of the events from every pixel */
+    void Clear(void) {
+        std::fill(size_.begin(), size_.end(), 0);
+    }
+
+    /** \return true if (x,y) is a pixel of the correlator
+     * \param [in] x : the x pixel
+     * \param [in] y : the y pixel */
+    bool Contains(const unsigned int &x, const unsigned int &y) const {
+        return x < sizeX_ && y < sizeY_;
+    }
+
+    /** \return the number of events stored in a pixel
+     * \param [in] x : the x pixel
+     * \param [in] y : the y pixel */
+    unsigned int Size(const unsigned int &x, const unsigned int &y) const {
+        return Contains(x, y) ? size_[Index(x, y)] : 0;
+    }
+
+    /** \return the i'th event of a pixel, starting from the oldest
+     * \param [in] x : the x pixel
+     * \param [in] y : the y pixel
+     * \param [in] i : the position of the event, must be less than Size(x,y) */
+    T &At(const unsigned int &x, const unsigned int &y, const unsigned int &i) {
+        return events_[Slot(Index(x, y), i)];
+    }
+
+    /** \return the i'th event of a pixel, starting from the oldest
+     * \param [in] x : the x pixel
+     * \param [in] y : the y pixel
+     * \param [in] i : the position of the event, must be less than Size(x,y) */
+    const T &At(const unsigned int &x, const unsigned int &y,
+                const unsigned int &i) const {
+        return events_[Slot(Index(x, y), i)];
+    }
+
+    /** \return the time of the i'th event of a pixel, starting from the oldest
+     * \param [in] x : the x pixel
+     * \param [in] y : the y pixel
+     * \param [in] i : the position of the event, must be less than Size(x,y) */
+    double GetTime(const unsigned int &x, const unsigned int &y,
+                   const unsigned int &i) const {
+        return Time(Index(x, y), i);
+    }
+
+    /** \return the number of pixels in x */
+    unsigned int GetSizeX(void) const { return sizeX_; }
+
+    /** \return the number of pixels in y */
+    unsigned int GetSizeY(void) const { return sizeY_; }
+
+    /** \return the maximum number of events stored per pixel */
+    unsigned int GetCapacity(void) const { return capacity_; }
+
+    /** \return the correlation window */
+    double GetWindow(void) const { return window_; }
+
+    /** \return the number of bytes allocated for the buffers */
+    unsigned long GetMemoryUsage(void) const {
+        return times_.capacity() * sizeof(double) + events_.capacity() * sizeof(T) +
+               (head_.capacity() + size_.capacity()) * sizeof(unsigned int);
+    }
+
+    /** \return the number of events added */
+    unsigned long GetNumAdded(void) const { return numAdded_; }
+
+    /** \return the number of events removed because they were too old */
+    unsigned long GetNumExpired(void) const { return numExpired_; }
+
+    /** \return the number of events dropped because a pixel was full */
+    unsigned long GetNumOverflows(void) const { return numOverflows_; }
+
+    /** \return the number of time window queries */
+    unsigned long GetNumQueries(void) const { return numQueries_; }
+
+    /** \return the number of queries per second of time spent in them */
+    double GetQueryRate(void) const {
+        return queryTime_ > 0 ? numQueries_ / queryTime_ : 0.0;
+    }
+
+    /** Writes the events of every pixel and the counters, the time spent in
+     * the queries is not saved
+     * \param [in] writer : the archive of the state */
+    void SaveState(StateWriter &writer) const {
+        writer.Write(sizeX_);
+        writer.Write(sizeY_);
+        writer.Write(capacity_);
+        writer.Write(head_);
+        writer.Write(size_);
+        writer.Write(times_);
+        writer.Write(events_);
+        writer.Write(numAdded_);
+        writer.Write(numExpired_);
+        writer.Write(numOverflows_);
+        writer.Write(numQueries_);
+    }
+
+    /** Reads the state written by SaveState
+     * \param [in] reader : the archive of the state
+     * \throw IOException if the correlator of the state has a different
+     * number of pixels or a different capacity */
+    void LoadState(StateReader &reader) {
+        if (reader.Get<unsigned int>() != sizeX_ || reader.Get<unsigned int>() != sizeY_ ||
+            reader.Get<unsigned int>() != capacity_)
+            throw IOException("PixelCorrelator::LoadState - The saved correlator has a different size.");
+        reader.Read(head_);
+        reader.Read(size_);
+        reader.Read(times_);
+        reader.Read(events_);
+        reader.Read(numAdded_);
+        reader.Read(numExpired_);
+        reader.Read(numOverflows_);
+        reader.Read(numQueries_);
+    }
+
+    /** Prints the memory usage and the query statistics
+     * \param [in] out : the stream to print to
+     * \param [in] name : the name of the correlator */
+    void PrintStatistics(std::ostream &out, const std::string &name) const {
+        unsigned long numStored = 0;
+        for (std::vector<unsigned int>::const_iterator it = size_.begin(); it != size_.end(); it++)
+            numStored += *it;
+        out << name << " : " << sizeX_ << " x " << sizeY_ << " pixels, "
+            << capacity_ << " events per pixel, "
+            << GetMemoryUsage() / 1024.0 << " kB" << std::endl
+            << "  " << numAdded_ << " events added, " << numStored << " stored, "
+            << numExpired_ << " expired, " << numOverflows_ << " dropped (full)"
+            << std::endl << "  " << numQueries_ << " queries, "
+            << std::scientific << std::setprecision(3) << GetQueryRate()
+            << " queries/s" << std::endl;
+        out.unsetf(std::ios::floatfield);
+    }
+
+private:
+    unsigned int sizeX_; //!< Number of pixels in x
+    unsigned int sizeY_; //!< Number of pixels in y
+    unsigned int capacity_; //!< Number of slots per pixel
+    double window_; //!< Correlation window
+    std::vector<unsigned int> head_; //!< Slot of the oldest event of each pixel
+    std::vector<unsigned int> size_; //!< Number of events in each pixel
+    std::vector<double> times_; //!< Times of the events, capacity_ slots per pixel
+    std::vector<T> events_; //!< The events, capacity_ slots per pixel
+
+    unsigned long numAdded_; //!< Number of events added
+    unsigned long numExpired_; //!< Number of events expired
+    unsigned long numOverflows_; //!< Number of events dropped from full pixels
+    unsigned long numQueries_; //!< Number of time window queries
+    double queryTime_; //!< Time spent in the queries in seconds
+
+    /** \return the index of a pixel */
+    unsigned int Index(const unsigned int &x, const unsigned int &y) const {
+        return x * sizeY_ + y;
+    }
+
+    /** \return the slot of the i'th event of a pixel */
+    unsigned int Slot(const unsigned int &pixel, const unsigned int &i) const {
+        unsigned int offset = head_[pixel] + i;
+        if (offset >= capacity_)
+            offset -= capacity_;
+        return pixel * capacity_ + offset;
+    }
+
+    /** \return the time of the i'th event of a pixel */
+    double Time(const unsigned int &pixel, const unsigned int &i) const {
+        return times_[Slot(pixel, i)];
+    }
+
+    /** Removes the oldest event of a pixel */
+    void Pop(const unsigned int &pixel) {
+        head_[pixel] = head_[pixel] + 1 == capacity_ ? 0 : head_[pixel] + 1;
+        size_[pixel]--;
+    }
+
+    /** Removes the events of a pixel that are older than time */
+    void Expire(const unsigned int &pixel, const double &time) {
+        if (window_ <= 0)
+            return;
+        while (size_[pixel] > 0 && Time(pixel, 0) < time) {
+            Pop(pixel);
+            numExpired_++;
+        }
+    }
+
+    /** \return the position of the first event of a pixel at or after time */
+    unsigned int LowerBound(const unsigned int &pixel, const double &time) const {
+        unsigned int low = 0, high = size_[pixel];
+        while (low < high) {
+            unsigned int mid = (low + high) / 2;
+            if (Time(pixel, mid) < time)
+                low = mid + 1;
+            else
+                high = mid;
+        }
+        return low;
+    }
+
+    /** Appends the events of a pixel in [t0, t1] to result */
+    unsigned int Collect(const unsigned int &pixel, const double &t0,
+                         const double &t1, std::vector<Hit> &result) {
+        unsigned int num = 0;
+        Hit hit;
+        hit.x = pixel / sizeY_;
+        hit.y = pixel % sizeY_;
+        for (unsigned int i = LowerBound(pixel, t0);
+             i < size_[pixel] && (hit.time = Time(pixel, i)) <= t1; i++, num++) {
+            hit.event = &events_[Slot(pixel, i)];
+            result.push_back(hit);
+        }
+        return num;
+    }
+
+    /** Updates the query statistics */
+    void EndQuery(const std::chrono::steady_clock::time_point &start) {
+        queryTime_ += std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - start).count();
+        numQueries_++;
+    }
+};
+
+#endif // __PIXELCORRELATOR_HPP__
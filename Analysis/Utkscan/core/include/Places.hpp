@@ -6,16 +6,83 @@
 #ifndef __PLACES_HPP__
 #define __PLACES_HPP__
 
+#include <atomic>
 #include <deque>
 #include <iostream>
+#include <mutex>
+#include <set>
 #include <vector>
 #include <utility>
 
 #include <cstdlib>
 
+#include <stdint.h>
+
 #include "Globals.hpp"
 #include "EventData.hpp"
 
+class StateReader;
+
+class StateWriter;
+
+/** \brief Records which processors change and look up a place.
+ *
+ * Processors that share a place have to run one after the other, but they
+ * only know each other through the name of the place. When the processors run
+ * concurrently the ProcessorScheduler sets the processor of every thread, and
+ * the pairs of processors that look up a place that the other changes (or
+ * both change it) in the same phase are collected, so that the scheduler can
+ * order them. Nothing is recorded on a thread without a user.
+ */
+class PlaceUsage {
+public:
+    static const unsigned int MAX_USERS = 64; //!< The number of users that can be recorded
+
+    /** Default constructor */
+    PlaceUsage() {
+        for (unsigned int i = 0; i < 2; i++)
+            readers_[i] = writers_[i] = 0;
+    }
+
+    /** Sets the user of the places on the calling thread
+     * \param [in] user : the index of the processor, -1 to stop recording
+     * \param [in] phase : 0 for PreProcess, 1 for Process */
+    static void SetUser(const int &user, const unsigned int &phase) {
+        user_ = user;
+        phase_ = phase;
+    }
+
+    /** Records that the user of this thread looked the place up */
+    void Read() {
+        if (user_ >= 0)
+            Use(false);
+    }
+
+    /** Records that the user of this thread changed the place */
+    void Write() {
+        if (user_ >= 0)
+            Use(true);
+    }
+
+    /** Takes the pairs of users that shared a place since the last call
+     * \return the pairs, the lower index first */
+    static std::set<std::pair<unsigned int, unsigned int> > TakeShared(void);
+
+private:
+    std::atomic<uint64_t> readers_[2]; //!< The users that looked the place up, per phase
+    std::atomic<uint64_t> writers_[2]; //!< The users that changed the place, per phase
+
+    static thread_local int user_; //!< The user of the calling thread
+    static thread_local unsigned int phase_; //!< The phase of the calling thread
+    static std::atomic<bool> hasShared_; //!< True if shared_ is not empty
+    static std::mutex sharedMutex_; //!< Protects shared_
+    static std::set<std::pair<unsigned int, unsigned int> > shared_; //!< The pairs of users found
+
+    /** Records a use of the place by the user of this thread
+     * \param [in] write : true if the place was changed */
+    void Use(const bool &write);
+};
+
 /** \brief A pure abstract class to define a "place" for correlator.
  *
  * A place has physical or abstract meaning, might be a detector,
@@ -60,6 +127,8 @@ public:
      * always saves event data to the fifo.
      * \param [in] info : the info to use for the activation */
     virtual void activate(EventData &info) {
+        std::unique_lock<std::recursive_mutex> guard = lock_();
+        usage_.Write();
         if (!status_) {
             status_ = true;
             add_info_(info);
@@ -81,6 +150,8 @@ public:
      * recorded in fifo.
      * \param [in] time : the time at which to set the place */
     virtual void deactivate(double time) {
+        std::unique_lock<std::recursive_mutex> guard = lock_();
+        usage_.Write();
         if (status_) {
             status_ = false;
             EventData info(time, status_);
@@ -112,6 +183,7 @@ public:
 
     /** \return status of the place.*/
     virtual bool operator()() const {
+        std::unique_lock<std::recursive_mutex> guard = lock_();
         return status_;
     }
 
@@ -125,6 +197,7 @@ public:
      * \param [in] index : the index of the data to get from the fifo
      * \return event data in fifo */
     virtual EventData &operator[](unsigned index) {
+        std::unique_lock<std::recursive_mutex> guard = lock_();
         return info_.at(index);
     }
 
@@ -133,6 +206,7 @@ public:
      * \param [in] index : the index to get from the fifo
      * \return data in fifo */
     virtual EventData operator[](unsigned index) const {
+        std::unique_lock<std::recursive_mutex> guard = lock_();
         return info_.at(index);
     }
 
@@ -140,6 +214,7 @@ public:
      * is empty time=-1 event is returned
      * \return The last EventData entry in the fifo */
     virtual EventData last() {
+        std::unique_lock<std::recursive_mutex> guard = lock_();
         if (info_.size() > 0)
             return info_.back();
         else {
@@ -152,6 +227,7 @@ public:
      * has only one event, time=-1 event is returned.
      * \return Second to last event data */
     virtual EventData secondlast() {
+        std::unique_lock<std::recursive_mutex> guard = lock_();
         if (info_.size() > 1) {
             unsigned sz = info_.size();
             return info_.at(sz - 2);
@@ -170,6 +246,24 @@ public:
         return resetable_;
     }
 
+    /** Writes the status and the fifo of the place for the checkpoints of
+     * the scan
+     * \param [in] writer : the archive of the state */
+    virtual void SaveState(StateWriter &writer) const;
+
+    /** Reads the state written by SaveState
+     * \param [in] reader : the archive of the state */
+    virtual void LoadState(StateReader &reader);
+
+    /** Records that the processor of the calling thread looked the place
+     * up, see PlaceUsage */
+    void lookedUp() { usage_.Read(); }
+
+    /** Takes the lock of the places before every change or look up, set when
+     * the processors run concurrently
+     * \param [in] a : true to take the lock */
+    static void SetThreadSafe(const bool &a) { threadSafe_ = a; }
+
     /** Pythonic style private field. Use it if you must,
      * but perhaps you should not. Stores information on past
      * events in a given Place.*/
@@ -229,6 +323,25 @@ protected:
      * should be reported.
      */
     std::vector<Place *> parents_;
+
+    /** The processors that changed or looked up the place */
+    PlaceUsage usage_;
+
+    /** Serializes changes of status, which propagate to the parents, and
+     * the reads when the processors are run concurrently. */
+    static std::recursive_mutex mutex_;
+
+    /** True if the processors are run concurrently */
+    static bool threadSafe_;
+
+    /** \return a lock of mutex_, only taken when the processors are run
+     * concurrently */
+    static std::unique_lock<std::recursive_mutex> lock_() {
+        std::unique_lock<std::recursive_mutex> lock(mutex_, std::defer_lock);
+        if (threadSafe_)
+            lock.lock();
+        return lock;
+    }
 };
 
 /** \brief "Lazy" Place does not store multiple activation or deactivation events.
@@ -245,6 +358,8 @@ public:
      * was not active before.
      * \param [in] info : the information to use to activate the place */
     virtual void activate(EventData &info) {
+        std::unique_lock<std::recursive_mutex> guard = lock_();
+        usage_.Write();
         if (!status_) {
             status_ = true;
             add_info_(info);
@@ -256,6 +371,8 @@ public:
      * recorded in fifo only if Place was active before.
      * \param [in] time : the time to deactivate the place */
     virtual void deactivate(double time) {
+        std::unique_lock<std::recursive_mutex> guard = lock_();
+        usage_.Write();
         if (status_) {
             status_ = false;
             EventData info(time, status_);
@@ -357,6 +474,7 @@ public:
     /** Activate the place
     * \param [in] info : data to activate the place with */
     void activate(EventData &info) {
+        std::unique_lock<std::recursive_mutex> guard = lock_();
         ++counter_;
         Place::activate(info);
     }
@@ -364,6 +482,7 @@ public:
     /** Deactive the place
     * \param [in] time : the time to deactivate */
     void deactivate(double time) {
+        std::unique_lock<std::recursive_mutex> guard = lock_();
         --counter_;
         Place::deactivate(time);
     }
@@ -376,9 +495,18 @@ public:
 
     /** \return the counter for the number of activations */
     virtual int getCounter() const {
+        std::unique_lock<std::recursive_mutex> guard = lock_();
         return counter_;
     }
 
+    /** Writes the state of the place and the counter
+     * \param [in] writer : the archive of the state */
+    virtual void SaveState(StateWriter &writer) const;
+
+    /** Reads the state of the place and the counter
+     * \param [in] reader : the archive of the state */
+    virtual void LoadState(StateReader &reader);
+
 protected:
     int counter_;//!< The counter for the place activation
 
@@ -9,13 +9,153 @@
 #include <fstream>
 #include <string>
 #include <map>
+#include <mutex>
 #include <set>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "Globals.hpp"
 #include "HisFile.hpp"
 #include "PlotsRegister.hpp"
 
+class Plots;
+
+/** A handle to a declared 1D histogram. The histogram is looked up in the
+ * .his file once, on the first fill through the handle, and from then on it
+ * is kept in memory in the tiles of a SparseHisData. A fill is then a range
+ * check and an increment of the bin instead of an id lookup and a queued
+ * fill. Histograms that cannot be filled this way (e.g. in HRIBF builds,
+ * when they were declared with a channel range or were already filled
+ * with plot) are filled through Plots::Plot instead. Only histograms that
+ * are filled through a handle are kept in memory. */
+class Histogram1D {
+public:
+    /** Default constructor, fills are ignored */
+    Histogram1D() : plots_(NULL), id_(0), resolved_(true), entry_(NULL), data_(NULL),
+                    comp_(1), size_(0) {}
+
+    /** Constructor for a declared histogram
+    * \param [in] plots : the Plots that declared the histogram
+    * \param [in] id : the id relative to the offset of the Plots */
+    Histogram1D(Plots *plots, const int &id) : plots_(plots), id_(id),
+            resolved_(false), entry_(NULL), data_(NULL), comp_(1), size_(0) {}
+
+    /** \return true if the handle points to a declared histogram */
+    bool IsValid() const { return plots_ != NULL; }
+
+    /** \return true if the fills go straight into memory, which is only
+     * known after the first fill */
+    bool IsDirect() const { return data_ != NULL; }
+
+    /** Increment the bin of a value
+    * \param [in] x : the x value, truncated like in Plots::Plot
+    * \param [in] weight : the amount to increment the bin by */
+    inline void Fill(const double &x, const unsigned int &weight = 1);
+
+    /** Increment the bins of a list of values
+    * \param [in] x : the x values
+    * \param [in] weight : the amount to increment each bin by */
+    void Fill(const std::vector<double> &x, const unsigned int &weight = 1);
+
+private:
+    Plots *plots_; //!< The Plots that declared the histogram
+    int id_; //!< The id relative to the offset of plots_
+    bool resolved_; //!< True once the histogram was looked up
+    drr_entry *entry_; //!< The .drr entry holding the fill counters
+    SparseHisData *data_; //!< The bins, NULL if filled through Plots::Plot
+    unsigned int comp_; //!< Compression of the x axis
+    unsigned int size_; //!< Number of bins on the x axis
+
+    /** Look up the histogram and fill it, through Plots::Plot if it cannot
+     * be kept in memory
+    * \param [in] x : the x value
+    * \param [in] weight : the amount to increment the bin by */
+    void FillSlow(const double &x, const unsigned int &weight);
+
+    /** Increment a bin without locking
+    * \param [in] x : the x value
+    * \param [in] weight : the amount to increment the bin by
+    * \return true if the value was in range */
+    bool Add(const double &x, const unsigned int &weight) {
+        unsigned int bin = (unsigned int) (int) x / comp_;
+        entry_->total_counts++;
+        if (bin >= size_)
+            return false;
+        data_->Add(bin, weight);
+        entry_->good_counts++;
+        return true;
+    }
+};
+
+/** A handle to a declared 2D histogram, see Histogram1D */
+class Histogram2D {
+public:
+    /** Default constructor, fills are ignored */
+    Histogram2D() : plots_(NULL), id_(0), resolved_(true), entry_(NULL), data_(NULL),
+                    compX_(1), compY_(1), sizeX_(0), sizeY_(0) {}
+
+    /** Constructor for a declared histogram
+    * \param [in] plots : the Plots that declared the histogram
+    * \param [in] id : the id relative to the offset of the Plots */
+    Histogram2D(Plots *plots, const int &id) : plots_(plots), id_(id),
+            resolved_(false), entry_(NULL), data_(NULL), compX_(1), compY_(1), sizeX_(0), sizeY_(0) {}
+
+    /** \return true if the handle points to a declared histogram */
+    bool IsValid() const { return plots_ != NULL; }
+
+    /** \return true if the fills go straight into memory, which is only
+     * known after the first fill */
+    bool IsDirect() const { return data_ != NULL; }
+
+    /** Increment the bin of a pair of values
+    * \param [in] x : the x value, truncated like in Plots::Plot
+    * \param [in] y : the y value, truncated like in Plots::Plot
+    * \param [in] weight : the amount to increment the bin by */
+    inline void Fill(const double &x, const double &y,
+                     const unsigned int &weight = 1);
+
+    /** Increment the bins of a list of pairs of values
+    * \param [in] xy : the x,y values
+    * \param [in] weight : the amount to increment each bin by */
+    void Fill(const std::vector<std::pair<double, double> > &xy,
+              const unsigned int &weight = 1);
+
+private:
+    Plots *plots_; //!< The Plots that declared the histogram
+    int id_; //!< The id relative to the offset of plots_
+    bool resolved_; //!< True once the histogram was looked up
+    drr_entry *entry_; //!< The .drr entry holding the fill counters
+    SparseHisData *data_; //!< The bins, NULL if filled through Plots::Plot
+    unsigned int compX_; //!< Compression of the x axis
+    unsigned int compY_; //!< Compression of the y axis
+    unsigned int sizeX_; //!< Number of bins on the x axis, also the stride of y
+    unsigned int sizeY_; //!< Number of bins on the y axis
+
+    /** Look up the histogram and fill it, through Plots::Plot if it cannot
+     * be kept in memory
+    * \param [in] x : the x value
+    * \param [in] y : the y value
+    * \param [in] weight : the amount to increment the bin by */
+    void FillSlow(const double &x, const double &y, const unsigned int &weight);
+
+    /** Increment a bin without locking
+    * \param [in] x : the x value
+    * \param [in] y : the y value
+    * \param [in] weight : the amount to increment the bin by
+    * \return true if the values were in range */
+    bool Add(const double &x, const double &y, const unsigned int &weight) {
+        unsigned int binX = (unsigned int) (int) x / compX_;
+        unsigned int binY = (unsigned int) (int) y / compY_;
+        entry_->total_counts++;
+        if (binX >= sizeX_ || binY >= sizeY_)
+            return false;
+        data_->Add((size_t) binY * sizeX_ + binX, weight);
+        entry_->good_counts++;
+        return true;
+    }
+};
+
 //! Holds pointers to all Histograms
 class Plots {
 public:
@@ -54,11 +194,11 @@ public:
     * \param [in] xLow : the Low range of the histogram
     * \param [in] xHigh : the High range of the histogram
     * \param [in] mne : the mnemonic for the histogram
-    * \return true if things go all right */
-    bool DeclareHistogram1D(int dammId, int xSize, const char *title,
-                            int halfWordsPerChan, int xHistLength, int xLow,
-                            int xHigh,
-                            const std::string &mne = "");
+    * \return a handle to the histogram */
+    Histogram1D DeclareHistogram1D(int dammId, int xSize, const char *title,
+                                   int halfWordsPerChan, int xHistLength, int xLow,
+                                   int xHigh,
+                                   const std::string &mne = "");
 
     /*! \brief Declares a 1D histogram calls the C++ wrapper for DAMM
     * \param [in] dammId : The histogram number to define
@@ -66,10 +206,10 @@ public:
     * \param [in] title : The title for the histogram
     * \param [in] halfWordsPerChan : the half words per channel in the his
     * \param [in] mne : the mnemonic for the histogram
-    * \return true if things go all right */
-    bool DeclareHistogram1D(int dammId, int xSize, const char *title,
-                            int halfWordsPerChan = 2,
-                            const std::string &mne = "");
+    * \return a handle to the histogram */
+    Histogram1D DeclareHistogram1D(int dammId, int xSize, const char *title,
+                                   int halfWordsPerChan = 2,
+                                   const std::string &mne = "");
 
     /*! \brief Declares a 1D histogram calls the C++ wrapper for DAMM
     * \param [in] dammId : The histogram number to define
@@ -78,10 +218,10 @@ public:
     * \param [in] halfWordsPerChan : the half words per channel in the his
     * \param [in] contraction : the histogram contraction number
     * \param [in] mne : the mnemonic for the histogram
-    * \return true if things go all right */
-    bool DeclareHistogram1D(int dammId, int xSize, const char *title,
-                            int halfWordsPerChan, int contraction,
-                            const std::string &mne = "");
+    * \return a handle to the histogram */
+    Histogram1D DeclareHistogram1D(int dammId, int xSize, const char *title,
+                                   int halfWordsPerChan, int contraction,
+                                   const std::string &mne = "");
 
     /*! \brief Declares a 2D histogram calls the C++ wrapper for DAMM
     * \param [in] dammId : The histogram number to define
@@ -96,11 +236,11 @@ public:
     * \param [in] yLow : the Low for the y-range of the histogram
     * \param [in] yHigh : the High for the y-range of the histogram
     * \param [in] mne : the mnemonic for the histogram
-    * \return true if things go all right */
-    bool DeclareHistogram2D(int dammId, int xSize, int ySize, const char *title,
-                            int halfWordsPerChan, int xHistLength, int xLow,
-                            int xHigh, int yHistLength, int yLow, int yHigh,
-                            const std::string &mne = "");
+    * \return a handle to the histogram */
+    Histogram2D DeclareHistogram2D(int dammId, int xSize, int ySize, const char *title,
+                                   int halfWordsPerChan, int xHistLength, int xLow,
+                                   int xHigh, int yHistLength, int yLow, int yHigh,
+                                   const std::string &mne = "");
 
     /*! \brief Declares a 2D histogram calls the C++ wrapper for DAMM
     * \param [in] dammId : The histogram number to define
@@ -109,10 +249,10 @@ public:
     * \param [in] title : The title of the histogram
     * \param [in] halfWordPerChan : the half words per channel in the his
     * \param [in] mne : the mnemonic for the histogram
-    * \return true if things go all right */
-    bool DeclareHistogram2D(int dammId, int xSize, int ySize, const char *title,
-                            int halfWordPerChan = 1,
-                            const std::string &mne = "");
+    * \return a handle to the histogram */
+    Histogram2D DeclareHistogram2D(int dammId, int xSize, int ySize, const char *title,
+                                   int halfWordPerChan = 1,
+                                   const std::string &mne = "");
 
     /*! \brief Declares a 2D histogram calls the C++ wrapper for DAMM
     * \param [in] dammId : The histogram number to define
@@ -123,10 +263,10 @@ public:
     * \param [in] xContraction : the histogram x contraction number
     * \param [in] yContraction : the histogram y contraction number
     * \param [in] mne : the mnemonic for the histogram
-    * \return true if things go all right */
-    bool DeclareHistogram2D(int dammId, int xSize, int ySize, const char *title,
-                            int halfWordsPerChan, int xContraction,
-                            int yContraction, const std::string &mne = "");
+    * \return a handle to the histogram */
+    Histogram2D DeclareHistogram2D(int dammId, int xSize, int ySize, const char *title,
+                                   int halfWordsPerChan, int xContraction,
+                                   int yContraction, const std::string &mne = "");
 
     /*! \brief Plots into histogram defined by dammId
     * \param [in] dammId : The histogram number to define
@@ -151,14 +291,47 @@ public:
     /** Method to test if a parameter is inside of a loaded banana
     *
     * Will not help you defend against a man wielding a pointed stick.
+    * Bananas loaded into the BananaLibrary are tested natively, others are
+    * passed on to bantesti_.
     * \param [in] id : the banana id to look at
     * \param [in] x : the x value to check
     * \param [in] y : the y value to check
     * \return true if the x,y coordinate was inside the banana */
     bool BananaTest(const int &id, const double &x, const double &y);
 
+    /** Method to test a list of parameters against a loaded banana
+    * \param [in] id : the banana id to look at
+    * \param [in] points : the x,y values to check
+    * \param [out] result : 1 for every point inside the banana, 0 otherwise
+    * \return the number of points inside the banana */
+    unsigned int BananaTest(const int &id,
+                            const std::vector<std::pair<double, double> > &points,
+                            std::vector<unsigned char> &result);
+
+    /** Serialize the filling of histograms so that Plot may be called from
+     * several threads at once. Used when the processors run concurrently.
+     * \param [in] a : true if histograms are filled from several threads */
+    static void SetThreadSafe(const bool &a) { threadSafe_ = a; }
+
+    /** \return true if histograms are filled from several threads */
+    static bool IsThreadSafe(void) { return threadSafe_; }
+
+    /** Stops filling the 2D histograms, used by an online scan that sheds
+     * load. Only changed between two spills.
+     * \param [in] a : true to skip the fills of the 2D histograms */
+    static void SetSkip2D(const bool &a) { skip2D_ = a; }
+
+    /** \return true if the 2D histograms are not filled */
+    static bool IsSkipping2D(void) { return skip2D_; }
+
 private:
+    friend class Histogram1D;
+    friend class Histogram2D;
+
     static PlotsRegister *plots_register_;//!< Instance of the plots register
+    static bool threadSafe_; //!< True if fills need to be serialized
+    static bool skip2D_; //!< True if the 2D histograms are not filled
+    static std::mutex fillMutex_; //!< Serializes the fills when threadSafe_
     /** Holds offset for a given set of plots */
     int offset_;
     /** Holds allowed range for a given set of plots*/
@@ -178,4 +351,33 @@ private:
     int Round(double val) const;
 };
 
+inline void Histogram1D::Fill(const double &x, const unsigned int &weight/*=1*/) {
+    if (!data_) {
+        FillSlow(x, weight);
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(Plots::fillMutex_, std::defer_lock);
+    if (Plots::threadSafe_)
+        lock.lock();
+    if (Add(x, weight))
+        output_his->CountSparseFills();
+}
+
+inline void Histogram2D::Fill(const double &x, const double &y,
+                              const unsigned int &weight/*=1*/) {
+    if (Plots::skip2D_)
+        return;
+    if (!data_) {
+        FillSlow(x, y, weight);
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(Plots::fillMutex_, std::defer_lock);
+    if (Plots::threadSafe_)
+        lock.lock();
+    if (Add(x, y, weight))
+        output_his->CountSparseFills();
+}
+
 #endif // __PLOTS_HPP_
@@ -0,0 +1,168 @@
+/*! \file ProcessorScheduler.hpp
+ *  \brief Schedules the PreProcess and Process calls of the EventProcessors
+ *  \date October 19, 2026
+ *
+ * Processors may declare that they use the results of other processors with
+ * EventProcessor::AddDependency (or the "depends" attribute of the Processor
+ * node in the configuration). The scheduler orders the processors so that a
+ * processor only runs after all of its dependencies, and groups them into
+ * levels in which no processor depends on another. When more than one thread
+ * is requested (the "threads" attribute of the DetectorDriver node) the
+ * processors of a level are run concurrently. With a single thread, or if no
+ * dependencies are declared, the processors are run one after the other in
+ * the order of the configuration file, exactly as before.
+ *
+ * Processors also share results through the places of the TreeCorrelator.
+ * A concurrent scan runs its first LEARNING_EVENTS events one processor at a
+ * time and records the processors that change a place that another one looks
+ * up in the same phase (see PlaceUsage). Every such pair runs in the order of
+ * the schedule from then on. A pair that is only found later stops the scan,
+ * it needs a "depends" attribute in the configuration.
+*/
+#ifndef __PROCESSORSCHEDULER_HPP__
+#define __PROCESSORSCHEDULER_HPP__
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <ostream>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+class EventProcessor;
+
+class RawEvent;
+
+//! Runs the EventProcessors of an event according to their dependencies
+class ProcessorScheduler {
+public:
+    /** Default constructor */
+    ProcessorScheduler();
+
+    /** Default destructor, stops the worker threads */
+    ~ProcessorScheduler();
+
+    /** Builds the schedule for a list of processors.
+     * \param [in] procs : the processors in the order they were configured
+     * \param [in] numThreads : the number of threads used to run a level
+     * \throw GeneralException if the dependencies contain a cycle */
+    void SetProcessors(const std::vector<EventProcessor *> &procs,
+                       const unsigned int &numThreads);
+
+    /** Calls PreProcess for every processor which has an event
+     * \param [in] event : the event to process */
+    void PreProcess(RawEvent &event) { Run(event, PREPROCESS); }
+
+    /** Calls Process for every processor which has an event
+     * \param [in] event : the event to process */
+    void Process(RawEvent &event) { Run(event, PROCESS); }
+
+    /** Stops calling some of the processors, used by an online scan that
+     * sheds load. The processors that depend on them, directly or through
+     * other processors, are skipped as well since their results would be
+     * built on the last event the skipped processors saw.
+     * \param [in] names : the names of the processors to skip, an empty set
+     *  runs all of them again */
+    void SetSkipped(const std::set<std::string> &names);
+
+    /** \param [in] name : the name of a processor
+     * \return true if the processor is skipped, by name or as a dependent */
+    bool IsSkipped(const std::string &name) const;
+
+    /** \return true if the processors of a level are run concurrently */
+    bool IsConcurrent(void) const { return !workers_.empty(); }
+
+    /** \return true while the processors sharing places are learned */
+    bool IsLearning(void) const { return learning_ > 0; }
+
+    static const unsigned long LEARNING_EVENTS = 1000; //!< Events run one processor at a time by a concurrent scan
+
+    /** Prints the wall clock time spent in every processor and the critical
+     * path through the dependency graph.
+     * \param [in] out : the stream to print to */
+    void PrintStatistics(std::ostream &out) const;
+
+private:
+    enum Phase {
+        PREPROCESS, PROCESS, NUM_PHASES
+    };
+
+    //! A processor and its place in the dependency graph
+    struct Node {
+        EventProcessor *proc; //!< The processor
+        unsigned int index; //!< The position of the processor in the configuration
+        std::vector<unsigned int> parents; //!< Nodes this one depends on
+        unsigned int level; //!< Length of the longest chain of parents
+        bool active; //!< True if the processor has an event
+        bool skipped; //!< True if the processor is not called
+        double latency; //!< Wall time of the last call in seconds
+        double finish; //!< Time at which the node finished in this event
+        double time[NUM_PHASES]; //!< Total wall time per phase in seconds
+        unsigned long calls[NUM_PHASES]; //!< Number of calls per phase
+        double path[NUM_PHASES]; //!< Total time along the critical path to this node
+    };
+
+    std::vector<Node> nodes_; //!< Nodes in dependency order
+    std::vector<std::vector<unsigned int> > levels_; //!< Nodes grouped by level
+    std::vector<unsigned int> order_; //!< Nodes in the order of the configuration, run when not concurrent
+    std::vector<EventProcessor *> procs_; //!< The processors in the order of the configuration
+    std::set<std::string> skippedNames_; //!< The processors skipped by name
+    std::set<std::pair<unsigned int, unsigned int> > placeEdges_; //!< Processors ordered since they share a place
+    unsigned int numThreads_; //!< The number of threads requested
+    unsigned long learning_; //!< Events left to run one processor at a time
+    bool hasDependencies_; //!< True if any processor declared a dependency
+    double criticalPath_[NUM_PHASES]; //!< Summed critical path per phase
+    unsigned long numEvents_[NUM_PHASES]; //!< Number of events scheduled
+
+    std::vector<std::thread> workers_; //!< The worker threads
+    std::mutex mutex_; //!< Protects the hand off of tasks to the workers
+    std::condition_variable wake_; //!< Signals the workers that tasks are ready
+    std::condition_variable done_; //!< Signals that a worker has finished
+    bool stop_; //!< Tells the workers to exit
+    unsigned long generation_; //!< Counts the levels handed to the workers
+    unsigned int busy_; //!< Number of workers working on the current level
+    std::vector<unsigned int> tasks_; //!< Nodes of the current level
+    std::atomic<unsigned int> next_; //!< Next task to be picked up
+    RawEvent *event_; //!< The event of the current level
+    Phase phase_; //!< The phase of the current level
+    std::exception_ptr error_; //!< First exception thrown by a task
+
+    /** Builds the nodes and levels from the dependencies of the processors
+     * and the places they share, keeping the statistics of the nodes
+     * \throw GeneralException if the dependencies contain a cycle */
+    void Build(void);
+
+    /** Orders the processors found to share a place
+     * \throw GeneralException if a pair is found after the learning */
+    void OrderSharedPlaces(void);
+
+    /** Skips the processors named in skippedNames_ and their dependents */
+    void Skip(void);
+
+    /** \return true if node a is an ancestor of node b */
+    bool IsAncestor(const unsigned int &a, const unsigned int &b) const;
+
+    /** Runs one phase for all processors */
+    void Run(RawEvent &event, const Phase &phase);
+
+    /** Calls the processor of node for the given phase and times it */
+    void RunNode(Node &node, RawEvent &event, const Phase &phase);
+
+    /** Runs the tasks of the current level until none are left */
+    void RunTasks(void);
+
+    /** Runs a level on the worker threads and the calling thread */
+    void RunLevel(const std::vector<unsigned int> &level, RawEvent &event,
+                  const Phase &phase);
+
+    /** Main loop of the worker threads */
+    void Worker(void);
+
+    /** Stops and joins all of the worker threads */
+    void StopWorkers(void);
+};
+
+#endif // __PROCESSORSCHEDULER_HPP__
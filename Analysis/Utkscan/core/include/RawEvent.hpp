@@ -11,6 +11,7 @@
 #ifndef __RAWEVENT_HPP_
 #define __RAWEVENT_HPP_
 
+#include <deque>
 #include <iostream>
 #include <map>
 #include <set>
@@ -26,8 +27,9 @@
  * The rawevent serves as the basis for the experimental analysis.  The rawevent
  * includes a vector of individual channels that have been deemed to be close to
  * each other in time.  This determination is performed in ScanList() from
- * PixieStd.cpp.  The rawevent also includes a map of detector summaries which
- * contains a detector summary for each detector type that is used in the analysis
+ * PixieStd.cpp.  The rawevent also includes the detector summaries, one for each
+ * summary registered in the DetectorLibrary and indexed by the id of the
+ * summary. The summaries keep their address for the whole analysis.
  *
  *  The rawevent is intended to be versatile enough to remain unaltered unless
  * LARGE changes are made to the pixie16 code.  Be careful when altering the
@@ -47,8 +49,8 @@ public:
     /** \return the number of channels in the current event */
     size_t Size(void) const { return (eventList.size()); };
 
-    /** \brief Raw event initialization and set the rawevent detector summary
-    * map with the passed argument.
+    /** \brief Raw event initialization, registers a detector summary for
+    * every type passed as argument.
     * \param [in] usedTypes : the list of types used in the analysis
     */
     void Init(const std::set<std::string> &usedTypes);
@@ -59,15 +61,30 @@ public:
 
     /** \brief Raw event zeroing
     *
-    * For any detector type that was used in the event, zero the appropriate
-    * detector summary in the map, and clear the event list
-    * \param [in] usedev : the detector summary to zero */
-    void Zero(const std::set<std::string> &usedev);
+    * Zero the detector summaries that were filled or handed out during the
+    * event, delete the channels and clear the event list */
+    void Zero(void);
+
+    /** Kept for older code, the list of used detectors is not needed
+    * \param [in] usedev : unused */
+    void Zero(const std::set<std::string> &usedev) { Zero(); }
+
+    /** Adds a channel to every summary it belongs to, using the lists of
+    * summary ids of the DetectorLibrary
+    * \param [in] event : the channel to add */
+    void AddToSummaries(ChanEvent *event);
+
+    /** \return the summary with the given id, see
+    * DetectorLibrary::GetSummaryId. It is only valid until the end of the
+    * analysis like the summaries returned by name.
+    * \param [in] id : the id of the summary */
+    DetectorSummary *GetSummary(const unsigned int &id);
 
     /** \brief Get a pointer to a specific detector summary
     *
-    * Retrieve from the detector summary map a pointer to the specific detector
-    * summary that is associated with the passed string.
+    * Retrieve a pointer to the specific detector summary that is associated
+    * with the passed string. The name is looked up in the registry of the
+    * DetectorLibrary, prefer keeping the id in code that runs for every event.
     * \param [in] a : the summary that you would like
     * \param [in] construct : flag indicating if we need to construct the summary
     * \return a pointer to the summary */
@@ -81,8 +98,24 @@ public:
     const std::vector<ChanEvent *> &GetEventList(void) const { return eventList; }
 
 private:
-    std::map<std::string, DetectorSummary> sumMap; /**< An STL map containing DetectorSummary classes
-					    associated with detector types */
+    /** Constructs the summaries registered since the last call
+    * \param [in] fill : true to add the channels of the current event that
+    * belong to them */
+    void UpdateSummaries(const bool &fill);
+
+    /** Remembers that a summary has to be zeroed at the end of the event
+    * \param [in] id : the id of the summary */
+    void Touch(const unsigned int &id) {
+        if (!isTouched_[id]) {
+            isTouched_[id] = true;
+            touched_.push_back(id);
+        }
+    }
+
+    std::deque<DetectorSummary> summaries_; /**< The summaries indexed by their id, a deque keeps
+                                               their address when more are registered */
+    std::vector<bool> isTouched_; //!< True for the summaries in touched_
+    std::vector<unsigned int> touched_; //!< The summaries to zero at the end of the event
     mutable std::set<std::string> nullSummaries;   /**< Summaries which were requested but don't exist */
     std::vector<ChanEvent *> eventList; /**< Pointers to all the channels that are close
                                             enough in time to be considered a single event */
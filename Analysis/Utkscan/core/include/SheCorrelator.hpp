@@ -5,10 +5,11 @@
 #ifndef __SHECORRELATOR_HPP_
 #define __SHECORRELATOR_HPP_
 
-#include <vector>
-#include <deque>
+#include <ostream>
 #include <sstream>
 
+#include "PixelCorrelator.hpp"
+
 ///An enumeration of the different super heavy event types
 enum SheEventType {
     alpha,
@@ -22,15 +23,18 @@ enum SheEventType {
 class SheEvent {
 public:
     /** Default Constructor */
-    SheEvent();
+    SheEvent() : energy_(-1.0), time_(-1.0), mwpc_(-1), has_veto_(false),
+                 has_beam_(false), has_escape_(false), type_(unknown) {}
 
     /** Constructor taking arguments */
     SheEvent(double energy, double time, int mwpc,
              bool has_beam, bool has_veto, bool has_escape,
-             SheEventType type = unknown);
+             SheEventType type = unknown) :
+            energy_(energy), time_(time), mwpc_(mwpc), has_veto_(has_veto),
+            has_beam_(has_beam), has_escape_(has_escape), type_(type) {}
 
-    /** Default destructor */
-    ~SheEvent() {}
+    /** No destructor is declared, the checkpoints write the events of the
+     * correlator as raw bytes which needs a trivially copyable class. */
 
     /** \return true if we had beam */
     bool get_beam() const { return has_beam_; }
@@ -94,8 +98,19 @@ private:
 ///Class to handle correlations for super heavy event experiments
 class SheCorrelator {
 public:
-    /** Constructor taking x and y size */
-    SheCorrelator(int size_x, int size_y);
+    /** Constructor taking x and y size
+     * \param [in] size_x : the highest x strip
+     * \param [in] size_y : the highest y strip
+     * \param [in] capacity : the maximum number of events in a chain, the
+     * oldest event is dropped when a pixel is full
+     * \param [in] corrTime : events older than this (in seconds) with respect
+     * to the last event of a pixel are dropped from its chain, a value <= 0
+     * keeps them until the chain is flushed
+     *
+     * A chain that loses its heavy ion this way is reported, since it can
+     * no longer be recognized when it is flushed. */
+    SheCorrelator(int size_x, int size_y, unsigned int capacity = 64,
+                  double corrTime = 0);
 
     /** Default Destructor */
     ~SheCorrelator();
@@ -104,15 +119,31 @@ public:
     bool add_event(SheEvent &event, int x, int y);
 
     /** provides human readable event info */
-    void human_event_info(SheEvent &event, std::stringstream &ss,
+    void human_event_info(const SheEvent &event, std::stringstream &ss,
                           double clockStart);
 
+    /** prints the memory usage and the query statistics of the pixels */
+    void print_statistics(std::ostream &out) const {
+        pixels_.PrintStatistics(out, "SheCorrelator");
+        out << "  " << lostChains_ << " chains lost their heavy ion" << std::endl;
+    }
+
+    /** writes the chains of every pixel for the checkpoints of the scan */
+    void save_state(StateWriter &writer) const { pixels_.SaveState(writer); }
+
+    /** reads the chains written by save_state */
+    void load_state(StateReader &reader) { pixels_.LoadState(reader); }
+
 private:
     int size_x_; //!< size in the x direction
     int size_y_; //!< size in the y direction 
-    std::deque<SheEvent> **pixels_; //!< deque of the pixels hit
+    PixelCorrelator<SheEvent> pixels_; //!< the chain of events in every pixel
+    unsigned long lostChains_; //!< the number of chains that lost their heavy ion
     /** flushes the chain */
     bool flush_chain(int x, int y);
+    /** reports the heavy ion of a chain that is about to be dropped to make
+     * room for an event at time */
+    void check_head(int x, int y, double time);
 };
 
 #endif
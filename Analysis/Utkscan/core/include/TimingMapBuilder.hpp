@@ -23,7 +23,7 @@ public:
     TimingMapBuilder(const std::vector<ChanEvent *> &evts);
 
     /** \return The map of events that had high resolution timing data. */
-    TimingMap GetMap(void) { return (map_); };
+    const TimingMap &GetMap(void) const { return (map_); };
 private:
     /** Fills finds all of the events that had high resolution timing data in
      * the vector of channel events
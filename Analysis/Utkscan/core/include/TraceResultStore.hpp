@@ -0,0 +1,144 @@
+/*! \file TraceResultStore.hpp
+ *  \brief Keeps the results of the trace analysis of every hit in a file next
+ *  to the input, so that scanning the same file again does not analyze the
+ *  traces again
+ *  \date October 19, 2026
+ *
+ * The store is configured with a TraceResultStore node in the configuration
+ * file, e.g.
+ * \code
+ * <TraceResultStore path="./trace_results/"/>
+ * \endcode
+ * Scanning run_012.pld writes run_012.pld.trs into the path, which defaults
+ * to the output path of the scan. The first scan analyzes every trace and
+ * stores the results, the scans that follow take them from the store instead
+ * of running the Analyzers of the DetectorDriver. A hit is found by its
+ * crate, its channel and its time stamp, so that the hits of the crates of a
+ * scan with several inputs are kept apart. Every result is stored with a hash of the
+ * Analyzer nodes and of the parameters of its channel in the Map (trace
+ * delay, waveform range, filters, CFD and fitting parameters, ...), a result
+ * whose parameters changed is analyzed again and replaces the stored one.
+ *
+ * The file is "PAASSTRS" and a version followed by records of a 32 bit
+ * crate, a 32 bit channel, a 64 bit time, the 64 bit hash of the parameters, the analysis
+ * time in seconds as a float and the results, preceded by their 32 bit length.
+ * The Analyzers do not fill their own histograms for the hits that are found.
+*/
+#ifndef __TRACERESULTSTORE_HPP__
+#define __TRACERESULTSTORE_HPP__
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <stdint.h>
+
+#include "pugixml.hpp"
+
+class ChanEvent;
+class ChannelConfiguration;
+class Trace;
+
+//! Stores the results of the trace analysis of the hits of an input file
+class TraceResultStore {
+public:
+    /** Constructor
+     * \param [in] node : the TraceResultStore node of the configuration */
+    TraceResultStore(const pugi::xml_node &node);
+
+    /** Destructor, writes the new results and reports the hit rate */
+    ~TraceResultStore();
+
+    /** Sets the hash of the analysis parameters of every channel
+     * \param [in] a : the hashes indexed by the id of the channel, 0 for the
+     *  channels whose traces are not analyzed */
+    void SetParameterHashes(const std::vector<uint64_t> &a) { hashes_ = a; }
+
+    /** Switches to the store of an input file when it changed, writing the
+     * new results of the previous one
+     * \param [in] input : the path of the input file */
+    void SetInputFile(const std::string &input);
+
+    /** Takes the results of a hit from the store
+     * \param [in] chan : the hit
+     * \param [in,out] trace : the trace of the hit, receives the results
+     * \return true if the results were found, false if the trace needs to be
+     *  analyzed */
+    bool Load(const ChanEvent &chan, Trace &trace);
+
+    /** Adds the results of a hit that was analyzed
+     * \param [in] chan : the hit
+     * \param [in] trace : the analyzed trace
+     * \param [in] seconds : the time the analysis took */
+    void Save(const ChanEvent &chan, Trace &trace, const double &seconds);
+
+    /** Writes the results that were added to the store of the current file */
+    void Flush(void);
+
+    /** \return the number of hits whose results were found */
+    unsigned long GetNumHits(void) const { return numHits_; }
+
+    /** \return the number of hits that were analyzed */
+    unsigned long GetNumMisses(void) const { return numMisses_; }
+
+    /** \return the analysis time of the hits that were found, minus the
+     * time it took to load them */
+    double GetSecondsSaved(void) const { return secondsSaved_ - loadSeconds_; }
+
+    /** Hashes the parameters that change the results of the analysis of a
+     * channel
+     * \param [in] cfg : the configuration of the channel
+     * \param [in] configuration : the Configuration node, its Global node
+     *  and the Analyzers of its DetectorDriver are hashed
+     * \return the 64 bit FNV-1a hash, never 0 */
+    static uint64_t HashParameters(const ChannelConfiguration &cfg, const pugi::xml_node &configuration);
+
+    static const char MAGIC[8]; //!< The first bytes of a store
+    static const uint32_t VERSION = 2; //!< Increased when the format changes
+
+private:
+    //! The crate, the channel and the time of a hit
+    struct Key {
+        uint32_t crate; //!< The crate of the hit
+        uint32_t id; //!< The id of the channel
+        uint64_t time; //!< The time stamp of the hit in clock ticks
+
+        /** \return true if the two keys are the same hit */
+        bool operator==(const Key &rhs) const { return crate == rhs.crate && id == rhs.id && time == rhs.time; }
+    };
+
+    //! Hashes a Key for the unordered_map
+    struct KeyHash {
+        /** \return the hash of the key */
+        size_t operator()(const Key &key) const { return (key.time * 16777619 ^ key.id) * 31 + key.crate; }
+    };
+
+    //! Where the results of a hit are in the loaded store
+    struct Entry {
+        size_t offset; //!< The offset of the results in data_
+        uint32_t size; //!< The number of bytes of the results
+        float seconds; //!< The time the analysis took
+    };
+
+    /** Reads the store of the input file, keeping the records whose
+     * parameters did not change */
+    void Read(void);
+
+    /** \return the key of a hit */
+    static Key MakeKey(const ChanEvent &chan);
+
+    std::string path_; //!< The directory of the stores
+    std::string fileName_; //!< The store of the current input file
+    std::string input_; //!< The current input file
+    std::vector<uint64_t> hashes_; //!< The hash of the parameters of every channel
+    std::string data_; //!< The loaded store
+    std::unordered_map<Key, Entry, KeyHash> entries_; //!< The loaded results of every hit
+    std::string added_; //!< The records of the hits analyzed since the store was read or written
+    bool rewrite_; //!< True if the store holds stale records and is written again
+    unsigned long numHits_; //!< Number of hits whose results were found
+    unsigned long numMisses_; //!< Number of hits that were analyzed
+    double secondsSaved_; //!< The analysis time of the hits that were found
+    double loadSeconds_; //!< The time spent loading the results
+};
+
+#endif // __TRACERESULTSTORE_HPP__
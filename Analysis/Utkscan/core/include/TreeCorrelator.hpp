@@ -52,6 +52,15 @@ public:
     */
     void buildTree();
 
+    /** Writes the state of every place for the checkpoints of the scan
+    * \param [in] writer : the archive of the state */
+    void SaveState(StateWriter &writer) const;
+
+    /** Reads the state written by SaveState
+    * \param [in] reader : the archive of the state
+    * \throw TreeCorrelatorException if a saved place does not exist */
+    void LoadState(StateReader &reader);
+
     /** Default Destructor */
     ~TreeCorrelator();
 
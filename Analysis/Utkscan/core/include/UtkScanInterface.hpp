@@ -8,6 +8,8 @@
 #include <ScanInterface.hpp>
 #include <XiaData.hpp>
 
+class HistogramServer;
+
 ///Class derived from ScanInterface to handle UI for the scan.
 class UtkScanInterface : public ScanInterface {
 public:
@@ -22,8 +24,44 @@ public:
      * \param[in]  prefix_ String to append to the beginning of system output.
      * \return True upon successfully initializing and false otherwise. */
     bool Initialize(std::string prefix_ = "");
+
+    /** Publish the live histograms between spills and while waiting for
+     * data, if they were enabled in the configuration. */
+    void IdleTask();
+
+    /** Passes the input file to the Globals when a file is opened, the
+     * trace results are stored next to it
+     * \param[in] code_ The action, LOAD_FILE when a file was opened */
+    void Notify(const std::string &code_ = "");
+
+    /** Adds the histograms and the places of the TreeCorrelator to a
+     * checkpoint, the unpacker saved the processors before
+     * \param[in] writer The archive of the checkpoint */
+    void SaveState(StateWriter &writer);
+
+    /** Loads the histograms and the places written by SaveState. The ROOT
+     * output and the skim are not part of the checkpoint, they only get the
+     * events that follow it.
+     * \param[in] reader The archive of the checkpoint */
+    void LoadState(StateReader &reader);
+
+    /** Switches the DetectorDriver to a degradation level of the
+     * LoadShedding node, when an online scan falls behind or catches up
+     * \param[in] level_ The degradation level, 0 for the full analysis */
+    void SetLoadLevel(const unsigned int &level_);
 private:
+    /** Sets up the trigger-centred event building from the
+     * /Configuration/Global/TriggeredEvents node, if it exists. The Trigger
+     * children select the channels that open events, the Window children
+     * give the pre and post trigger windows of the channels. Both select the
+     * channels by type and optionally subtype and tag, the last Window that
+     * matches a channel is used. The channels without a Window use the pre
+     * and post of the TriggeredEvents node, 0 and the event width by default.
+     * \throw invalid_argument if there are no triggers or a window is negative */
+    void InitializeTriggeredEvents();
+
     bool init_; /// Set to true when the initialization process successfully completes.
+    HistogramServer *server_; /// Answers queries for the live histograms, NULL if disabled.
     std::string outputFname_; /// The output histogram filename prefix.
 };
 
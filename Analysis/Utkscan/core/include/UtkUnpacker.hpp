@@ -7,9 +7,11 @@
 #define __UTKUNPACKER_HPP__
 
 #include <ctime>
+#include <string>
 
 #include "DetectorDriver.hpp"
 #include "DetectorLibrary.hpp"
+#include "EventCache.hpp"
 #include "RawEvent.hpp"
 #include "Unpacker.hpp"
 
@@ -21,16 +23,65 @@
 class UtkUnpacker : public Unpacker {
 public:
     /// Default constructor that does nothing in particular
-    UtkUnpacker() : Unpacker() {}
+    UtkUnpacker() : Unpacker(), isDriverInitialized_(false), isReplay_(false), eventCounter_(0),
+                    lastTimeOfPreviousEvent_(0), systemStartTime_(0), cache_(NULL) {}
 
-    /// Default destructor that deconstructs the DetectorDriver singleton
+    /// Default destructor that closes the event cache and deconstructs the
+    /// DetectorDriver singleton
     ~UtkUnpacker();
 
+    ///@brief Checks that an event cache was written with the Map, Global,
+    /// Crates and Analyzers of this configuration, see EventCache.
+    ///@param[in] header The header block of the cache.
+    ///@return True if the cache may be replayed.
+    bool OpenEventCache(const std::string &header);
+
+    ///@brief Processes the cached events of a spill. They skip the
+    /// calibration and the trace analysis of the DetectorDriver.
+    ///@param[in] data Pointer to the bytes of the spill block.
+    ///@param[in] size The number of bytes in the block.
+    void ReplayEventCache(const char *data, const size_t &size);
+
+    ///@brief Writes the state of the unpacker, the event counters and the
+    /// state of the DetectorDriver and its processors.
+    ///@param[in] writer The archive of the state.
+    void SaveState(StateWriter &writer) const;
+
+    ///@brief Reads the state written by SaveState. The DetectorDriver is
+    /// initialized on the first event, so its state is kept until then.
+    ///@param[in] reader The archive of the state.
+    void LoadState(StateReader &reader);
+
 private:
+    bool isDriverInitialized_; ///< True once InitializeDriver was called on the first event.
+    bool isReplay_; ///< True if the events are replayed from an event cache.
+    unsigned int eventCounter_; ///< The number of events that were processed.
+    double lastTimeOfPreviousEvent_; ///< The stop time of the previous event.
+    clock_t systemStartTime_; ///< The system time at which the driver was initialized.
+    std::string driverState_; ///< The state of the DetectorDriver loaded before it was initialized.
+    RawEvent rawev_; ///< The channels of the event that is processed.
+    EventCache *cache_; ///< Writes the calibrated events, NULL if there is no EventCache node.
+
     ///@brief Process all events in the event list.
     ///@param[in]  addr_ Pointer to a ScanInterface object.
     void ProcessRawEvent();
 
+    ///@brief Initializes the driver on the first event, applies the rejection
+    /// regions and plots the timing of the event.
+    ///@param[in] driver A pointer to the DetectorDriver that we're using.
+    ///@param[in] multiplicity The number of channels in the event.
+    ///@return False if the event is in a rejection region.
+    bool StartEvent(DetectorDriver *driver, const size_t &multiplicity);
+
+    ///@brief Processes the channels added to rawev_, caches them and clears
+    /// the event.
+    ///@param[in] driver A pointer to the DetectorDriver that we're using.
+    void FinishEvent(DetectorDriver *driver);
+
+    ///@brief Writes the events of the spill that passed the skim and the
+    /// cached events of the spill.
+    void EndSpill();
+
     ///@brief Initializes the DetectorLibrary and DetectorDriver
     ///@param[in] driver A pointer to the DetectorDriver that we're using.
     ///@param[in] detlib A pointer to the DetectorLibrary that we're using.
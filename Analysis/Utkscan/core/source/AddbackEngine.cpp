@@ -0,0 +1,119 @@
+/*! \file AddbackEngine.cpp
+ *  \brief Time clustering, addback and coincidence pairing of gamma-ray hits
+ *  \date October 19, 2026
+*/
+#include <algorithm>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+#include <cmath>
+
+#include "AddbackEngine.hpp"
+
+using namespace std;
+
+namespace {
+    //! Orders the hits in time, the order of the caller breaks ties
+    bool CompareTime(const AddbackEngine::Hit &lhs, const AddbackEngine::Hit &rhs) {
+        return lhs.time < rhs.time || (lhs.time == rhs.time && lhs.index < rhs.index);
+    }
+
+    const unsigned int NO_GROUP = numeric_limits<unsigned int>::max();
+}
+
+void AddbackEngine::SetGroup(const unsigned int &detector, const unsigned int &group) {
+    if (detector >= groups_.size())
+        groups_.resize(detector + 1, NO_GROUP);
+    groups_[detector] = group;
+}
+
+void AddbackEngine::Clear() {
+    hits_.clear();
+    clusters_.clear();
+    sums_.clear();
+    numSubEvents_ = 0;
+}
+
+void AddbackEngine::AddHit(const double &energy, const double &time, const unsigned int &detector,
+                           const unsigned int &index) {
+    if (energy < threshold_)
+        return;
+
+    unsigned int group = detector < groups_.size() && groups_[detector] != NO_GROUP ? groups_[detector] : detector;
+    if (group >= numGroups_) {
+        stringstream ss;
+        ss << "AddbackEngine::AddHit - Detector " << detector << " is in group " << group
+           << " but there are only " << numGroups_ << " groups.";
+        throw out_of_range(ss.str());
+    }
+
+    Hit hit = {energy, time, detector, group, 0, index};
+    hits_.push_back(hit);
+}
+
+void AddbackEngine::Build() {
+    sort(hits_.begin(), hits_.end(), CompareTime);
+
+    numSubEvents_ = 0;
+    double refTime = 0;
+    for (vector<Hit>::iterator it = hits_.begin(); it != hits_.end(); it++) {
+        if (numSubEvents_ == 0 || fabs(it->time - refTime) > window_)
+            numSubEvents_++;
+        it->subEvent = numSubEvents_ - 1;
+        refTime = it->time;
+    }
+
+    Cluster empty = {0, 0, 0, 0};
+    clusters_.assign((size_t) numSubEvents_ * numGroups_, empty);
+    sums_.assign(numSubEvents_, empty);
+
+    for (vector<Hit>::const_iterator it = hits_.begin(); it != hits_.end(); it++) {
+        Cluster *clusters[2] = {&sums_[it->subEvent], &clusters_[it->subEvent * numGroups_ + it->group]};
+        for (unsigned int i = 0; i < 2; i++) {
+            if (clusters[i]->multiplicity == 0)
+                clusters[i]->firstTime = it->time;
+            clusters[i]->energy += it->energy;
+            clusters[i]->time = it->time;
+            clusters[i]->multiplicity++;
+        }
+    }
+
+    //The groups without hits start with the sub event
+    for (size_t i = 0; i < clusters_.size(); i++)
+        if (clusters_[i].multiplicity == 0)
+            clusters_[i].time = clusters_[i].firstTime = sums_[i / numGroups_].firstTime;
+}
+
+void AddbackEngine::FindHitPairs(const double &maxDt, std::vector<Pair> &pairs) const {
+    pairs.clear();
+    for (unsigned int i = 0; i < hits_.size(); i++) {
+        for (unsigned int j = i + 1; j < hits_.size(); j++) {
+            double dtime = hits_[j].time - hits_[i].time;
+            if (dtime > maxDt)
+                break;
+            Pair pair = {i, j, dtime};
+            pairs.push_back(pair);
+        }
+    }
+}
+
+void AddbackEngine::FindClusterPairs(const double &maxDt, std::vector<Pair> &pairs) const {
+    pairs.clear();
+    for (unsigned int s = 0; s < numSubEvents_; s++) {
+        unsigned int offset = s * numGroups_;
+        for (unsigned int i = offset; i < offset + numGroups_; i++) {
+            if (clusters_[i].multiplicity == 0)
+                continue;
+            for (unsigned int j = i + 1; j < offset + numGroups_; j++) {
+                if (clusters_[j].multiplicity == 0)
+                    continue;
+                double dtime = clusters_[j].time - clusters_[i].time;
+                if (fabs(dtime) > maxDt)
+                    continue;
+                Pair pair = {i, j, dtime};
+                pairs.push_back(pair);
+            }
+        }
+    }
+}
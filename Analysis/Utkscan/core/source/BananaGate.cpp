@@ -0,0 +1,168 @@
+/*! \file BananaGate.cpp
+ *  \brief Native banana (polygon) gates loaded from DAMM .ban files
+ *  \date October 19, 2026
+*/
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+#include <cmath>
+
+#include "BananaGate.hpp"
+#include "Exceptions.hpp"
+
+using namespace std;
+
+BananaLibrary *BananaLibrary::instance = NULL;
+
+BananaGate::BananaGate(const std::vector<std::pair<int, int> > &vertices) :
+        xMin_(0), xMax_(-1), yMin_(0), yMax_(-1), hisId_(0), vertices_(vertices) {
+    if (vertices_.size() < 3)
+        return;
+
+    xMin_ = xMax_ = vertices_.front().first;
+    yMin_ = yMax_ = vertices_.front().second;
+    for (vector<pair<int, int> >::const_iterator it = vertices_.begin(); it != vertices_.end(); it++) {
+        xMin_ = min(xMin_, it->first);
+        xMax_ = max(xMax_, it->first);
+        yMin_ = min(yMin_, it->second);
+        yMax_ = max(yMax_, it->second);
+    }
+
+    //! The edge with x1 <= x < x2 crosses column x. Counting each vertex on
+    //! one side only keeps the number of crossings even.
+    vector<double> crossings;
+    columns_.reserve(xMax_ - xMin_ + 2);
+    for (int x = xMin_; x <= xMax_; x++) {
+        columns_.push_back(intervals_.size());
+        crossings.clear();
+        for (unsigned int i = 0; i < vertices_.size(); i++) {
+            const pair<int, int> &a = vertices_[i];
+            const pair<int, int> &b = vertices_[(i + 1) % vertices_.size()];
+            if ((a.first <= x && x < b.first) || (b.first <= x && x < a.first))
+                crossings.push_back(a.second + (double) (x - a.first) *
+                                               (b.second - a.second) / (b.first - a.first));
+        }
+        sort(crossings.begin(), crossings.end());
+        //! A point is inside when an odd number of crossings lie above it,
+        //! i.e. c[0] <= y < c[1], c[2] <= y < c[3] ...
+        for (unsigned int i = 0; i + 1 < crossings.size(); i += 2) {
+            int low = (int) ceil(crossings[i]);
+            int high = (int) ceil(crossings[i + 1]) - 1;
+            if (low <= high)
+                intervals_.push_back(make_pair(low, high));
+        }
+    }
+    columns_.push_back(intervals_.size());
+}
+
+unsigned int BananaGate::Test(const std::vector<std::pair<int, int> > &points,
+                              std::vector<unsigned char> &result) const {
+    unsigned int numInside = 0;
+    result.resize(points.size());
+    for (unsigned int i = 0; i < points.size(); i++) {
+        result[i] = Test(points[i].first, points[i].second);
+        numInside += result[i];
+    }
+    return numInside;
+}
+
+unsigned long BananaGate::Validate(const int &id,
+                                   bool (*reference)(const int &, const int &, const int &),
+                                   const int &step/*=1*/) const {
+    unsigned long numDifferent = 0;
+    for (int x = xMin_ - 1; x <= xMax_ + 1; x += max(1, step))
+        for (int y = yMin_ - 1; y <= yMax_ + 1; y += max(1, step))
+            if (Test(x, y) != reference(id, x, y))
+                numDifferent++;
+    return numDifferent;
+}
+
+BananaLibrary *BananaLibrary::get() {
+    if (!instance)
+        instance = new BananaLibrary();
+    return instance;
+}
+
+///The .ban files are written by DAMM as 80 character records without line
+/// breaks. The file starts with a list of the banana ids (80 x I5) and each
+/// banana is made up of an INP record (histogram file, histogram id, banana
+/// id, and number of points), a TIT and a GATE record, and the CXY records
+/// holding up to 7 (x,y) pairs each. Files with one record per line are
+/// read as well.
+unsigned int BananaLibrary::Load(const std::string &file) {
+    ifstream input(file.c_str());
+    if (!input)
+        throw GeneralException("BananaLibrary::Load : Could not open the banana file " + file);
+
+    string contents((istreambuf_iterator<char>(input)), istreambuf_iterator<char>());
+
+    vector<string> records;
+    if (contents.find('\n') != string::npos) {
+        stringstream lines(contents);
+        string line;
+        while (getline(lines, line))
+            records.push_back(line);
+    } else {
+        for (size_t pos = 400; pos < contents.size(); pos += 80)
+            records.push_back(contents.substr(pos, 80));
+    }
+
+    unsigned int numLoaded = 0;
+    int id = -1, hisId = 0;
+    unsigned int numPoints = 0;
+    vector<pair<int, int> > vertices;
+    for (vector<string>::const_iterator it = records.begin(); it != records.end(); it++) {
+        string key = it->substr(0, 3);
+        if (key == "INP") {
+            if (id >= 0)
+                throw GeneralException("BananaLibrary::Load : Banana in " + file +
+                                       " has fewer points than declared.");
+            //! Fields after the histogram file name: his id, banana id, 0, points
+            stringstream fields(it->substr(3));
+            string hisFile;
+            int unused;
+            fields >> hisFile >> hisId >> id >> unused >> numPoints;
+            if (fields.fail() || id < 0)
+                throw GeneralException("BananaLibrary::Load : Malformed INP record in " + file);
+            vertices.clear();
+        } else if (key == "CXY" && id >= 0) {
+            stringstream fields(it->substr(3));
+            int x, y;
+            while (vertices.size() < numPoints && fields >> x >> y)
+                vertices.push_back(make_pair(x, y));
+        } else
+            continue;
+
+        if (id >= 0 && vertices.size() == numPoints) {
+            BananaGate gate(vertices);
+            gate.SetHistogramId(hisId);
+            gates_[id] = gate;
+            numLoaded++;
+            id = -1;
+        }
+    }
+
+    if (id >= 0)
+        throw GeneralException("BananaLibrary::Load : Banana in " + file +
+                               " has fewer points than declared.");
+
+    BuildLookup();
+    return numLoaded;
+}
+
+void BananaLibrary::Add(const int &id, const BananaGate &gate) {
+    gates_[id] = gate;
+    BuildLookup();
+}
+
+void BananaLibrary::BuildLookup(void) {
+    lookup_.clear();
+    if (gates_.empty() || gates_.rbegin()->first < 0)
+        return;
+    lookup_.resize(gates_.rbegin()->first + 1, NULL);
+    for (map<int, BananaGate>::const_iterator it = gates_.begin(); it != gates_.end(); it++)
+        if (it->first >= 0)
+            lookup_[it->first] = &it->second;
+}
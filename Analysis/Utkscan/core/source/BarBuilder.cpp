@@ -3,11 +3,14 @@
  *  \author S. V. Paulauskas
  *  \date December 15, 2014
 */
+#include <algorithm>
 #include <iostream>
 #include <vector>
 
+#include <cmath>
+
 #include "BarBuilder.hpp"
-#include "TimingMapBuilder.hpp"
+#include "DetectorLibrary.hpp"
 
 using namespace std;
 
@@ -15,22 +18,23 @@ void BarBuilder::BuildBars(void) {
     ClearMaps();
     FillMaps();
 
-    for (map<unsigned int, unsigned int>::const_iterator it = lefts_.begin(); it != lefts_.end(); it++) {
-        map<unsigned int, unsigned int>::const_iterator mate = rights_.find(it->first);
-        if (mate == rights_.end())
+    sort(barNumbers_.begin(), barNumbers_.end());
+    for (vector<unsigned int>::const_iterator it = barNumbers_.begin(); it != barNumbers_.end(); it++) {
+        if (lefts_[*it] < 0 || rights_[*it] < 0)
             continue;
 
-        if (list_.at(it->second)->GetTrace().size() != 0 && list_.at(mate->second)->GetTrace().size() != 0) {
-            TimingDefs::TimingIdentifier key =
-                    make_pair(it->first, list_.at(it->second)->GetChanID().GetSubtype());
-            hrtBars_.insert(make_pair(key, BarDetector(HighResTimingData(*(list_.at(it->second))),
-                                                       HighResTimingData(*(list_.at(mate->second))), key)));
+        const ChanEvent *left = list_[lefts_[*it]];
+        const ChanEvent *right = list_[rights_[*it]];
+        if (left->GetTraceLength() != 0 && right->GetTraceLength() != 0) {
+            TimingDefs::TimingIdentifier key = make_pair(*it, left->GetChanID().GetSubtype());
+            hrtBars_.push_back(make_pair(key, BarDetector(HighResTimingData(*left),
+                                                          HighResTimingData(*right), key)));
         } else {
-            lrtBars_.insert(make_pair(it->first,
-                                      make_pair(0.5 * (list_.at(it->second)->GetWalkCorrectedTime() +
-                                                        list_.at(mate->second)->GetWalkCorrectedTime()),
-                                                sqrt(list_.at(it->second)->GetCalibratedEnergy() *
-                                                             list_.at(mate->second)->GetCalibratedEnergy()))));
+            lrtBars_.insert(make_pair(*it,
+                                      make_pair(0.5 * (left->GetWalkCorrectedTime() +
+                                                       right->GetWalkCorrectedTime()),
+                                                sqrt(left->GetCalibratedEnergy() *
+                                                     right->GetCalibratedEnergy()))));
         }
     }
 }
@@ -39,21 +43,51 @@ unsigned int BarBuilder::CalcBarNumber(const unsigned int &loc) {
     return loc / 2;
 }
 
+const vector<BarBuilder::ChannelInfo> &BarBuilder::GetChannelTable(void) {
+    static const vector<ChannelInfo> table = [] {
+        const DetectorLibrary *lib = DetectorLibrary::get();
+        vector<ChannelInfo> result(lib->size());
+        for (unsigned int i = 0; i < lib->size(); i++) {
+            const ChannelConfiguration &id = lib->at(i);
+            result[i].bar = CalcBarNumber(id.GetLocation());
+            result[i].side = NO_SIDE;
+            if (id.HasTag("left") || id.HasTag("up") || id.HasTag("top"))
+                result[i].side |= LEFT_SIDE;
+            if (id.HasTag("right") || id.HasTag("down") || id.HasTag("bottom"))
+                result[i].side |= RIGHT_SIDE;
+        }
+        return result;
+    }();
+    return table;
+}
+
 void BarBuilder::ClearMaps(void) {
     lrtBars_.clear();
     hrtBars_.clear();
-    lefts_.clear();
-    rights_.clear();
+    for (vector<unsigned int>::const_iterator it = barNumbers_.begin(); it != barNumbers_.end(); it++)
+        lefts_[*it] = rights_[*it] = -1;
+    barNumbers_.clear();
 }
 
 void BarBuilder::FillMaps(void) {
-    for (vector<ChanEvent *>::const_iterator it = list_.begin(); it != list_.end(); it++) {
-        ChannelConfiguration id = (*it)->GetChanID();
-        unsigned int barNum = CalcBarNumber(id.GetLocation());
-        unsigned int idx = (unsigned int) (it - list_.begin());
-        if (id.HasTag("left") || id.HasTag("up") || id.HasTag("top"))
-            lefts_.insert(make_pair(barNum, idx));
-        if (id.HasTag("right") || id.HasTag("down") || id.HasTag("bottom"))
-            rights_.insert(make_pair(barNum, idx));
+    const vector<ChannelInfo> &table = GetChannelTable();
+    for (unsigned int idx = 0; idx < list_.size(); idx++) {
+        unsigned int id = list_[idx]->GetID();
+        if (id >= table.size() || table[id].side == NO_SIDE)
+            continue;
+
+        unsigned int barNum = table[id].bar;
+        if (barNum >= lefts_.size()) {
+            lefts_.resize(barNum + 1, -1);
+            rights_.resize(barNum + 1, -1);
+        }
+        if (lefts_[barNum] < 0 && rights_[barNum] < 0)
+            barNumbers_.push_back(barNum);
+
+        //! As with the maps used before, the first end found is kept.
+        if ((table[id].side & LEFT_SIDE) && lefts_[barNum] < 0)
+            lefts_[barNum] = idx;
+        if ((table[id].side & RIGHT_SIDE) && rights_[barNum] < 0)
+            rights_[barNum] = idx;
     }
 }
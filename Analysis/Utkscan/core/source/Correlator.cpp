@@ -41,8 +41,15 @@ namespace dammIds {
 const double Correlator::minImpTime = 5e-3;
 const double Correlator::corrTime = 60; // used to be 3300
 const double Correlator::fastTime = 40e-6;
-
-Correlator::Correlator() : histo(OFFSET, RANGE, "correlator"), lastImplant(NULL), lastDecay(NULL), condition(UNKNOWN_CONDITION) {
+const unsigned int Correlator::decayCapacity;
+
+Correlator::Correlator() : histo(OFFSET, RANGE, "correlator"), condition(UNKNOWN_CONDITION),
+                           neighbourRadius_(0), implants_(arraySize, arraySize, 1, 0),
+                           decays_(arraySize, arraySize, decayCapacity,
+                                   corrTime / Globals::get()->GetFilterClockInSeconds()) {
+    for (unsigned int i = 0; i < arraySize; i++)
+        for (unsigned int j = 0; j < arraySize; j++)
+            flagged_[i][j] = false;
 }
 
 EventInfo::EventInfo() {
@@ -51,7 +58,7 @@ EventInfo::EventInfo() {
     hasVeto = false;
     hasTof = false;
     beamOn = false;
-    foilTime = offTime = energy = time = position = NAN;
+    foilTime = offTime = energy = time = dtime = position = NAN;
     boxMult = mcpMult = impMult = 0;
     type = UNKNOWN_EVENT;
     logicBits[0] = 'X';
@@ -163,6 +170,7 @@ Correlator::~Correlator() {
                 PrintDecayList(i, j);
         }
     }
+    PrintStatistics(cout);
 }
 
 void Correlator::DeclarePlots() {
@@ -180,21 +188,19 @@ void Correlator::Correlate(EventInfo &event, unsigned int fch,
         return;
     }
 
-    CorrelationList &theList = decaylist[fch][bch];
-
     double lastTime = NAN;
     double clockInSeconds = Globals::get()->GetFilterClockInSeconds();
 
     switch (event.type) {
         case EventInfo::IMPLANT_EVENT:
-            if (theList.IsFlagged())
+            if (IsFlagged(fch, bch))
                 PrintDecayList(fch, bch);
 
             lastTime = GetImplantTime(fch, bch);
-            theList.clear();
+            ClearPixel(fch, bch);
             condition = VALID_IMPLANT;
-            if (lastImplant != NULL) {
-                double dt = event.time - lastImplant->time;
+            if (!std::isnan(lastImplant.time)) {
+                double dt = event.time - lastImplant.time;
                 plot(D_TIME_BW_ALL_IMPLANTS, dt * clockInSeconds / 1e-6);
             }
             if (!std::isnan(lastTime)) {
@@ -205,17 +211,28 @@ void Correlator::Correlate(EventInfo &event, unsigned int fch,
                 event.dtime = INFINITY;
             }
             event.generation = 0;
-            theList.push_back(event);
-            lastImplant = &theList.back();
+            implants_.Add(fch, bch, event.time, event);
+            lastImplant = event;
             break;
         default:
-            if (theList.empty())
-                break;
+            //! Look for the most recent implant in the neighbouring pixels
+            //! if there was none in this one.
+            if (implants_.Size(fch, bch) == 0 && neighbourRadius_ > 0) {
+                vector<PixelCorrelator<EventInfo>::Hit> hits;
+                implants_.FindNeighbours(fch, bch, neighbourRadius_,
+                                         event.time - decays_.GetWindow(), event.time, hits);
+                for (vector<PixelCorrelator<EventInfo>::Hit>::const_iterator it = hits.begin();
+                     it != hits.end(); it++) {
+                    if (std::isnan(lastTime) || it->time > lastTime) {
+                        lastTime = it->time;
+                        fch = it->x;
+                        bch = it->y;
+                    }
+                }
+            }
 
-            if (std::isnan(theList.GetImplantTime())) {
-                cout << "No implant time for decay list" << endl;
+            if (implants_.Size(fch, bch) == 0)
                 break;
-            }
 
             if (event.type == EventInfo::UNKNOWN_EVENT)
                 condition = UNKNOWN_CONDITION;
@@ -223,12 +240,12 @@ void Correlator::Correlate(EventInfo &event, unsigned int fch,
                 condition = VALID_DECAY;
 
             condition = VALID_DECAY; // tmp -- DTM
-            lastTime = theList.back().time;
-            double dt = event.time - theList.GetImplantTime();
+            const EventInfo &implant = implants_.At(fch, bch, 0);
+            double dt = event.time - implant.time;
             if (dt < 0) {
                 if (dt < -5e11 && event.time < 1e9) {
                     cout << "Decay following pixie clock reset, clearing decay lists!" << endl;
-                    cout << "  Event time: " << event.time << "\n  Implant time: " << theList.GetImplantTime()
+                    cout << "  Event time: " << event.time << "\n  Implant time: " << implant.time
                          << "\n  DT: " << dt << endl;
                     // PIXIE's clock has most likely been zeroed due to a file marker
                     //   no chance of doing correlations
@@ -236,44 +253,48 @@ void Correlator::Correlate(EventInfo &event, unsigned int fch,
                         for (unsigned int j = 0; j < arraySize; j++) {
                             if (IsFlagged(i, j))
                                 PrintDecayList(i, j);
-                            decaylist[i][j].clear();
+                            flagged_[i][j] = false;
                         }
                     }
+                    implants_.Clear();
+                    decays_.Clear();
                 } else if (event.type != EventInfo::GAMMA_EVENT) {
                     // since gammas are processed at a different time than everything else
                     cout << "negative correlation time, DECAY: " << event.time
-                         << " IMPLANT: " << theList.GetImplantTime()
+                         << " IMPLANT: " << implant.time
                          << " DT: " << dt << endl;
                 }
                 event.dtime = NAN;
                 break;
             } // negative correlation itme
-            if (theList.front().dtime * clockInSeconds >= minImpTime) {
+            if (implant.dtime * clockInSeconds >= minImpTime) {
                 if (dt * clockInSeconds < corrTime) {
-                    event.dtime = event.time - theList.front().time; // FOR LERIBSS
+                    event.dtime = event.time - implant.time; // FOR LERIBSS
                 } else {
-                    event.dtime = event.time - theList.front().time; // FOR LERIBSS
+                    event.dtime = event.time - implant.time; // FOR LERIBSS
                     condition = DECAY_TOO_LATE;
                 }
             } else
                 condition = IMPLANT_TOO_SOON;
 
+            if (condition == VALID_DECAY) {
+                unsigned int numDecays = decays_.Size(fch, bch);
+                event.generation = (numDecays ? decays_.At(fch, bch, numDecays - 1).generation :
+                                    implant.generation) + 1;
+            }
 
-            if (condition == VALID_DECAY)
-                event.generation = theList.back().generation + 1;
-
-            theList.push_back(event);
+            decays_.Add(fch, bch, event.time, event);
 
             if (event.energy == 0 && std::isnan(event.time))
                 cout << " Adding zero decay event " << endl;
 
             if (event.flagged)
-                theList.Flag();
+                flagged_[fch][bch] = true;
 
             if (condition == VALID_DECAY)
-                lastDecay = &theList.back();
+                lastDecay = event;
             else if (condition == DECAY_TOO_LATE)
-                theList.clear();
+                ClearPixel(fch, bch);
 
             break;
     }
@@ -281,11 +302,15 @@ void Correlator::Correlate(EventInfo &event, unsigned int fch,
 }
 
 void Correlator::CorrelateAll(EventInfo &event) {
+    const double window = 10e-6 / Globals::get()->GetFilterClockInSeconds();
     for (unsigned int fch = 0; fch < arraySize; fch++) {
         for (unsigned int bch = 0; bch < arraySize; bch++) {
-            if (decaylist[fch][bch].size() == 0)
+            if (implants_.Size(fch, bch) == 0)
                 continue;
-            if (event.time - decaylist[fch][bch].back().time < 10e-6 / Globals::get()->GetFilterClockInSeconds())
+            unsigned int numDecays = decays_.Size(fch, bch);
+            double lastTime = numDecays ? decays_.GetTime(fch, bch, numDecays - 1) :
+                              implants_.GetTime(fch, bch, 0);
+            if (event.time - lastTime < window)
                 Correlate(event, fch, bch);
         }
     }
@@ -302,37 +327,82 @@ void Correlator::CorrelateAllY(EventInfo &event, unsigned int fch) {
 }
 
 double Correlator::GetDecayTime(void) const {
-    if (lastDecay == NULL)
-        return NAN;
-    else
-        return lastDecay->dtime;
+    return lastDecay.dtime;
 }
 
 double Correlator::GetDecayTime(int fch, int bch) const {
-    return decaylist[fch][bch].GetDecayTime();
+    unsigned int numDecays = decays_.Size(fch, bch);
+    if (numDecays == 0)
+        return NAN;
+    return decays_.At(fch, bch, numDecays - 1).dtime;
 }
 
 double Correlator::GetImplantTime(void) const {
-    if (lastImplant == NULL)
-        return NAN;
-    else
-        return lastImplant->time;
+    return lastImplant.time;
 }
 
 double Correlator::GetImplantTime(int fch, int bch) const {
-    return decaylist[fch][bch].GetImplantTime();
+    if (implants_.Size(fch, bch) == 0)
+        return NAN;
+    return implants_.GetTime(fch, bch, 0);
 }
 
 void Correlator::Flag(int fch, int bch) {
-    if (!decaylist[fch][bch].empty())
-        decaylist[fch][bch].Flag();
+    unsigned int numDecays = decays_.Size(fch, bch);
+    if (numDecays != 0)
+        decays_.At(fch, bch, numDecays - 1).flagged = true;
+    else if (implants_.Size(fch, bch) != 0)
+        implants_.At(fch, bch, 0).flagged = true;
+    else
+        return;
+    flagged_[fch][bch] = true;
 }
 
 bool Correlator::IsFlagged(int fch, int bch) {
-    return decaylist[fch][bch].IsFlagged();
+    if (!implants_.Contains(fch, bch))
+        return false;
+    return flagged_[fch][bch];
 }
 
 void Correlator::PrintDecayList(unsigned int fch, unsigned int bch) const {
     cout << "Current decay list for " << fch << " , " << bch << " : " << endl;
-    decaylist[fch][bch].PrintDecayList();
+    GetDecayList(fch, bch).PrintDecayList();
+}
+
+void Correlator::PrintStatistics(std::ostream &out) const {
+    implants_.PrintStatistics(out, "Correlator implants");
+    decays_.PrintStatistics(out, "Correlator decays");
+}
+
+void Correlator::SaveState(StateWriter &writer) const {
+    writer.Write(lastImplant);
+    writer.Write(lastDecay);
+    writer.Write(condition);
+    writer.WriteBytes(flagged_, sizeof(flagged_));
+    implants_.SaveState(writer);
+    decays_.SaveState(writer);
+}
+
+void Correlator::LoadState(StateReader &reader) {
+    reader.Read(lastImplant);
+    reader.Read(lastDecay);
+    reader.Read(condition);
+    reader.ReadBytes(flagged_, sizeof(flagged_));
+    implants_.LoadState(reader);
+    decays_.LoadState(reader);
+}
+
+CorrelationList Correlator::GetDecayList(unsigned int fch, unsigned int bch) const {
+    CorrelationList list;
+    if (implants_.Size(fch, bch) != 0)
+        list.push_back(implants_.At(fch, bch, 0));
+    for (unsigned int i = 0; i < decays_.Size(fch, bch); i++)
+        list.push_back(decays_.At(fch, bch, i));
+    return list;
+}
+
+void Correlator::ClearPixel(unsigned int fch, unsigned int bch) {
+    implants_.Clear(fch, bch);
+    decays_.Clear(fch, bch);
+    flagged_[fch][bch] = false;
 }
@@ -4,6 +4,7 @@
  * \date July 2, 2007
 */
 #include <algorithm>
+#include <chrono>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
@@ -11,7 +12,9 @@
 #include <limits>
 #include <map>
 #include <sstream>
+#include <stdexcept>
 
+#include "BananaGate.hpp"
 #include "DammPlotIds.hpp"
 #include "DetectorDriver.hpp"
 #include "DetectorDriverXmlParser.hpp"
@@ -20,10 +23,12 @@
 #include "EventProcessor.hpp"
 #include "Exceptions.hpp"
 #include "HighResTimingData.hpp"
-#include "RandomInterface.hpp"
 #include "RawEvent.hpp"
+#include "StateArchive.hpp"
+#include "StringManipulationFunctions.hpp"
 #include "TraceAnalyzer.hpp"
 #include "TreeCorrelator.hpp"
+#include "XmlInterface.hpp"
 
 using namespace std;
 using namespace dammIds::raw;
@@ -38,10 +43,18 @@ DetectorDriver *DetectorDriver::get() {
 
 DetectorDriver::DetectorDriver() : histo(OFFSET, RANGE, "DetectorDriver") {
     eventNumber_ = 0;
+    numThreads_ = 1;
     sysrootbool_ = false;
     fillLogic_  = false;
     tapeCycleNum_ = 0;
     lastCycleTime_ = 0;
+    skimmer_ = NULL;
+    isReplay_ = false;
+    traceResults_ = NULL;
+    loadBudget_ = 0;
+    loadLevel_ = 0;
+    skipsAnalyzers_ = false;
+    loadStart_ = chrono::steady_clock::now();
 
     #ifdef USE_HRIBF
     // needed for scanor.f sanity checking
@@ -56,6 +69,21 @@ DetectorDriver::DetectorDriver() : histo(OFFSET, RANGE, "DetectorDriver") {
         parser.ParseNode(this);
         sysrootbool_ = parser.GetRootOutOpt().first;
         rFileSizeGB_ = parser.GetRFileSize();
+        numThreads_ = parser.GetNumThreads();
+        LoadBananas();
+
+        pugi::xml_node skim = XmlInterface::get()->GetDocument()->child("Configuration").child("Skim");
+        if (skim)
+            skimmer_ = new EventSkimmer(skim);
+
+        pugi::xml_node store = XmlInterface::get()->GetDocument()->child("Configuration").child("TraceResultStore");
+        if (store)
+            traceResults_ = new TraceResultStore(store);
+
+        analyzerSkipped_.assign(vecAnalyzer.size(), false);
+        pugi::xml_node shedding = XmlInterface::get()->GetDocument()->child("Configuration").child("LoadShedding");
+        if (shedding)
+            ParseLoadShedding(shedding);
     } catch (GeneralException &e) {
         /// Any exception in registering plots in Processors
         /// and possible other exceptions in creating Processors
@@ -138,6 +166,8 @@ DetectorDriver::DetectorDriver() : histo(OFFSET, RANGE, "DetectorDriver") {
 }
 
 DetectorDriver::~DetectorDriver() {
+    scheduler_.PrintStatistics(cout);
+
     for (vector<EventProcessor *>::iterator it = vecProcess.begin(); it != vecProcess.end(); it++)
         delete (*it);
     vecProcess.clear();
@@ -145,6 +175,8 @@ DetectorDriver::~DetectorDriver() {
     for (vector<TraceAnalyzer *>::iterator it = vecAnalyzer.begin(); it != vecAnalyzer.end(); it++)
         delete (*it);
     vecAnalyzer.clear();
+    delete skimmer_;
+    delete traceResults_;
     instance = NULL;
 
     if (sysrootbool_) {
@@ -164,8 +196,99 @@ void DetectorDriver::Init(RawEvent &rawev) {
     for (vector<EventProcessor *>::iterator it = vecProcess.begin(); it != vecProcess.end(); it++)
         (*it)->Init(rawev);
 
+    scheduler_.SetProcessors(vecProcess, numThreads_);
+
     walk_ = DetectorLibrary::get()->GetWalkCorrections();
     cali_ = DetectorLibrary::get()->GetCalibrations();
+
+    //! A channel only needs its trace decoded if one of the analyzers looks
+    //! at it. Processors that want the trace of any other channel still get
+    //! it, the samples are then copied when they ask for them.
+    DetectorLibrary *modChan = DetectorLibrary::get();
+    traceMask_.assign(modChan->size(), false);
+    for (DetectorLibrary::size_type i = 0; i < modChan->size(); i++) {
+        if (!modChan->HasValue(i))
+            continue;
+        const ChannelConfiguration &cfg = modChan->at(i);
+        if (cfg.GetType() == "ignore" || cfg.GetType() == "")
+            continue;
+        for (vector<TraceAnalyzer *>::iterator it = vecAnalyzer.begin(); it != vecAnalyzer.end(); it++)
+            if (!(*it)->IsIgnoredDetector(cfg))
+                traceMask_[i] = true;
+    }
+
+    if (traceResults_) {
+        pugi::xml_node configuration = XmlInterface::get()->GetDocument()->child("Configuration");
+        vector<uint64_t> hashes(traceMask_.size(), 0);
+        for (DetectorLibrary::size_type i = 0; i < traceMask_.size(); i++)
+            if (traceMask_[i])
+                hashes[i] = TraceResultStore::HashParameters(modChan->at(i), configuration);
+        traceResults_->SetParameterHashes(hashes);
+    }
+}
+
+void DetectorDriver::ParseLoadShedding(const pugi::xml_node &node) {
+    loadBudget_ = node.attribute("budget").as_double(0) * 1e-3;
+    if (loadBudget_ <= 0)
+        throw invalid_argument("DetectorDriver::ParseLoadShedding - The budget of the LoadShedding node has to be "
+                                       "a positive number of ms per spill.");
+
+    //! The analyzers were made in the order of the Analyzer nodes
+    vector<string> analyzerNames;
+    pugi::xml_node driver = XmlInterface::get()->GetDocument()->child("Configuration").child("DetectorDriver");
+    for (pugi::xml_node analyzer = driver.child("Analyzer"); analyzer; analyzer = analyzer.next_sibling("Analyzer"))
+        analyzerNames.push_back(analyzer.attribute("name").value());
+    set<string> processorNames;
+    for (vector<EventProcessor *>::const_iterator it = vecProcess.begin(); it != vecProcess.end(); it++)
+        processorNames.insert((*it)->GetName());
+
+    for (pugi::xml_node level = node.child("Level"); level; level = level.next_sibling("Level")) {
+        LoadLevel stages;
+        stages.analyzers.assign(vecAnalyzer.size(), false);
+        stages.plots2D = level.attribute("plots2d").as_bool(false);
+
+        vector<string> names = StringManipulation::TokenizeString(level.attribute("analyzers").value(), ",");
+        for (vector<string>::const_iterator it = names.begin(); it != names.end(); it++) {
+            if (it->empty())
+                continue;
+            bool found = false;
+            for (unsigned int i = 0; i < analyzerNames.size() && i < vecAnalyzer.size(); i++)
+                if (analyzerNames[i] == *it)
+                    stages.analyzers[i] = found = true;
+            if (!found)
+                throw invalid_argument("DetectorDriver::ParseLoadShedding - The analyzer " + *it +
+                                       " of a LoadShedding Level is not in the DetectorDriver.");
+        }
+
+        names = StringManipulation::TokenizeString(level.attribute("processors").value(), ",");
+        for (vector<string>::const_iterator it = names.begin(); it != names.end(); it++) {
+            if (it->empty())
+                continue;
+            if (processorNames.find(*it) == processorNames.end())
+                throw invalid_argument("DetectorDriver::ParseLoadShedding - The processor " + *it +
+                                       " of a LoadShedding Level is not in the DetectorDriver.");
+            stages.processors.insert(*it);
+        }
+        loadLevels_.push_back(stages);
+    }
+}
+
+void DetectorDriver::SetLoadLevel(const unsigned int &level) {
+    loadLevel_ = min(level, (unsigned int) loadLevels_.size());
+
+    analyzerSkipped_.assign(vecAnalyzer.size(), false);
+    set<string> processors;
+    bool plots2D = false;
+    for (unsigned int i = 0; i < loadLevel_; i++) {
+        for (unsigned int j = 0; j < analyzerSkipped_.size(); j++)
+            if (loadLevels_[i].analyzers[j])
+                analyzerSkipped_[j] = true;
+        processors.insert(loadLevels_[i].processors.begin(), loadLevels_[i].processors.end());
+        plots2D = plots2D || loadLevels_[i].plots2D;
+    }
+    skipsAnalyzers_ = find(analyzerSkipped_.begin(), analyzerSkipped_.end(), true) != analyzerSkipped_.end();
+    scheduler_.SetSkipped(processors);
+    Plots::SetSkip2D(plots2D);
 }
 
 void DetectorDriver::ProcessEvent(RawEvent &rawev) {
@@ -178,11 +301,25 @@ void DetectorDriver::ProcessEvent(RawEvent &rawev) {
 	pixie_tree_event_.Reset();
     }
     plot(dammIds::raw::D_NUMBER_OF_EVENTS, dammIds::GENERIC_CHANNEL);
+    if (!loadLevels_.empty()) {
+        plot(dammIds::raw::D_LOAD_LEVEL, loadLevel_);
+        if (loadLevel_ != 0)
+            plot(dammIds::raw::D_DEGRADED_EVENTS,
+                 chrono::duration<double>(chrono::steady_clock::now() - loadStart_).count());
+    }
+    if (traceResults_ && !isReplay_)
+        traceResults_->SetInputFile(Globals::get()->GetInputFileName());
     try {
         int innerEvtCounter=0;
-        for (vector<ChanEvent *>::const_iterator it = rawev.GetEventList().begin(); it != rawev.GetEventList().end(); ++it) {
+        FillDithers(rawev);
+        vector<double>::const_iterator dither = dithers_.begin();
+        for (vector<ChanEvent *>::const_iterator it = rawev.GetEventList().begin(); it != rawev.GetEventList().end(); ++it, ++dither) {
             PlotRaw((*it));
-            ThreshAndCal((*it), rawev);
+            //! The cached channels only need to be added to their summaries
+            if (!isReplay_)
+                ThreshAndCal((*it), rawev, *dither);
+            else if ((*it)->GetChanID().GetType() != "ignore" && (*it)->GetChanID().GetType() != "")
+                rawev.AddToSummaries(*it);
             PlotCal((*it));
 
             //internal TS for the FDSi experiment (Xu)
@@ -222,16 +359,22 @@ void DetectorDriver::ProcessEvent(RawEvent &rawev) {
             firstEventTime_ = rawev.GetEventList().front()->GetTimeSansCfd();
             firstEventTimeinNs_ = firstEventTime_ * Globals::get()->GetClockInSeconds(rawev.GetEventList().front()->GetChanID().GetModFreq()) * 1.e9;
         }
+        //! The traces are copied on first use, which two processors running
+        //! concurrently must not do at the same time.
+        if (scheduler_.IsConcurrent())
+            for (vector<ChanEvent *>::const_iterator it = rawev.GetEventList().begin();
+                 it != rawev.GetEventList().end(); ++it)
+                (*it)->LoadTrace();
         //!First round is preprocessing, where process result must be guaranteed
-        //!to not to be dependent on results of other Processors.
-        for (vector<EventProcessor *>::iterator iProc = vecProcess.begin(); iProc != vecProcess.end(); iProc++)
-            if ((*iProc)->HasEvent())
-                (*iProc)->PreProcess(rawev);
+        //!to not to be dependent on results of other Processors, unless the
+        //!Processor declared the dependency.
+        scheduler_.PreProcess(rawev);
         ///In the second round the Process is called, which may depend on other
-        ///Processors.
-        for (vector<EventProcessor *>::iterator iProc = vecProcess.begin(); iProc != vecProcess.end(); iProc++)
-            if ((*iProc)->HasEvent())
-                (*iProc)->Process(rawev);
+        ///Processors. Independent Processors may run concurrently.
+        scheduler_.Process(rawev);
+        //! The skim looks at the places before they are cleared
+        if (skimmer_)
+            skimmer_->Select(rawev);
         // Clear all places in correlator (if of resetable type)
         for (map<string, Place *>::iterator it = TreeCorrelator::get()->places_.begin();
              it != TreeCorrelator::get()->places_.end(); ++it)
@@ -272,6 +415,8 @@ void DetectorDriver::DeclarePlots() {
         DeclareHistogram1D(D_HAS_TRACE, S8, "channels with traces");
         DeclareHistogram1D(D_HAS_TRACE_2, S8, "channels w/ traces: post WaveForm Analysis");
         DeclareHistogram1D(D_HAS_TRACE_3, S8, "channels w/ traces: post Fit Analysis");
+        DeclareHistogram1D(D_LOAD_LEVEL, S4, "events per load shedding level");
+        DeclareHistogram1D(D_DEGRADED_EVENTS, SE, "degraded events vs scan time in s");
         DeclareHistogram2D(DD_TRACE_MAX, SD, S8, "Max Value in Trace / 10 vs Chan Num");
         DeclareHistogram1D(D_SUBEVENT_GAP, SE, "Time Between Channels in 10 ns / bin");
         DeclareHistogram1D(D_EVENT_LENGTH, SE, "Event Length in ns");
@@ -283,6 +428,9 @@ void DetectorDriver::DeclarePlots() {
             DetectorLibrary *modChan = DetectorLibrary::get();
             
             DetectorLibrary::size_type maxChan = modChan->size();
+            rawEnergy_.assign(maxChan, Histogram1D());
+            filterEnergy_.assign(maxChan, Histogram1D());
+            calEnergy_.assign(maxChan, Histogram1D());
 
             for (DetectorLibrary::size_type i = 0; i < maxChan; i++) {
                 if (!modChan->HasValue(i))
@@ -297,12 +445,12 @@ void DetectorDriver::DeclarePlots() {
                       << " - " << id.GetType()
                       << ":" << id.GetSubtype()
                       << " L" << id.GetLocation();
-                DeclareHistogram1D(D_RAW_ENERGY + i, SE, ("RawE " + idstr.str()).c_str());
-                DeclareHistogram1D(D_FILTER_ENERGY + i, SE, ("FilterE " + idstr.str()).c_str());
+                rawEnergy_[i] = DeclareHistogram1D(D_RAW_ENERGY + i, SE, ("RawE " + idstr.str()).c_str());
+                filterEnergy_[i] = DeclareHistogram1D(D_FILTER_ENERGY + i, SE, ("FilterE " + idstr.str()).c_str());
                 DeclareHistogram1D(D_SCALAR + i, SE, ("Scalar " + idstr.str()).c_str());
                 if (Globals::get()->GetPixieRevision() == "A")
                     DeclareHistogram1D(D_TIME + i, SE, ("Time " + idstr.str()).c_str());
-                DeclareHistogram1D(D_CAL_ENERGY + i, SE, ("CalE " + idstr.str()).c_str());
+                calEnergy_[i] = DeclareHistogram1D(D_CAL_ENERGY + i, SE, ("CalE " + idstr.str()).c_str());
             }
         }
 
@@ -318,39 +466,57 @@ void DetectorDriver::DeclarePlots() {
     }
 }
 
-int DetectorDriver::ThreshAndCal(ChanEvent *chan, RawEvent &rawev) {
+void DetectorDriver::FillDithers(const RawEvent &rawev) {
+    const vector<ChanEvent *> &events = rawev.GetEventList();
+    ditherTimes_.resize(events.size());
+    ditherIds_.resize(events.size());
+    dithers_.resize(events.size());
+    for (size_t i = 0; i < events.size(); i++) {
+        ditherTimes_[i] = (uint64_t) events[i]->GetTimeSansCfd();
+        ditherIds_[i] = (uint64_t) events[i]->GetID();
+    }
+    dither_.Fill(ditherTimes_.data(), ditherIds_.data(), events.size(), dithers_.data());
+}
+
+int DetectorDriver::ThreshAndCal(ChanEvent *chan, RawEvent &rawev, const double &dither) {
     ChannelConfiguration chanCfg = chan->GetChanID();
     int id = chan->GetID();
     string type = chanCfg.GetType();
-    string subtype = chanCfg.GetSubtype();
-    set<string> tags = chanCfg.GetTags();
-    bool hasStartTag = chanCfg.HasTag("start");
-    Trace &trace = chan->GetTrace();
-
-    RandomInterface *randoms = RandomInterface::get();
+    //! Channels without a trace analyzer never copy the samples of the trace
+    Trace &trace = NeedsTrace(id) ? chan->GetTrace() : chan->GetTraceResults();
 
     double energy = 0.0;
 
     if (type == "ignore" || type == "")
         return (0);
 
-    if (!trace.empty()) {
+    if (chan->GetTraceLength() != 0) {
         plot(D_HAS_TRACE, id);
         
         //!Setting these to false initally so that we can guarante that its false either if we are ignored or if it fails in the analyzers. 
-        chan->GetTrace().SetHasValidWaveformAnalysis(false);
-        chan->GetTrace().SetHasValidTimingAnalysis(false);
-
-        for (vector<TraceAnalyzer *>::iterator it = vecAnalyzer.begin(); it != vecAnalyzer.end(); it++){
-            if (!(*it)->IsIgnoredDetector(chanCfg)){
-                (*it)->Analyze(trace, chanCfg);
+        trace.SetHasValidWaveformAnalysis(false);
+        trace.SetHasValidTimingAnalysis(false);
+
+        //! Traces analyzed by an earlier scan of the file take their results from the store
+        bool useStore = traceResults_ && NeedsTrace(id);
+        if (!useStore || !traceResults_->Load(*chan, trace)) {
+            chrono::steady_clock::time_point start = chrono::steady_clock::now();
+            for (vector<TraceAnalyzer *>::iterator it = vecAnalyzer.begin(); it != vecAnalyzer.end(); it++){
+                //! Analyzers switched off by the load shedding are skipped
+                if (!(*it)->IsIgnoredDetector(chanCfg) && !analyzerSkipped_[it - vecAnalyzer.begin()]){
+                    (*it)->Analyze(trace, chanCfg);
+                }
             }
+            //! The results of a degraded analysis are not stored
+            if (useStore && !skipsAnalyzers_)
+                traceResults_->Save(*chan, trace,
+                                    chrono::duration<double>(chrono::steady_clock::now() - start).count());
         }
 
-        if(chan->GetTrace().HasValidWaveformAnalysis()){
+        if(trace.HasValidWaveformAnalysis()){
             plot(D_HAS_TRACE_2,id);
         }
-        if(chan->GetTrace().HasValidTimingAnalysis()){
+        if(trace.HasValidTimingAnalysis()){
             plot(D_HAS_TRACE_3,id);
         } else {
             trace.SetPhase(0.0); // if the timing analysis fails for any reason then set the phase to 0
@@ -358,10 +524,11 @@ int DetectorDriver::ThreshAndCal(ChanEvent *chan, RawEvent &rawev) {
         //We are going to handle the filtered energies here.
         vector<double> filteredEnergies = trace.GetFilteredEnergies();
         if (filteredEnergies.empty()) {
-            energy = chan->GetEnergy() + randoms->Generate();
+            energy = chan->GetEnergy() + dither;
         } else {
             energy = filteredEnergies.front();
-            plot(D_FILTER_ENERGY + id, energy);
+            if ((size_t) id < filterEnergy_.size())
+                filterEnergy_[id].Fill(energy);
         }
 
         //Saves the time in nanoseconds
@@ -373,7 +540,7 @@ int DetectorDriver::ThreshAndCal(ChanEvent *chan, RawEvent &rawev) {
     } else {
         /// otherwise, use the Pixie on-board calculated energy and high res
         /// time is zero.
-        energy = chan->GetEnergy() + randoms->Generate();
+        energy = chan->GetEnergy() + dither;
         chan->SetHighResTime(0.0);
     }
 
@@ -390,32 +557,61 @@ int DetectorDriver::ThreshAndCal(ChanEvent *chan, RawEvent &rawev) {
     chan->SetCalibratedEnergy(cali_->GetCalEnergy(chanCfg, energy));
     chan->SetWalkCorrectedTime(time - walk_correction);
 
-    //TODO Add group support for GetSummary() 
-    rawev.GetSummary(type)->AddEvent(chan);
-    DetectorSummary *summary;
-
-    summary = rawev.GetSummary(type + ':' + subtype, false);
-    if (summary != NULL)
-        summary->AddEvent(chan);
-
-    if (hasStartTag && type != "logic") {
-        summary = rawev.GetSummary(type + ':' + subtype + ':' + "start", false);
-        if (summary != NULL)
-            summary->AddEvent(chan);
-    }
+    rawev.AddToSummaries(chan);
     return (1);
 }
 
 int DetectorDriver::PlotRaw(const ChanEvent *chan) {
-    plot(D_RAW_ENERGY + chan->GetID(), chan->GetEnergy());
+    if ((size_t) chan->GetID() < rawEnergy_.size())
+        rawEnergy_[chan->GetID()].Fill(chan->GetEnergy());
     return (0);
 }
 
 int DetectorDriver::PlotCal(const ChanEvent *chan) {
-    plot(D_CAL_ENERGY + chan->GetID(), chan->GetCalibratedEnergy());
+    if ((size_t) chan->GetID() < calEnergy_.size())
+        calEnergy_[chan->GetID()].Fill(chan->GetCalibratedEnergy());
     return (0);
 }
 
+///The processors are saved in the order of the configuration, so that two
+/// processors with the same name keep their own state.
+void DetectorDriver::SaveState(StateWriter &writer) const {
+    writer.Write(eventNumber_);
+    writer.Write(firstEventTime_);
+    writer.Write(firstEventTimeinNs_);
+    writer.Write(pixieToWallClock.first);
+    writer.Write(pixieToWallClock.second);
+    writer.Write(tapeCycleNum_);
+    writer.Write(lastCycleTime_);
+
+    writer.Write((uint64_t) vecProcess.size());
+    for (vector<EventProcessor *>::const_iterator it = vecProcess.begin(); it != vecProcess.end(); it++) {
+        writer.Write((*it)->GetName());
+        writer.Write(StateWriter::ToString(**it));
+    }
+}
+
+void DetectorDriver::LoadState(StateReader &reader) {
+    reader.Read(eventNumber_);
+    reader.Read(firstEventTime_);
+    reader.Read(firstEventTimeinNs_);
+    reader.Read(pixieToWallClock.first);
+    reader.Read(pixieToWallClock.second);
+    reader.Read(tapeCycleNum_);
+    reader.Read(lastCycleTime_);
+
+    if (reader.Get<uint64_t>() != vecProcess.size())
+        throw GeneralException("DetectorDriver::LoadState - The checkpoint was written with a different "
+                               "number of processors.");
+    for (vector<EventProcessor *>::iterator it = vecProcess.begin(); it != vecProcess.end(); it++) {
+        string name = reader.Get<string>();
+        if (name != (*it)->GetName())
+            throw GeneralException("DetectorDriver::LoadState - The checkpoint has the state of " + name
+                                   + " where the configuration has " + (*it)->GetName() + ".");
+        StateReader::FromString(reader.Get<string>(), **it);
+    }
+}
+
 EventProcessor *DetectorDriver::GetProcessor(const std::string &name) const {
     for (vector<EventProcessor *>::const_iterator it = vecProcess.begin(); it != vecProcess.end(); it++)
         if ((*it)->GetName() == name)
@@ -429,6 +625,28 @@ std::set<std::string> DetectorDriver::GetProcessorList() {
     return (setProcess);
 }
 
+void DetectorDriver::LoadBananas() {
+    const string file = Globals::get()->GetBananaFile();
+    if (file.empty())
+        return;
+
+    Messenger m;
+    stringstream ss;
+    ss << "Loaded " << BananaLibrary::get()->Load(file) << " banana gate(s) from " << file;
+    m.detail(ss.str());
+
+#ifdef USE_HRIBF
+    //! Cross check the edge tables with the bananas known to scanor.
+    const map<int, BananaGate> &gates = BananaLibrary::get()->GetGates();
+    for (map<int, BananaGate>::const_iterator it = gates.begin(); it != gates.end(); it++) {
+        ss.str("");
+        ss << "Banana " << it->first << " differs from bantesti_ in "
+           << it->second.Validate(it->first, bantesti_) << " channel(s)";
+        m.detail(ss.str(), 1);
+    }
+#endif
+}
+
 void DetectorDriver::FillLogicStruc() { //This should be called away from the event loops. (near where it fills the filenames)
 //TODO We need to make this sensative to running on something other than a 250MHz, also in the logic processor plotting its self
     double convertTimeNS = Globals::get()->GetClockInSeconds() * 1.0e9; // converstion factor from DSP TICKs to NS
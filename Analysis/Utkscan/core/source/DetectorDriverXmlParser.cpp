@@ -80,6 +80,8 @@ void DetectorDriverXmlParser::ParseNode(DetectorDriver *driver) {
 
     rFileSize = node.attribute("rFileSize").as_double(20);  //Defaults to 20GB (which is ~20-25 LDFs worth of 94rb_14 data)
 
+    numThreads = node.attribute("threads").as_uint(1);
+
     if (SysRootOut.first) {
         SysRootOut.second = "True";
     }
@@ -91,6 +93,11 @@ void DetectorDriverXmlParser::ParseNode(DetectorDriver *driver) {
         ss << "DetectorDriver Output Root File Size = " << rFileSize << " GB";
         messenger_.detail(ss.str(), 2);
     }
+    if (numThreads > 1) {
+        ss.str("");
+        ss << "DetectorDriver Processor Threads = " << numThreads;
+        messenger_.detail(ss.str(), 1);
+    }
     messenger_.start("Loading Analyzers");
     driver->SetTraceAnalyzers(ParseAnalyzers(node.child("Analyzer")));
     messenger_.done();
@@ -291,6 +298,11 @@ vector<EventProcessor *> DetectorDriverXmlParser::ParseProcessors(const pugi::xm
             throw GeneralException(ss.str());
         }
 
+        std::vector<std::string> deps = StringManipulation::TokenizeString(processor.attribute("depends").as_string(""), ",");
+        for (std::vector<std::string>::const_iterator it = deps.begin(); it != deps.end(); it++)
+            if (!it->empty())
+                vecProcess.back()->AddDependency(*it);
+
         PrintAttributeMessage(processor);
     }
     return vecProcess;
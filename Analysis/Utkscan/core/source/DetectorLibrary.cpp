@@ -11,12 +11,15 @@
 
 #include "Constants.hpp"
 #include "DetectorLibrary.hpp"
+#include "DetectorSummary.hpp"
 #include "MapNodeXmlParser.hpp"
 #include "Messenger.hpp"
 
 using namespace std;
 
 set<int> DetectorLibrary::emptyLocations;
+vector<unsigned int> DetectorLibrary::noSummaries;
+const unsigned int DetectorLibrary::NO_SUMMARY;
 
 DetectorLibrary *DetectorLibrary::instance = NULL;
 
@@ -116,6 +119,52 @@ void DetectorLibrary::Set(int index, const ChannelConfiguration &value) {
     usedSubtypes.insert(value.GetSubtype());
 
     at(index) = value;
+
+    if (value.GetType() == "ignore" || value.GetType() == "")
+        return;
+
+    RegisterSummary(value.GetType());
+    RegisterSummary(key);
+    if (value.HasTag("start") && value.GetType() != "logic")
+        RegisterSummary(key + ":start");
+    FindSummaries(index);
+}
+
+unsigned int DetectorLibrary::RegisterSummary(const std::string &name) {
+    map<string, unsigned int>::const_iterator it = summaryIds_.find(name);
+    if (it != summaryIds_.end())
+        return it->second;
+
+    DetectorSummary summary(name);
+    unsigned int id = (unsigned int) summaryNames_.size();
+    summaryIds_.insert(make_pair(name, id));
+    summaryNames_.push_back(name);
+
+    channelSummaries_.resize(size());
+    for (size_type i = 0; i < size(); i++) {
+        const ChannelConfiguration &cfg = vector<ChannelConfiguration>::operator[](i);
+        if (cfg.GetType() != "ignore" && cfg.GetType() != "" && summary.Matches(cfg))
+            channelSummaries_[i].push_back(id);
+    }
+    return id;
+}
+
+unsigned int DetectorLibrary::GetSummaryId(const std::string &name) const {
+    map<string, unsigned int>::const_iterator it = summaryIds_.find(name);
+    return it == summaryIds_.end() ? NO_SUMMARY : it->second;
+}
+
+void DetectorLibrary::FindSummaries(const size_type &idx) {
+    channelSummaries_.resize(size());
+    vector<unsigned int> &ids = channelSummaries_.at(idx);
+    ids.clear();
+
+    const ChannelConfiguration &cfg = at(idx);
+    if (cfg.GetType() == "ignore" || cfg.GetType() == "")
+        return;
+    for (unsigned int id = 0; id < summaryNames_.size(); id++)
+        if (DetectorSummary(summaryNames_[id]).Matches(cfg))
+            ids.push_back(id);
 }
 
 void DetectorLibrary::Set(int mod, int ch, const ChannelConfiguration &value) {
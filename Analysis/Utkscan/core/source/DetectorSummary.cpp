@@ -38,16 +38,19 @@ DetectorSummary::DetectorSummary(const std::string &str, const std::vector<ChanE
             throw invalid_argument("DetectorSummary::DetectorSummary - Too many tokens in the string: " + str);
     }
 
-    for (vector<ChanEvent *>::const_iterator it = fullList.begin(); it != fullList.end(); it++) {
-        const ChannelConfiguration &id = (*it)->GetChanID();
-        if ( id.GetType() != type_ )
-            continue;
-        if ( subtype_ != "" && id.GetSubtype() != subtype_ )
-            continue;
-        if (tag_ != "" && !id.HasTag(tag_))
-            continue;
-        AddEvent(*it);
-    }
+    for (vector<ChanEvent *>::const_iterator it = fullList.begin(); it != fullList.end(); it++)
+        if (Matches((*it)->GetChanID()))
+            AddEvent(*it);
+}
+
+bool DetectorSummary::Matches(const ChannelConfiguration &id) const {
+    if (id.GetType() != type_)
+        return false;
+    if (subtype_ != "" && id.GetSubtype() != subtype_)
+        return false;
+    if (tag_ != "" && !id.HasTag(tag_))
+        return false;
+    return true;
 }
 
 void DetectorSummary::AddEvent(ChanEvent *ev) {
@@ -0,0 +1,324 @@
+/*! \file EventCache.cpp
+ *  \brief Writes the built and calibrated events of a scan into a cache file
+ *  that is replayed by later scans instead of the raw data
+ *  \date October 19, 2026
+*/
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#include "ChanEvent.hpp"
+#include "EventCache.hpp"
+#include "Exceptions.hpp"
+#include "Globals.hpp"
+#include "Messenger.hpp"
+#include "RawEvent.hpp"
+#include "StateArchive.hpp"
+
+using namespace std;
+
+const char EventCache::MAGIC[8] = {'P', 'A', 'A', 'S', 'S', 'E', 'V', 'C'};
+const uint32_t EventCache::VERSION;
+
+///The spill blocks are written once they hold this many bytes, even if the
+/// spill did not end yet, so that a single huge spill does not grow the
+/// block without bound.
+static const size_t maxBlockSize = 67108864;
+
+///The flags of a channel, packed into one byte
+enum ChannelFlags {
+    PILEUP = 1, SATURATED = 2, VIRTUAL = 4, CFD_FORCED = 8, CFD_SOURCE = 16, TRACE_SATURATED = 32,
+    VALID_WAVEFORM = 64, VALID_TIMING = 128
+};
+
+EventCache::EventCache(const pugi::xml_node &node, const pugi::xml_node &configuration) : firstTime_(0),
+                                                                                          numEvents_(0),
+                                                                                          numBytes_(0) {
+    Messenger m;
+    m.start("Loading the event cache");
+
+    string prefix = node.attribute("output").as_string();
+    if (prefix.empty())
+        prefix = Globals::get()->GetOutputFileName();
+    string path = node.attribute("path").as_string();
+    if (path.empty())
+        path = Globals::get()->GetOutputPath();
+    traces_ = node.attribute("traces").as_bool(true);
+
+    fileName_ = path + prefix + ".evcache";
+    file_.open(fileName_.c_str(), ios::binary | ios::trunc);
+    if (!file_.good())
+        throw IOException("EventCache::EventCache - Unable to open the cache " + fileName_);
+
+    ostringstream header(ios::binary);
+    StateWriter writer(header);
+    writer.Write(VERSION);
+    writer.Write(Hash(configuration));
+    writer.Write(traces_);
+
+    file_.write(MAGIC, sizeof(MAGIC));
+    numBytes_ += sizeof(MAGIC);
+    WriteBlock(header.str());
+
+    m.detail("Writing the calibrated events " + string(traces_ ? "with" : "without") + " their traces to "
+             + fileName_);
+    m.done();
+}
+
+EventCache::~EventCache() {
+    try {
+        EndSpill();
+    } catch (IOException &ex) {
+        cout << ex.what() << endl;
+    }
+    file_.close();
+
+    Messenger m;
+    stringstream ss;
+    ss << "Event cache holds " << numEvents_ << " events (" << numBytes_ / 1048576.0 << " MB) in " << fileName_;
+    m.run_message(ss.str());
+}
+
+uint64_t EventCache::Hash(const pugi::xml_node &configuration) {
+    ostringstream text;
+    const char *nodes[] = {"Map", "Global", "Crates"};
+    for (unsigned int i = 0; i < 3; i++) {
+        text << nodes[i] << ":";
+        configuration.child(nodes[i]).print(text, "", pugi::format_raw);
+    }
+    pugi::xml_node driver = configuration.child("DetectorDriver");
+    for (pugi::xml_node analyzer = driver.child("Analyzer"); analyzer; analyzer = analyzer.next_sibling("Analyzer")) {
+        text << "Analyzer:";
+        analyzer.print(text, "", pugi::format_raw);
+    }
+
+    return Fnv1a(text.str());
+}
+
+uint64_t EventCache::Fnv1a(const std::string &bytes) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (string::const_iterator it = bytes.begin(); it != bytes.end(); it++) {
+        hash ^= (unsigned char) *it;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+void EventCache::CheckHeader(const string &header, const pugi::xml_node &configuration) {
+    istringstream in(header, ios::binary);
+    StateReader reader(in);
+    if (reader.Get<uint32_t>() != VERSION)
+        throw invalid_argument("EventCache::CheckHeader - The cache was written by another version of utkscan.");
+    if (reader.Get<uint64_t>() != Hash(configuration))
+        throw invalid_argument("EventCache::CheckHeader - The cache was written with another Map, Global, Crates or "
+                                       "Analyzer configuration. Scan the raw data again.");
+}
+
+void EventCache::Add(const RawEvent &rawev, const EventTimes &times) {
+    ostringstream out(ios::binary);
+    StateWriter writer(out);
+    writer.Write(times.eventStart);
+    writer.Write(times.realStart);
+    writer.Write(times.realStop);
+
+    const vector<ChanEvent *> &events = rawev.GetEventList();
+    writer.Write((uint32_t) events.size());
+    for (vector<ChanEvent *>::const_iterator it = events.begin(); it != events.end(); it++)
+        WriteChannel(writer, **it, traces_);
+
+    block_ += out.str();
+    numEvents_++;
+    if (block_.size() >= maxBlockSize)
+        EndSpill();
+}
+
+void EventCache::EndSpill(void) {
+    if (block_.empty())
+        return;
+
+    ostringstream out(ios::binary);
+    StateWriter writer(out);
+    writer.Write(firstTime_);
+    WriteBlock(out.str() + block_);
+    block_.clear();
+}
+
+void EventCache::WriteBlock(const string &block) {
+    uint32_t size = (uint32_t) block.size();
+    file_.write((const char *) &size, sizeof(size));
+    file_.write(block.data(), block.size());
+    if (!file_.good())
+        throw IOException("EventCache::WriteBlock - Unable to write to " + fileName_);
+    numBytes_ += sizeof(size) + block.size();
+}
+
+double EventCache::ReadFirstTime(StateReader &reader) {
+    return reader.Get<double>();
+}
+
+void EventCache::ReadEvent(StateReader &reader, vector<ChanEvent *> &events, EventTimes &times) {
+    reader.Read(times.eventStart);
+    reader.Read(times.realStart);
+    reader.Read(times.realStop);
+
+    uint32_t size = reader.Get<uint32_t>();
+    events.clear();
+    events.reserve(size);
+    for (uint32_t i = 0; i < size; i++)
+        events.push_back(ReadChannel(reader));
+}
+
+///The hit is written as it came from the module, followed by what the
+/// DetectorDriver added. Only the results of the trace analysis are kept, the
+/// baseline subtracted trace is rebuilt from the samples when it is read.
+void EventCache::WriteChannel(StateWriter &writer, const ChanEvent &event, const bool &traces) {
+    //GetTraceResults does not copy the samples, only ask for them when they are kept
+    ChanEvent &chan = const_cast<ChanEvent &>(event);
+    Trace &trace = traces ? chan.GetTrace() : chan.GetTraceResults();
+
+    uint8_t flags = 0;
+    flags |= event.IsPileup() ? PILEUP : 0;
+    flags |= event.IsSaturated() ? SATURATED : 0;
+    flags |= event.IsVirtualChannel() ? VIRTUAL : 0;
+    flags |= event.GetCfdForcedTriggerBit() ? CFD_FORCED : 0;
+    flags |= event.GetCfdTriggerSourceBit() ? CFD_SOURCE : 0;
+    flags |= trace.IsSaturated() ? TRACE_SATURATED : 0;
+    flags |= trace.HasValidWaveformAnalysis() ? VALID_WAVEFORM : 0;
+    flags |= trace.HasValidTimingAnalysis() ? VALID_TIMING : 0;
+
+    writer.Write((uint32_t) event.GetID());
+    writer.Write(flags);
+    writer.Write(event.GetEnergy());
+    writer.Write(event.GetBaseline());
+    writer.Write(event.GetTime());
+    writer.Write(event.GetTimeSansCfd());
+    writer.Write((uint64_t) event.GetExternalTimeStamp());
+    writer.Write(event.GetCfdFractionalTime());
+    writer.Write(event.GetEventTimeLow());
+    writer.Write(event.GetEventTimeHigh());
+    writer.Write(event.GetExternalTimeLow());
+    writer.Write(event.GetExternalTimeHigh());
+    writer.Write(event.GetEnergySums());
+    writer.Write(event.GetQdc());
+
+    writer.Write(event.GetCalibratedEnergy());
+    writer.Write(event.GetHighResTimeInNs());
+    writer.Write(event.GetWalkCorrectedTime());
+
+    //Only the channels that had a trace went through the trace analysis
+    bool analyzed = event.GetTraceLength() != 0;
+    writer.Write(analyzed);
+    if (!analyzed)
+        return;
+
+    WriteTraceResults(writer, trace);
+
+    vector<uint16_t> samples;
+    if (traces)
+        samples.assign(trace.begin(), trace.end());
+    writer.Write(samples);
+    writer.Write(!trace.GetTraceSansBaseline().empty());
+}
+
+ChanEvent *EventCache::ReadChannel(StateReader &reader) {
+    ChanEvent *event = new ChanEvent();
+
+    //The channel is deleted if the block ends before it does
+    try {
+        uint32_t id = reader.Get<uint32_t>();
+        event->SetCrateNumber(id / 208);
+        event->SetSlotNumber(id % 208 / 16 + 2);
+        event->SetChannelNumber(id % 16);
+
+        uint8_t flags = reader.Get<uint8_t>();
+        event->SetPileup((flags & PILEUP) != 0);
+        event->SetSaturation((flags & SATURATED) != 0);
+        event->SetVirtualChannel((flags & VIRTUAL) != 0);
+        event->SetCfdForcedTriggerBit((flags & CFD_FORCED) != 0);
+        event->SetCfdTriggerSourceBit((flags & CFD_SOURCE) != 0);
+
+        event->SetEnergy(reader.Get<double>());
+        event->SetBaseline(reader.Get<double>());
+        event->SetTime(reader.Get<double>());
+        event->SetTimeSansCfd(reader.Get<double>());
+        event->SetExternalTimeStamp(reader.Get<uint64_t>());
+        event->SetCfdFractionalTime(reader.Get<unsigned int>());
+        event->SetEventTimeLow(reader.Get<unsigned int>());
+        event->SetEventTimeHigh(reader.Get<unsigned int>());
+        event->SetExternalTimeLow(reader.Get<unsigned int>());
+        event->SetExternalTimeHigh(reader.Get<unsigned int>());
+        event->SetEnergySums(reader.Get<vector<unsigned int> >());
+        event->SetQdc(reader.Get<vector<unsigned int> >());
+
+        event->SetCalibratedEnergy(reader.Get<double>());
+        event->SetHighResTime(reader.Get<double>());
+        event->SetWalkCorrectedTime(reader.Get<double>());
+
+        //There are no raw samples behind a cached channel, the trace is marked as
+        // loaded before the results are set since SetTrace resets them
+        event->SetTrace(vector<unsigned int>());
+        Trace &trace = event->GetTraceResults();
+        trace.SetIsSaturated((flags & TRACE_SATURATED) != 0);
+        trace.SetHasValidWaveformAnalysis((flags & VALID_WAVEFORM) != 0);
+        trace.SetHasValidTimingAnalysis((flags & VALID_TIMING) != 0);
+        if (reader.Get<bool>()) {
+            ReadTraceResults(reader, trace);
+
+            vector<uint16_t> samples = reader.Get<vector<uint16_t> >();
+            trace.assign(samples.begin(), samples.end());
+            if (reader.Get<bool>())
+                RestoreTraceSansBaseline(trace);
+        }
+    } catch (IOException &ex) {
+        delete event;
+        throw;
+    }
+    return event;
+}
+
+void EventCache::WriteTraceResults(StateWriter &writer, const Trace &trace) {
+    writer.Write(trace.GetPhase());
+    writer.Write(trace.GetQdc());
+    writer.Write(trace.GetTailRatio());
+    writer.Write(trace.GetTau());
+    writer.Write(trace.GetFilteredBaseline());
+    writer.Write(trace.GetBaselineInfo().first);
+    writer.Write(trace.GetBaselineInfo().second);
+    writer.Write(trace.GetMaxInfo().first);
+    writer.Write(trace.GetMaxInfo().second);
+    writer.Write(trace.GetExtrapolatedMaxInfo().first);
+    writer.Write(trace.GetExtrapolatedMaxInfo().second);
+    writer.Write(trace.GetWaveformRange().first);
+    writer.Write(trace.GetWaveformRange().second);
+    writer.Write(trace.GetFilteredEnergies());
+    writer.Write(trace.GetEnergySums());
+    writer.Write(trace.GetTriggerPositions());
+}
+
+void EventCache::ReadTraceResults(StateReader &reader, Trace &trace) {
+    trace.SetPhase(reader.Get<double>());
+    trace.SetQdc(reader.Get<double>());
+    trace.SetTailRatio(reader.Get<double>());
+    trace.SetTau(reader.Get<double>());
+    trace.SetFilteredBaseline(reader.Get<double>());
+    double baseline = reader.Get<double>();
+    trace.SetBaseline(make_pair(baseline, reader.Get<double>()));
+    unsigned int position = reader.Get<unsigned int>();
+    trace.SetMax(make_pair(position, reader.Get<double>()));
+    position = reader.Get<unsigned int>();
+    trace.SetExtrapolatedMax(make_pair(position, reader.Get<double>()));
+    position = reader.Get<unsigned int>();
+    trace.SetWaveformRange(make_pair(position, reader.Get<unsigned int>()));
+    trace.SetFilteredEnergies(reader.Get<vector<double> >());
+    trace.SetEnergySums(reader.Get<vector<double> >());
+    trace.SetTriggerPositions(reader.Get<vector<unsigned int> >());
+}
+
+///The WaveformAnalyzer subtracts the average of the baseline from every sample
+void EventCache::RestoreTraceSansBaseline(Trace &trace) {
+    vector<double> sansBaseline(trace.begin(), trace.end());
+    double baseline = trace.GetBaselineInfo().first;
+    for (vector<double>::iterator it = sansBaseline.begin(); it != sansBaseline.end(); it++)
+        *it -= baseline;
+    trace.SetTraceSansBaseline(sansBaseline);
+}
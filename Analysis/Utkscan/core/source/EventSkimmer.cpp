@@ -0,0 +1,204 @@
+/*! \file EventSkimmer.cpp
+ *  \brief Writes the raw hits of the events that pass a set of gates into a
+ *  new .pld file
+ *  \date October 19, 2026
+*/
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+#include "ChanEvent.hpp"
+#include "EventSkimmer.hpp"
+#include "Exceptions.hpp"
+#include "Globals.hpp"
+#include "Messenger.hpp"
+#include "Places.hpp"
+#include "RawEvent.hpp"
+#include "StringManipulationFunctions.hpp"
+#include "TreeCorrelator.hpp"
+#include "XiaData.hpp"
+
+using namespace std;
+
+EventSkimmer::EventSkimmer(const pugi::xml_node &node) : numModules_(0), selected_(false), hasData_(false),
+                                                         numEvents_(0), numKept_(0), numHits_(0) {
+    Messenger m;
+    stringstream ss;
+    m.start("Loading the event skim");
+
+    string require = node.attribute("require").as_string("all");
+    if (require != "all" && require != "any")
+        throw invalid_argument("EventSkimmer::EventSkimmer - The require attribute of the Skim node must be \"all\" "
+                                       "or \"any\", not \"" + require + "\".");
+    requireAll_ = require == "all";
+
+    for (pugi::xml_node gate = node.child("Gate"); gate; gate = gate.next_sibling("Gate")) {
+        string detector = gate.attribute("detector").as_string();
+        vector<string> tokens = StringManipulation::TokenizeString(detector, ":");
+        if (detector.empty() || tokens.size() > 3)
+            throw invalid_argument("EventSkimmer::EventSkimmer - The detector \"" + detector + "\" of a Gate is not "
+                                           "of the form type[:subtype[:tag]].");
+        Gate g;
+        g.type = tokens[0];
+        g.subtype = tokens.size() > 1 ? tokens[1] : "";
+        g.tag = tokens.size() > 2 ? tokens[2] : "";
+        g.emin = gate.attribute("emin").as_double(-numeric_limits<double>::max());
+        g.emax = gate.attribute("emax").as_double(numeric_limits<double>::max());
+        g.min = gate.attribute("min").as_uint(1);
+        g.max = gate.attribute("max").as_uint(numeric_limits<unsigned int>::max());
+        gates_.push_back(g);
+
+        ss << "Gate : " << g.min << " <= " << detector;
+        if (g.max != numeric_limits<unsigned int>::max())
+            ss << " <= " << g.max;
+        if (!gate.attribute("emin").empty() || !gate.attribute("emax").empty())
+            ss << " with " << g.emin << " <= E <= " << g.emax;
+        m.detail(ss.str());
+        ss.str("");
+    }
+
+    for (pugi::xml_node place = node.child("Place"); place; place = place.next_sibling("Place")) {
+        PlaceGate p;
+        p.name = place.attribute("name").as_string();
+        if (p.name.empty())
+            throw invalid_argument("EventSkimmer::EventSkimmer - A Place of the Skim node has no name.");
+        p.status = place.attribute("status").as_bool(true);
+        p.place = NULL;
+        places_.push_back(p);
+
+        ss << "Place : " << p.name << " is " << (p.status ? "true" : "false");
+        m.detail(ss.str());
+        ss.str("");
+    }
+
+    if (gates_.empty() && places_.empty())
+        throw invalid_argument("EventSkimmer::EventSkimmer - The Skim node needs at least one Gate or Place.");
+    counts_.resize(gates_.size());
+
+    string prefix = node.attribute("output").as_string();
+    if (prefix.empty())
+        prefix = Globals::get()->GetOutputFileName() + "_skim";
+    string path = node.attribute("path").as_string();
+    if (path.empty())
+        path = Globals::get()->GetOutputPath();
+    unsigned int runNumber = node.attribute("run").as_uint(0);
+
+    output_.SetFileFormat(1);
+    if (!output_.OpenNewFile("utkscan skim", runNumber, prefix, path))
+        throw IOException("EventSkimmer::EventSkimmer - Unable to open the skim " + prefix + " in " + path);
+
+    m.detail("Keeping the events that pass " + string(requireAll_ ? "all" : "any") + " of the gates");
+    m.detail("Writing the skim to " + output_.GetCurrentFilename());
+    m.done();
+}
+
+EventSkimmer::~EventSkimmer() {
+    try {
+        EndSpill();
+    } catch (IOException &ex) {
+        cout << ex.what() << endl;
+    }
+    output_.CloseFile();
+
+    Messenger m;
+    stringstream ss;
+    ss << "Skim kept " << numKept_ << " of " << numEvents_ << " events (" << numHits_ << " hits) in "
+       << output_.GetCurrentFilename();
+    m.run_message(ss.str());
+}
+
+void EventSkimmer::SetDataMask(const unsigned int &vsn, const XiaListModeDataMask &mask) {
+    if (vsn >= masks_.size())
+        masks_.resize(vsn + 1);
+    masks_[vsn] = mask;
+}
+
+const XiaListModeDataMask &EventSkimmer::GetDataMask(const unsigned int &vsn) {
+    if (vsn >= masks_.size() || masks_[vsn].GetFirmware() == DataProcessing::UNKNOWN)
+        throw invalid_argument("EventSkimmer::GetDataMask - There is no data mask to encode the hits of module "
+                               + to_string(vsn) + ".");
+    return masks_[vsn];
+}
+
+bool EventSkimmer::Select(const RawEvent &rawev) {
+    numEvents_++;
+    fill(counts_.begin(), counts_.end(), 0);
+
+    const vector<ChanEvent *> &events = rawev.GetEventList();
+    for (vector<ChanEvent *>::const_iterator it = events.begin(); it != events.end(); it++) {
+        const ChannelConfiguration &cfg = (*it)->GetChanID();
+        for (size_t i = 0; i < gates_.size(); i++) {
+            const Gate &g = gates_[i];
+            if (cfg.GetType() != g.type)
+                continue;
+            if (!g.subtype.empty() && cfg.GetSubtype() != g.subtype)
+                continue;
+            if (!g.tag.empty() && !cfg.HasTag(g.tag))
+                continue;
+            double energy = (*it)->GetCalibratedEnergy();
+            if (energy >= g.emin && energy <= g.emax)
+                counts_[i]++;
+        }
+    }
+
+    size_t numPassed = 0;
+    for (size_t i = 0; i < gates_.size(); i++)
+        if (counts_[i] >= gates_[i].min && counts_[i] <= gates_[i].max)
+            numPassed++;
+
+    //! The places only exist once the TreeCorrelator has been built
+    for (vector<PlaceGate>::iterator it = places_.begin(); it != places_.end(); it++) {
+        if (!it->place)
+            it->place = TreeCorrelator::get()->place(it->name);
+        if (it->place->status() == it->status)
+            numPassed++;
+    }
+
+    selected_ = requireAll_ ? numPassed == gates_.size() + places_.size() : numPassed != 0;
+    if (selected_)
+        numKept_++;
+    return selected_;
+}
+
+void EventSkimmer::Add(const std::deque<XiaData *> &hits) {
+    if (!selected_)
+        return;
+    selected_ = false;
+
+    for (deque<XiaData *>::const_iterator it = hits.begin(); it != hits.end(); it++) {
+        if (!(*it))
+            continue;
+        unsigned int vsn = (*it)->GetModuleNumber();
+        const XiaListModeDataMask &mask = GetDataMask(vsn);
+        if (vsn >= modules_.size())
+            modules_.resize(vsn + 1);
+        vector<unsigned int> words = encoder_.EncodeXiaData(*(*it), mask.GetFirmware(), mask.GetFrequency());
+        modules_[vsn].insert(modules_[vsn].end(), words.begin(), words.end());
+        numHits_++;
+    }
+    hasData_ = true;
+}
+
+void EventSkimmer::EndSpill(void) {
+    if (!hasData_)
+        return;
+    hasData_ = false;
+
+    //! Every module gets a buffer, the unpacker drops spills with missing modules
+    unsigned int numModules = max(numModules_, (unsigned int) modules_.size());
+    spill_.clear();
+    for (unsigned int vsn = 0; vsn < numModules; vsn++) {
+        unsigned int numWords = vsn < modules_.size() ? modules_[vsn].size() : 0;
+        spill_.push_back(numWords + 2);
+        spill_.push_back(vsn);
+        if (numWords != 0) {
+            spill_.insert(spill_.end(), modules_[vsn].begin(), modules_[vsn].end());
+            modules_[vsn].clear();
+        }
+    }
+
+    if (output_.Write((char *) &spill_[0], spill_.size()) < 0)
+        throw IOException("EventSkimmer::EndSpill - Unable to write the spill to " + output_.GetCurrentFilename());
+}
@@ -55,8 +55,11 @@ Globals::Globals(const std::string &file) {
 void Globals::InitializeMemberVariables() {
     sysClockFreqInHz_ = sysconf(_SC_CLK_TCK);
     hasRawHistogramsDefined_ = true;
-    outputFilename_ = outputPath_ = revision_ = "";
+    inputFilename_ = outputFilename_ = outputPath_ = revision_ = bananaFile_ = "";
+    liveHistogramsName_ = liveHistogramsSocket_ = "";
+    liveHistogramsPeriod_ = 1;
     eventLengthInTicks_ = 0;
+    sparseThresholdInMb_ = 0;
     adcClockInSeconds_ = clockInSeconds_ = eventLengthInSeconds_ =
     filterClockInSeconds_ = vandleBigSpeedOfLight_ =
     vandleMediumSpeedOfLight_ = vandleSmallSpeedOfLight_ = 0;
@@ -8,6 +8,7 @@
 
 #include "HelperFunctions.hpp"
 #include "GlobalsXmlParser.hpp"
+#include "StringManipulationFunctions.hpp"
 #include "TrapFilterParameters.hpp"
 #include "XmlInterface.hpp"
 
@@ -121,7 +122,54 @@ void GlobalsXmlParser::ParseGlobalNode(const pugi::xml_node &node, Globals *glob
     messenger_.detail(sstream_.str());
     sstream_.str("");
 
-    set <string> knownNodes = {"Revision", "EventWidth", "HasRaw", "DammPlots"};
+    if (!node.child("Bananas").empty()) {
+        globals->SetBananaFile(node.child("Bananas").attribute("file").as_string(""));
+        messenger_.detail("Banana gates : " + globals->GetBananaFile());
+    }
+
+    ///Large 2D histograms are kept in memory as tiles until they are flushed
+    /// to the .his file. The ids are the full DAMM ids, i.e. including the
+    /// offset of the processor that declares them. This is off unless the
+    /// node is given, the tiles reach the .his file only every 10M fills so
+    /// an online viewer of the file sees them update less often.
+    if (!node.child("SparseHistograms").empty()) {
+        pugi::xml_node sparse = node.child("SparseHistograms");
+        globals->SetSparseThresholdInMb(sparse.attribute("threshold").as_double(16));
+
+        vector<unsigned int> ids;
+        vector<string> tokens = StringManipulation::TokenizeString(
+                sparse.attribute("ids").as_string(""), ", ");
+        for (vector<string>::const_iterator it = tokens.begin(); it != tokens.end(); it++)
+            if (!it->empty())
+                ids.push_back((unsigned int) strtoul(it->c_str(), NULL, 10));
+        globals->SetSparseHistograms(ids);
+
+        sstream_ << "Sparse histograms : above " << globals->GetSparseThresholdInMb()
+                 << " MB and " << ids.size() << " selected by id";
+        messenger_.detail(sstream_.str());
+        sstream_.str("");
+    }
+
+    ///The histograms are published in a POSIX shared memory segment while
+    /// the scan runs, see LiveHistograms.hpp. The socket is optional.
+    if (!node.child("LiveHistograms").empty()) {
+        pugi::xml_node live = node.child("LiveHistograms");
+        string name = live.attribute("name").as_string("/utkscan");
+        if (name.empty() || name[0] != '/')
+            name = "/" + name;
+        globals->SetLiveHistogramsName(name);
+        globals->SetLiveHistogramsSocket(live.attribute("socket").as_string(""));
+        globals->SetLiveHistogramsPeriod(live.attribute("period").as_double(1));
+
+        sstream_ << "Live histograms : " << name << " every " << globals->GetLiveHistogramsPeriod() << " s";
+        if (!globals->GetLiveHistogramsSocket().empty())
+            sstream_ << ", queries on " << globals->GetLiveHistogramsSocket();
+        messenger_.detail(sstream_.str());
+        sstream_.str("");
+    }
+
+    set <string> knownNodes = {"Revision", "EventWidth", "HasRaw", "DammPlots", "Bananas",
+                               "SparseHistograms", "LiveHistograms", "TriggeredEvents"};
     WarnOfUnknownChildren(node, knownNodes);
 }
 
@@ -10,17 +10,23 @@
  * \author C. R. Thornsberry
  * \date Feb. 12th, 2016
  */
+#include <algorithm>
 #include <iostream>
 #include <iomanip>
 #include <fstream>
 #include <sstream>
 #include <vector>
 
+#include <fcntl.h>
 #include <string.h>
 #include <time.h>
 #include <math.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include "HisFile.hpp"
+#include "LiveHistograms.hpp"
+#include "StateArchive.hpp"
 
 #ifndef USE_HRIBF
 
@@ -173,6 +179,146 @@ unsigned int &HisData::operator[](const size_t &index_) {
     return data[index_];
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// class SparseHisData
+///////////////////////////////////////////////////////////////////////////////
+
+const size_t SparseHisData::TILE_BINS;
+const unsigned char SparseHisData::DIRTY_FILE;
+const unsigned char SparseHisData::DIRTY_LIVE;
+
+SparseHisData::SparseHisData(size_t total_bins_) {
+    total_bins = total_bins_;
+    num_allocated = 0;
+    tiles.assign((total_bins_ + TILE_BINS - 1) / TILE_BINS, NULL);
+    is_dirty.assign(tiles.size(), 0);
+    dirty_mask = DIRTY_FILE;
+}
+
+SparseHisData::~SparseHisData() {
+    this->Zero();
+}
+
+void SparseHisData::allocate_tile(size_t index_) {
+    tiles[index_] = new unsigned int[TILE_BINS](); // Zero initialized
+    num_allocated++;
+}
+
+void SparseHisData::mark_dirty(size_t index_) {
+    if (!(is_dirty[index_] & DIRTY_FILE))
+        dirty_tiles.push_back(index_);
+    if ((dirty_mask & DIRTY_LIVE) && !(is_dirty[index_] & DIRTY_LIVE))
+        live_tiles.push_back(index_);
+    is_dirty[index_] |= dirty_mask;
+}
+
+void SparseHisData::SetLiveTracking(bool track_) {
+    for (std::vector<size_t>::iterator iter = live_tiles.begin();
+         iter != live_tiles.end(); iter++)
+        is_dirty[*iter] &= ~DIRTY_LIVE;
+    live_tiles.clear();
+
+    if (!track_) {
+        dirty_mask = DIRTY_FILE;
+        return;
+    }
+
+    dirty_mask = DIRTY_FILE | DIRTY_LIVE;
+    for (size_t i = 0; i < tiles.size(); i++) {
+        if (tiles[i]) {
+            is_dirty[i] |= DIRTY_LIVE;
+            live_tiles.push_back(i);
+        }
+    }
+}
+
+size_t SparseHisData::Copy(char *image_, bool use_int_) {
+    for (std::vector<size_t>::iterator iter = live_tiles.begin();
+         iter != live_tiles.end(); iter++) {
+        size_t first = *iter * TILE_BINS;
+        size_t count = std::min(TILE_BINS, total_bins - first);
+        const unsigned int *tile = tiles[*iter];
+        is_dirty[*iter] &= ~DIRTY_LIVE;
+
+        if (use_int_) {
+            memcpy(image_ + first * 4, tile, count * 4);
+        } else {
+            unsigned short *cells = (unsigned short *) image_ + first;
+            for (size_t i = 0; i < count; i++)
+                cells[i] = (unsigned short) tile[i];
+        }
+    }
+
+    size_t num_copied = live_tiles.size();
+    live_tiles.clear();
+    return num_copied;
+}
+
+size_t SparseHisData::Write(std::fstream *file_, std::streampos offset_,
+                            bool use_int_) {
+    if (dirty_tiles.empty())
+        return 0;
+
+    // Write the tiles in file order so that the writes are sequential
+    std::sort(dirty_tiles.begin(), dirty_tiles.end());
+
+    std::vector<unsigned short> sdata(use_int_ ? 0 : TILE_BINS);
+    for (std::vector<size_t>::iterator iter = dirty_tiles.begin();
+         iter != dirty_tiles.end(); iter++) {
+        size_t first = *iter * TILE_BINS;
+        size_t count = std::min(TILE_BINS, total_bins - first);
+        const unsigned int *tile = tiles[*iter];
+        is_dirty[*iter] &= ~DIRTY_FILE;
+
+        if (use_int_) {
+            file_->seekp(offset_ + (std::streamoff) (first * 4), std::ios::beg);
+            file_->write((const char *) tile, count * 4);
+        } else {
+            // Short cells wrap around just like the queued fills do
+            for (size_t i = 0; i < count; i++)
+                sdata[i] = (unsigned short) tile[i];
+            file_->seekp(offset_ + (std::streamoff) (first * 2), std::ios::beg);
+            file_->write((const char *) &sdata[0], count * 2);
+        }
+    }
+
+    size_t num_written = dirty_tiles.size();
+    dirty_tiles.clear();
+    return num_written;
+}
+
+void SparseHisData::Zero() {
+    for (std::vector<unsigned int *>::iterator iter = tiles.begin();
+         iter != tiles.end(); iter++) {
+        delete[] (*iter);
+        *iter = NULL;
+    }
+    for (std::vector<size_t>::iterator iter = dirty_tiles.begin();
+         iter != dirty_tiles.end(); iter++)
+        is_dirty[*iter] = 0;
+    for (std::vector<size_t>::iterator iter = live_tiles.begin();
+         iter != live_tiles.end(); iter++)
+        is_dirty[*iter] = 0;
+    dirty_tiles.clear();
+    live_tiles.clear();
+    num_allocated = 0;
+}
+
+void SparseHisData::SetTile(size_t index_, const unsigned int *bins_) {
+    if (!tiles[index_])
+        allocate_tile(index_);
+    if (is_dirty[index_] != dirty_mask)
+        mark_dirty(index_);
+    memcpy(tiles[index_], bins_, TILE_BINS * sizeof(unsigned int));
+}
+
+size_t SparseHisData::GetMemoryUsage() const {
+    return (sizeof(SparseHisData) + tiles.capacity() * sizeof(unsigned int *) +
+            (dirty_tiles.capacity() + live_tiles.capacity()) * sizeof(size_t) +
+            is_dirty.capacity() +
+            num_allocated * TILE_BINS * sizeof(unsigned int));
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // struct drr_entry
 ///////////////////////////////////////////////////////////////////////////////
@@ -228,6 +374,8 @@ drr_entry::drr_entry(unsigned int hisID_, unsigned short halfWords_,
     total_size = total_bins * 2 * halfWords;
     total_counts = 0;
     good_counts = 0;
+    sparse = NULL;
+    live_index = 0;
 
     good = true;
     offset = 0; // The file offset will be set later
@@ -292,6 +440,8 @@ drr_entry::drr_entry(unsigned int hisID_, unsigned short halfWords_,
     set_char_array(title, std::string(title_), 40);
     total_counts = 0;
     good_counts = 0;
+    sparse = NULL;
+    live_index = 0;
 
     good = true;
     offset = 0; // The file offset will be set later
@@ -303,6 +453,10 @@ drr_entry::drr_entry(unsigned int hisID_, unsigned short halfWords_,
     }
 }
 
+drr_entry::~drr_entry() {
+    delete sparse;
+}
+
 void drr_entry::initialize() {
     if (hisDim == 1) {
         dx = ((float) (maxc[0] - minc[0])) / (scaled[0] - 1.0);
@@ -344,8 +498,9 @@ drr_entry::get_bin_xy(unsigned int bin_, unsigned int &x, unsigned int &y) {
 bool drr_entry::find_bin(unsigned int x_, unsigned int y_, unsigned int &bin) {
     if (!check_x_range(x_) ||
         !check_y_range(y_)) { return false; } // Range check
-    bin = ((unsigned int) roundf(y_ / dy) * scaled[0] +
-           (unsigned int) roundf(x_ / dx));
+    // A 1D histogram has dy = 0, its y value is ignored
+    bin = (hisDim < 2 ? 0 : (unsigned int) roundf(y_ / dy) * scaled[0]) +
+          (unsigned int) roundf(x_ / dx);
     return true;
 }
 
@@ -826,6 +981,12 @@ void OutputHisFile::Flush() {
     if (debug_mode)
         std::cout << "debug: Flushing histogram entries to file.\n";
 
+    flush_queue();
+    flush_sparse();
+}
+
+void OutputHisFile::flush_queue() {
+
     if (writable) { // Do the filling
         for (std::vector<fill_queue *>::iterator iter = fills_waiting.begin();
              iter != fills_waiting.end(); iter++) {
@@ -878,6 +1039,128 @@ void OutputHisFile::Flush() {
     Flush_count = 0;
 }
 
+void OutputHisFile::flush_sparse() {
+    if (writable) {
+        // Copy the tiles of the sparse histograms which changed over the file
+        for (std::map<unsigned int, drr_entry *>
+             ::iterator iter = drrMap_.begin();
+             iter != drrMap_.end();
+             iter++) {
+            if ((*iter).second->sparse)
+                (*iter).second->sparse->Write(&ofile,
+                                              (*iter).second->offset * 2,
+                                              (*iter).second->use_int);
+        }
+    }
+
+    Sparse_count = 0;
+}
+
+///The histograms are written one after the other with their id and size, so
+/// that a checkpoint of a different configuration is recognized. The bins
+/// of the queued histograms are copied from the file in blocks.
+void OutputHisFile::SaveState(StateWriter &writer_) {
+    flush_queue();
+
+    writer_.Write((uint64_t) drrMap_.size());
+    writer_.Write((uint64_t) total_his_size);
+    std::vector<char> block(1048576);
+    for (std::map<unsigned int, drr_entry *>::iterator iter = drrMap_.begin();
+         iter != drrMap_.end(); iter++) {
+        drr_entry *entry = (*iter).second;
+        writer_.Write(entry->hisID);
+        writer_.Write((uint64_t) entry->total_size);
+        writer_.Write(entry->total_counts);
+        writer_.Write(entry->good_counts);
+        writer_.Write(entry->sparse != NULL);
+
+        if (entry->sparse) {
+            writer_.Write((uint64_t) entry->sparse->GetNumTiles());
+            for (size_t i = 0; i < entry->sparse->GetTotalTiles(); i++) {
+                if (!entry->sparse->GetTile(i))
+                    continue;
+                writer_.Write((uint64_t) i);
+                writer_.WriteBytes(entry->sparse->GetTile(i),
+                                   SparseHisData::TILE_BINS * sizeof(unsigned int));
+            }
+            continue;
+        }
+
+        ofile.seekg(entry->offset * 2, std::ios::beg);
+        for (size_t done = 0; done < entry->total_size; done += block.size()) {
+            size_t count = std::min(block.size(), entry->total_size - done);
+            ofile.read(&block[0], count);
+            writer_.WriteBytes(&block[0], count);
+        }
+    }
+    if (!ofile.good())
+        throw IOException("OutputHisFile::SaveState - Could not read the .his file.");
+
+    writer_.Write(std::vector<unsigned int>(failed_fills.begin(), failed_fills.end()));
+}
+
+void OutputHisFile::LoadState(StateReader &reader_) {
+    if (!writable || !finalized)
+        throw IOException("OutputHisFile::LoadState - The histograms must be finalized first.");
+    if (reader_.Get<uint64_t>() != drrMap_.size() ||
+        reader_.Get<uint64_t>() != (uint64_t) total_his_size)
+        throw IOException("OutputHisFile::LoadState - The checkpoint was written with other histograms.");
+
+    std::vector<char> block(1048576);
+    std::vector<unsigned int> tile(SparseHisData::TILE_BINS);
+    for (std::map<unsigned int, drr_entry *>::iterator iter = drrMap_.begin();
+         iter != drrMap_.end(); iter++) {
+        drr_entry *entry = (*iter).second;
+        if (reader_.Get<unsigned int>() != entry->hisID ||
+            reader_.Get<uint64_t>() != entry->total_size)
+            throw IOException("OutputHisFile::LoadState - The histogram " +
+                              std::to_string(entry->hisID) +
+                              " of the checkpoint was declared differently.");
+        reader_.Read(entry->total_counts);
+        reader_.Read(entry->good_counts);
+        if (reader_.Get<bool>() != (entry->sparse != NULL))
+            throw IOException("OutputHisFile::LoadState - The histogram " +
+                              std::to_string(entry->hisID) +
+                              " of the checkpoint is stored differently.");
+
+        if (entry->sparse) {
+            Zero(entry->hisID);
+            for (uint64_t num = reader_.Get<uint64_t>(); num > 0; num--) {
+                uint64_t index = reader_.Get<uint64_t>();
+                if (index >= entry->sparse->GetTotalTiles())
+                    throw IOException("OutputHisFile::LoadState - A tile of the histogram " +
+                                      std::to_string(entry->hisID) + " does not exist.");
+                reader_.ReadBytes(&tile[0], tile.size() * sizeof(unsigned int));
+                entry->sparse->SetTile(index, &tile[0]);
+            }
+            continue;
+        }
+
+        ofile.seekp(entry->offset * 2, std::ios::beg);
+        if (live)
+            live->BeginWrite(entry->live_index);
+        for (size_t done = 0; done < entry->total_size; done += block.size()) {
+            size_t count = std::min(block.size(), entry->total_size - done);
+            reader_.ReadBytes(&block[0], count);
+            ofile.write(&block[0], count);
+            if (live)
+                memcpy(live->GetBins(entry->live_index) + done, &block[0], count);
+        }
+        if (live)
+            live->EndWrite(entry->live_index);
+    }
+    if (!ofile.good())
+        throw IOException("OutputHisFile::LoadState - Could not write the .his file.");
+
+    std::vector<unsigned int> failed;
+    reader_.Read(failed);
+    failed_fills.insert(failed.begin(), failed.end());
+
+    flush_sparse();
+    if (live)
+        PublishLive(true);
+}
+
 OutputHisFile::OutputHisFile() {
     fname = "";
     writable = false;
@@ -885,7 +1168,13 @@ OutputHisFile::OutputHisFile() {
     existing_file = false;
     Flush_wait = 100000;
     Flush_count = 0;
+    Sparse_wait = 10000000;
+    Sparse_count = 0;
     total_his_size = 0;
+    sparse_threshold = 0;
+    fd = -1;
+    live = NULL;
+    Live_period = 1.0;
 
     initialize();
 }
@@ -897,7 +1186,13 @@ OutputHisFile::OutputHisFile(std::string fname_prefix) {
     existing_file = false;
     Flush_wait = 100000;
     Flush_count = 0;
+    Sparse_wait = 10000000;
+    Sparse_count = 0;
     total_his_size = 0;
+    sparse_threshold = 0;
+    fd = -1;
+    live = NULL;
+    Live_period = 1.0;
 
     initialize();
     Open(fname_prefix);
@@ -928,24 +1223,30 @@ size_t OutputHisFile::push_back(drr_entry *entry) {
         return (0);
     }
 
-    // Seek to the end of this histogram file
-    ofile.seekp(0, std::ios::end);
-    entry->offset =
-            (size_t) ofile.tellp() / 2; // Set the file offset (in 2 byte words)
-    drrMap_.insert(std::make_pair(entry->hisID, entry));
-
     if (debug_mode)
         std::cout << "debug: Extending .his file by " << entry->total_size
                   << " bytes for his ID = " << entry->hisID << " i.e. '"
                   << rstrip(entry->title) << "'\n";
 
-    char *block = new char[entry->total_size];
-    memset(block, 0x0, entry->total_size);
-    ofile.write(block, entry->total_size);
-    delete[] block;
+    if (!extend_file(total_his_size + (std::streamoff) entry->total_size)) {
+        if (debug_mode)
+            std::cout << "debug: Failed to extend the .his file!\n";
+        return (0);
+    }
 
-    ofile.seekp(0, std::ios::end);
-    total_his_size = ofile.tellp();
+    // The histogram starts at the old end of the file
+    entry->offset = (size_t) total_his_size / 2; // Set the file offset (in 2 byte words)
+
+    // Large matrices are mostly empty, keep them in tiles until they are flushed
+    if (sparse_threshold > 0 && entry->hisDim == 2 &&
+        entry->total_size >= sparse_threshold && !entry->sparse) {
+        if (debug_mode)
+            std::cout << "debug: Using sparse storage for his ID = "
+                      << entry->hisID << std::endl;
+        entry->sparse = new SparseHisData(entry->total_bins);
+    }
+    drrMap_.insert(std::make_pair(entry->hisID, entry));
+    total_his_size += entry->total_size;
 
     return entry->total_size;
 }
@@ -1073,12 +1374,22 @@ bool OutputHisFile::Fill(unsigned int hisID_, unsigned int x_, unsigned int y_,
                                 (unsigned int) (y_ / temp_drr->comp[1]), bin))
             return (false);
 
-        // Push this fill into the queue
-        fill_queue *fill = new fill_queue(temp_drr, bin, weight_);
-        fills_waiting.push_back(fill);
-
-        if (++Flush_count >= Flush_wait)
-            Flush();
+        if (temp_drr->sparse) {
+            if (!temp_drr->check_bin(bin))
+                return (false);
+            temp_drr->sparse->Add(bin, weight_);
+            temp_drr->good_counts++;
+            if (++Sparse_count >= Sparse_wait)
+                flush_sparse();
+        } else {
+            // Push this fill into the queue
+            fill_queue *fill = new fill_queue(temp_drr, bin, weight_);
+            fills_waiting.push_back(fill);
+            if (live && fill->good)
+                live->Add(temp_drr->live_index, bin, weight_);
+            if (++Flush_count >= Flush_wait)
+                flush_queue();
+        }
     }
 
     return (false);
@@ -1095,11 +1406,19 @@ OutputHisFile::FillBin(unsigned int hisID_, unsigned int x_, unsigned int y_,
         temp_drr->total_counts++;
         if (!temp_drr->get_bin(x_, y_, bin)) { return false; }
 
-        // Push this fill into the queue
-        fill_queue *fill = new fill_queue(temp_drr, bin, weight_);
-        fills_waiting.push_back(fill);
-
-        if (++Flush_count >= Flush_wait) { Flush(); }
+        if (temp_drr->sparse) {
+            if (!temp_drr->check_bin(bin)) { return false; }
+            temp_drr->sparse->Add(bin, weight_);
+            temp_drr->good_counts++;
+            if (++Sparse_count >= Sparse_wait) { flush_sparse(); }
+        } else {
+            // Push this fill into the queue
+            fill_queue *fill = new fill_queue(temp_drr, bin, weight_);
+            fills_waiting.push_back(fill);
+            if (live && fill->good)
+                live->Add(temp_drr->live_index, bin, weight_);
+            if (++Flush_count >= Flush_wait) { flush_queue(); }
+        }
         return true;
     }
 
@@ -1111,14 +1430,11 @@ bool OutputHisFile::Zero(unsigned int hisID_) {
 
     drr_entry *temp_drr = find_drr_in_list(hisID_);
     if (temp_drr) {
-        ofile.seekp(temp_drr->offset * 2, std::ios::beg);
-
-        char *block = new char[temp_drr->total_size];
-        memset(block, 0x0, temp_drr->total_size);
-        ofile.write(block, temp_drr->total_size);
-        delete[] block;
-
-        return true;
+        if (temp_drr->sparse)
+            temp_drr->sparse->Zero();
+        if (live)
+            live->Zero(temp_drr->live_index);
+        return zero_range(temp_drr->offset * 2, temp_drr->total_size);
     }
 
     return false;
@@ -1132,13 +1448,14 @@ bool OutputHisFile::Zero() {
          ::iterator iter = drrMap_.begin();
          iter != drrMap_.end();
          iter++) {
-        ofile.seekp((*iter).second->offset * 2, std::ios::beg);
-        char *block = new char[(*iter).second->total_size];
-        memset(block, 0x0, (*iter).second->total_size);
-        ofile.write(block, (*iter).second->total_size);
-        delete[] block;
+        if ((*iter).second->sparse)
+            (*iter).second->sparse->Zero();
+        if (live)
+            live->Zero((*iter).second->live_index);
     }
-    return true;
+
+    // The histograms are stored back to back, so this is the whole file
+    return zero_range(0, total_his_size);
 }
 
 bool OutputHisFile::Open(std::string fname_prefix) {
@@ -1156,6 +1473,9 @@ bool OutputHisFile::Open(std::string fname_prefix) {
     ofile.open((fname + ".his").c_str(),
                std::ios::out | std::ios::in | std::ios::trunc |
                std::ios::binary);
+    total_his_size = 0;
+    if (ofile.good())
+        fd = ::open((fname + ".his").c_str(), O_RDWR);
     return (writable = ofile.good());
 }
 
@@ -1181,14 +1501,210 @@ void OutputHisFile::Close() {
              iter != failed_fills.end(); iter++) {
             log_file << std::setw(5) << *iter << std::endl;
         }
+        if (GetNumSparse() > 0) {
+            log_file << "\nSparse histograms:\n\n"
+                     << "  HID     TILES     TOTAL    MEMORY(kB)\n\n";
+            for (std::map<unsigned int, drr_entry *>
+                 ::iterator iter = drrMap_.begin();
+                 iter != drrMap_.end();
+                 iter++) {
+                SparseHisData *sparse = (*iter).second->sparse;
+                if (!sparse)
+                    continue;
+                log_file << std::setw(5) << (*iter).first << std::setw(10)
+                         << sparse->GetNumTiles() << std::setw(10)
+                         << sparse->GetTotalTiles() << std::setw(14)
+                         << sparse->GetMemoryUsage() / 1024 << std::endl;
+            }
+        }
     } else if (debug_mode) {
         std::cout << "debug: Failed to open the .log file for writing!\n";
     }
     log_file.close();
 
+    // Remove the live image, the spectra are all in the .his file now
+    delete live;
+    live = NULL;
+
     // Clear the .drr entries in the entries vector
     clear_drr_entries();
 
     writable = false;
     ofile.close();
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+bool OutputHisFile::SetSparse(unsigned int hisID_, bool sparse_/*=true*/) {
+    drr_entry *entry = FindEntry(hisID_);
+    if (!entry)
+        return false;
+
+    // The tiles hold the total bin contents, they cannot take over from the file
+    if (entry->total_counts > 0) {
+        if (debug_mode)
+            std::cout << "debug: His ID = " << hisID_
+                      << " was already filled, not changing its storage!\n";
+        return false;
+    }
+
+    if (sparse_ && !entry->sparse) {
+        entry->sparse = new SparseHisData(entry->total_bins);
+        if (live)
+            entry->sparse->SetLiveTracking(true);
+    } else if (!sparse_ && entry->sparse) {
+        delete entry->sparse;
+        entry->sparse = NULL;
+    }
+    return true;
+}
+
+bool OutputHisFile::OpenLive(const std::string &name_) {
+    if (!finalized || live)
+        return false;
+
+    // The image starts out empty, so nothing may have been filled yet
+    for (std::map<unsigned int, drr_entry *>
+         ::iterator iter = drrMap_.begin();
+         iter != drrMap_.end();
+         iter++) {
+        if ((*iter).second->total_counts > 0) {
+            if (debug_mode)
+                std::cout << "debug: His ID = " << (*iter).first
+                          << " was already filled, not publishing the histograms!\n";
+            return false;
+        }
+    }
+
+    live = new LiveHisWriter();
+    for (std::map<unsigned int, drr_entry *>
+         ::iterator iter = drrMap_.begin();
+         iter != drrMap_.end();
+         iter++) {
+        drr_entry *entry = (*iter).second;
+        entry->live_index = live->Declare(entry->hisID, entry->hisDim,
+                                          entry->halfWords, entry->scaled[0],
+                                          entry->scaled[1],
+                                          (uint64_t) entry->offset * 2,
+                                          entry->title);
+    }
+
+    if (!live->Open(name_, total_his_size)) {
+        delete live;
+        live = NULL;
+        return false;
+    }
+
+    for (std::map<unsigned int, drr_entry *>
+         ::iterator iter = drrMap_.begin();
+         iter != drrMap_.end();
+         iter++) {
+        if ((*iter).second->sparse)
+            (*iter).second->sparse->SetLiveTracking(true);
+    }
+    Live_last = std::chrono::steady_clock::now();
+    return true;
+}
+
+void OutputHisFile::PublishLive(bool force_/*=false*/) {
+    if (!live)
+        return;
+
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (!force_ && std::chrono::duration<double>(now - Live_last).count() < Live_period)
+        return;
+    Live_last = now;
+
+    for (std::map<unsigned int, drr_entry *>
+         ::iterator iter = drrMap_.begin();
+         iter != drrMap_.end();
+         iter++) {
+        drr_entry *entry = (*iter).second;
+        if (!entry->sparse)
+            continue;
+        live->BeginWrite(entry->live_index);
+        entry->sparse->Copy(live->GetBins(entry->live_index), entry->use_int);
+        live->EndWrite(entry->live_index);
+    }
+    live->Publish();
+}
+
+drr_entry *OutputHisFile::FindEntry(unsigned int hisID_) {
+    std::map<unsigned int, drr_entry *>::iterator it = drrMap_.find(hisID_);
+    return (it != drrMap_.end() ? (*it).second : NULL);
+}
+
+size_t OutputHisFile::GetNumSparse() const {
+    size_t num_sparse = 0;
+    for (std::map<unsigned int, drr_entry *>
+         ::const_iterator iter = drrMap_.begin();
+         iter != drrMap_.end();
+         iter++) {
+        if ((*iter).second->sparse)
+            num_sparse++;
+    }
+    return num_sparse;
+}
+
+size_t OutputHisFile::GetSparseMemoryUsage() const {
+    size_t total = 0;
+    for (std::map<unsigned int, drr_entry *>
+         ::const_iterator iter = drrMap_.begin();
+         iter != drrMap_.end();
+         iter++) {
+        if ((*iter).second->sparse)
+            total += (*iter).second->sparse->GetMemoryUsage();
+    }
+    return total;
+}
+
+size_t OutputHisFile::GetAllocatedSize() const {
+    struct stat info;
+    if (fd < 0 || fstat(fd, &info) != 0)
+        return (0);
+    return ((size_t) info.st_blocks * 512);
+}
+
+bool OutputHisFile::extend_file(std::streampos size_) {
+    // Anything still buffered in the stream has to reach the file first
+    ofile.flush();
+    if (fd >= 0 && ftruncate(fd, size_) == 0)
+        return (true);
+
+    // Without a descriptor we have to write out the zeros
+    ofile.seekp(0, std::ios::end);
+    const size_t chunk = 1 << 20;
+    std::vector<char> block(chunk, 0x0);
+    for (std::streamoff left = size_ - ofile.tellp(); left > 0; left -= chunk)
+        ofile.write(&block[0], std::min((std::streamoff) chunk, left));
+    ofile.flush();
+    return (ofile.good());
+}
+
+bool OutputHisFile::zero_range(std::streampos offset_, size_t size_) {
+    if (size_ == 0)
+        return (true);
+
+    ofile.flush();
+#ifdef FALLOC_FL_PUNCH_HOLE
+    // Give the blocks back to the file system, the range reads as zeros
+    if (fd >= 0 && fallocate(fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+                             offset_, size_) == 0)
+        return (true);
+#endif
+#ifdef FALLOC_FL_ZERO_RANGE
+    if (fd >= 0 && fallocate(fd, FALLOC_FL_ZERO_RANGE | FALLOC_FL_KEEP_SIZE,
+                             offset_, size_) == 0)
+        return (true);
+#endif
+
+    ofile.seekp(offset_, std::ios::beg);
+    const size_t chunk = 1 << 20;
+    std::vector<char> block(std::min(chunk, size_), 0x0);
+    for (size_t left = size_; left > 0; left -= std::min(chunk, left))
+        ofile.write(&block[0], std::min(chunk, left));
+    ofile.flush();
+    return (ofile.good());
 }
@@ -0,0 +1,370 @@
+/*! \file LiveHistograms.cpp
+ *  \brief Publishes the histograms of a running scan in POSIX shared memory
+ *  \date October 19, 2026
+*/
+#include <algorithm>
+#include <new>
+#include <sstream>
+
+#include <cstring>
+#include <ctime>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "LiveHistograms.hpp"
+
+using namespace std;
+
+namespace {
+    const char LIVE_MAGIC[8] = {'P', 'A', 'A', 'S', 'S', 'H', 'I', 'S'};
+
+    ///Size of the header and directory rounded up to a whole page, so that the
+    /// image starts page aligned like the .his file does.
+    uint64_t GetDataOffset(const size_t &numHistograms) {
+        uint64_t size = sizeof(LiveHisHeader) + numHistograms * sizeof(LiveHisEntry);
+        uint64_t page = (uint64_t) sysconf(_SC_PAGESIZE);
+        return (size + page - 1) / page * page;
+    }
+
+    ///Writes all of the bytes to a socket
+    bool WriteAll(const int &fd, const char *buf, size_t len) {
+        while (len > 0) {
+            ssize_t num = send(fd, buf, len, MSG_NOSIGNAL);
+            if (num <= 0)
+                return false;
+            buf += num;
+            len -= num;
+        }
+        return true;
+    }
+}
+
+const uint32_t LiveHisWriter::VERSION;
+
+LiveHisWriter::LiveHisWriter() : size_(0), header_(NULL), entries_(NULL), data_(NULL) {}
+
+LiveHisWriter::~LiveHisWriter() {
+    Close();
+    for (vector<LiveHisEntry *>::iterator it = declared_.begin(); it != declared_.end(); it++)
+        delete *it;
+}
+
+size_t LiveHisWriter::Declare(const unsigned int &hisID, const unsigned short &hisDim,
+                              const unsigned short &halfWords, const unsigned short &scaledX,
+                              const unsigned short &scaledY, const uint64_t &offset,
+                              const std::string &title) {
+    LiveHisEntry *entry = new LiveHisEntry();
+    entry->hisID = hisID;
+    entry->hisDim = hisDim;
+    entry->halfWords = halfWords;
+    entry->scaled[0] = scaledX;
+    entry->scaled[1] = hisDim > 1 ? scaledY : 1;
+    entry->offset = offset;
+    entry->totalBins = (uint64_t) entry->scaled[0] * entry->scaled[1];
+    strncpy(entry->title, title.c_str(), sizeof(entry->title) - 1);
+    entry->title[sizeof(entry->title) - 1] = '\0';
+    declared_.push_back(entry);
+    return declared_.size() - 1;
+}
+
+bool LiveHisWriter::Open(const std::string &name, const uint64_t &dataSize) {
+    if (IsOpen())
+        return false;
+
+    uint64_t dataOffset = GetDataOffset(declared_.size());
+    size_t size = dataOffset + dataSize;
+
+    //! Remove a segment left behind by a scan that crashed
+    shm_unlink(name.c_str());
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0)
+        return false;
+
+    //! ftruncate leaves a hole, pages are only allocated when they are written
+    void *addr = MAP_FAILED;
+    if (ftruncate(fd, size) == 0)
+        addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    name_ = name;
+    size_ = size;
+    header_ = new(addr) LiveHisHeader();
+    entries_ = (LiveHisEntry *) ((char *) addr + sizeof(LiveHisHeader));
+    data_ = (char *) addr + dataOffset;
+
+    header_->version = VERSION;
+    header_->numHistograms = declared_.size();
+    header_->dataOffset = dataOffset;
+    header_->dataSize = dataSize;
+    header_->numUpdates.store(0);
+    header_->lastUpdate.store(time(NULL));
+    header_->pid = getpid();
+
+    for (size_t i = 0; i < declared_.size(); i++) {
+        LiveHisEntry *entry = new(&entries_[i]) LiveHisEntry();
+        entry->sequence.store(0, memory_order_relaxed);
+        entry->hisID = declared_[i]->hisID;
+        entry->hisDim = declared_[i]->hisDim;
+        entry->halfWords = declared_[i]->halfWords;
+        entry->scaled[0] = declared_[i]->scaled[0];
+        entry->scaled[1] = declared_[i]->scaled[1];
+        entry->offset = declared_[i]->offset;
+        entry->totalBins = declared_[i]->totalBins;
+        memcpy(entry->title, declared_[i]->title, sizeof(entry->title));
+        delete declared_[i];
+    }
+    declared_.clear();
+
+    //! Readers check the magic last, so they never see a half built directory
+    atomic_thread_fence(memory_order_release);
+    memcpy(header_->magic, LIVE_MAGIC, sizeof(LIVE_MAGIC));
+    return true;
+}
+
+void LiveHisWriter::Close(void) {
+    if (!IsOpen())
+        return;
+    munmap(header_, size_);
+    shm_unlink(name_.c_str());
+    header_ = NULL;
+    entries_ = NULL;
+    data_ = NULL;
+    size_ = 0;
+}
+
+void LiveHisWriter::Zero(const size_t &index) {
+    BeginWrite(index);
+    memset(GetBins(index), 0, entries_[index].totalBins * entries_[index].halfWords * 2);
+    EndWrite(index);
+}
+
+void LiveHisWriter::Publish(void) {
+    header_->lastUpdate.store(time(NULL), memory_order_relaxed);
+    header_->numUpdates.fetch_add(1, memory_order_release);
+}
+
+LiveHisReader::LiveHisReader() : size_(0), header_(NULL), entries_(NULL), data_(NULL) {}
+
+LiveHisReader::~LiveHisReader() {
+    Close();
+}
+
+bool LiveHisReader::Open(const std::string &name) {
+    Close();
+
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0)
+        return false;
+
+    struct stat info;
+    void *addr = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && (size_t) info.st_size >= sizeof(LiveHisHeader))
+        addr = mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED)
+        return false;
+
+    const LiveHisHeader *header = (const LiveHisHeader *) addr;
+    atomic_thread_fence(memory_order_acquire);
+    if (memcmp(header->magic, LIVE_MAGIC, sizeof(LIVE_MAGIC)) != 0 ||
+        header->version != LiveHisWriter::VERSION ||
+        header->dataOffset + header->dataSize > (uint64_t) info.st_size) {
+        munmap(addr, info.st_size);
+        return false;
+    }
+
+    size_ = info.st_size;
+    header_ = header;
+    entries_ = (const LiveHisEntry *) ((const char *) addr + sizeof(LiveHisHeader));
+    data_ = (const char *) addr + header->dataOffset;
+    return true;
+}
+
+void LiveHisReader::Close(void) {
+    if (!IsOpen())
+        return;
+    munmap((void *) header_, size_);
+    header_ = NULL;
+    entries_ = NULL;
+    data_ = NULL;
+    size_ = 0;
+}
+
+const LiveHisEntry *LiveHisReader::FindEntry(const unsigned int &hisID) const {
+    for (size_t i = 0; i < GetNumHistograms(); i++)
+        if (entries_[i].hisID == hisID)
+            return &entries_[i];
+    return NULL;
+}
+
+uint64_t LiveHisReader::GetNumUpdates(void) const {
+    return header_ ? header_->numUpdates.load(memory_order_acquire) : 0;
+}
+
+int64_t LiveHisReader::GetLastUpdate(void) const {
+    return header_ ? header_->lastUpdate.load(memory_order_relaxed) : 0;
+}
+
+bool LiveHisReader::Read(const unsigned int &hisID, std::vector<unsigned int> &bins,
+                         const unsigned int &maxTries/*=1000*/) const {
+    const LiveHisEntry *entry = FindEntry(hisID);
+    if (!entry)
+        return false;
+
+    const char *first = data_ + entry->offset;
+    bins.resize(entry->totalBins);
+    for (unsigned int i = 0; i < maxTries; i++) {
+        uint32_t before = entry->sequence.load(memory_order_acquire);
+        if (before % 2 == 1) {
+            this_thread::yield();
+            continue;
+        }
+
+        if (entry->halfWords == 2)
+            memcpy(&bins[0], first, entry->totalBins * 4);
+        else
+            copy((const uint16_t *) first, (const uint16_t *) first + entry->totalBins,
+                 bins.begin());
+
+        atomic_thread_fence(memory_order_acquire);
+        if (entry->sequence.load(memory_order_relaxed) == before)
+            return true;
+    }
+    return false;
+}
+
+HistogramServer::HistogramServer(const std::string &segment, const std::string &socketPath) :
+        segment_(segment), socketPath_(socketPath), listenFd_(-1), stop_(false) {}
+
+HistogramServer::~HistogramServer() {
+    Stop();
+}
+
+bool HistogramServer::Start(void) {
+    if (IsRunning() || !reader_.Open(segment_))
+        return false;
+
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (socketPath_.size() >= sizeof(address.sun_path))
+        return false;
+    strcpy(address.sun_path, socketPath_.c_str());
+
+    unlink(socketPath_.c_str());
+    listenFd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd_ < 0)
+        return false;
+    if (bind(listenFd_, (sockaddr *) &address, sizeof(address)) != 0 ||
+        listen(listenFd_, 4) != 0) {
+        close(listenFd_);
+        listenFd_ = -1;
+        return false;
+    }
+
+    stop_ = false;
+    thread_ = thread(&HistogramServer::Run, this);
+    return true;
+}
+
+void HistogramServer::Stop(void) {
+    stop_ = true;
+    if (thread_.joinable())
+        thread_.join();
+    if (listenFd_ >= 0) {
+        close(listenFd_);
+        unlink(socketPath_.c_str());
+        listenFd_ = -1;
+    }
+    reader_.Close();
+}
+
+std::string HistogramServer::Process(const std::string &request) const {
+    stringstream input(request), output;
+    string command;
+    input >> command;
+
+    if (command == "LIST") {
+        output << "OK " << reader_.GetNumHistograms() << "\n";
+        for (size_t i = 0; i < reader_.GetNumHistograms(); i++) {
+            const LiveHisEntry &entry = reader_.GetEntry(i);
+            output << entry.hisID << " " << entry.hisDim << " " << entry.scaled[0]
+                   << " " << entry.scaled[1] << " " << entry.title << "\n";
+        }
+    } else if (command == "INFO") {
+        output << "OK " << reader_.GetNumUpdates() << " " << reader_.GetLastUpdate()
+               << " " << reader_.GetWriterPid() << "\n";
+    } else if (command == "GET") {
+        unsigned int hisID;
+        vector<unsigned int> bins;
+        if (!(input >> hisID))
+            return "ERR Usage : GET <id>\n";
+        if (!reader_.FindEntry(hisID))
+            return "ERR Unknown histogram\n";
+        if (!reader_.Read(hisID, bins))
+            return "ERR Histogram is busy\n";
+
+        const LiveHisEntry *entry = reader_.FindEntry(hisID);
+        output << "OK " << hisID << " " << entry->hisDim << " " << entry->scaled[0] << " "
+               << entry->scaled[1] << " " << bins.size() << "\n";
+        output.write((const char *) &bins[0], bins.size() * sizeof(unsigned int));
+    } else
+        return "ERR Unknown request\n";
+
+    return output.str();
+}
+
+void HistogramServer::Run(void) {
+    pollfd listener = {listenFd_, POLLIN, 0};
+    while (!stop_) {
+        //! Wake up regularly to see if we were asked to stop
+        if (poll(&listener, 1, 100) <= 0)
+            continue;
+        int fd = accept(listenFd_, NULL, NULL);
+        if (fd >= 0) {
+            Serve(fd);
+            close(fd);
+        }
+    }
+}
+
+void HistogramServer::Serve(const int &fd) {
+    pollfd client = {fd, POLLIN, 0};
+    string pending;
+    char buf[256];
+    while (!stop_) {
+        if (poll(&client, 1, 100) <= 0)
+            continue;
+        ssize_t num = recv(fd, buf, sizeof(buf), 0);
+        if (num <= 0)
+            return;
+        pending.append(buf, num);
+
+        size_t end;
+        while ((end = pending.find('\n')) != string::npos) {
+            string request = pending.substr(0, end);
+            pending.erase(0, end + 1);
+            if (!request.empty() && request[request.size() - 1] == '\r')
+                request.erase(request.size() - 1);
+            if (request == "QUIT")
+                return;
+            string response = Process(request);
+            if (!WriteAll(fd, response.data(), response.size()))
+                return;
+        }
+
+        //! Nobody sends requests this long, drop the client
+        if (pending.size() > 4096)
+            return;
+    }
+}
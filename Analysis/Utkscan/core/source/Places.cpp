@@ -3,15 +3,95 @@
 * \author K. A. Miernik
 * \date October 22, 2012
 */
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 #include <map>
 
-#include "TreeCorrelator.hpp"
 #include "Exceptions.hpp"
+#include "StateArchive.hpp"
+#include "TreeCorrelator.hpp"
 
 using namespace std;
 
+std::recursive_mutex Place::mutex_;
+bool Place::threadSafe_ = false;
+
+const unsigned int PlaceUsage::MAX_USERS;
+thread_local int PlaceUsage::user_ = -1;
+thread_local unsigned int PlaceUsage::phase_ = 0;
+std::atomic<bool> PlaceUsage::hasShared_(false);
+std::mutex PlaceUsage::sharedMutex_;
+std::set<std::pair<unsigned int, unsigned int> > PlaceUsage::shared_;
+
+///A user is only compared with the others the first time it uses the place
+/// in a phase. Whichever of two users comes second finds the first one.
+void PlaceUsage::Use(const bool &write) {
+    uint64_t bit = (uint64_t) 1 << user_;
+    std::atomic<uint64_t> &uses = write ? writers_[phase_] : readers_[phase_];
+    if (uses.fetch_or(bit) & bit)
+        return;
+
+    uint64_t others = writers_[phase_].load();
+    if (write)
+        others |= readers_[phase_].load();
+    others &= ~bit;
+    if (others == 0)
+        return;
+
+    lock_guard<mutex> lock(sharedMutex_);
+    for (unsigned int i = 0; i < MAX_USERS; i++)
+        if (others >> i & 1)
+            shared_.insert(make_pair(min(i, (unsigned int) user_), max(i, (unsigned int) user_)));
+    hasShared_ = true;
+}
+
+set<pair<unsigned int, unsigned int> > PlaceUsage::TakeShared(void) {
+    set<pair<unsigned int, unsigned int> > shared;
+    if (!hasShared_)
+        return shared;
+    lock_guard<mutex> lock(sharedMutex_);
+    shared.swap(shared_);
+    hasShared_ = false;
+    return shared;
+}
+
+void Place::SaveState(StateWriter &writer) const {
+    writer.Write(status_);
+    writer.Write((uint64_t) info_.size());
+    for (deque<EventData>::const_iterator it = info_.begin(); it != info_.end(); ++it) {
+        writer.Write(it->status);
+        writer.Write(it->time);
+        writer.Write(it->energy);
+        writer.Write(it->location);
+        writer.Write(it->type);
+    }
+}
+
+void Place::LoadState(StateReader &reader) {
+    reader.Read(status_);
+    info_.clear();
+    for (uint64_t i = reader.Get<uint64_t>(); i > 0; i--) {
+        EventData info(0);
+        reader.Read(info.status);
+        reader.Read(info.time);
+        reader.Read(info.energy);
+        reader.Read(info.location);
+        reader.Read(info.type);
+        info_.push_back(info);
+    }
+}
+
+void PlaceCounter::SaveState(StateWriter &writer) const {
+    Place::SaveState(writer);
+    writer.Write(counter_);
+}
+
+void PlaceCounter::LoadState(StateReader &reader) {
+    Place::LoadState(reader);
+    reader.Read(counter_);
+}
+
 bool Place::checkParents(Place *child) {
     bool isAllDifferent = true;
     vector<Place *>::iterator it;
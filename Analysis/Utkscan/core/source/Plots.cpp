@@ -9,10 +9,130 @@
 #include <cmath>
 #include <cstring>
 
+#include "BananaGate.hpp"
 #include "Plots.hpp"
 
 using namespace std;
 
+bool Plots::threadSafe_ = false;
+bool Plots::skip2D_ = false;
+std::mutex Plots::fillMutex_;
+
+///Finds the .drr entry of a histogram that can be filled straight into
+/// memory. The channels have to map one to one onto the bins after the
+/// compression, which is the case unless the histogram was declared with a
+/// channel range. The histogram is switched to the sparse storage, whose
+/// tiles then hold the bins.
+static drr_entry *FindDirectEntry(const int &dammId, const unsigned short &dim) {
+    if (!output_his)
+        return NULL;
+    drr_entry *entry = output_his->FindEntry(dammId);
+    if (!entry || !entry->good || entry->hisDim != dim)
+        return NULL;
+    for (unsigned short i = 0; i < dim; i++)
+        if (entry->comp[i] == 0 || entry->minc[i] != 0 ||
+            entry->maxc[i] + 1 != entry->scaled[i])
+            return NULL;
+    if (!entry->sparse && !output_his->SetSparse(dammId))
+        return NULL;
+    return entry;
+}
+
+void Histogram1D::FillSlow(const double &x, const unsigned int &weight) {
+    if (!plots_)
+        return;
+
+    if (!resolved_) {
+        {
+            //! The .drr entries are shared with the threads filling other histograms
+            unique_lock<mutex> lock(Plots::fillMutex_, defer_lock);
+            if (Plots::threadSafe_)
+                lock.lock();
+            entry_ = FindDirectEntry(id_ + plots_->GetOffset(), 1);
+        }
+        resolved_ = true;
+        if (entry_) {
+            data_ = entry_->sparse;
+            comp_ = entry_->comp[0];
+            size_ = entry_->scaled[0];
+            Fill(x, weight);
+            return;
+        }
+    }
+
+    //! Plot takes the second value as y, the weight of a 1D fill goes third
+    if (weight == 1)
+        plots_->Plot(id_, x);
+    else if (weight > 0)
+        plots_->Plot(id_, x, 0, weight);
+}
+
+void Histogram1D::Fill(const std::vector<double> &x, const unsigned int &weight/*=1*/) {
+    if (!data_) {
+        for (vector<double>::const_iterator it = x.begin(); it != x.end(); it++)
+            Fill(*it, weight);
+        return;
+    }
+
+    unique_lock<mutex> lock(Plots::fillMutex_, defer_lock);
+    if (Plots::threadSafe_)
+        lock.lock();
+    unsigned int numGood = 0;
+    for (vector<double>::const_iterator it = x.begin(); it != x.end(); it++)
+        numGood += Add(*it, weight);
+    output_his->CountSparseFills(numGood);
+}
+
+void Histogram2D::FillSlow(const double &x, const double &y,
+                           const unsigned int &weight) {
+    if (!plots_)
+        return;
+
+    if (!resolved_) {
+        {
+            //! The .drr entries are shared with the threads filling other histograms
+            unique_lock<mutex> lock(Plots::fillMutex_, defer_lock);
+            if (Plots::threadSafe_)
+                lock.lock();
+            entry_ = FindDirectEntry(id_ + plots_->GetOffset(), 2);
+        }
+        resolved_ = true;
+        if (entry_) {
+            data_ = entry_->sparse;
+            compX_ = entry_->comp[0];
+            compY_ = entry_->comp[1];
+            sizeX_ = entry_->scaled[0];
+            sizeY_ = entry_->scaled[1];
+            Fill(x, y, weight);
+            return;
+        }
+    }
+
+    if (weight == 1)
+        plots_->Plot(id_, x, y);
+    else if (weight > 0)
+        plots_->Plot(id_, x, y, weight);
+}
+
+void Histogram2D::Fill(const std::vector<std::pair<double, double> > &xy,
+                       const unsigned int &weight/*=1*/) {
+    if (Plots::skip2D_)
+        return;
+    if (!data_) {
+        for (vector<pair<double, double> >::const_iterator it = xy.begin(); it != xy.end(); it++)
+            Fill(it->first, it->second, weight);
+        return;
+    }
+
+    unique_lock<mutex> lock(Plots::fillMutex_, defer_lock);
+    if (Plots::threadSafe_)
+        lock.lock();
+    unsigned int numGood = 0;
+    for (vector<pair<double, double> >::const_iterator it = xy.begin(); it != xy.end(); it++)
+        numGood += Add(it->first, it->second, weight);
+    output_his->CountSparseFills(numGood);
+}
+
 Plots::Plots(int offset, int range, std::string name) {
     offset_ = offset;
     range_ = range;
@@ -21,9 +141,33 @@ Plots::Plots(int offset, int range, std::string name) {
 }
 
 bool Plots::BananaTest(const int &id, const double &x, const double &y) {
+    const BananaGate *gate = BananaLibrary::get()->Find(id);
+    if (gate)
+        return gate->Test(Round(x), Round(y));
     return (bantesti_(id, Round(x), Round(y)));
 }
 
+unsigned int Plots::BananaTest(const int &id,
+                               const std::vector<std::pair<double, double> > &points,
+                               std::vector<unsigned char> &result) {
+    vector<pair<int, int> > channels;
+    channels.reserve(points.size());
+    for (vector<pair<double, double> >::const_iterator it = points.begin(); it != points.end(); it++)
+        channels.push_back(make_pair(Round(it->first), Round(it->second)));
+
+    const BananaGate *gate = BananaLibrary::get()->Find(id);
+    if (gate)
+        return gate->Test(channels, result);
+
+    unsigned int numInside = 0;
+    result.resize(channels.size());
+    for (unsigned int i = 0; i < channels.size(); i++) {
+        result[i] = bantesti_(id, channels[i].first, channels[i].second);
+        numInside += result[i];
+    }
+    return numInside;
+}
+
 /** Check if the id falls within the expected range */
 bool Plots::CheckRange(int id) const {
     return (id < range_ && id >= 0);
@@ -42,9 +186,9 @@ bool Plots::Exists(const std::string &mne) const {
 }
 
 /** Constructors based on DeclareHistogram functions. */
-bool Plots::DeclareHistogram1D(int dammId, int xSize, const char *title,
-                               int halfWordsPerChan, int xHistLength,
-                               int xLow, int xHigh, const std::string &mne) {
+Histogram1D Plots::DeclareHistogram1D(int dammId, int xSize, const char *title,
+                                      int halfWordsPerChan, int xHistLength,
+                                      int xLow, int xHigh, const std::string &mne) {
     if (!CheckRange(dammId)) {
         stringstream ss;
         ss << "Plots: Histogram titled '" << title << "' requests id "
@@ -62,36 +206,36 @@ bool Plots::DeclareHistogram1D(int dammId, int xSize, const char *title,
 
     pair<set<int>::iterator, bool> result = idList_.insert(dammId);
     if (result.second == false)
-        return false;
+        return Histogram1D();
     // Mnemonic is optional and added only if longer then 0
     if (mne.size() > 0)
         mneList.insert(pair<string, int>(mne, dammId));
     hd1d_(dammId + offset_, halfWordsPerChan, xSize, xHistLength,
           xLow, xHigh, title, strlen(title));
     titleList.insert(pair<int, string>(dammId, string(title)));
-    return true;
+    return Histogram1D(this, dammId);
 }
 
-bool Plots::DeclareHistogram1D(int dammId, int xSize, const char *title,
-                               int halfWordsPerChan /* = 2*/,
-                               const std::string &mne /*=empty*/ ) {
+Histogram1D Plots::DeclareHistogram1D(int dammId, int xSize, const char *title,
+                                      int halfWordsPerChan /* = 2*/,
+                                      const std::string &mne /*=empty*/ ) {
     return DeclareHistogram1D(dammId, xSize, title, halfWordsPerChan,
                               xSize, 0, xSize - 1, mne);
 }
 
-bool Plots::DeclareHistogram1D(int dammId, int xSize, const char *title,
-                               int halfWordsPerChan, int contraction,
-                               const std::string &mne) {
+Histogram1D Plots::DeclareHistogram1D(int dammId, int xSize, const char *title,
+                                      int halfWordsPerChan, int contraction,
+                                      const std::string &mne) {
     return DeclareHistogram1D(dammId, xSize, title, halfWordsPerChan,
                               xSize / contraction, 0, xSize / contraction - 1,
                               mne);
 }
 
-bool Plots::DeclareHistogram2D(int dammId, int xSize, int ySize,
-                               const char *title, int halfWordsPerChan,
-                               int xHistLength, int xLow, int xHigh,
-                               int yHistLength, int yLow, int yHigh,
-                               const std::string &mne) {
+Histogram2D Plots::DeclareHistogram2D(int dammId, int xSize, int ySize,
+                                      const char *title, int halfWordsPerChan,
+                                      int xHistLength, int xLow, int xHigh,
+                                      int yHistLength, int yLow, int yHigh,
+                                      const std::string &mne) {
     if (!CheckRange(dammId)) {
         stringstream ss;
         ss << "Plots: Histogram titled '" << title << "' requests id "
@@ -109,7 +253,7 @@ bool Plots::DeclareHistogram2D(int dammId, int xSize, int ySize,
 
     pair<set<int>::iterator, bool> result = idList_.insert(dammId);
     if (result.second == false)
-        return (false);
+        return Histogram2D();
     // Mnemonic is optional and added only if longer then 0
     if (mne.size() > 0)
         mneList.insert(pair<string, int>(mne, dammId));
@@ -117,22 +261,22 @@ bool Plots::DeclareHistogram2D(int dammId, int xSize, int ySize,
     hd2d_(dammId + offset_, halfWordsPerChan, xSize, xHistLength, xLow, xHigh,
           ySize, yHistLength, yLow, yHigh, title, strlen(title));
     titleList.insert(pair<int, string>(dammId, string(title)));
-    return true;
+    return Histogram2D(this, dammId);
 }
 
-bool Plots::DeclareHistogram2D(int dammId, int xSize, int ySize,
-                               const char *title,
-                               int halfWordsPerChan /* = 1*/,
-                               const std::string &mne /* = empty*/) {
+Histogram2D Plots::DeclareHistogram2D(int dammId, int xSize, int ySize,
+                                      const char *title,
+                                      int halfWordsPerChan /* = 1*/,
+                                      const std::string &mne /* = empty*/) {
     return DeclareHistogram2D(dammId, xSize, ySize, title, halfWordsPerChan,
                               xSize, 0, xSize - 1,
                               ySize, 0, ySize - 1, mne);
 }
 
-bool Plots::DeclareHistogram2D(int dammId, int xSize, int ySize,
-                               const char *title, int halfWordsPerChan,
-                               int xContraction, int yContraction,
-                               const std::string &mne) {
+Histogram2D Plots::DeclareHistogram2D(int dammId, int xSize, int ySize,
+                                      const char *title, int halfWordsPerChan,
+                                      int xContraction, int yContraction,
+                                      const std::string &mne) {
     return DeclareHistogram2D(dammId, xSize, ySize, title, halfWordsPerChan,
                               xSize / xContraction, 0, xSize / xContraction - 1,
                               ySize / yContraction, 0, ySize / yContraction - 1,
@@ -153,6 +297,17 @@ bool Plots::Plot(int dammId, double val1, double val2, double val3,
         return (false);
     }
 
+    //! Only a fill with a y value can be into a 2D histogram
+    if (skip2D_ && val2 != -1 && output_his) {
+        drr_entry *entry = output_his->FindEntry(dammId + offset_);
+        if (entry && entry->hisDim == 2)
+            return (false);
+    }
+
+    unique_lock<mutex> lock(fillMutex_, defer_lock);
+    if (threadSafe_)
+        lock.lock();
+
     if (val2 == -1 && val3 == -1)
         count1cc_(dammId + offset_, int(val1), 1);
     else if (val3 == -1 || val3 == 0)
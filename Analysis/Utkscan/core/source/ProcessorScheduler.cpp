@@ -0,0 +1,446 @@
+/*! \file ProcessorScheduler.cpp
+ *  \brief Schedules the PreProcess and Process calls of the EventProcessors
+ *  \date October 19, 2026
+*/
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+#include "EventProcessor.hpp"
+#include "Exceptions.hpp"
+#include "Messenger.hpp"
+#include "Places.hpp"
+#include "Plots.hpp"
+#include "ProcessorScheduler.hpp"
+
+using namespace std;
+
+const unsigned long ProcessorScheduler::LEARNING_EVENTS;
+
+ProcessorScheduler::ProcessorScheduler() : numThreads_(1), learning_(0), hasDependencies_(false),
+        stop_(false), generation_(0), busy_(0), next_(0), event_(NULL),
+        phase_(PREPROCESS) {
+    for (unsigned int i = 0; i < NUM_PHASES; i++) {
+        criticalPath_[i] = 0.0;
+        numEvents_[i] = 0;
+    }
+}
+
+ProcessorScheduler::~ProcessorScheduler() {
+    StopWorkers();
+}
+
+void ProcessorScheduler::SetProcessors(const std::vector<EventProcessor *> &procs,
+                                       const unsigned int &numThreads) {
+    StopWorkers();
+    procs_ = procs;
+    numThreads_ = numThreads;
+    placeEdges_.clear();
+    learning_ = 0;
+    nodes_.clear();
+    Build();
+
+    Messenger m;
+    stringstream ss;
+    ss << "Scheduling " << nodes_.size() << " processors in "
+       << levels_.size() << " level(s)";
+    if (hasDependencies_ && numThreads > 1 && procs.size() > PlaceUsage::MAX_USERS) {
+        ss << ", one at a time since the places of more than " << PlaceUsage::MAX_USERS
+           << " processors cannot be followed";
+    } else if (hasDependencies_ && numThreads > 1) {
+        ss << " on " << numThreads << " threads, the first " << LEARNING_EVENTS
+           << " events one at a time to find the processors sharing places";
+        Plots::SetThreadSafe(true);
+        Place::SetThreadSafe(true);
+        learning_ = LEARNING_EVENTS;
+        //! The calling thread runs tasks too.
+        for (unsigned int i = 1; i < numThreads; i++)
+            workers_.push_back(thread(&ProcessorScheduler::Worker, this));
+    }
+    m.detail(ss.str());
+}
+
+void ProcessorScheduler::Build(void) {
+    Messenger m;
+    stringstream ss;
+    const vector<EventProcessor *> &procs = procs_;
+    vector<Node> previous;
+    previous.swap(nodes_);
+    levels_.clear();
+    order_.clear();
+    hasDependencies_ = false;
+
+    map<string, unsigned int> indices;
+    for (unsigned int i = 0; i < procs.size(); i++)
+        indices.insert(make_pair(procs[i]->GetName(), i));
+
+    vector<vector<unsigned int> > parents(procs.size());
+    vector<vector<unsigned int> > children(procs.size());
+    for (unsigned int i = 0; i < procs.size(); i++) {
+        const set<string> &deps = procs[i]->GetDependencies();
+        for (set<string>::const_iterator it = deps.begin(); it != deps.end(); it++) {
+            map<string, unsigned int>::const_iterator dep = indices.find(*it);
+            if (dep == indices.end()) {
+                if (previous.empty()) {
+                    ss.str("");
+                    ss << procs[i]->GetName() << " depends on " << *it
+                       << ", which is not loaded.";
+                    m.detail(ss.str());
+                }
+                continue;
+            }
+            if (dep->second == i)
+                continue;
+            parents[i].push_back(dep->second);
+            children[dep->second].push_back(i);
+            hasDependencies_ = true;
+        }
+    }
+    for (set<pair<unsigned int, unsigned int> >::const_iterator it = placeEdges_.begin();
+         it != placeEdges_.end(); it++) {
+        parents[it->second].push_back(it->first);
+        children[it->first].push_back(it->second);
+    }
+
+    //! Kahn's algorithm, always taking the processor that comes first in the
+    //! configuration so that the order only changes where it has to.
+    vector<unsigned int> numParents(procs.size());
+    set<unsigned int> ready;
+    for (unsigned int i = 0; i < procs.size(); i++) {
+        numParents[i] = parents[i].size();
+        if (numParents[i] == 0)
+            ready.insert(i);
+    }
+
+    vector<unsigned int> position(procs.size());
+    while (!ready.empty()) {
+        unsigned int idx = *ready.begin();
+        ready.erase(ready.begin());
+
+        Node node;
+        node.proc = procs[idx];
+        node.index = idx;
+        node.level = 0;
+        for (vector<unsigned int>::const_iterator it = parents[idx].begin();
+             it != parents[idx].end(); it++) {
+            node.parents.push_back(position[*it]);
+            node.level = max(node.level, nodes_[position[*it]].level + 1);
+        }
+        node.active = false;
+        node.skipped = false;
+        node.latency = node.finish = 0.0;
+        for (unsigned int i = 0; i < NUM_PHASES; i++) {
+            node.time[i] = node.path[i] = 0.0;
+            node.calls[i] = 0;
+        }
+        //! A rebuilt schedule keeps what was measured so far
+        for (vector<Node>::const_iterator it = previous.begin(); it != previous.end(); it++) {
+            if (it->proc != node.proc)
+                continue;
+            for (unsigned int i = 0; i < NUM_PHASES; i++) {
+                node.time[i] = it->time[i];
+                node.path[i] = it->path[i];
+                node.calls[i] = it->calls[i];
+            }
+        }
+
+        position[idx] = nodes_.size();
+        nodes_.push_back(node);
+        if (node.level >= levels_.size())
+            levels_.resize(node.level + 1);
+        levels_[node.level].push_back(position[idx]);
+
+        for (vector<unsigned int>::const_iterator it = children[idx].begin();
+             it != children[idx].end(); it++)
+            if (--numParents[*it] == 0)
+                ready.insert(*it);
+    }
+
+    //! One thread keeps the order of the configuration, dependencies only
+    //! reorder the processors when they run concurrently.
+    for (unsigned int i = 0; i < procs.size() && nodes_.size() == procs.size(); i++) {
+        order_.push_back(position[i]);
+        if (numThreads_ > 1 || !previous.empty())
+            continue;
+        for (vector<unsigned int>::const_iterator it = parents[i].begin(); it != parents[i].end(); it++) {
+            if (*it < i)
+                continue;
+            ss.str("");
+            ss << procs[i]->GetName() << " depends on " << procs[*it]->GetName()
+               << ", which is configured after it. It runs in the configured order on one thread.";
+            m.detail(ss.str());
+        }
+    }
+
+    if (nodes_.size() != procs.size()) {
+        ss.str("");
+        ss << "ProcessorScheduler::SetProcessors : The processor dependencies "
+           << "contain a cycle involving";
+        for (unsigned int i = 0; i < procs.size(); i++)
+            if (numParents[i] != 0)
+                ss << " " << procs[i]->GetName();
+        throw GeneralException(ss.str());
+    }
+    Skip();
+}
+
+bool ProcessorScheduler::IsAncestor(const unsigned int &a, const unsigned int &b) const {
+    vector<unsigned int> stack(1, b);
+    vector<bool> seen(nodes_.size(), false);
+    while (!stack.empty()) {
+        unsigned int idx = stack.back();
+        stack.pop_back();
+        for (vector<unsigned int>::const_iterator it = nodes_[idx].parents.begin();
+             it != nodes_[idx].parents.end(); it++) {
+            if (*it == a)
+                return true;
+            if (!seen[*it]) {
+                seen[*it] = true;
+                stack.push_back(*it);
+            }
+        }
+    }
+    return false;
+}
+
+///The pairs are ordered as they ran while learning, the order of the nodes,
+/// so that the new edges never make a cycle.
+void ProcessorScheduler::OrderSharedPlaces(void) {
+    set<pair<unsigned int, unsigned int> > shared = PlaceUsage::TakeShared();
+    bool changed = false;
+    for (set<pair<unsigned int, unsigned int> >::const_iterator it = shared.begin(); it != shared.end(); it++) {
+        unsigned int first = min(order_[it->first], order_[it->second]);
+        unsigned int second = max(order_[it->first], order_[it->second]);
+        if (IsAncestor(first, second))
+            continue;
+        if (!IsLearning())
+            throw GeneralException("ProcessorScheduler::OrderSharedPlaces : " + nodes_[second].proc->GetName()
+                                   + " and " + nodes_[first].proc->GetName() + " use the same TreeCorrelator "
+                                   "place but do not depend on each other. Add depends=\""
+                                   + nodes_[first].proc->GetName() + "\" to the Processor node of "
+                                   + nodes_[second].proc->GetName() + ".");
+        placeEdges_.insert(make_pair(nodes_[first].index, nodes_[second].index));
+        changed = true;
+
+        Messenger m;
+        m.detail(nodes_[second].proc->GetName() + " runs after " + nodes_[first].proc->GetName()
+                 + ", they use the same TreeCorrelator place");
+    }
+    if (changed)
+        Build();
+}
+
+void ProcessorScheduler::SetSkipped(const std::set<std::string> &names) {
+    skippedNames_ = names;
+    Skip();
+}
+
+///The parents come before their children in the nodes, so one pass carries
+/// the skip down the whole graph.
+void ProcessorScheduler::Skip(void) {
+    for (vector<Node>::iterator it = nodes_.begin(); it != nodes_.end(); it++) {
+        it->skipped = skippedNames_.find(it->proc->GetName()) != skippedNames_.end();
+        for (vector<unsigned int>::const_iterator idx = it->parents.begin();
+             idx != it->parents.end() && !it->skipped; idx++)
+            it->skipped = nodes_[*idx].skipped;
+    }
+}
+
+bool ProcessorScheduler::IsSkipped(const std::string &name) const {
+    for (vector<Node>::const_iterator it = nodes_.begin(); it != nodes_.end(); it++)
+        if (it->proc->GetName() == name)
+            return it->skipped;
+    return false;
+}
+
+void ProcessorScheduler::Run(RawEvent &event, const Phase &phase) {
+    for (vector<Node>::iterator it = nodes_.begin(); it != nodes_.end(); it++) {
+        it->active = !it->skipped && it->proc->HasEvent();
+        it->latency = 0.0;
+    }
+
+    if (IsConcurrent() && !IsLearning()) {
+        vector<unsigned int> level;
+        for (vector<vector<unsigned int> >::const_iterator it = levels_.begin();
+             it != levels_.end(); it++) {
+            level.clear();
+            for (vector<unsigned int>::const_iterator idx = it->begin(); idx != it->end(); idx++)
+                if (nodes_[*idx].active)
+                    level.push_back(*idx);
+
+            if (level.size() == 1)
+                RunNode(nodes_[level.front()], event, phase);
+            else if (level.size() > 1)
+                RunLevel(level, event, phase);
+        }
+    } else if (IsConcurrent()) {
+        //! While learning one at a time, in the order the levels run them
+        for (vector<Node>::iterator it = nodes_.begin(); it != nodes_.end(); it++)
+            if (it->active)
+                RunNode(*it, event, phase);
+    } else {
+        for (vector<unsigned int>::const_iterator it = order_.begin(); it != order_.end(); it++)
+            if (nodes_[*it].active)
+                RunNode(nodes_[*it], event, phase);
+    }
+
+    //! With unlimited threads the event takes as long as the slowest chain.
+    double critical = 0.0;
+    for (vector<Node>::iterator it = nodes_.begin(); it != nodes_.end(); it++) {
+        double start = 0.0;
+        for (vector<unsigned int>::const_iterator idx = it->parents.begin();
+             idx != it->parents.end(); idx++)
+            start = max(start, nodes_[*idx].finish);
+        it->finish = start + it->latency;
+        it->path[phase] += it->finish;
+        critical = max(critical, it->finish);
+    }
+    criticalPath_[phase] += critical;
+    numEvents_[phase]++;
+
+    if (IsConcurrent()) {
+        PlaceUsage::SetUser(-1, phase);
+        OrderSharedPlaces();
+        if (phase == PROCESS && IsLearning() && --learning_ == 0) {
+            Messenger m;
+            stringstream ss;
+            ss << "Running the processors concurrently in " << levels_.size() << " level(s), "
+               << placeEdges_.size() << " pair(s) ordered since they share places";
+            m.detail(ss.str());
+        }
+    }
+}
+
+void ProcessorScheduler::RunNode(Node &node, RawEvent &event, const Phase &phase) {
+    if (IsConcurrent())
+        PlaceUsage::SetUser(node.index, phase);
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    if (phase == PREPROCESS)
+        node.proc->PreProcess(event);
+    else
+        node.proc->Process(event);
+    node.latency = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    node.time[phase] += node.latency;
+    node.calls[phase]++;
+}
+
+void ProcessorScheduler::RunTasks(void) {
+    unsigned int idx;
+    while ((idx = next_++) < tasks_.size()) {
+        try {
+            RunNode(nodes_[tasks_[idx]], *event_, phase_);
+        } catch (...) {
+            lock_guard<mutex> lock(mutex_);
+            if (!error_)
+                error_ = current_exception();
+        }
+    }
+}
+
+void ProcessorScheduler::RunLevel(const std::vector<unsigned int> &level,
+                                  RawEvent &event, const Phase &phase) {
+    {
+        unique_lock<mutex> lock(mutex_);
+        //! Workers that woke up late may still be looking at the last level.
+        done_.wait(lock, [this] { return busy_ == 0; });
+        tasks_ = level;
+        next_ = 0;
+        event_ = &event;
+        phase_ = phase;
+        error_ = nullptr;
+        generation_++;
+    }
+    wake_.notify_all();
+
+    RunTasks();
+
+    exception_ptr error;
+    {
+        unique_lock<mutex> lock(mutex_);
+        done_.wait(lock, [this] { return busy_ == 0; });
+        error = error_;
+        error_ = nullptr;
+    }
+    if (error)
+        rethrow_exception(error);
+}
+
+void ProcessorScheduler::Worker(void) {
+    unsigned long seen = 0;
+    unique_lock<mutex> lock(mutex_);
+    while (true) {
+        wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+        if (stop_)
+            return;
+        seen = generation_;
+        busy_++;
+        lock.unlock();
+
+        RunTasks();
+
+        lock.lock();
+        busy_--;
+        done_.notify_all();
+    }
+}
+
+void ProcessorScheduler::StopWorkers(void) {
+    {
+        lock_guard<mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (vector<thread>::iterator it = workers_.begin(); it != workers_.end(); it++)
+        it->join();
+    workers_.clear();
+    stop_ = false;
+}
+
+void ProcessorScheduler::PrintStatistics(std::ostream &out) const {
+    static const char *phaseNames[NUM_PHASES] = {"PreProcess", "Process"};
+
+    if (nodes_.empty() || numEvents_[PREPROCESS] == 0)
+        return;
+
+    out << "Processor wall clock times (" << levels_.size() << " level(s), "
+        << (IsConcurrent() ? workers_.size() + 1 : 1) << " thread(s))" << endl;
+    for (vector<Node>::const_iterator it = nodes_.begin(); it != nodes_.end(); it++) {
+        out << "  " << left << setw(24) << it->proc->GetName() << right
+            << " level " << it->level;
+        for (unsigned int i = 0; i < NUM_PHASES; i++)
+            out << ", " << phaseNames[i] << " " << it->time[i] << " s ("
+                << (it->calls[i] ? it->time[i] / it->calls[i] * 1e6 : 0.0)
+                << " us/call)";
+        out << endl;
+    }
+
+    for (unsigned int i = 0; i < NUM_PHASES; i++) {
+        double serial = 0.0;
+        unsigned int last = 0;
+        for (unsigned int j = 0; j < nodes_.size(); j++) {
+            serial += nodes_[j].time[i];
+            if (nodes_[j].path[i] > nodes_[last].path[i])
+                last = j;
+        }
+
+        //! Walk back from the slowest node along the slowest parents.
+        vector<unsigned int> chain(1, last);
+        while (!nodes_[chain.back()].parents.empty()) {
+            const vector<unsigned int> &parents = nodes_[chain.back()].parents;
+            unsigned int slowest = parents.front();
+            for (vector<unsigned int>::const_iterator it = parents.begin();
+                 it != parents.end(); it++)
+                if (nodes_[*it].path[i] > nodes_[slowest].path[i])
+                    slowest = *it;
+            chain.push_back(slowest);
+        }
+
+        out << "  " << phaseNames[i] << " : " << serial << " s total, "
+            << criticalPath_[i] << " s on the critical path";
+        for (vector<unsigned int>::reverse_iterator it = chain.rbegin(); it != chain.rend(); it++)
+            out << (it == chain.rbegin() ? " (" : " -> ") << nodes_[*it].proc->GetName();
+        out << ")" << endl;
+    }
+}
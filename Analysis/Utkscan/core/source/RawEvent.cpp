@@ -2,31 +2,48 @@
  *  \brief defines functions associated with a rawevent
  *  @authors D. Miller, K. Miernik, S. V. Paulauskas
  */
+#include <mutex>
 #include <sstream>
 
+#include "DetectorLibrary.hpp"
+#include "Plots.hpp"
 #include "RawEvent.hpp"
 #include "Messenger.hpp"
 
 using namespace std;
 
+/// Summaries may be constructed on first use, which must not race with
+/// lookups from processors running on other threads. The lock is only taken
+/// when the processors run concurrently.
+static mutex summaryMutex;
+
 void RawEvent::Init(const std::set<std::string> &usedTypes) {
-    /*! initialize the map of used detectors. This will associate the name of a
-       detector type (such as dssd_front, ge ...) with a detector summary.
-       See ProcessEvent() for a description of the
-       variables in the summary
-    */
-    DetectorSummary ds;
-    ds.Zero();
+    unique_lock<mutex> lock(summaryMutex, defer_lock);
+    if (Plots::IsThreadSafe())
+        lock.lock();
+    for (set<string>::const_iterator it = usedTypes.begin(); it != usedTypes.end(); it++)
+        DetectorLibrary::get()->RegisterSummary(*it);
+    UpdateSummaries(true);
+}
 
-    for (set<string>::const_iterator it = usedTypes.begin(); it != usedTypes.end(); it++) {
-        ds.SetName(*it);
-        sumMap.insert(make_pair(*it, ds));
+void RawEvent::UpdateSummaries(const bool &fill) {
+    const DetectorLibrary *lib = DetectorLibrary::get();
+    static const vector<ChanEvent *> noEvents;
+    while (summaries_.size() < lib->GetNumSummaries()) {
+        unsigned int id = (unsigned int) summaries_.size();
+        summaries_.push_back(DetectorSummary(lib->GetSummaryName(id), fill ? eventList : noEvents));
+        isTouched_.push_back(false);
+        if (summaries_.back().GetMult() != 0)
+            Touch(id);
     }
 }
 
-void RawEvent::Zero(const std::set<std::string> &usedev) {
-    for (map<string, DetectorSummary>::iterator it = sumMap.begin(); it != sumMap.end(); it++)
-        (*it).second.Zero();
+void RawEvent::Zero(void) {
+    for (vector<unsigned int>::const_iterator it = touched_.begin(); it != touched_.end(); it++) {
+        summaries_[*it].Zero();
+        isTouched_[*it] = false;
+    }
+    touched_.clear();
 
     for (vector<ChanEvent *>::iterator it = eventList.begin(); it != eventList.end(); it++)
         delete *it;
@@ -34,19 +51,53 @@ void RawEvent::Zero(const std::set<std::string> &usedev) {
     eventList.clear();
 }
 
+///This is called for every channel before the processors run, so the new
+/// summaries were registered while reading the map or by a processor in an
+/// earlier event. They start empty, the channels of the event are added one
+/// by one as they are calibrated.
+void RawEvent::AddToSummaries(ChanEvent *event) {
+    const DetectorLibrary *lib = DetectorLibrary::get();
+    if (summaries_.size() < lib->GetNumSummaries()) {
+        unique_lock<mutex> lock(summaryMutex, defer_lock);
+        if (Plots::IsThreadSafe())
+            lock.lock();
+        UpdateSummaries(false);
+    }
+
+    const vector<unsigned int> &ids = lib->GetSummaryIds(event->GetID());
+    for (vector<unsigned int>::const_iterator it = ids.begin(); it != ids.end(); it++) {
+        summaries_[*it].AddEvent(event);
+        Touch(*it);
+    }
+}
+
+DetectorSummary *RawEvent::GetSummary(const unsigned int &id) {
+    unique_lock<mutex> lock(summaryMutex, defer_lock);
+    if (Plots::IsThreadSafe())
+        lock.lock();
+    if (id >= summaries_.size())
+        UpdateSummaries(true);
+    if (id >= summaries_.size())
+        return NULL;
+    Touch(id);
+    return &summaries_[id];
+}
+
 DetectorSummary *RawEvent::GetSummary(const std::string &s, bool construct) {
-    map<string, DetectorSummary>::iterator it = sumMap.find(s);
-    static set <string> nullSummaries;
+    unique_lock<mutex> lock(summaryMutex, defer_lock);
+    if (Plots::IsThreadSafe())
+        lock.lock();
+    DetectorLibrary *lib = DetectorLibrary::get();
+    unsigned int id = lib->GetSummaryId(s);
 
-    Messenger m;
-    stringstream ss;
-    if (it == sumMap.end()) {
+    if (id == DetectorLibrary::NO_SUMMARY) {
+        Messenger m;
+        stringstream ss;
         if (construct) {
             // construct the summary
             ss << "Constructing detector summary for type " << s;
             m.detail(ss.str());
-            sumMap.insert(make_pair(s, DetectorSummary(s, eventList)));
-            it = sumMap.find(s);
+            id = lib->RegisterSummary(s);
         } else {
             if (nullSummaries.count(s) == 0) {
                 ss << "Returning NULL detector summary for type " << s;
@@ -56,18 +107,23 @@ DetectorSummary *RawEvent::GetSummary(const std::string &s, bool construct) {
             return NULL;
         }
     }
-    return &(it->second);
+    UpdateSummaries(true);
+    Touch(id);
+    return &summaries_[id];
 }
 
 const DetectorSummary *RawEvent::GetSummary(const std::string &s) const {
-    map<string, DetectorSummary>::const_iterator it = sumMap.find(s);
+    unique_lock<mutex> lock(summaryMutex, defer_lock);
+    if (Plots::IsThreadSafe())
+        lock.lock();
+    unsigned int id = DetectorLibrary::get()->GetSummaryId(s);
 
-    if (it == sumMap.end()) {
+    if (id == DetectorLibrary::NO_SUMMARY || id >= summaries_.size()) {
         if (nullSummaries.count(s) == 0) {
             cout << "Returning NULL const detector summary for type " << s << endl;
             nullSummaries.insert(s);
         }
         return NULL;
     }
-    return &(it->second);
+    return &summaries_[id];
 }
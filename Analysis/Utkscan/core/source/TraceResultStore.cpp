@@ -0,0 +1,251 @@
+/*! \file TraceResultStore.cpp
+ *  \brief Keeps the results of the trace analysis of every hit in a file next
+ *  to the input, so that scanning the same file again does not analyze the
+ *  traces again
+ *  \date October 19, 2026
+*/
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "ChanEvent.hpp"
+#include "ChannelConfiguration.hpp"
+#include "EventCache.hpp"
+#include "Exceptions.hpp"
+#include "Globals.hpp"
+#include "Messenger.hpp"
+#include "StateArchive.hpp"
+#include "TraceResultStore.hpp"
+
+using namespace std;
+
+const char TraceResultStore::MAGIC[8] = {'P', 'A', 'A', 'S', 'S', 'T', 'R', 'S'};
+const uint32_t TraceResultStore::VERSION;
+
+///The size of the record before the results : crate, id, time, hash, seconds and length
+static const size_t recordHeaderSize = 4 + 4 + 8 + 8 + 4 + 4;
+
+///The flags of the results, packed into one byte
+enum ResultFlags {
+    VALID_WAVEFORM = 1, VALID_TIMING = 2, SANS_BASELINE = 4
+};
+
+TraceResultStore::TraceResultStore(const pugi::xml_node &node) : rewrite_(false), numHits_(0), numMisses_(0),
+                                                                  secondsSaved_(0), loadSeconds_(0) {
+    path_ = node.attribute("path").as_string();
+    if (path_.empty())
+        path_ = Globals::get()->GetOutputPath();
+    else if (path_[path_.size() - 1] != '/')
+        path_ += '/';
+}
+
+TraceResultStore::~TraceResultStore() {
+    try {
+        Flush();
+    } catch (IOException &ex) {
+        cout << ex.what() << endl;
+    }
+
+    Messenger m;
+    stringstream ss;
+    unsigned long numTraces = numHits_ + numMisses_;
+    ss << "Trace results found for " << numHits_ << " of " << numTraces << " traces ("
+       << (numTraces ? 100.0 * numHits_ / numTraces : 0) << "%), saving " << GetSecondsSaved()
+       << " s of trace analysis";
+    m.run_message(ss.str());
+}
+
+void TraceResultStore::SetInputFile(const string &input) {
+    if (input == input_)
+        return;
+
+    Flush();
+    input_ = input;
+    size_t slash = input.find_last_of('/');
+    fileName_ = path_ + (slash == string::npos ? input : input.substr(slash + 1)) + ".trs";
+    Read();
+}
+
+///Records that are cut short by the end of the file, e.g. when a scan
+/// crashed while writing, are dropped like the stale ones.
+void TraceResultStore::Read(void) {
+    data_.clear();
+    entries_.clear();
+    added_.clear();
+    rewrite_ = false;
+
+    ifstream file(fileName_.c_str(), ios::binary);
+    if (!file.good())
+        return;
+    data_.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+
+    uint32_t version = 0;
+    if (data_.size() < sizeof(MAGIC) + sizeof(version) || memcmp(data_.data(), MAGIC, sizeof(MAGIC)) != 0
+        || (memcpy(&version, data_.data() + sizeof(MAGIC), sizeof(version)), version) != VERSION) {
+        cout << "TraceResultStore::Read - " << fileName_ << " is not a store of this version, it is replaced."
+             << endl;
+        data_.clear();
+        rewrite_ = true;
+        return;
+    }
+
+    unsigned long numStale = 0;
+    size_t offset = sizeof(MAGIC) + sizeof(version);
+    while (offset + recordHeaderSize <= data_.size()) {
+        Key key;
+        uint64_t hash;
+        Entry entry;
+        const char *record = data_.data() + offset;
+        memcpy(&key.crate, record, 4);
+        memcpy(&key.id, record + 4, 4);
+        memcpy(&key.time, record + 8, 8);
+        memcpy(&hash, record + 16, 8);
+        memcpy(&entry.seconds, record + 24, 4);
+        memcpy(&entry.size, record + 28, 4);
+        entry.offset = offset + recordHeaderSize;
+        if (entry.offset + entry.size > data_.size())
+            break;
+        offset = entry.offset + entry.size;
+
+        if (key.id < hashes_.size() && hashes_[key.id] == hash)
+            entries_[key] = entry;
+        else
+            numStale++;
+    }
+    if (offset != data_.size() || numStale != 0)
+        rewrite_ = true;
+
+    Messenger m;
+    stringstream ss;
+    ss << "Loaded " << entries_.size() << " trace results from " << fileName_;
+    if (numStale != 0)
+        ss << ", " << numStale << " are analyzed again since their parameters changed";
+    m.run_message(ss.str());
+}
+
+///Without stale records the new ones are appended to the store, otherwise
+/// the store is written again into a temporary file that replaces it.
+void TraceResultStore::Flush(void) {
+    if (fileName_.empty() || (added_.empty() && !rewrite_))
+        return;
+
+    string name = rewrite_ ? fileName_ + ".tmp" : fileName_;
+    bool isNew = rewrite_ || !ifstream(fileName_.c_str()).good();
+    ofstream file(name.c_str(), ios::binary | (isNew ? ios::trunc : ios::app));
+    if (isNew) {
+        uint32_t version = VERSION;
+        file.write(MAGIC, sizeof(MAGIC));
+        file.write((const char *) &version, sizeof(version));
+    }
+
+    if (rewrite_) {
+        ostringstream out(ios::binary);
+        StateWriter writer(out);
+        for (unordered_map<Key, Entry, KeyHash>::const_iterator it = entries_.begin(); it != entries_.end(); it++) {
+            writer.Write(it->first.crate);
+            writer.Write(it->first.id);
+            writer.Write(it->first.time);
+            writer.Write(hashes_[it->first.id]);
+            writer.Write(it->second.seconds);
+            writer.Write(it->second.size);
+            writer.WriteBytes(data_.data() + it->second.offset, it->second.size);
+        }
+        file << out.str();
+    }
+    file << added_;
+    file.close();
+
+    if (file.fail() || (rewrite_ && rename(name.c_str(), fileName_.c_str()) != 0)) {
+        remove((fileName_ + ".tmp").c_str());
+        throw IOException("TraceResultStore::Flush - Unable to write the trace results to " + fileName_);
+    }
+    added_.clear();
+    rewrite_ = false;
+}
+
+bool TraceResultStore::Load(const ChanEvent &chan, Trace &trace) {
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    unordered_map<Key, Entry, KeyHash>::const_iterator it = entries_.find(MakeKey(chan));
+    if (it == entries_.end())
+        return false;
+
+    istringstream in(data_.substr(it->second.offset, it->second.size), ios::binary);
+    StateReader reader(in);
+    uint8_t flags = reader.Get<uint8_t>();
+    trace.SetHasValidWaveformAnalysis((flags & VALID_WAVEFORM) != 0);
+    trace.SetHasValidTimingAnalysis((flags & VALID_TIMING) != 0);
+    EventCache::ReadTraceResults(reader, trace);
+    trace.SetTriggerFilter(reader.Get<vector<double> >());
+    if (flags & SANS_BASELINE)
+        EventCache::RestoreTraceSansBaseline(trace);
+
+    numHits_++;
+    secondsSaved_ += it->second.seconds;
+    loadSeconds_ += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+void TraceResultStore::Save(const ChanEvent &chan, Trace &trace, const double &seconds) {
+    numMisses_++;
+    Key key = MakeKey(chan);
+    if (fileName_.empty() || key.id >= hashes_.size() || hashes_[key.id] == 0)
+        return;
+
+    uint8_t flags = 0;
+    flags |= trace.HasValidWaveformAnalysis() ? VALID_WAVEFORM : 0;
+    flags |= trace.HasValidTimingAnalysis() ? VALID_TIMING : 0;
+    flags |= !trace.GetTraceSansBaseline().empty() ? SANS_BASELINE : 0;
+
+    ostringstream results(ios::binary);
+    StateWriter resultsWriter(results);
+    resultsWriter.Write(flags);
+    EventCache::WriteTraceResults(resultsWriter, trace);
+    resultsWriter.Write(trace.GetTriggerFilter());
+
+    ostringstream out(ios::binary);
+    StateWriter writer(out);
+    writer.Write(key.crate);
+    writer.Write(key.id);
+    writer.Write(key.time);
+    writer.Write(hashes_[key.id]);
+    writer.Write((float) seconds);
+    writer.Write((uint32_t) results.str().size());
+    added_ += out.str() + results.str();
+}
+
+TraceResultStore::Key TraceResultStore::MakeKey(const ChanEvent &chan) {
+    Key key;
+    key.crate = chan.GetCrateNumber();
+    key.id = chan.GetID();
+    key.time = (uint64_t) chan.GetEventTimeHigh() << 32 | chan.GetEventTimeLow();
+    return key;
+}
+
+uint64_t TraceResultStore::HashParameters(const ChannelConfiguration &cfg, const pugi::xml_node &configuration) {
+    ostringstream text;
+    configuration.child("Global").print(text, "", pugi::format_raw);
+    pugi::xml_node driver = configuration.child("DetectorDriver");
+    for (pugi::xml_node analyzer = driver.child("Analyzer"); analyzer; analyzer = analyzer.next_sibling("Analyzer"))
+        analyzer.print(text, "", pugi::format_raw);
+
+    text.precision(17);
+    text << cfg.GetType() << ":" << cfg.GetSubtype() << ":" << cfg.GetGroup() << ":";
+    set<string> tags = cfg.GetTags();
+    for (set<string>::const_iterator it = tags.begin(); it != tags.end(); it++)
+        text << *it << ",";
+    text << ":" << cfg.GetModFreq() << ":" << cfg.GetBaselineThreshold() << ":"
+         << cfg.GetDiscriminationStartInSamples() << ":" << cfg.GetTraceDelayInSamples() << ":"
+         << cfg.GetWaveformBoundsInSamples().first << ":" << cfg.GetWaveformBoundsInSamples().second << ":"
+         << get<0>(cfg.GetCfdParameters()) << ":" << get<1>(cfg.GetCfdParameters()) << ":"
+         << get<2>(cfg.GetCfdParameters()) << ":" << cfg.GetFittingParameters().first << ":"
+         << cfg.GetFittingParameters().second;
+    TrapFilterParameters filters[] = {cfg.GetTriggerFilterParameters(), cfg.GetEnergyFilterParameters()};
+    for (unsigned int i = 0; i < 2; i++)
+        text << ":" << filters[i].GetRisetime() << ":" << filters[i].GetFlattop() << ":" << filters[i].GetT();
+
+    uint64_t hash = EventCache::Fnv1a(text.str());
+    return hash == 0 ? 1 : hash;
+}
@@ -8,6 +8,7 @@
 #include "Exceptions.hpp"
 #include "Globals.hpp"
 #include "Messenger.hpp"
+#include "StateArchive.hpp"
 #include "StringManipulationFunctions.hpp"
 #include "TreeCorrelator.hpp"
 #include "TreeCorrelatorXmlParser.hpp"
@@ -32,6 +33,7 @@ Place *TreeCorrelator::place(std::string name) {
         ss << "TreeCorrelator: place " << name << " doesn't exist " << endl;
         throw TreeCorrelatorException(ss.str());
     }
+    element->second->lookedUp();
     return element->second;
 }
 
@@ -154,6 +156,25 @@ vector<string> TreeCorrelator::split_names(std::string name) {
     return names;
 }
 
+void TreeCorrelator::SaveState(StateWriter &writer) const {
+    writer.Write((uint64_t) places_.size());
+    for (map<string, Place *>::const_iterator it = places_.begin(); it != places_.end(); ++it) {
+        writer.Write(it->first);
+        writer.Write(StateWriter::ToString(*it->second));
+    }
+}
+
+void TreeCorrelator::LoadState(StateReader &reader) {
+    for (uint64_t i = reader.Get<uint64_t>(); i > 0; i--) {
+        string name = reader.Get<string>();
+        map<string, Place *>::iterator it = places_.find(name);
+        if (it == places_.end())
+            throw TreeCorrelatorException("TreeCorrelator::LoadState - The place " + name
+                                          + " of the checkpoint does not exist.");
+        StateReader::FromString(reader.Get<string>(), *it->second);
+    }
+}
+
 TreeCorrelator::~TreeCorrelator() {
     for (map<string, Place *>::iterator it = places_.begin(); it != places_.end(); ++it)
         delete it->second;
@@ -2,11 +2,16 @@
 ///@brief Derived class handling the interface with utkscan.
 ///@author S. V. Paulauskas
 ///@date September 23, 2016
+#include <chrono>
 #include <iostream>
 #include <stdexcept>
 
 #include "DetectorDriver.hpp"
 #include "Display.h"
+#include "HelperFunctions.hpp"
+#include "LiveHistograms.hpp"
+#include "Messenger.hpp"
+#include "StateArchive.hpp"
 #include "TreeCorrelator.hpp"
 #include "UtkScanInterface.hpp"
 #include "UtkUnpacker.hpp"
@@ -22,16 +27,85 @@ OutputHisFile *output_his = NULL;
 /// Default constructor.
 UtkScanInterface::UtkScanInterface() : ScanInterface() {
     init_ = false;
+    server_ = NULL;
 }
 
 /// Destructor.
 UtkScanInterface::~UtkScanInterface() {
+    delete server_;
 #ifndef USE_HRIBF
     if (init_)
         delete (output_his);
 #endif
 }
 
+///@return True if the channel has the type and, when they are given, the
+/// subtype and the tag of the node
+static bool MatchesChannel(const pugi::xml_node &node, const ChannelConfiguration &channel) {
+    string subtype = node.attribute("subtype").as_string("");
+    string tag = node.attribute("tag").as_string("");
+    return channel.GetType() == node.attribute("type").as_string("") &&
+           (subtype.empty() || channel.GetSubtype() == subtype) && (tag.empty() || channel.HasTag(tag));
+}
+
+///@return A time of the node in clock ticks
+static double TicksFromNode(const pugi::xml_node &node, const string &name, const double &defaultTicks,
+                            const string &unit) {
+    if (node.attribute(name.c_str()).empty())
+        return defaultTicks;
+    return Conversions::ConvertSecondsWithPrefix(node.attribute(name.c_str()).as_double(),
+                                                 node.attribute("unit").as_string(unit.c_str())) /
+           Globals::get()->GetClockInSeconds();
+}
+
+void UtkScanInterface::InitializeTriggeredEvents() {
+    pugi::xml_node node = XmlInterface::get()->GetDocument()->child("Configuration").child("Global")
+            .child("TriggeredEvents");
+    if (!node)
+        return;
+
+    Messenger m;
+    stringstream ss;
+    string unit = node.attribute("unit").as_string("ns");
+    TriggeredEventBuilder *builder = unpacker_->GetTriggeredEventBuilder();
+    builder->SetDefaultWindow(TicksFromNode(node, "pre", 0, unit),
+                              TicksFromNode(node, "post", Globals::get()->GetEventLengthInTicks(), unit));
+
+    DetectorLibrary *detlib = DetectorLibrary::get();
+    for (pugi::xml_node window = node.child("Window"); window; window = window.next_sibling("Window")) {
+        string name = window.attribute("type").as_string("");
+        if (!window.attribute("subtype").empty())
+            name += string(":") + window.attribute("subtype").as_string();
+        if (!window.attribute("tag").empty())
+            name += string(":") + window.attribute("tag").as_string();
+
+        unsigned int number = builder->AddWindow(name, TicksFromNode(window, "pre", 0, unit),
+                                                 TicksFromNode(window, "post", 0, unit));
+        unsigned int numChannels = 0;
+        for (unsigned int id = 0; id < detlib->size(); id++) {
+            if (MatchesChannel(window, detlib->at(id))) {
+                builder->SetWindow(id, number);
+                numChannels++;
+            }
+        }
+        ss << "Triggered events : window " << name << " of " << numChannels << " channels";
+        m.detail(ss.str());
+        ss.str("");
+    }
+
+    for (pugi::xml_node trigger = node.child("Trigger"); trigger; trigger = trigger.next_sibling("Trigger"))
+        for (unsigned int id = 0; id < detlib->size(); id++)
+            if (MatchesChannel(trigger, detlib->at(id)))
+                builder->SetTrigger(id);
+
+    if (!builder->HasTriggers())
+        throw invalid_argument("UtkScanInterface::InitializeTriggeredEvents - None of the channels in the map "
+                                       "match a Trigger of the TriggeredEvents node.");
+
+    unpacker_->SetTriggeredMode(true);
+    m.detail("Triggered events : the events are built around the trigger channels");
+}
+
 /** Initialize the map file, the config file, the processor handler, 
  * and add all of the required processors.
  * \param[in]  prefix_ String to append to the beginning of system output.
@@ -56,6 +130,7 @@ bool UtkScanInterface::Initialize(string prefix_) {
     }
 
     unpacker_->SetEventWidth(Globals::get()->GetEventLengthInTicks());
+    InitializeTriggeredEvents();
     Globals::get()->SetOutputFilename(GetOutputFilename());
     Globals::get()->SetOutputPath(GetOutputPath());
 
@@ -63,8 +138,11 @@ bool UtkScanInterface::Initialize(string prefix_) {
     //@TODO find a better way to handle HRIBF...This should be cleaned up!!
 #ifndef USE_HRIBF
     try {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
         output_his = new OutputHisFile((GetOutputPath() + GetOutputFilename()).c_str());
         output_his->SetDebugMode(false);
+        output_his->SetSparseThreshold(
+                (size_t) (Globals::get()->GetSparseThresholdInMb() * 1048576));
 
         /** The DetectorDriver constructor will load processors
          *  from the xml configuration file upon first call.
@@ -78,7 +156,38 @@ bool UtkScanInterface::Initialize(string prefix_) {
          *  calibration and walk correction factors.
          */
         DetectorDriver::get()->DeclarePlots();
+        SetLoadShedding(DetectorDriver::get()->GetLoadBudget(), DetectorDriver::get()->GetNumLoadLevels());
+
+        vector<unsigned int> sparse = Globals::get()->GetSparseHistograms();
+        for (vector<unsigned int>::const_iterator it = sparse.begin(); it != sparse.end(); it++)
+            if (!output_his->SetSparse(*it))
+                cout << "UtkScanInterface::Initialize : Cannot store histogram "
+                     << *it << " sparse, it was not declared." << endl;
         output_his->Finalize();
+
+        string liveName = Globals::get()->GetLiveHistogramsName();
+        if (!liveName.empty()) {
+            output_his->SetLivePeriod(Globals::get()->GetLiveHistogramsPeriod());
+            if (!output_his->OpenLive(liveName))
+                cout << "UtkScanInterface::Initialize : Could not create the "
+                        "shared memory segment " << liveName << " for the live histograms." << endl;
+            else if (!Globals::get()->GetLiveHistogramsSocket().empty()) {
+                server_ = new HistogramServer(liveName, Globals::get()->GetLiveHistogramsSocket());
+                if (!server_->Start())
+                    cout << "UtkScanInterface::Initialize : Could not open the socket "
+                         << Globals::get()->GetLiveHistogramsSocket()
+                         << " for the live histograms." << endl;
+            }
+        }
+
+        cout << "UtkScanInterface::Initialize : Declared "
+             << output_his->GetNumHistograms() << " histograms ("
+             << output_his->GetTotalSize() / 1048576.0 << " MB, "
+             << output_his->GetAllocatedSize() / 1048576.0
+             << " MB on disk, " << output_his->GetNumSparse()
+             << " sparse) in "
+             << chrono::duration<double>(chrono::steady_clock::now() - start).count()
+             << " s" << endl;
     } catch (exception &e) {
         cout << Display::ErrorStr(
                 prefix_ + "Exception caught at UtkScanInterface::Initialize")
@@ -87,4 +196,37 @@ bool UtkScanInterface::Initialize(string prefix_) {
     }
 #endif
     return (init_ = true);
-}
\ No newline at end of file
+}
+
+void UtkScanInterface::IdleTask() {
+#ifndef USE_HRIBF
+    if (init_ && output_his->IsLive())
+        output_his->PublishLive();
+#endif
+}
+
+void UtkScanInterface::Notify(const string &code_) {
+    if (init_ && code_ == "LOAD_FILE")
+        Globals::get()->SetInputFileName(GetInputPath());
+}
+
+void UtkScanInterface::SetLoadLevel(const unsigned int &level_) {
+    DetectorDriver::get()->SetLoadLevel(level_);
+}
+
+void UtkScanInterface::SaveState(StateWriter &writer) {
+#ifndef USE_HRIBF
+    output_his->SaveState(writer);
+#endif
+    TreeCorrelator::get()->SaveState(writer);
+}
+
+void UtkScanInterface::LoadState(StateReader &reader) {
+#ifndef USE_HRIBF
+    output_his->LoadState(reader);
+#endif
+    TreeCorrelator::get()->LoadState(reader);
+
+    Messenger m;
+    m.detail("The ROOT outputs and the skim, if any, only hold the events after the checkpoint.");
+}
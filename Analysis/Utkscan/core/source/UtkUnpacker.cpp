@@ -10,10 +10,14 @@
 #include <sys/times.h>
 
 #include "DammPlotIds.hpp"
+#include "Exceptions.hpp"
 #include "Places.hpp"
+#include "ScanLog.hpp"
+#include "StateArchive.hpp"
 #include "TreeCorrelator.hpp"
 #include "UtkScanInterface.hpp"
 #include "UtkUnpacker.hpp"
+#include "XmlInterface.hpp"
 
 using namespace std;
 using namespace dammIds::raw;
@@ -22,11 +26,24 @@ using namespace dammIds::raw;
 /// DetectorDriver. This will ensure that the memory is freed for all of the
 /// initialized detector and experiment processors and that information about
 /// the amount of time spent in each processor is output to the screen at the
-/// end of execution.
+/// end of execution. The event cache is closed first, while the channels it
+/// looks up are still in the DetectorLibrary.
 UtkUnpacker::~UtkUnpacker() {
+    delete cache_;
     delete DetectorDriver::get();
 }
 
+namespace {
+    ///Gives the bytes of a spill block to a StateReader without copying them.
+    class MemoryBuffer : public streambuf {
+    public:
+        MemoryBuffer(const char *data, const size_t &size) {
+            char *begin = const_cast<char *>(data);
+            setg(begin, begin, begin + size);
+        }
+    };
+}
+
 /// This method initializes the DetectorLibrary and DetectorDriver classes so
 /// that we can begin processing the events. We take special action on the
 /// first event so that we can handle somethings poperly. Then we processes
@@ -36,37 +53,11 @@ UtkUnpacker::~UtkUnpacker() {
 /// methods to plot useful spectra and output processing information to the
 /// screen.
 void UtkUnpacker::ProcessRawEvent() {
-    static RawEvent rawev;
     DetectorDriver *driver = DetectorDriver::get();
     DetectorLibrary *detectorLibrary = DetectorLibrary::get();
-    set<string> usedDetectors;
-    Messenger m;
-    stringstream ss;
-
-    static clock_t systemStartTime;
-    static struct tms systemTimes;
-    static double lastTimeOfPreviousEvent;
-    static unsigned int eventCounter = 0;
-
-    if (eventCounter == 0)
-        InitializeDriver(driver, detectorLibrary, rawev, systemStartTime);
-    else if (eventCounter % 5000 == 0 || eventCounter == 1)
-        PrintProcessingTimeInformation(systemStartTime, times(&systemTimes), GetEventStartTime(), eventCounter);
-
-    if (Globals::get()->HasRejectionRegion()) {
-        double eventTime = (GetEventStartTime() - GetFirstTime()) * Globals::get()->GetClockInSeconds();
-        vector <pair<unsigned int, unsigned int>> rejectRegions = Globals::get()->GetRejectionRegions();
-
-        for (vector<pair<unsigned int, unsigned int> >::iterator region = rejectRegions.begin();
-             region != rejectRegions.end(); ++region)
-            if (eventTime > region->first && eventTime < region->second)
-                return;
-    }
 
-    driver->plot(D_EVENT_GAP, (GetRealStopTime() - lastTimeOfPreviousEvent) * Globals::get()->GetClockInSeconds() * 1e9);
-    driver->plot(D_BUFFER_END_TIME, GetRealStopTime() * Globals::get()->GetClockInSeconds() * 1e9);
-    driver->plot(D_EVENT_LENGTH, (GetRealStopTime() - GetRealStartTime()) * Globals::get()->GetClockInSeconds() * 1e9);
-    driver->plot(D_EVENT_MULTIPLICITY, rawEvent.size());
+    if (!StartEvent(driver, rawEvent.size()))
+        return;
 
     //loop over the list of channels that fired in this event
     for (deque<XiaData *>::iterator it = rawEvent.begin(); it != rawEvent.end(); it++) {
@@ -77,9 +68,7 @@ void UtkUnpacker::ProcessRawEvent() {
         RawStats((*it), driver);
 
         if ((*it)->GetId() == std::numeric_limits<unsigned int>::max()) {
-            ss << "pattern 0 ignore";
-            m.warning(ss.str());
-            ss.str("");
+            SCAN_LOG(ScanLog::WARNING, "pattern 0 ignore");
             continue;
         }
 
@@ -92,17 +81,56 @@ void UtkUnpacker::ProcessRawEvent() {
         /// that it is right now.
         ChanEvent *event = new ChanEvent(*(*it));
 
-        ///@TODO This will also fail if the user doesn't define enough modules in the map. Related to pixie16/paass:#103
-        usedDetectors.insert((*detectorLibrary)[(*it)->GetId()].GetType());
-        rawev.AddChan(event);
+        rawev_.AddChan(event);
 
         ///@TODO Add back in the processing for the dtime.
     }//for(deque<PixieData*>::iterator
 
+    FinishEvent(driver);
+}
+
+bool UtkUnpacker::StartEvent(DetectorDriver *driver, const size_t &multiplicity) {
+    static struct tms systemTimes;
+
+    if (!isDriverInitialized_) {
+        InitializeDriver(driver, DetectorLibrary::get(), rawev_, systemStartTime_);
+        isDriverInitialized_ = true;
+        if (!driverState_.empty()) {
+            StateReader::FromString(driverState_, *driver);
+            driverState_.clear();
+        }
+    } else if (eventCounter_ % 5000 == 0 || eventCounter_ == 1)
+        PrintProcessingTimeInformation(systemStartTime_, times(&systemTimes), GetEventStartTime(), eventCounter_);
+
+    if (Globals::get()->HasRejectionRegion()) {
+        double eventTime = (GetEventStartTime() - GetFirstTime()) * Globals::get()->GetClockInSeconds();
+        vector <pair<unsigned int, unsigned int>> rejectRegions = Globals::get()->GetRejectionRegions();
+
+        for (vector<pair<unsigned int, unsigned int> >::iterator region = rejectRegions.begin();
+             region != rejectRegions.end(); ++region)
+            if (eventTime > region->first && eventTime < region->second)
+                return false;
+    }
+
+    driver->plot(D_EVENT_GAP, (GetRealStopTime() - lastTimeOfPreviousEvent_) * Globals::get()->GetClockInSeconds() * 1e9);
+    driver->plot(D_BUFFER_END_TIME, GetRealStopTime() * Globals::get()->GetClockInSeconds() * 1e9);
+    driver->plot(D_EVENT_LENGTH, (GetRealStopTime() - GetRealStartTime()) * Globals::get()->GetClockInSeconds() * 1e9);
+    driver->plot(D_EVENT_MULTIPLICITY, multiplicity);
+    return true;
+}
+
+///The event is cached after the DetectorDriver processed it, which is when
+/// the channels are calibrated and their traces analyzed.
+void UtkUnpacker::FinishEvent(DetectorDriver *driver) {
     try {
-        driver->ProcessEvent(rawev);
-        rawev.Zero(usedDetectors);
-        usedDetectors.clear();
+        driver->ProcessEvent(rawev_);
+        if (driver->GetSkimmer() && !isReplay_)
+            driver->GetSkimmer()->Add(rawEvent);
+        if (cache_ && rawev_.Size() != 0) {
+            EventCache::EventTimes times = {GetEventStartTime(), GetRealStartTime(), GetRealStopTime()};
+            cache_->Add(rawev_, times);
+        }
+        rawev_.Zero();
 
         ///@TODO I think that this is done twice, it needs to be investigated.
         for (map<string, Place *>::iterator it = TreeCorrelator::get()->places_.begin();
@@ -113,8 +141,84 @@ void UtkUnpacker::ProcessRawEvent() {
         throw;
     }
 
-    eventCounter++;
-    lastTimeOfPreviousEvent = GetRealStopTime();
+    eventCounter_++;
+    lastTimeOfPreviousEvent_ = GetRealStopTime();
+}
+
+///The cache can only be replayed by a scan that did not process any event
+/// yet, since the DetectorDriver is told on the first event whether it
+/// calibrates the channels.
+bool UtkUnpacker::OpenEventCache(const string &header) {
+    if (isDriverInitialized_ && !isReplay_) {
+        cout << "UtkUnpacker::OpenEventCache - An event cache can only be replayed by a new scan." << endl;
+        return false;
+    }
+
+    try {
+        EventCache::CheckHeader(header, XmlInterface::get()->GetDocument()->child("Configuration"));
+    } catch (exception &ex) {
+        cout << ex.what() << endl;
+        return false;
+    }
+
+    isReplay_ = true;
+    return true;
+}
+
+///The cached events go through the same steps as the built ones, except for
+/// the plots of the hits that are not in the cache : the event multiplicity
+/// counts the channels that were not ignored.
+void UtkUnpacker::ReplayEventCache(const char *data, const size_t &size) {
+    DetectorDriver *driver = DetectorDriver::get();
+    MemoryBuffer buffer(data, size);
+    istream in(&buffer);
+    StateReader reader(in);
+    vector<ChanEvent *> events;
+    EventCache::EventTimes times;
+
+    try {
+        double firstTime = EventCache::ReadFirstTime(reader);
+        while (reader.GetNumBytes() < size) {
+            EventCache::ReadEvent(reader, events, times);
+            SetReplayedEvent(firstTime, times.eventStart, times.realStart, times.realStop);
+
+            if (!StartEvent(driver, events.size())) {
+                for (vector<ChanEvent *>::iterator it = events.begin(); it != events.end(); it++)
+                    delete *it;
+                continue;
+            }
+
+            for (vector<ChanEvent *>::iterator it = events.begin(); it != events.end(); it++) {
+                RawStats((*it), driver);
+                rawev_.AddChan(*it);
+            }
+            events.clear();
+            FinishEvent(driver);
+        }
+    } catch (IOException &ex) {
+        for (vector<ChanEvent *>::iterator it = events.begin(); it != events.end(); it++)
+            delete *it;
+        cout << ex.what() << endl;
+        cout << "UtkUnpacker::ReplayEventCache - Skipping the rest of a corrupt spill." << endl;
+    }
+
+    EndSpill();
+}
+
+///The state of the DetectorDriver is written as a string, which is empty if
+/// no event was processed yet.
+void UtkUnpacker::SaveState(StateWriter &writer) const {
+    Unpacker::SaveState(writer);
+    writer.Write(eventCounter_);
+    writer.Write(lastTimeOfPreviousEvent_);
+    writer.Write(isDriverInitialized_ ? StateWriter::ToString(*DetectorDriver::get()) : string());
+}
+
+void UtkUnpacker::LoadState(StateReader &reader) {
+    Unpacker::LoadState(reader);
+    reader.Read(eventCounter_);
+    reader.Read(lastTimeOfPreviousEvent_);
+    reader.Read(driverState_);
 }
 
 /// This method plots information about the running time of the program, the
@@ -163,12 +267,33 @@ void UtkUnpacker::InitializeDriver(DetectorDriver *driver, DetectorLibrary *detl
     m.detail(ss.str());
     ss.str("");
 
-    if(GetMaxModuleInFile() != detlib->GetModules() - 1)
+    if(!isReplay_ && GetMaxModuleInFile() != detlib->GetModules() - 1)
         throw invalid_argument("UtkUnpacker::InitializeDriver - You did not define the last module (" +
                                        to_string(GetMaxModuleInFile()) + ") in the configuration file. This is fatal.");
 
     //detlib->PrintUsedDetectors(rawev);
     driver->Init(rawev);
+    ss << "Decoding the traces of " << driver->GetNumTracesNeeded() << " of "
+       << detlib->size() << " channels";
+    m.detail(ss.str());
+    ss.str("");
+
+    if (EventSkimmer *skimmer = driver->GetSkimmer()) {
+        skimmer->SetNumModules(detlib->GetModules());
+        for (unsigned int vsn = 0; vsn < detlib->GetModules(); vsn++)
+            skimmer->SetDataMask(vsn, GetDataMask(vsn));
+    }
+
+    driver->SetIsReplay(isReplay_);
+    pugi::xml_node configuration = XmlInterface::get()->GetDocument()->child("Configuration");
+    if (isReplay_) {
+        m.detail("Replaying calibrated events, the Analyzers and the calibrations are not run again");
+        if (driver->GetSkimmer())
+            m.detail("The skim has no raw hits to write when an event cache is replayed");
+    } else if (pugi::xml_node node = configuration.child("EventCache")) {
+        cache_ = new EventCache(node, configuration);
+        cache_->SetFirstTime(GetFirstTime());
+    }
 
     try {
         driver->SanityCheck();
@@ -189,6 +314,16 @@ void UtkUnpacker::InitializeDriver(DetectorDriver *driver, DetectorLibrary *detl
     m.done();
 }
 
+///The hits of the events that passed the skim are collected until the spill
+/// was processed, so that the skim keeps the spills of the original file.
+/// The event cache keeps them as well.
+void UtkUnpacker::EndSpill() {
+    if (EventSkimmer *skimmer = DetectorDriver::get()->GetSkimmer())
+        skimmer->EndSpill();
+    if (cache_)
+        cache_->EndSpill();
+}
+
 /// Spits out some useful information about the analysis time, what timestamp
 /// that we are currently on and information about how long it took us to get
 /// to this point. One should note that this does not contain all of the
@@ -0,0 +1,104 @@
+///@file unittest-AddbackEngine.cpp
+///@brief Program that will test functionality of the AddbackEngine
+///@date October 19, 2026
+#include <iostream>
+#include <stdexcept>
+
+#include <UnitTest++.h>
+
+#include "AddbackEngine.hpp"
+
+using namespace std;
+
+///Two clovers of four crystals each, the crystal is the detector
+struct CloverFixture {
+    CloverFixture() : engine(2, 10, 5) {
+        for (unsigned int i = 0; i < 8; i++)
+            engine.SetGroup(i, i / 4);
+    }
+
+    AddbackEngine engine;
+};
+
+TEST_FIXTURE(CloverFixture, Test_SubEvents) {
+    engine.AddHit(100, 1000, 5, 0);
+    engine.AddHit(200, 1004, 1, 1);
+    engine.AddHit(300, 1008, 2, 2);
+    engine.AddHit(400, 2000, 0, 3);
+    engine.AddHit(1, 1002, 3, 4);
+    engine.Build();
+
+    CHECK_EQUAL(2u, engine.GetNumSubEvents());
+    CHECK_EQUAL(4u, engine.GetHits().size());
+    CHECK_EQUAL(5u, engine.GetHits().front().detector);
+    CHECK_EQUAL(1u, engine.GetHits().back().subEvent);
+
+    CHECK_CLOSE(500, engine.GetCluster(0, 0).energy, 1e-9);
+    CHECK_EQUAL(2u, engine.GetCluster(0, 0).multiplicity);
+    CHECK_CLOSE(1004, engine.GetCluster(0, 0).firstTime, 1e-9);
+    CHECK_CLOSE(1008, engine.GetCluster(0, 0).time, 1e-9);
+    CHECK_CLOSE(100, engine.GetCluster(0, 1).energy, 1e-9);
+    CHECK_CLOSE(600, engine.GetSum(0).energy, 1e-9);
+    CHECK_EQUAL(3u, engine.GetSum(0).multiplicity);
+
+    CHECK_EQUAL(0u, engine.GetCluster(1, 1).multiplicity);
+    CHECK_CLOSE(2000, engine.GetCluster(1, 1).time, 1e-9);
+    CHECK_CLOSE(400, engine.GetSum(1).energy, 1e-9);
+}
+
+TEST_FIXTURE(CloverFixture, Test_ClusterPairs) {
+    engine.AddHit(100, 1000, 5);
+    engine.AddHit(200, 1004, 1);
+    engine.AddHit(300, 2000, 0);
+    engine.AddHit(300, 2009, 7);
+    engine.Build();
+
+    vector<AddbackEngine::Pair> pairs;
+    engine.FindClusterPairs(5, pairs);
+    CHECK_EQUAL(1u, pairs.size());
+    CHECK_EQUAL(0u, pairs.at(0).first);
+    CHECK_EQUAL(1u, pairs.at(0).second);
+    CHECK_CLOSE(-4, pairs.at(0).dtime, 1e-9);
+
+    engine.FindClusterPairs(10, pairs);
+    CHECK_EQUAL(2u, pairs.size());
+    CHECK_EQUAL(2u, pairs.at(1).first);
+    CHECK_EQUAL(3u, pairs.at(1).second);
+}
+
+TEST_FIXTURE(CloverFixture, Test_HitPairs) {
+    engine.AddHit(100, 30, 0);
+    engine.AddHit(100, 10, 1);
+    engine.AddHit(100, 20, 6);
+    engine.Build();
+
+    vector<AddbackEngine::Pair> pairs;
+    engine.FindHitPairs(10, pairs);
+    CHECK_EQUAL(2u, pairs.size());
+    CHECK_EQUAL(1u, pairs.at(0).second);
+    CHECK_CLOSE(10, pairs.at(1).dtime, 1e-9);
+
+    engine.FindHitPairs(1e9, pairs);
+    CHECK_EQUAL(3u, pairs.size());
+}
+
+TEST_FIXTURE(CloverFixture, Test_Clear) {
+    engine.AddHit(100, 30, 0);
+    engine.Build();
+    engine.Clear();
+    engine.Build();
+    CHECK_EQUAL(0u, engine.GetNumSubEvents());
+    CHECK(engine.GetClusters().empty());
+}
+
+TEST(Test_UngroupedDetectors) {
+    AddbackEngine engine(3, 10);
+    engine.AddHit(100, 0, 2);
+    engine.Build();
+    CHECK_CLOSE(100, engine.GetCluster(0, 2).energy, 1e-9);
+    CHECK_THROW(engine.AddHit(100, 0, 3), out_of_range);
+}
+
+int main(int argv, char *argc[]) {
+    return (UnitTest::RunAllTests());
+}
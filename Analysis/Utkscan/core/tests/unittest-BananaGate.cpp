@@ -0,0 +1,132 @@
+///@file unittest-BananaGate.cpp
+///@brief Program that will test functionality of the BananaGate
+///@date October 19, 2026
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include <cstdio>
+
+#include <UnitTest++.h>
+
+#include "BananaGate.hpp"
+#include "Exceptions.hpp"
+
+using namespace std;
+
+///A plain crossing number test to compare the edge table against.
+bool PolygonTest(const vector<pair<int, int> > &v, const int &x, const int &y) {
+    bool inside = false;
+    for (unsigned int i = 0, j = v.size() - 1; i < v.size(); j = i++) {
+        if ((v[j].first <= x && x < v[i].first) || (v[i].first <= x && x < v[j].first)) {
+            double yc = v[j].second + (double) (x - v[j].first) *
+                                      (v[i].second - v[j].second) / (v[i].first - v[j].first);
+            if (yc > y)
+                inside = !inside;
+        }
+    }
+    return inside;
+}
+
+///Banana 1 from share/utkscan/bananas/077cu.ban
+static const vector<pair<int, int> > banana = {
+        {260, 6339}, {259, 4639}, {259, 2991}, {261, 2345}, {265, 1410}, {269, 1087},
+        {276, 830}, {283, 653}, {284, 518}, {297, 386}, {305, 287}, {328, 185},
+        {352, 137}, {390, 104}, {424, 80}, {487, 71}, {538, 59}, {614, 38},
+        {630, 8}, {557, 5}, {396, 3}, {331, 5}, {299, 16}, {288, 40}, {278, 78},
+        {267, 123}, {256, 173}, {256, 196}, {249, 311}, {242, 393}, {239, 541},
+        {237, 673}, {239, 835}, {234, 949}, {233, 989}, {228, 2768}, {229, 4463},
+        {225, 6291}};
+
+///Writes a banana as a DAMM .ban file, 80 character records without newlines
+void WriteBanFile(const string &name, const int &id, const vector<pair<int, int> > &v) {
+    stringstream ss;
+    ss << setw(5) << id;
+    for (unsigned int i = 1; i < 80; i++)
+        ss << setw(5) << 0;
+
+    stringstream rec;
+    rec << "INP test00.his                " << setw(6) << 3115 << setw(6) << id
+        << setw(6) << 0 << setw(6) << v.size();
+    ss << left << setw(80) << rec.str() << setw(80) << "TIT test" << setw(80) << "GATE" << right;
+    for (unsigned int i = 0; i < 9; i++) {
+        rec.str("");
+        rec << "CXY";
+        for (unsigned int j = 7 * i; j < 7 * (i + 1) && j < v.size(); j++)
+            rec << setw(5) << v[j].first << setw(5) << v[j].second;
+        ss << left << setw(80) << rec.str() << right;
+    }
+    ofstream(name.c_str()) << ss.str();
+}
+
+TEST(Test_Square) {
+    BananaGate gate({{10, 10}, {20, 10}, {20, 20}, {10, 20}});
+    CHECK(gate.Test(15, 15));
+    CHECK(gate.Test(10, 10));
+    CHECK(!gate.Test(20, 15));
+    CHECK(!gate.Test(15, 20));
+    CHECK(!gate.Test(9, 15));
+    CHECK(!gate.Test(15, 9));
+}
+
+TEST(Test_Degenerate) {
+    BananaGate gate({{10, 10}, {20, 10}});
+    CHECK(!gate.Test(10, 10));
+    CHECK(!gate.Test(15, 10));
+}
+
+TEST(Test_AgainstPolygon) {
+    BananaGate gate(banana);
+    unsigned int numInside = 0;
+    for (int x = 200; x < 650; x++) {
+        for (int y = 0; y < 6500; y += 3) {
+            CHECK_EQUAL(PolygonTest(banana, x, y), gate.Test(x, y));
+            numInside += gate.Test(x, y);
+        }
+    }
+    CHECK(numInside > 0);
+}
+
+TEST(Test_Batch) {
+    BananaGate gate(banana);
+    vector<pair<int, int> > points;
+    for (int x = 200; x < 650; x += 7)
+        for (int y = 0; y < 6500; y += 11)
+            points.push_back(make_pair(x, y));
+
+    vector<unsigned char> result;
+    unsigned int numInside = gate.Test(points, result);
+    CHECK_EQUAL(points.size(), result.size());
+
+    unsigned int expected = 0;
+    for (unsigned int i = 0; i < points.size(); i++) {
+        CHECK_EQUAL(gate.Test(points[i].first, points[i].second), (bool) result[i]);
+        expected += result[i];
+    }
+    CHECK_EQUAL(expected, numInside);
+}
+
+TEST(Test_LoadBanFile) {
+    const string name = "unittest-BananaGate.ban";
+    WriteBanFile(name, 7, banana);
+    CHECK_EQUAL(1u, BananaLibrary::get()->Load(name));
+    remove(name.c_str());
+
+    const BananaGate *gate = BananaLibrary::get()->Find(7);
+    CHECK(gate != NULL);
+    CHECK(BananaLibrary::get()->Find(6) == NULL);
+    CHECK(BananaLibrary::get()->Find(-1) == NULL);
+    if (!gate)
+        return;
+    CHECK_EQUAL(3115, gate->GetHistogramId());
+    CHECK(gate->GetVertices() == banana);
+}
+
+TEST(Test_LoadMissingFile) {
+    CHECK_THROW(BananaLibrary::get()->Load("unittest-BananaGate-missing.ban"), GeneralException);
+}
+
+int main(int argv, char *argc[]) {
+    return (UnitTest::RunAllTests());
+}
@@ -0,0 +1,157 @@
+///@file unittest-EventCache.cpp
+///@brief Program that will test the records of the EventCache
+///@date October 19, 2026
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#include <UnitTest++.h>
+
+#include "ChanEvent.hpp"
+#include "EventCache.hpp"
+#include "Exceptions.hpp"
+#include "StateArchive.hpp"
+
+using namespace std;
+
+///A calibrated channel with a trace that was analyzed
+struct ChannelFixture {
+    ChannelFixture() {
+        channel.SetCrateNumber(1);
+        channel.SetSlotNumber(4);
+        channel.SetChannelNumber(7);
+        channel.SetPileup(true);
+        channel.SetCfdTriggerSourceBit(true);
+        channel.SetEnergy(1234.5);
+        channel.SetTime(1.5e9 + 0.25);
+        channel.SetTimeSansCfd(1.5e9);
+        channel.SetCfdFractionalTime(8192);
+        channel.SetExternalTimeStamp(123456789012ULL);
+        channel.SetQdc(vector<unsigned int>(8, 3));
+        channel.SetCalibratedEnergy(661.7);
+        channel.SetHighResTime(12.5);
+        channel.SetWalkCorrectedTime(10.5);
+
+        unsigned int samples[] = {400, 401, 399, 900, 1500, 800, 450, 400};
+        channel.SetTrace(vector<unsigned int>(samples, samples + 8));
+        Trace &trace = channel.GetTrace();
+        trace.SetIsSaturated(false);
+        trace.SetHasValidWaveformAnalysis(true);
+        trace.SetHasValidTimingAnalysis(false);
+        trace.SetPhase(0.3);
+        trace.SetQdc(2800);
+        trace.SetTailRatio(0.2);
+        trace.SetTau(0);
+        trace.SetFilteredBaseline(0);
+        trace.SetBaseline(make_pair(400.0, 1.0));
+        trace.SetMax(make_pair(4u, 1100.0));
+        trace.SetExtrapolatedMax(make_pair(4u, 1110.0));
+        trace.SetWaveformRange(make_pair(2u, 7u));
+        trace.SetTriggerPositions(vector<unsigned int>(1, 3));
+        vector<double> sansBaseline;
+        for (Trace::iterator it = trace.begin(); it != trace.end(); it++)
+            sansBaseline.push_back(*it - 400.0);
+        trace.SetTraceSansBaseline(sansBaseline);
+    }
+
+    ///Writes the channel and reads it back
+    ChanEvent *RoundTrip(const bool &traces) {
+        ostringstream out(ios::binary);
+        StateWriter writer(out);
+        EventCache::WriteChannel(writer, channel, traces);
+
+        istringstream in(out.str(), ios::binary);
+        StateReader reader(in);
+        ChanEvent *read = EventCache::ReadChannel(reader);
+        CHECK_EQUAL(out.str().size(), reader.GetNumBytes());
+        return read;
+    }
+
+    ChanEvent channel;
+};
+
+TEST_FIXTURE(ChannelFixture, Test_RoundTrip) {
+    ChanEvent *read = RoundTrip(true);
+
+    CHECK_EQUAL(channel.GetID(), read->GetID());
+    CHECK_EQUAL(1u, read->GetCrateNumber());
+    CHECK_EQUAL(4u, read->GetSlotNumber());
+    CHECK_EQUAL(7u, read->GetChannelNumber());
+    CHECK(read->IsPileup());
+    CHECK(!read->IsSaturated());
+    CHECK(read->GetCfdTriggerSourceBit());
+    CHECK_EQUAL(1234.5, read->GetEnergy());
+    CHECK_EQUAL(channel.GetTime(), read->GetTime());
+    CHECK_EQUAL(8192u, read->GetCfdFractionalTime());
+    CHECK_EQUAL(123456789012ULL, read->GetExternalTimeStamp());
+    CHECK_EQUAL(8u, read->GetQdc().size());
+    CHECK_EQUAL(661.7, read->GetCalibratedEnergy());
+    CHECK_EQUAL(12.5, read->GetHighResTimeInNs());
+    CHECK_EQUAL(10.5, read->GetWalkCorrectedTime());
+
+    const Trace &trace = read->GetTrace();
+    CHECK_EQUAL(8u, trace.size());
+    CHECK_EQUAL(1500u, trace[4]);
+    CHECK(trace.HasValidWaveformAnalysis());
+    CHECK(!trace.HasValidTimingAnalysis());
+    CHECK_EQUAL(0.3, trace.GetPhase());
+    CHECK_EQUAL(2800, trace.GetQdc());
+    CHECK_EQUAL(1100.0, trace.GetMaxInfo().second);
+    CHECK_EQUAL(7u, trace.GetWaveformRange().second);
+    CHECK_EQUAL(1u, trace.GetTriggerPositions().size());
+    CHECK_EQUAL(8u, trace.GetTraceSansBaseline().size());
+    CHECK_EQUAL(1100.0, trace.GetTraceSansBaseline()[4]);
+    delete read;
+}
+
+TEST_FIXTURE(ChannelFixture, Test_WithoutTraces) {
+    ChanEvent *read = RoundTrip(false);
+
+    CHECK_EQUAL(0u, read->GetTraceLength());
+    CHECK_EQUAL(0u, read->GetTrace().size());
+    CHECK_EQUAL(2800, read->GetTraceResults().GetQdc());
+    CHECK_EQUAL(400.0, read->GetTraceResults().GetBaselineInfo().first);
+    delete read;
+}
+
+TEST_FIXTURE(ChannelFixture, Test_TruncatedChannel) {
+    ostringstream out(ios::binary);
+    StateWriter writer(out);
+    EventCache::WriteChannel(writer, channel, true);
+
+    istringstream in(out.str().substr(0, out.str().size() / 2), ios::binary);
+    StateReader reader(in);
+    CHECK_THROW(EventCache::ReadChannel(reader), IOException);
+}
+
+TEST(Test_Header) {
+    pugi::xml_document doc;
+    doc.load_string("<Configuration><Map><Module number=\"0\"/></Map><Global/>"
+                            "<DetectorDriver><Analyzer name=\"WaveformAnalyzer\"/>"
+                            "<Processor name=\"VandleProcessor\"/></DetectorDriver></Configuration>");
+    pugi::xml_node configuration = doc.child("Configuration");
+
+    ostringstream out(ios::binary);
+    StateWriter writer(out);
+    writer.Write(EventCache::VERSION);
+    writer.Write(EventCache::Hash(configuration));
+    writer.Write(true);
+    string header = out.str();
+    EventCache::CheckHeader(header, configuration);
+
+    //Changing the processors keeps the cache
+    configuration.child("DetectorDriver").remove_child("Processor");
+    EventCache::CheckHeader(header, configuration);
+
+    //Changing the map or the analyzers does not
+    configuration.child("DetectorDriver").child("Analyzer").append_attribute("ignored").set_value("vandle");
+    CHECK_THROW(EventCache::CheckHeader(header, configuration), invalid_argument);
+    configuration.child("DetectorDriver").child("Analyzer").remove_attribute("ignored");
+    EventCache::CheckHeader(header, configuration);
+    configuration.child("Map").child("Module").attribute("number").set_value(1);
+    CHECK_THROW(EventCache::CheckHeader(header, configuration), invalid_argument);
+}
+
+int main(int argv, char *argc[]) {
+    return (UnitTest::RunAllTests());
+}
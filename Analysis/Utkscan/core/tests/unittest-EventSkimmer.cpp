@@ -0,0 +1,160 @@
+///@file unittest-EventSkimmer.cpp
+///@brief Program that will test that the EventSkimmer writes a .pld file
+/// that the Unpacker reads back
+///@date October 19, 2026
+#include <deque>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#include <cstdio>
+
+#include <UnitTest++.h>
+
+#include "EventSkimmer.hpp"
+#include "HisFile.hpp"
+#include "RawEvent.hpp"
+#include "Unpacker.hpp"
+#include "XiaData.hpp"
+
+using namespace std;
+
+OutputHisFile *output_his = NULL;
+
+///An unpacker that keeps copies of the events that it builds
+class SkimReader : public Unpacker {
+public:
+    SkimReader() : numSpills(0) {}
+
+    vector<vector<XiaData> > events; //!< The events that were built
+    unsigned int numSpills; //!< The number of spills that were read
+
+private:
+    void ProcessRawEvent() {
+        vector<XiaData> event;
+        for (deque<XiaData *>::iterator it = rawEvent.begin(); it != rawEvent.end(); it++) {
+            (*it)->DetachTrace();
+            event.push_back(**it);
+        }
+        events.push_back(event);
+        Unpacker::ProcessRawEvent();
+    }
+
+    void EndSpill() { numSpills++; }
+};
+
+///Makes a hit with a trace on a module of the 250 MHz R30474 firmware
+XiaData *MakeHit(const unsigned int &vsn, const unsigned int &channel,
+                 const unsigned long long &time, const unsigned int &energy) {
+    XiaData *hit = new XiaData();
+    hit->SetSlotNumber(vsn + 2);
+    hit->SetChannelNumber(channel);
+    hit->SetCrateNumber(0);
+    hit->SetEventTimeLow(time & 0xFFFFFFFF);
+    hit->SetEventTimeHigh(time >> 32);
+    hit->SetEnergy(energy);
+    hit->SetCfdFractionalTime(1234);
+    hit->SetTime(time);
+    vector<unsigned int> trace(100);
+    for (unsigned int i = 0; i < trace.size(); i++)
+        trace[i] = 300 + (i * energy) % 500;
+    hit->SetTrace(trace);
+    return hit;
+}
+
+///Reads the skim back with an Unpacker
+void ReadSkim(const string &name, SkimReader &reader) {
+    ifstream input(name.c_str(), ios::binary);
+    PLD_header header;
+    PLD_data data;
+    CHECK(header.Read(&input));
+    vector<unsigned int> buffer(header.GetMaxSpillSize() + 2);
+    unsigned int numBytes;
+    reader.InitializeDataMask("30474", 250);
+    reader.SetEventWidth(100);
+    while (data.Read(&input, (char *) &buffer[0], numBytes, 4 * header.GetMaxSpillSize())) {
+        //! The end of spill record is not part of the spill that was written
+        buffer[numBytes / 4] = 2;
+        buffer[numBytes / 4 + 1] = 9999;
+        reader.ReadSpill(&buffer[0], numBytes / 4 + 2, true);
+    }
+}
+
+///The kept events are read back with their hits and traces, spills without
+/// kept events are not written
+TEST(Test_SkimIsReadBack) {
+    pugi::xml_document doc;
+    doc.load_string("<Skim output=\"unittest-EventSkimmer\" path=\"./\">"
+                            "<Gate detector=\"any\" min=\"0\"/></Skim>");
+    vector<vector<XiaData> > kept;
+    string name;
+    {
+        EventSkimmer skim(doc.child("Skim"));
+        skim.SetNumModules(3);
+        for (unsigned int vsn = 0; vsn < 3; vsn++)
+            skim.SetDataMask(vsn, XiaListModeDataMask("30474", 250));
+
+        RawEvent event;
+        unsigned long long time = 1000;
+        for (unsigned int spill = 0; spill < 5; spill++) {
+            for (unsigned int i = 0; i < 20; i++, time += 5000) {
+                deque<XiaData *> hits;
+                hits.push_back(MakeHit(i % 3, i % 16, time, 100 + i));
+                hits.push_back(MakeHit((i + 1) % 3, 3, time + 10, 200 + i));
+                CHECK(skim.Select(event));
+                //! Keep every third event and none of spill 2
+                if (i % 3 == 0 && spill != 2) {
+                    skim.Add(hits);
+                    vector<XiaData> copies;
+                    for (deque<XiaData *>::iterator it = hits.begin(); it != hits.end(); it++)
+                        copies.push_back(**it);
+                    kept.push_back(copies);
+                }
+                for (deque<XiaData *>::iterator it = hits.begin(); it != hits.end(); it++)
+                    delete *it;
+            }
+            skim.EndSpill();
+        }
+        CHECK_EQUAL(100u, skim.GetNumEvents());
+        CHECK_EQUAL(100u, skim.GetNumKept());
+        name = skim.GetFileName();
+    }
+
+    SkimReader reader;
+    ReadSkim(name, reader);
+    remove(name.c_str());
+
+    CHECK_EQUAL(4u, reader.numSpills);
+    CHECK_EQUAL(kept.size(), reader.events.size());
+    for (size_t i = 0; i < kept.size() && i < reader.events.size(); i++) {
+        CHECK_EQUAL(kept[i].size(), reader.events[i].size());
+        for (size_t j = 0; j < kept[i].size() && j < reader.events[i].size(); j++) {
+            const XiaData &expected = kept[i][j], &read = reader.events[i][j];
+            CHECK_EQUAL(expected.GetId(), read.GetId());
+            CHECK_EQUAL(expected.GetEnergy(), read.GetEnergy());
+            CHECK_EQUAL(expected.GetEventTimeLow(), read.GetEventTimeLow());
+            CHECK_EQUAL(expected.GetCfdFractionalTime(), read.GetCfdFractionalTime());
+            CHECK(expected.GetTrace() == read.GetTrace());
+        }
+    }
+}
+
+///A malformed Skim node is refused
+TEST(Test_MalformedSkim) {
+    pugi::xml_document doc;
+    doc.load_string("<Skim output=\"unittest-EventSkimmer\" path=\"./\" require=\"most\">"
+                            "<Gate detector=\"any\"/></Skim>"
+                            "<Skim output=\"unittest-EventSkimmer\" path=\"./\"/>"
+                            "<Skim output=\"unittest-EventSkimmer\" path=\"./\">"
+                            "<Gate detector=\"a:b:c:d\"/></Skim>");
+    pugi::xml_node node = doc.child("Skim");
+    CHECK_THROW(EventSkimmer skim(node), invalid_argument);
+    node = node.next_sibling("Skim");
+    CHECK_THROW(EventSkimmer skim(node), invalid_argument);
+    node = node.next_sibling("Skim");
+    CHECK_THROW(EventSkimmer skim(node), invalid_argument);
+}
+
+int main(int argv, char *argc[]) {
+    return (UnitTest::RunAllTests());
+}
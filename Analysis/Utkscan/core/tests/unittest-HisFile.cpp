@@ -0,0 +1,170 @@
+///@file unittest-HisFile.cpp
+///@brief Program that will test the sparse histograms of the OutputHisFile
+///@date October 19, 2026
+#include <fstream>
+#include <sstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <cstdio>
+
+#include <UnitTest++.h>
+
+#include "HisFile.hpp"
+#include "StateArchive.hpp"
+
+using namespace std;
+
+OutputHisFile *output_his = NULL;
+
+///Reads the whole .his file written with the given prefix
+string ReadHisFile(const string &prefix) {
+    ifstream input((prefix + ".his").c_str(), ios::binary);
+    return string((istreambuf_iterator<char>(input)), istreambuf_iterator<char>());
+}
+
+///Removes the files written by an OutputHisFile
+void RemoveFiles(const string &prefix) {
+    const char *extensions[] = {".his", ".drr", ".list", ".log"};
+    for (unsigned int i = 0; i < 4; i++)
+        remove((prefix + extensions[i]).c_str());
+}
+
+///Declares a 1D, a 2D int and a 2D short histogram, and fills them the same
+/// way for any storage that was selected.
+string FillHistograms(const string &prefix, const size_t &threshold,
+                      const bool &sparse1d) {
+    OutputHisFile *his = new OutputHisFile(prefix);
+    his->SetSparseThreshold(threshold);
+    his->SetFlushWait(1000);
+    his->SetSparseFlushWait(777);
+    his->push_back(new drr_entry(100, 2, 2048, 2048, 0, 2047, "1d"));
+    his->push_back(new drr_entry(200, 2, 1024, 1024, 0, 1023, 1024, 1024, 0, 1023, "2d int"));
+    his->push_back(new drr_entry(300, 1, 512, 512, 0, 511, 512, 512, 0, 511, "2d short"));
+    if (sparse1d)
+        CHECK(his->SetSparse(100));
+    his->Finalize();
+
+    for (unsigned int i = 0; i < 20000; i++) {
+        his->Fill(100, (i * 7) % 2100, 0);
+        his->Fill(200, (i * 13) % 1000, (i * 31) % 1100, 1 + i % 3);
+        //! Enough counts in a few bins to wrap the short cells around
+        his->FillBin(300, i % 5, (i * 3) % 7, 200);
+    }
+    delete his;
+
+    string contents = ReadHisFile(prefix);
+    RemoveFiles(prefix);
+    return contents;
+}
+
+TEST(Test_SparseMatchesQueued) {
+    string queued = FillHistograms("unittest-HisFile-queued", 0, false);
+    string sparse = FillHistograms("unittest-HisFile-sparse", 1, true);
+    CHECK_EQUAL(2048u * 4 + 1024u * 1024 * 4 + 512u * 512 * 2, queued.size());
+    CHECK(queued == sparse);
+}
+
+TEST(Test_Threshold) {
+    const string prefix = "unittest-HisFile-threshold";
+    OutputHisFile *his = new OutputHisFile(prefix);
+    his->SetSparseThreshold(1024 * 1024);
+    his->push_back(new drr_entry(100, 2, 2048, 2048, 0, 2047, "1d"));
+    his->push_back(new drr_entry(200, 2, 1024, 1024, 0, 1023, 1024, 1024, 0, 1023, "2d big"));
+    his->push_back(new drr_entry(300, 2, 256, 256, 0, 255, 256, 256, 0, 255, "2d small"));
+    CHECK_EQUAL(1u, his->GetNumSparse());
+
+    //! Only one tile was touched
+    his->Fill(200, 10, 10);
+    CHECK(his->GetSparseMemoryUsage() < 1024 * 1024 / 64);
+
+    //! The storage cannot change once the histogram was filled
+    CHECK(!his->SetSparse(200, false));
+    CHECK(his->SetSparse(300));
+    CHECK(!his->SetSparse(400));
+    CHECK_EQUAL(2u, his->GetNumSparse());
+    delete his;
+    RemoveFiles(prefix);
+}
+
+TEST(Test_Zero) {
+    const string prefix = "unittest-HisFile-zero";
+    OutputHisFile *his = new OutputHisFile(prefix);
+    his->push_back(new drr_entry(200, 2, 1024, 1024, 0, 1023, 1024, 1024, 0, 1023, "2d"));
+    CHECK(his->SetSparse(200));
+    his->Finalize();
+
+    his->Fill(200, 5, 5, 3);
+    his->Flush();
+    his->Zero(200);
+    his->Fill(200, 6, 5, 2);
+    delete his;
+
+    string contents = ReadHisFile(prefix);
+    RemoveFiles(prefix);
+    vector<unsigned int> bins(contents.size() / 4);
+    contents.copy((char *) &bins[0], contents.size());
+    CHECK_EQUAL(0u, bins[5 * 1024 + 5]);
+    CHECK_EQUAL(2u, bins[5 * 1024 + 6]);
+}
+
+///Declares a queued and a sparse histogram for the checkpoint tests
+OutputHisFile *OpenCheckpointHistograms(const string &prefix) {
+    OutputHisFile *his = new OutputHisFile(prefix);
+    his->SetFlushWait(1000);
+    his->push_back(new drr_entry(100, 2, 2048, 2048, 0, 2047, "1d"));
+    his->push_back(new drr_entry(300, 1, 512, 512, 0, 511, 512, 512, 0, 511, "2d short"));
+    CHECK(his->SetSparse(300));
+    his->Finalize();
+    return his;
+}
+
+///Fills the checkpoint histograms with the fills first to last - 1
+void FillCheckpointHistograms(OutputHisFile *his, const unsigned int &first, const unsigned int &last) {
+    for (unsigned int i = first; i < last; i++) {
+        his->Fill(100, (i * 7) % 2100, 0);
+        his->FillBin(300, i % 5, (i * 3) % 7, 200);
+    }
+}
+
+///A scan resumed from the state of the histograms writes the same file as a
+/// scan that was not interrupted
+TEST(Test_SaveAndLoadState) {
+    stringstream state(ios::in | ios::out | ios::binary);
+    StateWriter writer(state);
+
+    OutputHisFile *his = OpenCheckpointHistograms("unittest-HisFile-whole");
+    FillCheckpointHistograms(his, 0, 15000);
+    his->SaveState(writer);
+    FillCheckpointHistograms(his, 15000, 20000);
+    delete his;
+    string whole = ReadHisFile("unittest-HisFile-whole");
+    RemoveFiles("unittest-HisFile-whole");
+
+    his = OpenCheckpointHistograms("unittest-HisFile-resumed");
+    StateReader reader(state);
+    his->LoadState(reader);
+    CHECK_EQUAL(writer.GetNumBytes(), reader.GetNumBytes());
+    FillCheckpointHistograms(his, 15000, 20000);
+    delete his;
+    string resumed = ReadHisFile("unittest-HisFile-resumed");
+    RemoveFiles("unittest-HisFile-resumed");
+
+    CHECK_EQUAL(2048u * 4 + 512u * 512 * 2, whole.size());
+    CHECK(whole == resumed);
+
+    //! The state does not fit other histograms
+    his = new OutputHisFile("unittest-HisFile-other");
+    his->push_back(new drr_entry(100, 2, 1024, 1024, 0, 1023, "1d"));
+    his->Finalize();
+    state.seekg(0);
+    StateReader otherReader(state);
+    CHECK_THROW(his->LoadState(otherReader), IOException);
+    delete his;
+    RemoveFiles("unittest-HisFile-other");
+}
+
+int main(int argv, char *argc[]) {
+    return (UnitTest::RunAllTests());
+}
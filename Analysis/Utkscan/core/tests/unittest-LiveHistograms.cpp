@@ -0,0 +1,193 @@
+///@file unittest-LiveHistograms.cpp
+///@brief Program that will test the live histograms in shared memory
+///@date October 19, 2026
+#include <atomic>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <cstdio>
+#include <cstring>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <UnitTest++.h>
+
+#include "HisFile.hpp"
+#include "LiveHistograms.hpp"
+
+using namespace std;
+
+OutputHisFile *output_his = NULL;
+
+static const string segment = "/unittest-LiveHistograms";
+
+///Removes the files written by an OutputHisFile
+void RemoveFiles(const string &prefix) {
+    const char *extensions[] = {".his", ".drr", ".list", ".log"};
+    for (unsigned int i = 0; i < 4; i++)
+        remove((prefix + extensions[i]).c_str());
+}
+
+///Sends a request to the server and returns everything it answered
+string Query(const string &path, const string &request) {
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, path.c_str());
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (connect(fd, (sockaddr *) &address, sizeof(address)) != 0) {
+        close(fd);
+        return "";
+    }
+    string message = request + "\nQUIT\n";
+    send(fd, message.data(), message.size(), 0);
+
+    string response;
+    char buf[4096];
+    ssize_t num;
+    while ((num = recv(fd, buf, sizeof(buf), 0)) > 0)
+        response.append(buf, num);
+    close(fd);
+    return response;
+}
+
+TEST(Test_ImageMatchesFills) {
+    const string prefix = "unittest-LiveHistograms-image";
+    OutputHisFile *his = new OutputHisFile(prefix);
+    his->push_back(new drr_entry(100, 2, 2048, 2048, 0, 2047, "1d queued"));
+    his->push_back(new drr_entry(200, 2, 1024, 1024, 0, 1023, 1024, 1024, 0, 1023, "2d sparse"));
+    his->push_back(new drr_entry(300, 1, 512, 512, 0, 511, "1d short"));
+    CHECK(his->SetSparse(200));
+    his->Finalize();
+    CHECK(his->OpenLive(segment));
+
+    LiveHisReader reader;
+    CHECK(reader.Open(segment));
+    CHECK_EQUAL(3u, reader.GetNumHistograms());
+    CHECK(reader.FindEntry(400) == NULL);
+
+    vector<unsigned int> expected(1024 * 1024, 0);
+    for (unsigned int i = 0; i < 5000; i++) {
+        his->Fill(100, i % 2048, 0);
+        his->Fill(200, i % 1024, (i * 7) % 1024, 2);
+        his->Fill(300, i % 3, 0, 30000);
+        expected[(i * 7) % 1024 * 1024 + i % 1024] += 2;
+    }
+
+    //! The queued fills are visible right away without a flush
+    vector<unsigned int> bins;
+    CHECK(reader.Read(100, bins));
+    CHECK_EQUAL(2048u, bins.size());
+    CHECK_EQUAL(3u, bins[0]);
+    CHECK_EQUAL(2u, bins[2047]);
+
+    //! The sparse tiles only after they were published
+    CHECK(reader.Read(200, bins));
+    CHECK_EQUAL(0u, bins[7 * 1024 + 1]);
+    his->PublishLive(true);
+    CHECK_EQUAL(1u, reader.GetNumUpdates());
+    CHECK(reader.Read(200, bins));
+    CHECK(bins == expected);
+
+    //! Short cells wrap around like they do in the .his file
+    CHECK(reader.Read(300, bins));
+    CHECK_EQUAL((unsigned int) (unsigned short) (1666 * 30000), bins[2]);
+
+    his->Zero(100);
+    CHECK(reader.Read(100, bins));
+    CHECK_EQUAL(0u, bins[0]);
+
+    delete his;
+    RemoveFiles(prefix);
+
+    //! The segment is removed when the file is closed
+    LiveHisReader closed;
+    CHECK(!closed.Open(segment));
+}
+
+TEST(Test_ConsistentSnapshots) {
+    LiveHisWriter writer;
+    writer.Declare(1, 1, 2, 4096, 1, 0, "spectrum");
+    CHECK(writer.Open(segment, 4096 * 4));
+
+    LiveHisReader reader;
+    CHECK(reader.Open(segment));
+
+    //! Every update adds one count to all of the bins, so a torn copy would
+    //! hold bins with different contents.
+    atomic<bool> done(false);
+    thread filler([&writer, &done]() {
+        for (unsigned int i = 0; i < 2000; i++) {
+            writer.BeginWrite(0);
+            unsigned int *bins = (unsigned int *) writer.GetBins(0);
+            for (unsigned int j = 0; j < 4096; j++)
+                bins[j]++;
+            writer.EndWrite(0);
+        }
+        done = true;
+    });
+
+    unsigned int numTorn = 0;
+    vector<unsigned int> bins;
+    while (!done) {
+        if (!reader.Read(1, bins, 1000000))
+            continue;
+        for (unsigned int j = 1; j < bins.size(); j++)
+            if (bins[j] != bins[0])
+                numTorn++;
+    }
+    filler.join();
+    CHECK_EQUAL(0u, numTorn);
+    CHECK(reader.Read(1, bins));
+    CHECK_EQUAL(2000u, bins[4095]);
+}
+
+TEST(Test_Server) {
+    const string path = "unittest-LiveHistograms.sock";
+    LiveHisWriter writer;
+    writer.Declare(7, 1, 2, 16, 1, 0, "seven");
+    CHECK(writer.Open(segment, 16 * 4));
+    writer.Add(0, 3, 5);
+    writer.Publish();
+
+    HistogramServer server(segment, path);
+    CHECK(server.Start());
+    CHECK(server.IsRunning());
+
+    CHECK_EQUAL("OK 1\n7 1 16 1 seven\n", Query(path, "LIST"));
+    CHECK_EQUAL("ERR Unknown histogram\n", Query(path, "GET 8"));
+    CHECK_EQUAL("ERR Unknown request\n", Query(path, "PUT 7"));
+
+    stringstream info(Query(path, "INFO"));
+    string ok;
+    unsigned int numUpdates, pid;
+    long long lastUpdate;
+    info >> ok >> numUpdates >> lastUpdate >> pid;
+    CHECK_EQUAL("OK", ok);
+    CHECK_EQUAL(1u, numUpdates);
+    CHECK_EQUAL((unsigned int) getpid(), pid);
+
+    string response = Query(path, "GET 7");
+    string header = "OK 7 1 16 1 16\n";
+    CHECK_EQUAL(header.size() + 16 * 4, response.size());
+    CHECK(response.compare(0, header.size(), header) == 0);
+    if (response.size() == header.size() + 16 * 4) {
+        vector<unsigned int> bins(16);
+        memcpy(&bins[0], response.data() + header.size(), 16 * 4);
+        CHECK_EQUAL(5u, bins[3]);
+        CHECK_EQUAL(0u, bins[4]);
+    }
+
+    server.Stop();
+    CHECK(!server.IsRunning());
+    CHECK(access(path.c_str(), F_OK) != 0);
+}
+
+int main(int argv, char *argc[]) {
+    return (UnitTest::RunAllTests());
+}
@@ -0,0 +1,176 @@
+///@file unittest-PixelCorrelator.cpp
+///@brief Program that will test functionality of the PixelCorrelator
+///@date October 19, 2026
+#include <iostream>
+#include <sstream>
+
+#include <UnitTest++.h>
+
+#include "PixelCorrelator.hpp"
+#include "SheCorrelator.hpp"
+
+using namespace std;
+
+typedef PixelCorrelator<int> Correlator;
+
+TEST(Test_AddAndFind) {
+    Correlator corr(4, 4, 8, 0);
+    for (int i = 0; i < 5; i++)
+        CHECK(corr.Add(1, 2, 10.0 * i, i));
+    CHECK(!corr.Add(4, 0, 0.0, 0));
+    CHECK_EQUAL(5u, corr.Size(1, 2));
+    CHECK_EQUAL(0u, corr.Size(2, 1));
+
+    vector<Correlator::Hit> hits;
+    CHECK_EQUAL(3u, corr.Find(1, 2, 10.0, 30.0, hits));
+    CHECK_EQUAL(3u, hits.size());
+    for (unsigned int i = 0; i < hits.size(); i++) {
+        CHECK_EQUAL(int(i + 1), *hits[i].event);
+        CHECK_EQUAL(10.0 * (i + 1), hits[i].time);
+        CHECK_EQUAL(1u, hits[i].x);
+        CHECK_EQUAL(2u, hits[i].y);
+    }
+    CHECK_EQUAL(0u, corr.Find(1, 2, 41.0, 100.0, hits));
+    CHECK_EQUAL(2u, corr.GetNumQueries());
+}
+
+TEST(Test_OutOfOrder) {
+    Correlator corr(1, 1, 8, 0);
+    corr.Add(0, 0, 30.0, 3);
+    corr.Add(0, 0, 10.0, 1);
+    corr.Add(0, 0, 40.0, 4);
+    corr.Add(0, 0, 20.0, 2);
+    CHECK_EQUAL(4u, corr.Size(0, 0));
+    for (unsigned int i = 0; i < 4; i++) {
+        CHECK_EQUAL(int(i + 1), corr.At(0, 0, i));
+        CHECK_EQUAL(10.0 * (i + 1), corr.GetTime(0, 0, i));
+    }
+}
+
+TEST(Test_Overflow) {
+    Correlator corr(1, 1, 4, 0);
+    for (int i = 0; i < 10; i++)
+        corr.Add(0, 0, i, i);
+    CHECK_EQUAL(4u, corr.Size(0, 0));
+    CHECK_EQUAL(6u, corr.GetNumOverflows());
+    for (unsigned int i = 0; i < 4; i++)
+        CHECK_EQUAL(int(i + 6), corr.At(0, 0, i));
+
+    vector<Correlator::Hit> hits;
+    CHECK_EQUAL(2u, corr.Find(0, 0, 7.0, 8.0, hits));
+    CHECK_EQUAL(7, *hits.front().event);
+}
+
+TEST(Test_Expiry) {
+    Correlator corr(1, 1, 16, 5.0);
+    for (int i = 0; i < 10; i++)
+        corr.Add(0, 0, i, i);
+    //! The events at 4 ... 9 are within 5 of the newest one
+    CHECK_EQUAL(6u, corr.Size(0, 0));
+    CHECK_EQUAL(4u, corr.GetNumExpired());
+    CHECK_EQUAL(4, corr.At(0, 0, 0));
+
+    corr.Expire(0, 0, 8.0);
+    CHECK_EQUAL(2u, corr.Size(0, 0));
+    CHECK_EQUAL(8, corr.At(0, 0, 0));
+}
+
+TEST(Test_Neighbours) {
+    Correlator corr(5, 5, 4, 0);
+    for (unsigned int x = 0; x < 5; x++)
+        for (unsigned int y = 0; y < 5; y++)
+            corr.Add(x, y, 1.0, 10 * x + y);
+
+    vector<Correlator::Hit> hits;
+    CHECK_EQUAL(1u, corr.FindNeighbours(2, 2, 0, 0.0, 2.0, hits));
+    CHECK_EQUAL(22, *hits.front().event);
+
+    hits.clear();
+    CHECK_EQUAL(9u, corr.FindNeighbours(2, 2, 1, 0.0, 2.0, hits));
+    for (unsigned int i = 0; i < hits.size(); i++) {
+        CHECK(hits[i].x >= 1 && hits[i].x <= 3);
+        CHECK(hits[i].y >= 1 && hits[i].y <= 3);
+        CHECK_EQUAL(int(10 * hits[i].x + hits[i].y), *hits[i].event);
+    }
+
+    //! Clipped at the edges of the detector
+    hits.clear();
+    CHECK_EQUAL(4u, corr.FindNeighbours(0, 4, 1, 0.0, 2.0, hits));
+    hits.clear();
+    CHECK_EQUAL(0u, corr.FindNeighbours(2, 2, 2, 1.5, 2.0, hits));
+}
+
+TEST(Test_ClearAndStatistics) {
+    Correlator corr(2, 3, 4, 0);
+    corr.Add(1, 1, 1.0, 1);
+    corr.Add(0, 2, 1.0, 2);
+    corr.Clear(1, 1);
+    CHECK_EQUAL(0u, corr.Size(1, 1));
+    CHECK_EQUAL(1u, corr.Size(0, 2));
+    corr.Clear();
+    CHECK_EQUAL(0u, corr.Size(0, 2));
+
+    CHECK(corr.GetMemoryUsage() >= 2 * 3 * 4 * (sizeof(int) + sizeof(double)));
+    stringstream ss;
+    corr.PrintStatistics(ss, "test");
+    CHECK(ss.str().find("2 events added") != string::npos);
+}
+
+TEST(Test_SaveAndLoadState) {
+    Correlator corr(3, 3, 4, 50.0);
+    for (int i = 0; i < 6; i++)
+        corr.Add(2, 1, 10.0 * i, i);
+    stringstream stream(ios::in | ios::out | ios::binary);
+    StateWriter writer(stream);
+    corr.SaveState(writer);
+
+    Correlator loaded(3, 3, 4, 50.0);
+    StateReader reader(stream);
+    loaded.LoadState(reader);
+    CHECK_EQUAL(writer.GetNumBytes(), reader.GetNumBytes());
+    CHECK_EQUAL(corr.Size(2, 1), loaded.Size(2, 1));
+    CHECK_EQUAL(corr.GetNumOverflows(), loaded.GetNumOverflows());
+    for (unsigned int i = 0; i < corr.Size(2, 1); i++) {
+        CHECK_EQUAL(corr.At(2, 1, i), loaded.At(2, 1, i));
+        CHECK_EQUAL(corr.GetTime(2, 1, i), loaded.GetTime(2, 1, i));
+    }
+
+    //! Both continue exactly alike
+    corr.Add(2, 1, 70.0, 7);
+    loaded.Add(2, 1, 70.0, 7);
+    CHECK_EQUAL(corr.Size(2, 1), loaded.Size(2, 1));
+    CHECK_EQUAL(corr.At(2, 1, 0), loaded.At(2, 1, 0));
+
+    stream.seekg(0);
+    Correlator other(3, 4, 4, 50.0);
+    StateReader otherReader(stream);
+    CHECK_THROW(other.LoadState(otherReader), IOException);
+}
+
+///The SheCorrelator keeps its chains in a PixelCorrelator of SheEvents
+TEST(Test_SaveAndLoadSheEvents) {
+    PixelCorrelator<SheEvent> corr(2, 2, 4, 50.0);
+    corr.Add(1, 1, 10.0, SheEvent(8000.0, 10.0, 0, false, false, false, alpha));
+    corr.Add(1, 1, 20.0, SheEvent(150000.0, 20.0, 2, true, false, true, heavyIon));
+    stringstream stream(ios::in | ios::out | ios::binary);
+    StateWriter writer(stream);
+    corr.SaveState(writer);
+
+    PixelCorrelator<SheEvent> loaded(2, 2, 4, 50.0);
+    StateReader reader(stream);
+    loaded.LoadState(reader);
+    CHECK_EQUAL(2u, loaded.Size(1, 1));
+    const SheEvent &event = loaded.At(1, 1, 1);
+    CHECK_EQUAL(150000.0, event.get_energy());
+    CHECK_EQUAL(20.0, event.get_time());
+    CHECK_EQUAL(2, event.get_mwpc());
+    CHECK(event.get_beam());
+    CHECK(!event.get_veto());
+    CHECK(event.get_escape());
+    CHECK_EQUAL(heavyIon, event.get_type());
+    CHECK_EQUAL(alpha, loaded.At(1, 1, 0).get_type());
+}
+
+int main(int argv, char *argc[]) {
+    return (UnitTest::RunAllTests());
+}
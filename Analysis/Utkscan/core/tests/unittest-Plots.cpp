@@ -0,0 +1,127 @@
+///@file unittest-Plots.cpp
+///@brief Program that will test the histogram handles of the Plots
+///@date October 19, 2026
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include <cstdio>
+
+#include <UnitTest++.h>
+
+#include "HisFile.hpp"
+#include "Plots.hpp"
+
+using namespace std;
+
+OutputHisFile *output_his = NULL;
+
+///Reads the whole .his file written with the given prefix and removes the
+/// files of the OutputHisFile
+string ReadHisFile(const string &prefix) {
+    string contents;
+    {
+        ifstream input((prefix + ".his").c_str(), ios::binary);
+        contents = string((istreambuf_iterator<char>(input)), istreambuf_iterator<char>());
+    }
+    const char *extensions[] = {".his", ".drr", ".list", ".log"};
+    for (unsigned int i = 0; i < 4; i++)
+        remove((prefix + extensions[i]).c_str());
+    return contents;
+}
+
+///Declares a 1D, a 1D with a channel range, which cannot be filled directly,
+/// and a 2D histogram, then fills them through the handles or through
+/// Plots::Plot. The weights of the Plot fills are repeated fills.
+string FillHistograms(const string &prefix, const int &offset, const bool &handles) {
+    output_his = new OutputHisFile(prefix);
+    output_his->SetFlushWait(100);
+
+    Plots plots(offset, 10, prefix);
+    Histogram1D oneD = plots.DeclareHistogram1D(0, 1024, "1d");
+    Histogram1D ranged = plots.DeclareHistogram1D(1, 1024, "1d ranged", 2, 512, 256, 767);
+    Histogram2D twoD = plots.DeclareHistogram2D(2, 256, 128, "2d");
+    output_his->Finalize();
+
+    for (unsigned int i = 0; i < 5000; i++) {
+        unsigned int weight = 1 + i % 3;
+        double x = (i * 7) % 1100 + 0.25;
+        double y = (i * 11) % 140 + 0.75;
+        if (handles) {
+            oneD.Fill(x, weight);
+            ranged.Fill(x, weight);
+            twoD.Fill(x / 4, y, weight);
+        } else {
+            for (unsigned int j = 0; j < weight; j++) {
+                plots.Plot(0, x);
+                plots.Plot(1, x);
+                plots.Plot(2, x / 4, y);
+            }
+        }
+    }
+    if (handles) {
+        CHECK(oneD.IsDirect());
+        CHECK(!ranged.IsDirect());
+        CHECK(ranged.IsValid());
+        CHECK(twoD.IsDirect());
+    }
+
+    delete output_his;
+    output_his = NULL;
+    return ReadHisFile(prefix);
+}
+
+///The handles write the same .his file as Plots::Plot, with the weights
+/// applied on the direct and on the fallback path
+TEST(Test_HandlesMatchPlot) {
+    string plotted = FillHistograms("unittest-Plots-plot", 100, false);
+    string filled = FillHistograms("unittest-Plots-handles", 200, true);
+    CHECK_EQUAL(1024u * 4 + 512u * 4 + 256u * 128 * 2, plotted.size());
+    CHECK(plotted == filled);
+}
+
+///A weight is added to a single bin of a 1D histogram
+TEST(Test_Weights) {
+    const string prefix = "unittest-Plots-weights";
+    output_his = new OutputHisFile(prefix);
+    Plots plots(300, 10, prefix);
+    Histogram1D direct = plots.DeclareHistogram1D(0, 16, "direct");
+    Histogram1D ranged = plots.DeclareHistogram1D(1, 16, "ranged", 2, 16, 4, 19);
+    output_his->Finalize();
+
+    direct.Fill(3, 5);
+    ranged.Fill(6, 7);
+    direct.Fill(4, 0);
+    delete output_his;
+    output_his = NULL;
+
+    string contents = ReadHisFile(prefix);
+    CHECK_EQUAL(32u * 4, contents.size());
+    const unsigned int *bins = (const unsigned int *) contents.data();
+    CHECK_EQUAL(5u, bins[3]);
+    CHECK_EQUAL(0u, bins[4]);
+    unsigned int sum = 0;
+    for (unsigned int i = 16; i < 32; i++)
+        sum += bins[i];
+    CHECK_EQUAL(7u, sum);
+}
+
+///A handle without a .his file or a declared histogram ignores the fills
+TEST(Test_Unresolved) {
+    Histogram1D empty;
+    CHECK(!empty.IsValid());
+    empty.Fill(1, 2);
+
+    Plots plots(400, 10, "unittest-Plots-unresolved");
+    Histogram1D oneD = plots.DeclareHistogram1D(0, 16, "no his");
+    Histogram2D twoD = plots.DeclareHistogram2D(1, 16, 16, "no his");
+    oneD.Fill(1, 2);
+    twoD.Fill(1, 2, 3);
+    CHECK(oneD.IsValid());
+    CHECK(!oneD.IsDirect());
+    CHECK(!twoD.IsDirect());
+}
+
+int main(int argv, char *argc[]) {
+    return (UnitTest::RunAllTests());
+}
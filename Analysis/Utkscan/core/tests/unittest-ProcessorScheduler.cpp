@@ -0,0 +1,187 @@
+///@file unittest-ProcessorScheduler.cpp
+///@brief Program that will test the scheduling of the EventProcessors
+///@date October 19, 2026
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <UnitTest++.h>
+
+#include "EventProcessor.hpp"
+#include "Exceptions.hpp"
+#include "HisFile.hpp"
+#include "ProcessorScheduler.hpp"
+#include "RawEvent.hpp"
+#include "TreeCorrelator.hpp"
+
+using namespace std;
+
+OutputHisFile *output_his = NULL;
+
+///A processor that activates a place in PreProcess, or looks it up
+class PlaceProcessor : public EventProcessor {
+public:
+    PlaceProcessor(const string &name, const string &place, const bool &activates) :
+            EventProcessor(0, 0, name), place_(place), activates_(activates), usesPlace_(true), numSeen_(0),
+            numCalls_(0) {}
+
+    bool HasEvent(void) const { return true; }
+
+    bool PreProcess(RawEvent &event) {
+        numCalls_++;
+        if (!usesPlace_)
+            return true;
+        if (activates_)
+            TreeCorrelator::get()->place(place_)->activate(1.0);
+        else if (TreeCorrelator::get()->place(place_)->status())
+            numSeen_++;
+        return true;
+    }
+
+    bool Process(RawEvent &event) { return true; }
+
+    string place_; //!< The place that is used
+    bool activates_; //!< True if the place is activated, false if it is looked up
+    bool usesPlace_; //!< False to leave the place alone
+    unsigned long numSeen_; //!< The number of events in which the place was active
+    unsigned long numCalls_; //!< The number of calls of PreProcess
+};
+
+///Creates a place of the TreeCorrelator
+void CreatePlace(const string &name) {
+    map<string, string> params;
+    params["name"] = name;
+    params["type"] = "PlaceDetector";
+    params["parent"] = "root";
+    params["reset"] = "true";
+    params["fifo"] = "2";
+    params["init"] = "false";
+    params["replace"] = TreeCorrelator::get()->checkPlace(name) ? "true" : "false";
+    TreeCorrelator::get()->createPlace(params, false);
+}
+
+///Runs an event and resets the places like the DetectorDriver
+void RunEvent(ProcessorScheduler &scheduler, RawEvent &event) {
+    scheduler.PreProcess(event);
+    scheduler.Process(event);
+    for (map<string, Place *>::iterator it = TreeCorrelator::get()->places_.begin();
+         it != TreeCorrelator::get()->places_.end(); it++)
+        if (it->second->resetable())
+            it->second->reset();
+}
+
+///The processors sharing a place are learned and ordered
+TEST(Test_SharedPlaces) {
+    CreatePlace("Beta");
+    PlaceProcessor beta("BetaProcessor", "Beta", true);
+    PlaceProcessor gamma("GammaProcessor", "Beta", false);
+    PlaceProcessor other("OtherProcessor", "Beta", false);
+    other.usesPlace_ = false;
+    other.AddDependency("BetaProcessor");
+    vector<EventProcessor *> procs;
+    procs.push_back(&beta);
+    procs.push_back(&gamma);
+    procs.push_back(&other);
+
+    ProcessorScheduler scheduler;
+    scheduler.SetProcessors(procs, 3);
+    CHECK(scheduler.IsConcurrent());
+    CHECK(scheduler.IsLearning());
+
+    RawEvent event;
+    for (unsigned long i = 0; i < ProcessorScheduler::LEARNING_EVENTS; i++)
+        RunEvent(scheduler, event);
+    CHECK(!scheduler.IsLearning());
+
+    for (unsigned int i = 0; i < 500; i++)
+        RunEvent(scheduler, event);
+    CHECK_EQUAL(gamma.numCalls_, gamma.numSeen_);
+    CHECK_EQUAL(ProcessorScheduler::LEARNING_EVENTS + 500, gamma.numCalls_);
+}
+
+///A place shared only after the learning stops the scan
+TEST(Test_SharedAfterLearning) {
+    CreatePlace("Neutron");
+    PlaceProcessor neutron("NeutronProcessor", "Neutron", true);
+    PlaceProcessor gamma("GammaProcessor", "Neutron", false);
+    gamma.usesPlace_ = false;
+    PlaceProcessor other("OtherProcessor", "Neutron", false);
+    other.usesPlace_ = false;
+    other.AddDependency("NeutronProcessor");
+    vector<EventProcessor *> procs;
+    procs.push_back(&neutron);
+    procs.push_back(&gamma);
+    procs.push_back(&other);
+
+    ProcessorScheduler scheduler;
+    scheduler.SetProcessors(procs, 2);
+    RawEvent event;
+    for (unsigned long i = 0; i < ProcessorScheduler::LEARNING_EVENTS; i++)
+        RunEvent(scheduler, event);
+
+    gamma.usesPlace_ = true;
+    CHECK_THROW(RunEvent(scheduler, event), GeneralException);
+}
+
+///On one thread nothing is learned and the configuration order is kept
+TEST(Test_SingleThread) {
+    CreatePlace("Beta");
+    PlaceProcessor gamma("GammaProcessor", "Beta", false);
+    PlaceProcessor beta("BetaProcessor", "Beta", true);
+    gamma.AddDependency("BetaProcessor");
+    vector<EventProcessor *> procs;
+    procs.push_back(&gamma);
+    procs.push_back(&beta);
+
+    ProcessorScheduler scheduler;
+    scheduler.SetProcessors(procs, 1);
+    CHECK(!scheduler.IsConcurrent());
+    CHECK(!scheduler.IsLearning());
+
+    RawEvent event;
+    RunEvent(scheduler, event);
+    CHECK_EQUAL(0u, gamma.numSeen_);
+}
+
+///Skipping a processor skips the ones that depend on it too
+TEST(Test_SkipDependents) {
+    CreatePlace("Beta");
+    PlaceProcessor vandle("VandleProcessor", "Beta", true);
+    PlaceProcessor experiment("ExperimentProcessor", "Beta", false);
+    PlaceProcessor histogram("HistogramProcessor", "Beta", false);
+    PlaceProcessor gamma("GammaProcessor", "Beta", false);
+    experiment.AddDependency("VandleProcessor");
+    histogram.AddDependency("ExperimentProcessor");
+    vector<EventProcessor *> procs;
+    procs.push_back(&vandle);
+    procs.push_back(&experiment);
+    procs.push_back(&histogram);
+    procs.push_back(&gamma);
+
+    ProcessorScheduler scheduler;
+    scheduler.SetProcessors(procs, 1);
+    set<string> skipped;
+    skipped.insert("VandleProcessor");
+    scheduler.SetSkipped(skipped);
+    CHECK(scheduler.IsSkipped("VandleProcessor"));
+    CHECK(scheduler.IsSkipped("ExperimentProcessor"));
+    CHECK(scheduler.IsSkipped("HistogramProcessor"));
+    CHECK(!scheduler.IsSkipped("GammaProcessor"));
+
+    RawEvent event;
+    RunEvent(scheduler, event);
+    CHECK_EQUAL(0u, vandle.numCalls_);
+    CHECK_EQUAL(0u, experiment.numCalls_);
+    CHECK_EQUAL(0u, histogram.numCalls_);
+    CHECK_EQUAL(1u, gamma.numCalls_);
+
+    scheduler.SetSkipped(set<string>());
+    CHECK(!scheduler.IsSkipped("HistogramProcessor"));
+    RunEvent(scheduler, event);
+    CHECK_EQUAL(1u, histogram.numCalls_);
+}
+
+int main(int argv, char *argc[]) {
+    return (UnitTest::RunAllTests());
+}
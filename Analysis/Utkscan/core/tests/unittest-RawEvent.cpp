@@ -0,0 +1,158 @@
+///@file unittest-RawEvent.cpp
+///@brief Program that will test the registry of the detector summaries and
+/// their zeroing at the end of an event
+///@date October 19, 2026
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <cstdio>
+
+#include <UnitTest++.h>
+
+#include "DetectorLibrary.hpp"
+#include "HisFile.hpp"
+#include "RawEvent.hpp"
+#include "XmlInterface.hpp"
+
+using namespace std;
+
+OutputHisFile *output_his = NULL;
+
+///Loads a map with two clovers, one of them tagged as start, and two betas
+DetectorLibrary *LoadLibrary() {
+    static DetectorLibrary *lib = NULL;
+    if (lib)
+        return lib;
+
+    const string name = "unittest-RawEvent.xml";
+    {
+        ofstream config(name.c_str());
+        config << "<Configuration><Map TraceDelay=\"344\" frequency=\"250\"><Module number=\"0\">"
+               << "<Channel number=\"0\" type=\"ge\" subtype=\"clover\"/>"
+               << "<Channel number=\"1\" type=\"ge\" subtype=\"clover\" tags=\"start\"/>"
+               << "<Channel number=\"2\" type=\"beta\" subtype=\"single\" tags=\"left\"/>"
+               << "<Channel number=\"3\" type=\"beta\" subtype=\"double\"/>"
+               << "</Module></Map></Configuration>";
+    }
+    XmlInterface::get(name);
+    remove(name.c_str());
+    return lib = DetectorLibrary::get();
+}
+
+///Creates a channel of module 0
+ChanEvent *MakeChannel(const unsigned int &channel) {
+    ChanEvent *event = new ChanEvent();
+    event->SetSlotNumber(2);
+    event->SetChannelNumber(channel);
+    event->SetCrateNumber(0);
+    return event;
+}
+
+///Adds a channel of module 0 to the event and its summaries
+void AddChannel(RawEvent &event, const unsigned int &channel) {
+    ChanEvent *chan = MakeChannel(channel);
+    event.AddChan(chan);
+    event.AddToSummaries(chan);
+}
+
+///@return True if the channel belongs to the summary
+bool BelongsTo(DetectorLibrary *lib, const unsigned int &channel, const string &summary) {
+    const vector<unsigned int> &ids = lib->GetSummaryIds(channel);
+    return find(ids.begin(), ids.end(), lib->GetSummaryId(summary)) != ids.end();
+}
+
+///@return The multiplicity of a summary, looked up without touching it
+int GetMult(const RawEvent &event, const string &summary) {
+    const DetectorSummary *s = event.GetSummary(summary);
+    return s ? s->GetMult() : -1;
+}
+
+///Checks that all the summaries of the event are empty
+void CheckEmpty(DetectorLibrary *lib, const RawEvent &event) {
+    for (unsigned int id = 0; id < lib->GetNumSummaries(); id++)
+        CHECK_EQUAL(0, GetMult(event, lib->GetSummaryName(id)));
+}
+
+///The map registers the types, the subtypes and the start channels
+TEST(Test_RegisterSummary) {
+    DetectorLibrary *lib = LoadLibrary();
+    unsigned int ge = lib->GetSummaryId("ge");
+    CHECK(ge != DetectorLibrary::NO_SUMMARY);
+    CHECK(lib->GetSummaryId("ge:clover") != DetectorLibrary::NO_SUMMARY);
+    CHECK(lib->GetSummaryId("ge:clover:start") != DetectorLibrary::NO_SUMMARY);
+    CHECK(lib->GetSummaryId("beta:single") != DetectorLibrary::NO_SUMMARY);
+    CHECK_EQUAL(DetectorLibrary::NO_SUMMARY, lib->GetSummaryId("beta:single:left"));
+    CHECK_EQUAL(ge, lib->RegisterSummary("ge"));
+    CHECK_EQUAL(string("ge"), lib->GetSummaryName(ge));
+
+    CHECK(BelongsTo(lib, 0, "ge"));
+    CHECK(BelongsTo(lib, 0, "ge:clover"));
+    CHECK(!BelongsTo(lib, 0, "ge:clover:start"));
+    CHECK(BelongsTo(lib, 1, "ge:clover:start"));
+    CHECK(!BelongsTo(lib, 2, "ge"));
+    CHECK(BelongsTo(lib, 3, "beta"));
+    CHECK(lib->GetSummaryIds(100).empty());
+}
+
+///The channels are added to their summaries, a summary registered by name
+/// after the map was loaded is filled with the channels of the event, and
+/// Zero clears the summaries that the event touched
+TEST(Test_AddAndZero) {
+    DetectorLibrary *lib = LoadLibrary();
+    RawEvent event;
+    event.Init(lib->GetUsedDetectors());
+
+    AddChannel(event, 0);
+    AddChannel(event, 2);
+    CHECK_EQUAL(1, event.GetSummary("ge")->GetMult());
+    CHECK_EQUAL(1, event.GetSummary("ge:clover")->GetMult());
+    CHECK_EQUAL(0, event.GetSummary("ge:clover:start")->GetMult());
+    CHECK_EQUAL(1, event.GetSummary(lib->GetSummaryId("beta:single"))->GetMult());
+    CHECK_EQUAL(0, event.GetSummary(lib->GetSummaryId("beta:double"))->GetMult());
+
+    unsigned int numSummaries = lib->GetNumSummaries();
+    DetectorSummary *left = event.GetSummary("beta:single:left");
+    CHECK_EQUAL(numSummaries + 1, lib->GetNumSummaries());
+    CHECK(BelongsTo(lib, 2, "beta:single:left"));
+    CHECK(!BelongsTo(lib, 3, "beta:single:left"));
+    CHECK_EQUAL(1, left->GetMult());
+    CHECK(event.GetSummary("not:in:map", false) == NULL);
+    CHECK_EQUAL(numSummaries + 1, lib->GetNumSummaries());
+
+    event.Zero();
+    CHECK(event.GetEventList().empty());
+    CheckEmpty(lib, event);
+
+    //Only adding the channels touches the summaries of the second event
+    AddChannel(event, 3);
+    AddChannel(event, 2);
+    CHECK_EQUAL(2, GetMult(event, "beta"));
+    CHECK_EQUAL(1, GetMult(event, "beta:double"));
+    CHECK_EQUAL(1, GetMult(event, "beta:single:left"));
+    CHECK_EQUAL(0, GetMult(event, "ge"));
+    event.Zero();
+    CheckEmpty(lib, event);
+}
+
+///A summary registered by another event is constructed empty for the
+/// channels that are added afterwards
+TEST(Test_RegisteredElsewhere) {
+    DetectorLibrary *lib = LoadLibrary();
+    RawEvent event;
+    event.Init(lib->GetUsedDetectors());
+    unsigned int id = lib->RegisterSummary("ge:clover:veto");
+    CHECK(!BelongsTo(lib, 0, "ge:clover:veto"));
+
+    AddChannel(event, 0);
+    DetectorSummary *veto = event.GetSummary(id);
+    CHECK(veto != NULL);
+    CHECK_EQUAL(0, veto->GetMult());
+    CHECK_EQUAL(1, event.GetSummary("ge")->GetMult());
+    event.Zero();
+}
+
+int main(int argv, char *argc[]) {
+    return (UnitTest::RunAllTests());
+}
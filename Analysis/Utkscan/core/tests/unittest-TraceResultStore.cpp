@@ -0,0 +1,168 @@
+///@file unittest-TraceResultStore.cpp
+///@brief Program that will test the store of the trace results
+///@date October 19, 2026
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include <UnitTest++.h>
+
+#include "ChanEvent.hpp"
+#include "ChannelConfiguration.hpp"
+#include "TraceResultStore.hpp"
+
+using namespace std;
+
+///A configuration with an analyzer, a channel and its analyzed trace
+struct StoreFixture {
+    StoreFixture() {
+        doc.load_string("<Configuration><Global/><DetectorDriver><Analyzer name=\"WaveformAnalyzer\"/>"
+                                "<Processor name=\"VandleProcessor\"/></DetectorDriver></Configuration>");
+        configuration = doc.child("Configuration");
+
+        cfg.SetType("vandle");
+        cfg.SetSubtype("small");
+        cfg.SetBaselineThreshold(3.0);
+        cfg.SetCfdParameters(make_tuple(0.5, 1.0, 2.0));
+        cfg.SetDiscriminationStartInSamples(3);
+        cfg.SetEnergyFilterParameters(TrapFilterParameters(0.1, 0.1, 0));
+        cfg.SetTriggerFilterParameters(TrapFilterParameters(0.1, 0.1, 10));
+        cfg.SetFittingParameters(make_pair(0.3, 0.1));
+        cfg.SetModFreq(250);
+        cfg.SetTraceDelayInSamples(80);
+        cfg.SetWaveformBoundsInSamples(make_pair(5u, 10u));
+
+        channel.SetCrateNumber(0);
+        channel.SetSlotNumber(3);
+        channel.SetChannelNumber(5);
+        channel.SetEventTimeHigh(12);
+        channel.SetEventTimeLow(3456789);
+        unsigned int samples[] = {400, 401, 399, 900, 1500, 800, 450, 400};
+        channel.SetTrace(vector<unsigned int>(samples, samples + 8));
+
+        char dir[] = "/tmp/unittest-TraceResultStore-XXXXXX";
+        path = mkdtemp(dir);
+        node = doc.append_child("TraceResultStore");
+        node.append_attribute("path").set_value(path.c_str());
+        hashes.assign(channel.GetID() + 1, 0);
+        hashes[channel.GetID()] = TraceResultStore::HashParameters(cfg, configuration);
+    }
+
+    ~StoreFixture() {
+        remove((path + "/run_012.pld.trs").c_str());
+        remove(path.c_str());
+    }
+
+    ///Fills the results of the trace like the analyzers would
+    void Analyze(Trace &trace) {
+        trace.SetHasValidWaveformAnalysis(true);
+        trace.SetHasValidTimingAnalysis(true);
+        trace.SetPhase(0.3);
+        trace.SetQdc(2800);
+        trace.SetBaseline(make_pair(400.0, 1.0));
+        trace.SetMax(make_pair(4u, 1100.0));
+        trace.SetWaveformRange(make_pair(2u, 7u));
+        trace.SetTriggerFilter(vector<double>(8, 1.5));
+        vector<double> sansBaseline;
+        for (Trace::iterator it = trace.begin(); it != trace.end(); it++)
+            sansBaseline.push_back(*it - 400.0);
+        trace.SetTraceSansBaseline(sansBaseline);
+    }
+
+    ///Opens the store of the input file with the hashes of the fixture
+    TraceResultStore *Open(void) {
+        TraceResultStore *store = new TraceResultStore(node);
+        store->SetParameterHashes(hashes);
+        store->SetInputFile("/data/run_012.pld");
+        return store;
+    }
+
+    pugi::xml_document doc;
+    pugi::xml_node configuration;
+    pugi::xml_node node;
+    ChannelConfiguration cfg;
+    ChanEvent channel;
+    string path;
+    vector<uint64_t> hashes;
+};
+
+TEST_FIXTURE(StoreFixture, Test_HashParameters) {
+    uint64_t hash = TraceResultStore::HashParameters(cfg, configuration);
+    CHECK(hash != 0);
+    CHECK_EQUAL(hash, TraceResultStore::HashParameters(cfg, configuration));
+
+    //Changing the processors keeps the hash
+    configuration.child("DetectorDriver").remove_child("Processor");
+    CHECK_EQUAL(hash, TraceResultStore::HashParameters(cfg, configuration));
+
+    //Changing the analyzers or the parameters of the channel does not
+    configuration.child("DetectorDriver").child("Analyzer").append_attribute("ignored").set_value("vandle");
+    CHECK(hash != TraceResultStore::HashParameters(cfg, configuration));
+    configuration.child("DetectorDriver").child("Analyzer").remove_attribute("ignored");
+    cfg.SetCfdParameters(make_tuple(0.5, 2.0, 2.0));
+    CHECK(hash != TraceResultStore::HashParameters(cfg, configuration));
+}
+
+TEST_FIXTURE(StoreFixture, Test_RoundTrip) {
+    TraceResultStore *store = Open();
+    CHECK(!store->Load(channel, channel.GetTrace()));
+    Analyze(channel.GetTrace());
+    store->Save(channel, channel.GetTrace(), 1e-3);
+    CHECK_EQUAL(1u, store->GetNumMisses());
+    delete store;
+
+    ChanEvent read(channel);
+    unsigned int samples[] = {400, 401, 399, 900, 1500, 800, 450, 400};
+    read.SetTrace(vector<unsigned int>(samples, samples + 8));
+    store = Open();
+    CHECK(store->Load(read, read.GetTrace()));
+    CHECK_EQUAL(1u, store->GetNumHits());
+    CHECK(store->GetSecondsSaved() <= 1e-3);
+
+    const Trace &trace = read.GetTrace();
+    CHECK(trace.HasValidWaveformAnalysis());
+    CHECK(trace.HasValidTimingAnalysis());
+    CHECK_EQUAL(0.3, trace.GetPhase());
+    CHECK_EQUAL(2800, trace.GetQdc());
+    CHECK_EQUAL(1100.0, trace.GetMaxInfo().second);
+    CHECK_EQUAL(7u, trace.GetWaveformRange().second);
+    CHECK_EQUAL(8u, trace.GetTriggerFilter().size());
+    CHECK_EQUAL(8u, trace.GetTraceSansBaseline().size());
+    CHECK_EQUAL(1100.0, trace.GetTraceSansBaseline()[4]);
+
+    //Neither is the same channel of another crate at the same time
+    read.SetCrateNumber(1);
+    CHECK(!store->Load(read, read.GetTrace()));
+    read.SetCrateNumber(0);
+
+    //Another hit of the same channel is not in the store
+    read.SetEventTimeLow(3456790);
+    CHECK(!store->Load(read, read.GetTrace()));
+    delete store;
+}
+
+TEST_FIXTURE(StoreFixture, Test_StaleParameters) {
+    TraceResultStore *store = Open();
+    Analyze(channel.GetTrace());
+    store->Save(channel, channel.GetTrace(), 1e-3);
+    delete store;
+
+    //The results are analyzed again once the parameters changed
+    cfg.SetTraceDelayInSamples(100);
+    hashes[channel.GetID()] = TraceResultStore::HashParameters(cfg, configuration);
+    store = Open();
+    CHECK(!store->Load(channel, channel.GetTrace()));
+    channel.GetTrace().SetPhase(0.7);
+    store->Save(channel, channel.GetTrace(), 1e-3);
+    delete store;
+
+    store = Open();
+    CHECK(store->Load(channel, channel.GetTrace()));
+    CHECK_EQUAL(0.7, channel.GetTrace().GetPhase());
+    delete store;
+}
+
+int main(int argv, char *argc[]) {
+    return (UnitTest::RunAllTests());
+}
@@ -61,14 +61,17 @@ namespace dammIds {
 ///Class to handle DSSDs for Super heavy element experiments
 class Dssd4SHEProcessor : public EventProcessor {
 public:
-    /** Constructor taking arguments */
+    /** Constructor taking arguments, chainCapacity and chainTime are the
+     * capacity and correlation time (in seconds) of the SheCorrelator */
     Dssd4SHEProcessor(double frontBackTimeWindow,
                       double deltaEnergy,
                       double highEnergyCut,
                       double lowEnergyCut,
                       double fisisonEnergyCut,
                       int numFrontStrips,
-                      int numBackStrips);
+                      int numBackStrips,
+                      unsigned int chainCapacity = 64,
+                      double chainTime = 0);
 
     /** Declare plots */
     virtual void DeclarePlots();
@@ -79,6 +82,12 @@ public:
     /** Perform Process */
     virtual bool Process(RawEvent &event);
 
+    /** Save the chains of the correlator */
+    virtual void SaveState(StateWriter &writer) const { correlator_.save_state(writer); }
+
+    /** Load the chains of the correlator */
+    virtual void LoadState(StateReader &reader) { correlator_.load_state(reader); }
+
 protected:
     /** Picks what event type we had 
      * \return true if the event type was found(?) */
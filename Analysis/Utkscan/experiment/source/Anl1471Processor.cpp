@@ -111,6 +111,8 @@ Anl1471Processor::Anl1471Processor() : EventProcessor(OFFSET, RANGE,
     associatedTypes.insert("vandle");
     associatedTypes.insert("beta");
     associatedTypes.insert("ge");
+    AddDependency("VandleProcessor");
+    AddDependency("CloverProcessor");
 
     stringstream name;
     name << Globals::get()->GetOutputPath()
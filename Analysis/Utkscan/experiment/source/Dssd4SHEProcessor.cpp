@@ -28,9 +28,11 @@ Dssd4SHEProcessor::Dssd4SHEProcessor(double timeWindow,
                                      double lowEnergyCut,
                                      double fissionEnergyCut,
                                      int numBackStrips,
-                                     int numFrontStrips) :
+                                     int numFrontStrips,
+                                     unsigned int chainCapacity,
+                                     double chainTime) :
         EventProcessor(OFFSET, RANGE, "dssd4she"),
-        correlator_(numBackStrips, numFrontStrips) {
+        correlator_(numBackStrips, numFrontStrips, chainCapacity, chainTime) {
     timeWindow_ = timeWindow;
     deltaEnergy_ = deltaEnergy;
     highEnergyCut_ = highEnergyCut;
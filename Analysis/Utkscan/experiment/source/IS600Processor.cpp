@@ -66,6 +66,9 @@ IS600Processor::IS600Processor() : EventProcessor(OFFSET, RANGE,
     associatedTypes.insert("labr3");
     associatedTypes.insert("beta");
     associatedTypes.insert("ge");
+    AddDependency("VandleProcessor");
+    AddDependency("DoubleBetaProcessor");
+    AddDependency("CloverProcessor");
 
     stringstream name;
     name << Globals::get()->GetOutputPath()
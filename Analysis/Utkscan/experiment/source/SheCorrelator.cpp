@@ -5,6 +5,7 @@
  * and to correlate chains of alphas in dssd pixels
  */
 
+#include <algorithm>
 #include <ctime>
 #include <iomanip>
 #include <iostream>
@@ -13,49 +14,25 @@
 #include "SheCorrelator.hpp"
 #include "DetectorDriver.hpp"
 #include "Exceptions.hpp"
+#include "Globals.hpp"
+#include "Messenger.hpp"
 #include "Notebook.hpp"
 
 
 using namespace std;
 
-SheEvent::SheEvent() {
-    energy_ = -1.0;
-    time_ = -1.0;
-    mwpc_ = -1;
-    has_beam_ = false;
-    has_veto_ = false;
-    has_escape_ = false;
-    type_ = unknown;
-}
-
-SheEvent::SheEvent(double energy, double time, int mwpc,
-                   bool has_beam, bool has_veto, bool has_escape,
-                   SheEventType type /* = unknown*/) {
-    set_energy(energy);
-    set_time(time);
-    set_mwpc(mwpc);
-    set_beam(has_beam);
-    set_veto(has_veto);
-    set_escape(has_escape);
-    set_type(type);
-}
-
-
-SheCorrelator::SheCorrelator(int size_x, int size_y) {
-    size_x_ = size_x + 1;
-    size_y_ = size_y + 1;
-    pixels_ = new deque <SheEvent> *[size_x_];
-    for (int i = 0; i < size_x_; ++i)
-        pixels_[i] = new deque<SheEvent>[size_y_];
+SheCorrelator::SheCorrelator(int size_x, int size_y,
+                             unsigned int capacity /* = 64*/,
+                             double corrTime /* = 0*/) :
+        size_x_(size_x + 1), size_y_(size_y + 1),
+        pixels_(size_x + 1, size_y + 1, capacity,
+                corrTime / Globals::get()->GetFilterClockInSeconds()),
+        lostChains_(0) {
 }
 
 
 SheCorrelator::~SheCorrelator() {
-    for (int i = 0; i < size_y_; ++i) {
-        pixels_[i]->clear();
-        delete[] pixels_[i];
-    }
-    delete[] pixels_;
+    print_statistics(cout);
 }
 
 
@@ -75,7 +52,8 @@ bool SheCorrelator::add_event(SheEvent &event, int x, int y) {
     if (event.get_type() == heavyIon)
         flush_chain(x, y);
 
-    pixels_[x][y].push_back(event);
+    check_head(x, y, event.get_time());
+    pixels_.Add(x, y, event.get_time(), event);
 
     if (event.get_type() == fission)
         flush_chain(x, y);
@@ -84,15 +62,15 @@ bool SheCorrelator::add_event(SheEvent &event, int x, int y) {
 }
 
 bool SheCorrelator::flush_chain(int x, int y) {
-    unsigned chain_size = pixels_[x][y].size();
+    unsigned chain_size = pixels_.Size(x, y);
 
     /** If chain too short just clear it */
     if (chain_size < 2) {
-        pixels_[x][y].clear();
+        pixels_.Clear(x, y);
         return false;
     }
 
-    SheEvent first = pixels_[x][y].front();
+    SheEvent first = pixels_.At(x, y, 0);
 
     /** Conditions for interesing chain:
      *      * starts with heavy ion implantation
@@ -102,14 +80,14 @@ bool SheCorrelator::flush_chain(int x, int y) {
 
     /** If it doesn't start with hevayIon, clear and exit**/
     if (first.get_type() != heavyIon) {
-        pixels_[x][y].clear();
+        pixels_.Clear(x, y);
         return false;
     }
 
     /** If it is 2 elements long, check if the second is fission,
      *  if not - clear and exit**/
-    if (chain_size == 2 && pixels_[x][y].back().get_type() != fission) {
-        pixels_[x][y].clear();
+    if (chain_size == 2 && pixels_.At(x, y, chain_size - 1).get_type() != fission) {
+        pixels_.Clear(x, y);
         return false;
     }
 
@@ -121,17 +99,16 @@ bool SheCorrelator::flush_chain(int x, int y) {
     ss << humanTime << "\t X = " << x << " Y = " << y << endl;
 
     int alphas = 0;
-    for (deque<SheEvent>::iterator it = pixels_[x][y].begin();
-         it != pixels_[x][y].end();
-         ++it) {
-        if ((*it).get_type() == alpha) {
+    for (unsigned i = 0; i < chain_size; ++i) {
+        const SheEvent &event = pixels_.At(x, y, i);
+        if (event.get_type() == alpha) {
             alphas += 1;
         }
-        human_event_info((*it), ss, first.get_time());
+        human_event_info(event, ss, first.get_time());
         ss << endl;
     }
 
-    pixels_[x][y].clear();
+    pixels_.Clear(x, y);
 
     if (alphas >= 2) {
         Notebook::get()->report(ss.str());
@@ -140,8 +117,26 @@ bool SheCorrelator::flush_chain(int x, int y) {
     return true;
 }
 
+void SheCorrelator::check_head(int x, int y, double time) {
+    unsigned size = pixels_.Size(x, y);
+    if (size == 0 || pixels_.At(x, y, 0).get_type() != heavyIon)
+        return;
+
+    double newest = max(time, pixels_.GetTime(x, y, size - 1));
+    bool expires = pixels_.GetWindow() > 0 && pixels_.GetTime(x, y, 0) < newest - pixels_.GetWindow();
+    if (!expires && size < pixels_.GetCapacity())
+        return;
+
+    lostChains_++;
+    stringstream ss;
+    ss << "SheCorrelator : The chain at X = " << x << " Y = " << y << " lost its heavy ion, "
+       << (expires ? "it is older than the correlation time" : "the chain is full") << ".";
+    Messenger m;
+    m.warning(ss.str());
+}
+
 // Save event to file
-void SheCorrelator::human_event_info(SheEvent &event, stringstream &ss,
+void SheCorrelator::human_event_info(const SheEvent &event, stringstream &ss,
                                      double clockStart) {
     string humanType;
     switch (event.get_type()) {
@@ -73,6 +73,8 @@ TemplateExpProcessor::~TemplateExpProcessor() {
 void TemplateExpProcessor::SetAssociatedTypes(void) {
     associatedTypes.insert("template");
     associatedTypes.insert("clover");
+    AddDependency("TemplateProcessor");
+    AddDependency("CloverProcessor");
 }
 
 ///Sets up the name of the output ascii data file
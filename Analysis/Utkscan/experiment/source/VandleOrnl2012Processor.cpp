@@ -61,6 +61,8 @@ void VandleOrnl2012Processor::DeclarePlots(void) {
 VandleOrnl2012Processor::VandleOrnl2012Processor() :
         EventProcessor(OFFSET, RANGE, "VandleOrnl2012Processor") {
     associatedTypes.insert("vandle");
+    AddDependency("VandleProcessor");
+    AddDependency("CloverProcessor");
 
     stringstream name;
     name << Globals::get()->GetOutputPath()
@@ -9,6 +9,7 @@
 #include <utility>
 #include <cmath>
 
+#include "AddbackEngine.hpp"
 #include "EventProcessor.hpp"
 #include "PaassRootStruct.hpp"
 #include "RawEvent.hpp"
@@ -214,10 +215,10 @@ public:
     std::vector<ChanEvent *> GetGeEvents(void) { return (geEvents_); }
 
     /** Returns the events that were added to the addbackEvents_ */
-    std::vector<std::vector<AddBackEvent>> GetAddbackEvents(void) { return (addbackEvents_); }
+    const std::vector<std::vector<AddBackEvent>> &GetAddbackEvents(void) const { return (addbackEvents_); }
 
     /** Returns the events that were added to the tas_ */
-    std::vector<AddBackEvent> GetTasEvents(void) { return (tas_); }
+    const std::vector<AddBackEvent> &GetTasEvents(void) const { return (tas_); }
 
 protected:
     static const unsigned int chansPerClover = 4; /*!< number of channels per clover */
@@ -276,6 +277,17 @@ protected:
     /** tas vector for total energy absorbed, similar structure as addback
      * but there is only one "super-clover" (sum of all detectors)*/
     std::vector<AddBackEvent> tas_;
+
+    /** Sorts the good ge events in time, builds the sub events, sums the
+     * crystals of every clover and finds the coincidences. The times are in
+     * clock ticks. */
+    AddbackEngine addback_;
+
+    std::vector<AddbackEngine::Pair> pairs_; //!< The gamma-gamma pairs of the event
+    std::vector<double> hitDecayTime_; //!< The decay time of every hit of addback_
+    std::vector<double> hitBetaDt_; //!< The gamma-beta time of every hit of addback_
+    std::vector<double> clusterBetaDt_; //!< The gamma-beta time of every cluster of addback_
+    std::vector<ChanEvent *> lowByLocation_; //!< The low gain event of every location
 #ifdef GGATES
     std::vector< std::vector<LineGate> > gGates; //!< List of Gamma gates to use
 #endif
@@ -6,6 +6,7 @@
 #ifndef __DOUBLEBETAPROCESSOR_HPP__
 #define __DOUBLEBETAPROCESSOR_HPP__
 
+#include "BarBuilder.hpp"
 #include "BarDetector.hpp"
 #include "EventProcessor.hpp"
 #include "HighResTimingData.hpp"
@@ -32,8 +33,10 @@ public:
     * \return true if processing was successful */
     virtual bool Process(RawEvent &event);
 
-    /** \return The map of the bars that had high resolution timing */
-    BarMap GetBars(void) { return (bars_); }
+    /** \return The map of the bars that had high resolution timing, which is
+     * empty if there were no double beta channels in the current event since
+     * the bars refer to the channels of the event they were built in. */
+    const BarMap &GetBars(void) const;
 
     /** \return the map of the bars that had low resolution timing */
     std::map<unsigned int, std::pair<double, double> > GetLowResBars(void) {
@@ -41,6 +44,7 @@ public:
     }
 
 private:
+    BarBuilder builder_; //!< Builds the bars, reused between events
     BarMap bars_; //!< Map holding all the bars we found 
     std::map<unsigned int, std::pair<double, double> > lrtbars_; //!< map holding low res bars
     processor_struct::DOUBLEBETA DBstruc; //!<Root Struct
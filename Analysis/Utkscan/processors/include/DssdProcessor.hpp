@@ -6,6 +6,7 @@
 #ifndef __DSSDPROCESSOR_HPP_
 #define __DSSDPROCESSOR_HPP_
 
+#include "Correlator.hpp"
 #include "EventProcessor.hpp"
 
 class DetectorSummary;
@@ -20,10 +21,17 @@ public:
 
     virtual bool Process(RawEvent &event);
 
+    /** Saves the implants and decays of the correlator */
+    virtual void SaveState(StateWriter &writer) const { correlator_.SaveState(writer); }
+
+    /** Loads the implants and decays of the correlator */
+    virtual void LoadState(StateReader &reader) { correlator_.LoadState(reader); }
+
 private:
     DetectorSummary *frontSummary; ///< all detectors of type dssd_front
     DetectorSummary *backSummary;  ///< all detectors of type dssd_back
     static const double cutoffEnergy; ///< cutoff energy for implants versus decays
+    Correlator correlator_; ///< correlates the decays with the implants
 };
 
 #endif // __DSSDPOCESSOR_HPP_
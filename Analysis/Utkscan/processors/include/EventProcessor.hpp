@@ -21,6 +21,10 @@ class DetectorSummary;
 
 class RawEvent;
 
+class StateReader;
+
+class StateWriter;
+
 #ifdef useroot
 
 class TTree;
@@ -91,6 +95,33 @@ public:
         return (name);
     }
 
+    /** Get the processors whose results this processor uses. PreProcess and
+    * Process of this processor are only called after the respective calls of
+    * these processors have finished.
+    * \return The names of the processors this one depends on */
+    const std::set<std::string> &GetDependencies(void) const {
+        return (dependencies);
+    }
+
+    /** Declare that this processor uses the results of another processor
+    * \param [in] proc : the name of the processor this one depends on */
+    void AddDependency(const std::string &proc) {
+        dependencies.insert(proc);
+    }
+
+    /** Write the state that the processor keeps from one event to the next
+    * (correlations, counters, ...) for the checkpoints of the scan. The
+    * histograms are saved with the histogram file. By default nothing is
+    * written and, unless the processor called DeclareStateless, a warning
+    * says that the processor starts over when the scan is resumed.
+    * \param [in] writer : the archive of the state */
+    virtual void SaveState(StateWriter &writer) const;
+
+    /** Read the state written by SaveState. This is called after Init when
+    * the scan is resumed from a checkpoint.
+    * \param [in] reader : the archive of the state */
+    virtual void LoadState(StateReader &reader);
+
 #ifdef useroot
 
     /** This functions adds the branch to the tree that will be responsible
@@ -116,8 +147,10 @@ public:
 protected:
     std::string name; //!< Name of the Processor
     std::set<std::string> associatedTypes; //!< Set of associated types for Processor
+    std::set<std::string> dependencies; //!< Names of the Processors this one depends on
     bool initDone;//!< True if the initialization has finished
     bool didProcess;//!< True if the process finished
+    bool stateless;//!< True if nothing is kept from one event to the next
     std::map<std::string, const DetectorSummary *> sumMap; //!< Map of associated detector summary
 
     /** Plots class for given Processor, takes care of declaration
@@ -127,6 +160,10 @@ protected:
     /** tree event data container for ROOT output **/
     PixTreeEvent *pixie_tree_event_;
 
+    /** Declare that the processor keeps nothing from one event to the next,
+    * so that the checkpoints of the scan are complete without SaveState */
+    void DeclareStateless(void) { stateless = true; }
+
     /*! \brief Implementation of the plot command to interface with the DAMM
     * routines
     *
@@ -148,29 +185,34 @@ protected:
     * \param [in] dammId : The histogram number to define
     * \param [in] xSize : The range of the x-axis
     * \param [in] title : The title for the histogram
+    * \return a handle to the histogram
     */
-    virtual void DeclareHistogram1D(int dammId, int xSize, const char *title) {
+    virtual Histogram1D DeclareHistogram1D(int dammId, int xSize, const char *title) {
         if(Globals::get()->GetDammPlots()){
-            histo.DeclareHistogram1D(dammId, xSize, title);
+            return histo.DeclareHistogram1D(dammId, xSize, title);
         }
+        return Histogram1D();
     }
     /*! \brief Declares a 2D histogram calls the C++ wrapper for DAMM
     * \param [in] dammId : The histogram number to define
     * \param [in] xSize : The range of the x-axis
     * \param [in] ySize : The range of the y-axis
     * \param [in] title : The title of the histogram
+    * \return a handle to the histogram
     */
-    virtual void DeclareHistogram2D(int dammId, int xSize, int ySize,
-                                    const char *title) {
+    virtual Histogram2D DeclareHistogram2D(int dammId, int xSize, int ySize,
+                                           const char *title) {
         if(Globals::get()->GetDammPlots()){
-            histo.DeclareHistogram2D(dammId, xSize, ySize, title);
+            return histo.DeclareHistogram2D(dammId, xSize, ySize, title);
         }
+        return Histogram2D();
     }
 private:
     tms tmsBegin; //!< The beginning processor time
     double userTime;//!< The user time spent in the processor
     double systemTime;//!< The system time spent in the processor
     double clocksPerSecond;//!< The number of clock cycles per second
+    mutable bool warnedState;//!< True once the missing state was reported
 };
 
 #endif // __EVENTPROCESSOR_HPP_
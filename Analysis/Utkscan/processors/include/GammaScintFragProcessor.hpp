@@ -24,7 +24,6 @@
 #include <TH1.h>
 #include <TH2.h>
 #include <TTree.h>
-#include "GSaddback.hpp"
 #include "PaassRootStruct.hpp"
 #include "TROOT.h"
 #include "TSystem.h"
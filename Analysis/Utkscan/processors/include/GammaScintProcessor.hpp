@@ -11,6 +11,7 @@
 #include <sstream>
 #include <string>
 
+#include "AddbackEngine.hpp"
 #include "DammPlotIds.hpp"
 #include "EventProcessor.hpp"
 #include "Messenger.hpp"
@@ -28,7 +29,6 @@
 #include <TH1.h>
 #include <TH2.h>
 #include "PaassRootStruct.hpp"
-#include "GSaddback.hpp"
 
 #endif
 
@@ -108,33 +108,19 @@ private:
      */
     unsigned int ReturnOffset(const std::string &subtype);
 
-    /** Returns the addback parameters for known types
+    /** Returns the index of the addback of known types
      * \param [in] subtype : The known subtype to lookup
-     * \param [in] option : Parameter to lookup
-     * @return Returns (by reference ) parameter
+     * @return Returns the index in addback_, the size of addback_ for unknown types
      */
-    double GetAddbackPara(const std::string &subtype,const std::string &option);
-
-    /** Updates the Addback Reference time for known types
-     * \param [in] subtype : The subtype's whose RefTime needs updating
-     * \param [in] newRefTime : New Reference time
-     */
-    void SetAddbackRefTime(const std::string &subtype, const double &newRefTime);
-
-    /** Returns the addback struct for a specific type
-     * @param subtype
-     * @return Pointer to the GSAddback struct for the known subtypes
-     */
-    GSAddback* GetAddbackStruct(const std::string &subtype);
+    unsigned int AddbackIndex(const std::string &subtype);
 
     // Variable list
     std::set<std::string> typeList_ ;//!< list of requested types
     std::vector<ChanEvent *> GSEvents_; //!< Vector of GammaScint Events
 
-    /** The nested map structure is <subtype , < parameter , value > >.
-     *    Parameters are "thresh" , "subEvtWin", "refTime".
-     *    RefTimes and SubEvtWin need to be in seconds in the cfg but we convert to ticks for the running
-     */ std::map<std::string,std::map<std::string,double> > ParameterMap; //!<Map of addback parameters
+    /** The addback of the "nai", "smallhag" and "bighag" subtypes with their thresholds and sub event windows.
+     *    The SubEvtWin need to be in seconds in the cfg but we convert to ticks for the running
+     */ std::vector<AddbackEngine> addback_; //!< Addback of the known types, indexed by AddbackIndex
 
     bool hasTrigBeta_;//!<  has a Trigger (the GLobal Pixie Trigger; i.e. VANDLE's) Beta
     bool hasLowResBeta_; //!< has Event (Low Res) Beta
@@ -155,12 +141,6 @@ private:
     const int binDepth = 1; //!<With binDep 1 they dont add so much; (cloverProcessor uses 2, but the normal DeclareHis uses 1
 
 
-    //Vectors of Events for addback
-    GSAddback* LHaddBack_;//!<structure for Small HAGRiD addback 
-    GSAddback* NaddBack_;//!<structure for NaI addback
-    GSAddback* BHaddBack_;//!<structure for Big HAGRiD addback
-    GSAddback* FAILEDaddback_;//!< Numeric Limits vector for Failed GetAddbackStruct
-
     /** Most Beta (actual beta type) events are Multi 1
         but this allow for multiple beta decays in 1 pixie event (requires extreme rate)
         This is a vector of a pair of doubles The data is stored as <<Time,Energy>,...>
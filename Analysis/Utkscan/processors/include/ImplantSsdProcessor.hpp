@@ -26,6 +26,14 @@ public:
     * \param [in] event : the event to process
     * \return true if the processing was successful */
     bool Process(RawEvent &event);
+
+    /** Saves the correlator and the counters of the processor
+    * \param [in] writer : the archive of the state */
+    virtual void SaveState(StateWriter &writer) const;
+
+    /** Loads the correlator and the counters of the processor
+    * \param [in] reader : the archive of the state */
+    virtual void LoadState(StateReader &reader);
 private:
     static const double cutoffEnergy; ///< cutoff energy for implants versus decays
     static const double implantTof;   ///< minimum time-of-flight for an implant
@@ -37,6 +45,9 @@ private:
     unsigned int fastTracesWritten;//!< Number of fast traces written
     unsigned int highTracesWritten;//!< Number of high traces written
 
+    Correlator correlator_; //!< Correlates the decays with the implants
+    double prevVeto_; //!< Time of the last veto
+
     /** Sets the event type
      * \param [in] info : the event information to set
      * \return The event types that were set */
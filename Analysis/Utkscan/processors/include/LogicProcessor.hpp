@@ -34,6 +34,14 @@ public:
     * \return true if processing was successful */
     virtual bool Process(RawEvent &event);
 
+    /** Write the edges, levels and counts of the logic signals
+    * \param [in] writer : the archive of the state */
+    virtual void SaveState(StateWriter &writer) const;
+
+    /** Read the state written by SaveState
+    * \param [in] reader : the archive of the state */
+    virtual void LoadState(StateReader &reader);
+
     /** \return The logic status for a given location
      * \param [in] loc : the location to get the status from */
     virtual bool LogicStatus(size_t loc) const { return logicStatus.at(loc); };
@@ -73,6 +81,7 @@ protected:
 
     std::vector<unsigned long> stopCount;  //!< number of stops received
     std::vector<unsigned long> startCount; //!< number of starts received
+    double t0_; //!< time of the first logic signal, the origin of the event plots
 
 private:
     /** Basic Processing of the event
@@ -6,6 +6,7 @@
 #ifndef PAASS_MtasProcessor_H
 #define PAASS_MtasProcessor_H
 
+#include "AddbackEngine.hpp"
 #include "EventProcessor.hpp"
 #include "PaassRootStruct.hpp"
 #include "SegmentDetector.hpp"
@@ -57,6 +58,8 @@ class MtasProcessor : public EventProcessor {
 		std::string MTASMode;
 		
 		std::vector<MtasSegment> MtasSegVec;
+		std::vector<short> MtasSegMulti; //!< MTAS segment multiplicity "map"
+		AddbackEngine MtasRings; //!< sums the segments of the center, inner, middle and outer rings
 		double MTASTotal;
 		double MTASCenter;
 		double MTASInner;
@@ -17,6 +17,7 @@
 #include <set>
 #include <string>
 
+#include "BarBuilder.hpp"
 #include "BarDetector.hpp"
 #include "EventProcessor.hpp"
 #include "HighResTimingData.hpp"
@@ -63,8 +64,10 @@ public:
         return ((z0 / corRadius) * TOF);
     }
 
-    ///@return the map of the build VANDLE bars */
-    BarMap GetBars(void) { return bars_; }
+    ///@return the map of the build VANDLE bars, which is empty if there were no
+    /// VANDLE channels in the current event since the bars refer to the
+    /// channels of the event they were built in. */
+    const BarMap &GetBars(void) const;
 
     ///@return true if we requested small bars in the xml */
     bool GetHasSmall(void) { return requestedTypes_.find("small") != requestedTypes_.end(); }
@@ -93,6 +96,8 @@ private:
     ///@param [in] type : The type of bar that we are dealing with
     std::pair<unsigned int, unsigned int> ReturnOffset(const std::string &type);
 
+    BarBuilder barBuilder_;//!< Builds the VANDLE bars, reused between events
+    BarBuilder startBuilder_;//!< Builds the bar starts, reused between events
     BarMap bars_;//!< A map to hold all the bars
     TimingMap starts_;//!< A map to to hold all the starts
     BarMap barStarts_;//!< A map that holds all of the bar starts
@@ -23,6 +23,7 @@ static const double timeSpectraTimeResolution = 10.e-3;
 BetaScintProcessor::BetaScintProcessor(double gammaBetaLimit, double energyContraction) :
         EventProcessor(OFFSET, RANGE, "BetaScintProcessor") {
     associatedTypes.insert("beta_scint");
+    DeclareStateless();
     gammaBetaLimit_ = gammaBetaLimit;
     energyContraction_ = energyContraction;
 }
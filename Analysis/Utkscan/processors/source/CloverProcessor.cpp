@@ -68,7 +68,7 @@ CloverProcessor::CloverProcessor(double gammaThreshold, double lowRatio,
                          double cycle_gate1_min, double cycle_gate1_max,
                          double cycle_gate2_min, double cycle_gate2_max) :
         EventProcessor(OFFSET, RANGE, "CloverProcessor"),
-        leafToClover() {
+        leafToClover(), numClovers(0) {
     associatedTypes.insert("clover"); // associate with germanium detectors
 
     gammaThreshold_ = gammaThreshold;
@@ -218,10 +218,13 @@ void CloverProcessor::DeclarePlots(void) {
         m.done();
     }
 
-    for (unsigned i = 0; i < numClovers; ++i) {
-        vector<AddBackEvent> empty;
-        addbackEvents_.push_back(empty);
-    }
+    addbackEvents_.resize(numClovers);
+
+    addback_.SetNumberOfGroups(numClovers);
+    addback_.SetWindow(subEventWindow_ / Globals::get()->GetClockInSeconds());
+    addback_.SetThreshold(gammaThreshold_);
+    for (map<int, int>::const_iterator it = leafToClover.begin(); it != leafToClover.end(); it++)
+        addback_.SetGroup(it->first, it->second);
 
     DeclareHistogram1D(D_ENERGY, energyBins1, "Gamma singles");
     DeclareHistogram1D(D_ENERGY_MOVE, energyBins1,
@@ -396,13 +399,20 @@ bool CloverProcessor::PreProcess(RawEvent &event) {
         return false;
 
     geEvents_.clear();
-    for (unsigned i = 0; i < numClovers; ++i)
-        addbackEvents_[i].clear();
-    tas_.clear();
+    addback_.Clear();
 
     static const vector<ChanEvent *> &highEvents = event.GetSummary("clover:clover_high", true)->GetList();
     static const vector<ChanEvent *> &lowEvents = event.GetSummary("clover:clover_low", true)->GetList();
 
+    //The low gain events are looked up by their location
+    for (vector<ChanEvent *>::const_iterator itLow = lowEvents.begin(); itLow != lowEvents.end(); itLow++) {
+        unsigned int location = (*itLow)->GetChanID().GetLocation();
+        if (location >= lowByLocation_.size())
+            lowByLocation_.resize(location + 1, NULL);
+        if (!lowByLocation_[location])
+            lowByLocation_[location] = *itLow;
+    }
+
     /** Only the high gain events are going to be used. The events where
      * low/high gain mismatches, saturation or pileup is marked are rejected
      */
@@ -412,70 +422,46 @@ bool CloverProcessor::PreProcess(RawEvent &event) {
         if ((*itHigh)->IsSaturated() || (*itHigh)->IsPileup())
             continue;
 
-        vector<ChanEvent *>::const_iterator itLow = lowEvents.begin();
-        for (; itLow != lowEvents.end(); itLow++) {
-            if ((*itLow)->GetChanID().GetLocation() == location) {
-                break;
-            }
-        }
-        if (itLow != lowEvents.end()) {
-            double ratio = (*itHigh)->GetEnergy() / (*itLow)->GetEnergy();
+        if (location < lowByLocation_.size() && lowByLocation_[location]) {
+            double ratio = (*itHigh)->GetEnergy() / lowByLocation_[location]->GetEnergy();
             if (ratio < lowRatio_ || ratio > highRatio_)
                 continue;
         }
         geEvents_.push_back(*itHigh);
     }
 
-    // now we sort the germanium events according to their corrected time
-    sort(geEvents_.begin(), geEvents_.end());
+    for (vector<ChanEvent *>::const_iterator itLow = lowEvents.begin(); itLow != lowEvents.end(); itLow++)
+        lowByLocation_[(*itLow)->GetChanID().GetLocation()] = NULL;
 
-    /** Here the addback spectra is constructed.
-     *  addbackEvents_ is a vector for each clover
-     *  holding a vector of pairs <energy, time> (both double),
-     *  where each element is a one addback event for a given clover.
+    /** Here the addback spectra is constructed. The engine sorts the
+     *  germanium events above threshold in their walk corrected time, starts
+     *  a new sub event for all clovers and "tas" when the time to the
+     *  previous event is larger than the subevent window and sums the
+     *  crystals of every clover.
      * */
-
-    /** guarantee the first event will be greater than
-     * the subevent window delayed from reference
-     * We need the ref time to be in TICKS and subEvent to be in seconds
-     * (look at the dtime calculation)
-     */
-    double refTime = -2.0 * (subEventWindow_/Globals::get()->GetClockInSeconds());
-
-    for (vector<ChanEvent *>::iterator it = geEvents_.begin();
-         it != geEvents_.end(); it++) {
-        ChanEvent *chan = *it;
-        double energy = chan->GetCalibratedEnergy();
-        double time = chan->GetWalkCorrectedTime();
-        int clover = leafToClover[chan->GetChanID().GetLocation()];
-
-        /**
-        * Do not take into account events with too low energy
-        * (avoid summing of noise with real gammas)
-        */
-        if (energy < gammaThreshold_)
-            continue;
-
-        // entries in map are sorted by time
-        // if event time is outside of subEventWindow, we start new
-        //   events for all clovers and "tas"
-        double dtime =  abs(time - refTime) * Globals::get()->GetClockInSeconds();
-        if (dtime > subEventWindow_) {
-            for (unsigned i = 0; i < numClovers; ++i) {
-                addbackEvents_[i].push_back(AddBackEvent());
-                addbackEvents_[i].back().time = time* Globals::get()->GetClockInSeconds()*1.e9;
-            }
-            tas_.push_back(AddBackEvent());
+    for (unsigned int i = 0; i < geEvents_.size(); i++)
+        addback_.AddHit(geEvents_[i]->GetCalibratedEnergy(), geEvents_[i]->GetWalkCorrectedTime(),
+                        geEvents_[i]->GetChanID().GetLocation(), i);
+    addback_.Build();
+
+    /** addbackEvents_ is a vector for each clover holding one addback
+     *  event per sub event, the times are in ns. tas_ holds the sum of all
+     *  clovers with the times in clock ticks. The vectors keep their
+     *  capacity between events.
+     * */
+    double nsPerTick = Globals::get()->GetClockInSeconds() * 1.e9;
+    unsigned int nEvents = addback_.GetNumSubEvents();
+    tas_.resize(nEvents);
+    for (unsigned int det = 0; det < numClovers; ++det)
+        addbackEvents_[det].resize(nEvents);
+    for (unsigned int ev = 0; ev < nEvents; ev++) {
+        const AddbackEngine::Cluster &sum = addback_.GetSum(ev);
+        tas_[ev] = AddBackEvent(sum.energy, sum.time, sum.multiplicity, sum.firstTime);
+        for (unsigned int det = 0; det < numClovers; ++det) {
+            const AddbackEngine::Cluster &cluster = addback_.GetCluster(ev, det);
+            addbackEvents_[det][ev] = AddBackEvent(cluster.energy, cluster.time * nsPerTick, cluster.multiplicity,
+                                                   cluster.firstTime * nsPerTick);
         }
-        // Total addback energy
-        addbackEvents_[clover].back().energy += energy;
-        // We store latest time only
-        addbackEvents_[clover].back().time = time * Globals::get()->GetClockInSeconds()*1.e9;
-        addbackEvents_[clover].back().multiplicity += 1;
-        tas_.back().energy += energy;
-        tas_.back().time = time;
-        tas_.back().multiplicity += 1;
-        refTime = time;
     }
 
     return true;
@@ -564,19 +550,16 @@ bool CloverProcessor::Process(RawEvent &event) {
 
     plot(D_MULT, geEvents_.size());
 
-    // Note that geEvents_ vector holds only good events (matched
-    // low & high gain). See PreProcess
-      for (vector<ChanEvent *>::iterator it1 = geEvents_.begin();
-         it1 != geEvents_.end(); ++it1) {
-        ChanEvent *chan = *it1;
-
-        double gEnergy = chan->GetCalibratedEnergy();
-        if (gEnergy < gammaThreshold_)
-            continue;
-
-        double gTime = chan->GetWalkCorrectedTime();
+    // The hits of the addback engine are the good events (matched low &
+    // high gain, see PreProcess) above threshold sorted in time
+    const vector<AddbackEngine::Hit> &hits = addback_.GetHits();
+    hitDecayTime_.resize(hits.size());
+    hitBetaDt_.resize(hits.size());
+    for (unsigned int i = 0; i < hits.size(); i++) {
+        double gEnergy = hits[i].energy;
+        double gTime = hits[i].time;
         double decayTime = (gTime - cycleTime) * clockInSeconds;
-        int det = leafToClover[chan->GetChanID().GetLocation()];
+        int det = hits[i].group;
 
         plot(D_ENERGY, gEnergy);
         plot(D_ENERGY_CLOVERX + det, gEnergy);
@@ -628,142 +611,142 @@ bool CloverProcessor::Process(RawEvent &event) {
             }
         }
 
-        for (vector<ChanEvent *>::const_iterator it2 = it1 + 1;
-             it2 != geEvents_.end(); it2++) {
-            ChanEvent *chan2 = *it2;
-
-            double gEnergy2 = chan2->GetCalibratedEnergy();
-            int det2 = leafToClover[chan2->GetChanID().GetLocation()];
-            double gTime2 = chan2->GetWalkCorrectedTime();
+        hitDecayTime_[i] = decayTime;
+        hitBetaDt_[i] = gb_dtime;
+    }
 
-            if (gEnergy2 < gammaThreshold_)
-                continue;
+    // The gamma-gamma pairs in bulk, the first gamma is the earlier one
+    addback_.FindHitPairs(numeric_limits<double>::max(), pairs_);
+    for (vector<AddbackEngine::Pair>::const_iterator itPair = pairs_.begin();
+         itPair != pairs_.end(); ++itPair) {
+        double gEnergy = hits[itPair->first].energy;
+        double gEnergy2 = hits[itPair->second].energy;
+        int det = hits[itPair->first].group;
+        int det2 = hits[itPair->second].group;
+        double decayTime = hitDecayTime_[itPair->first];
+        double gb_dtime = hitBetaDt_[itPair->first];
+        double gg_dtime = itPair->dtime * clockInSeconds;
+
+        /** Plot timediff between events in the same clover
+         * to monitor addback subevent gates. */
+        if (det == det2) {
+            double plotResolution = clockInSeconds;
+            plot(DD_TDIFF__GAMMA_GAMMA_ENERGY,
+                 (int) (gg_dtime / plotResolution + 100),
+                 gEnergy);
+            plot(DD_TDIFF__GAMMA_GAMMA_ENERGY_SUM,
+                 (int) (gg_dtime / plotResolution + 100),
+                 gEnergy + gEnergy2);
+        }
 
-            double gg_dtime = (gTime2 - gTime) * clockInSeconds;
+        /*
+         * This condition removes coincidences within the same
+         * clover significantly reducing "cross-talk"
+         * but also reducing efficiency
+         * (by 20% approx)
+         */
+        if (det2 != det) {
+            symplot(DD_ENERGY, gEnergy, gEnergy2);
+
+            if (decayTime > cycle_gate1_min_ &&
+                decayTime < cycle_gate1_max_)
+                symplot(DD_ENERGY_CGATE1, gEnergy, gEnergy2);
+            if (decayTime > cycle_gate2_min_ &&
+                decayTime < cycle_gate2_max_)
+                symplot(DD_ENERGY_CGATE2, gEnergy, gEnergy2);
 
-            /** Plot timediff between events in the same clover
-             * to monitor addback subevent gates. */
-            if (det == det2) {
-                double plotResolution = clockInSeconds;
-                plot(DD_TDIFF__GAMMA_GAMMA_ENERGY,
-                     (int) (gg_dtime / plotResolution + 100),
-                     gEnergy);
-                plot(DD_TDIFF__GAMMA_GAMMA_ENERGY_SUM,
-                     (int) (gg_dtime / plotResolution + 100),
-                     gEnergy + gEnergy2);
-            }
-
-            /*
-             * This condition removes coincidences within the same
-             * clover significantly reducing "cross-talk"
-             * but also reducing efficiency
-             * (by 20% approx)
-             */
-            if (det2 != det) {
-                symplot(DD_ENERGY, gEnergy, gEnergy2);
-
-                if (decayTime > cycle_gate1_min_ &&
-                    decayTime < cycle_gate1_max_)
-                    symplot(DD_ENERGY_CGATE1, gEnergy, gEnergy2);
-                if (decayTime > cycle_gate2_min_ &&
-                    decayTime < cycle_gate2_max_)
-                    symplot(DD_ENERGY_CGATE2, gEnergy, gEnergy2);
-
-                if (hasBeta) {
-                    if (GoodGammaBeta(gb_dtime)) {
-                        symplot(betaGated::DD_ENERGY, gEnergy,
-                                gEnergy2);
-                        if (decayTime > cycle_gate1_min_ &&
-                            decayTime < cycle_gate1_max_)
-                            symplot(betaGated::DD_ENERGY_CGATE1,
-                                    gEnergy, gEnergy2);
-                        if (decayTime > cycle_gate2_min_ &&
-                            decayTime < cycle_gate2_max_)
-                            symplot(betaGated::DD_ENERGY_CGATE2,
-                                    gEnergy, gEnergy2);
-
-                    } else if (gb_dtime > gammaBetaLimit_) {
-                        symplot(betaGated::DD_ENERGY_BDELAYED,
+            if (hasBeta) {
+                if (GoodGammaBeta(gb_dtime)) {
+                    symplot(betaGated::DD_ENERGY, gEnergy,
+                            gEnergy2);
+                    if (decayTime > cycle_gate1_min_ &&
+                        decayTime < cycle_gate1_max_)
+                        symplot(betaGated::DD_ENERGY_CGATE1,
+                                gEnergy, gEnergy2);
+                    if (decayTime > cycle_gate2_min_ &&
+                        decayTime < cycle_gate2_max_)
+                        symplot(betaGated::DD_ENERGY_CGATE2,
                                 gEnergy, gEnergy2);
-                    }
+
+                } else if (gb_dtime > gammaBetaLimit_) {
+                    symplot(betaGated::DD_ENERGY_BDELAYED,
+                            gEnergy, gEnergy2);
                 }
+            }
 
-                if (abs(gg_dtime) < gammaGammaLimit_) {
-                    symplot(DD_ENERGY_PROMPT, gEnergy, gEnergy2);
-                    if (hasBeta && GoodGammaBeta(gb_dtime)) {
-                        symplot(betaGated::DD_ENERGY_PROMPT,
-                                gEnergy, gEnergy2);
-                    }
+            if (abs(gg_dtime) < gammaGammaLimit_) {
+                symplot(DD_ENERGY_PROMPT, gEnergy, gEnergy2);
+                if (hasBeta && GoodGammaBeta(gb_dtime)) {
+                    symplot(betaGated::DD_ENERGY_PROMPT,
+                            gEnergy, gEnergy2);
                 }
             }
+        }
 #ifdef GGATES
-            /**
-            * Gamma-gamma gate
-            */
-            unsigned ig = 0;
-            double e1 = min(gEnergy, gEnergy2);
-            double e2 = max(gEnergy, gEnergy2);
-            for (vector< vector<LineGate> >::iterator it_gate =
-                    gGates.begin();
-                    it_gate != gGates.end(); ++it_gate) {
-                if ((*it_gate).size() != 2)
-                    throw NotImplemented("Gamma gates of size different than 2 are not implemented");
-                if ((*it_gate)[0].IsWithin(e1) &&
-                    (*it_gate)[1].IsWithin(e2)) {
-
-                    double plotResolution = clockInSeconds;
-                    plot(DD_TDIFF__GATEX,
-                         (int)(gg_dtime / plotResolution + 100), ig);
+        /**
+        * Gamma-gamma gate
+        */
+        unsigned ig = 0;
+        double e1 = min(gEnergy, gEnergy2);
+        double e2 = max(gEnergy, gEnergy2);
+        for (vector< vector<LineGate> >::iterator it_gate =
+                gGates.begin();
+                it_gate != gGates.end(); ++it_gate) {
+            if ((*it_gate).size() != 2)
+                throw NotImplemented("Gamma gates of size different than 2 are not implemented");
+            if ((*it_gate)[0].IsWithin(e1) &&
+                (*it_gate)[1].IsWithin(e2)) {
+
+                double plotResolution = clockInSeconds;
+                plot(DD_TDIFF__GATEX,
+                     (int)(gg_dtime / plotResolution + 100), ig);
+                if (hasBeta && GoodGammaBeta(gb_dtime))
+                    plot(betaGated::DD_TDIFF__GATEX,
+                        (int)(gg_dtime / plotResolution + 100), ig);
+
+                /** Angular corelations:
+                 * 4 clover setup :
+                 *     |0|
+                 * |3|     |1|
+                 *     |2|
+                 *
+                 * bin 0 -> same clover (0 deg), 1 -> 90 deg, 2 -> 180 deg
+                 */
+                if (det == det2) {
+                    plot(DD_ANGLE__GATEX, 0, ig);
+                    if (hasBeta && GoodGammaBeta(gb_dtime))
+                        plot(betaGated::DD_ANGLE__GATEX, 0, ig);
+                } else if (det % 2 != det2 % 2) {
+                    plot(DD_ANGLE__GATEX, 1, ig);
+                    if (hasBeta && GoodGammaBeta(gb_dtime))
+                        plot(betaGated::DD_ANGLE__GATEX, 1, ig);
+                } else {
+                    plot(DD_ANGLE__GATEX, 2, ig);
+                    if (hasBeta && GoodGammaBeta(gb_dtime))
+                        plot(betaGated::DD_ANGLE__GATEX, 2, ig);
+                }
+
+                for (unsigned int i3 = itPair->second + 1;
+                        i3 < hits.size(); i3++) {
+                    double gEnergy3 = hits[i3].energy;
+                    plot(DD_ENERGY__GATEX, gEnergy3, ig);
                     if (hasBeta && GoodGammaBeta(gb_dtime))
-                        plot(betaGated::DD_TDIFF__GATEX,
-                            (int)(gg_dtime / plotResolution + 100), ig);
-
-                    /** Angular corelations:
-                     * 4 clover setup :
-                     *     |0|
-                     * |3|     |1|
-                     *     |2|
-                     *
-                     * bin 0 -> same clover (0 deg), 1 -> 90 deg, 2 -> 180 deg
-                     */
-                    if (det == det2) {
-                        plot(DD_ANGLE__GATEX, 0, ig);
-                        if (hasBeta && GoodGammaBeta(gb_dtime))
-                            plot(betaGated::DD_ANGLE__GATEX, 0, ig);
-                    } else if (det % 2 != det2 % 2) {
-                        plot(DD_ANGLE__GATEX, 1, ig);
-                        if (hasBeta && GoodGammaBeta(gb_dtime))
-                            plot(betaGated::DD_ANGLE__GATEX, 1, ig);
-                    } else {
-                        plot(DD_ANGLE__GATEX, 2, ig);
-                        if (hasBeta && GoodGammaBeta(gb_dtime))
-                            plot(betaGated::DD_ANGLE__GATEX, 2, ig);
-                    }
-
-                    for (vector<ChanEvent*>::const_iterator it3 = it2 + 1;
-                            it3 != geEvents_.end(); it3++) {
-                        double gEnergy3 = (*it3)->GetCalEnergy();
-                        if (gEnergy3 < gammaThreshold_)
-                            continue;
-                        plot(DD_ENERGY__GATEX, gEnergy3, ig);
-                        if (hasBeta && GoodGammaBeta(gb_dtime))
-                            plot(betaGated::DD_ENERGY__GATEX, gEnergy3, ig);
-                    }
+                        plot(betaGated::DD_ENERGY__GATEX, gEnergy3, ig);
                 }
-                ++ig;
             }
+            ++ig;
+        }
 #endif
-        } // iteration over other gammas
-    }
+    } // iteration over gamma-gamma pairs
 
-    // Vectors tas and addbackEvents should have the same size
-    unsigned nEvents = tas_.size();
+    unsigned nEvents = addback_.GetNumSubEvents();
 
     // Plot 'tas' spectra
     for (unsigned i = 0; i < nEvents; ++i) {
-        double gEnergy = tas_[i].energy;
-        double gTime = tas_[i].time;
-        double gMulti = tas_[i].multiplicity;
+        const AddbackEngine::Cluster &sum = addback_.GetSum(i);
+        double gEnergy = sum.energy;
+        double gTime = sum.time;
+        double gMulti = sum.multiplicity;
 
         if (gEnergy < gammaThreshold_)
             continue;
@@ -784,72 +767,75 @@ bool CloverProcessor::Process(RawEvent &event) {
         }
     }
 
-    // Plot addback spectra
-    for (unsigned int ev = 0; ev < nEvents; ev++) {
-        for (unsigned int det = 0; det < numClovers; ++det) {
-            double gEnergy = addbackEvents_[det][ev].energy;
-            if (gEnergy < gammaThreshold_)
-                continue;
+    // Plot addback spectra, the times of the clusters are in clock ticks
+    const vector<AddbackEngine::Cluster> &clusters = addback_.GetClusters();
+    clusterBetaDt_.resize(clusters.size());
+    for (unsigned int i = 0; i < clusters.size(); i++) {
+        unsigned int det = i % numClovers;
+        double gEnergy = clusters[i].energy;
+        clusterBetaDt_[i] = numeric_limits<double>::max();
+        if (gEnergy < gammaThreshold_)
+            continue;
 
-            double gTime = addbackEvents_[det][ev].time;
-            double gMulti = addbackEvents_[det][ev].multiplicity;
-            double decayTime = (gTime - cycleTime) * clockInSeconds;
+        double gTime = clusters[i].time;
+        double gMulti = clusters[i].multiplicity;
+        double decayTime = (gTime - cycleTime) * clockInSeconds;
 
-            plot(D_ADD_ENERGY, gEnergy);
-            plot(D_ADD_ENERGY_CLOVERX + det, gEnergy);
-            granploty(DD_ADD_ENERGY__TIMEX, gEnergy, decayTime, timeResolution);
-            if (gMulti == 1)
-                plot(multi::D_ADD_ENERGY, gEnergy);
+        plot(D_ADD_ENERGY, gEnergy);
+        plot(D_ADD_ENERGY_CLOVERX + det, gEnergy);
+        granploty(DD_ADD_ENERGY__TIMEX, gEnergy, decayTime, timeResolution);
+        if (gMulti == 1)
+            plot(multi::D_ADD_ENERGY, gEnergy);
 
-            double gb_dtime = numeric_limits<double>::max();
-            if (hasBeta) {
-                EventData bestBeta = BestBetaForGamma(gTime);
-                gb_dtime = (gTime - bestBeta.time) * clockInSeconds;
+        if (hasBeta) {
+            EventData bestBeta = BestBetaForGamma(gTime);
+            double gb_dtime = (gTime - bestBeta.time) * clockInSeconds;
+            clusterBetaDt_[i] = gb_dtime;
 
-                plot(betaGated::D_ADD_ENERGY, gEnergy);
+            plot(betaGated::D_ADD_ENERGY, gEnergy);
+            if (gMulti == 1)
+                plot(multi::betaGated::D_ADD_ENERGY, gEnergy);
+            plot(betaGated::D_ADD_ENERGY_CLOVERX + det, gEnergy);
+            if (GoodGammaBeta(gb_dtime)) {
+                plot(betaGated::D_ADD_ENERGY_PROMPT, gEnergy);
                 if (gMulti == 1)
-                    plot(multi::betaGated::D_ADD_ENERGY, gEnergy);
-                plot(betaGated::D_ADD_ENERGY_CLOVERX + det, gEnergy);
-                if (GoodGammaBeta(gb_dtime)) {
-                    plot(betaGated::D_ADD_ENERGY_PROMPT, gEnergy);
-                    if (gMulti == 1)
-                        plot(multi::betaGated::D_ADD_ENERGY_PROMPT, gEnergy);
-                    granploty(betaGated::DD_ADD_ENERGY__TIMEX, gEnergy,
-                              decayTime, timeResolution);
-                }
+                    plot(multi::betaGated::D_ADD_ENERGY_PROMPT, gEnergy);
+                granploty(betaGated::DD_ADD_ENERGY__TIMEX, gEnergy,
+                          decayTime, timeResolution);
             }
+        }
+    }
 
-            for (unsigned int det2 = det + 1;
-                 det2 < numClovers; ++det2) {
-                double gEnergy2 = addbackEvents_[det2][ev].energy;
-                if (gEnergy2 < gammaThreshold_)
-                    continue;
+    // Addback gamma-gamma pairs of different clovers in the same sub event
+    addback_.FindClusterPairs(gammaGammaLimit_ / clockInSeconds, pairs_);
+    for (vector<AddbackEngine::Pair>::const_iterator itPair = pairs_.begin();
+         itPair != pairs_.end(); ++itPair) {
+        double gEnergy = clusters[itPair->first].energy;
+        double gEnergy2 = clusters[itPair->second].energy;
+        if (gEnergy < gammaThreshold_ || gEnergy2 < gammaThreshold_)
+            continue;
 
-                double gTime2 = addbackEvents_[det2][ev].time;
-                double gMulti2 = addbackEvents_[det2][ev].multiplicity;
-                double gg_dtime = (gTime2 - gTime) * clockInSeconds;
-                if (abs(gg_dtime) > gammaGammaLimit_)
-                    continue;
+        double gMulti = clusters[itPair->first].multiplicity;
+        double gMulti2 = clusters[itPair->second].multiplicity;
+        double gb_dtime = clusterBetaDt_[itPair->first];
 
-                symplot(DD_ADD_ENERGY, gEnergy, gEnergy2);
+        symplot(DD_ADD_ENERGY, gEnergy, gEnergy2);
+        if (gMulti == 1 && gMulti2 == 1)
+            symplot(multi::DD_ADD_ENERGY, gEnergy, gEnergy2);
+        if (hasBeta) {
+            symplot(betaGated::DD_ADD_ENERGY, gEnergy, gEnergy2);
+            if (gMulti == 1 && gMulti2 == 1)
+                symplot(multi::betaGated::DD_ADD_ENERGY,
+                        gEnergy, gEnergy2);
+            if (GoodGammaBeta(gb_dtime)) {
+                symplot(betaGated::DD_ADD_ENERGY_PROMPT,
+                        gEnergy, gEnergy2);
                 if (gMulti == 1 && gMulti2 == 1)
-                    symplot(multi::DD_ADD_ENERGY, gEnergy, gEnergy2);
-                if (hasBeta) {
-                    symplot(betaGated::DD_ADD_ENERGY, gEnergy, gEnergy2);
-                    if (gMulti == 1 && gMulti2 == 1)
-                        symplot(multi::betaGated::DD_ADD_ENERGY,
-                                gEnergy, gEnergy2);
-                    if (GoodGammaBeta(gb_dtime)) {
-                        symplot(betaGated::DD_ADD_ENERGY_PROMPT,
-                                gEnergy, gEnergy2);
-                        if (gMulti == 1 && gMulti2 == 1)
-                            symplot(multi::betaGated::DD_ADD_ENERGY_PROMPT,
-                                    gEnergy, gEnergy2);
-                    }
-                }
-            } // iteration over other clovers
-        } // itertaion over clovers
-    } // iteration over events
+                    symplot(multi::betaGated::DD_ADD_ENERGY_PROMPT,
+                            gEnergy, gEnergy2);
+            }
+        }
+    } // iteration over addback pairs
 
     EndProcess(); // update the processing time
     return true;
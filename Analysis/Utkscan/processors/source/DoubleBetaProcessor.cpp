@@ -30,6 +30,7 @@ using namespace dammIds::doublebeta;
 DoubleBetaProcessor::DoubleBetaProcessor() :
         EventProcessor(OFFSET, RANGE, "DoubleBetaProcessor") {
     associatedTypes.insert("beta");
+    DeclareStateless();
 }
 
 void DoubleBetaProcessor::DeclarePlots(void) {
@@ -40,6 +41,11 @@ void DoubleBetaProcessor::DeclarePlots(void) {
     DeclareHistogram2D(DD_BETAMAXXVAL,SD,S3,"Max Value in the Trace");
 }
 
+const BarMap &DoubleBetaProcessor::GetBars(void) const {
+    static const BarMap empty;
+    return HasEvent() ? bars_ : empty;
+}
+
 bool DoubleBetaProcessor::PreProcess(RawEvent &event) {
     if (!EventProcessor::PreProcess(event))
         return (false);
@@ -50,11 +56,11 @@ bool DoubleBetaProcessor::PreProcess(RawEvent &event) {
     static const vector<ChanEvent *> &events =
             event.GetSummary("beta:double")->GetList();
 
-    BarBuilder builder(events);
-    builder.BuildBars();
+    builder_.SetChannelList(events);
+    builder_.BuildBars();
 
-    lrtbars_ = builder.GetLrtBarMap();
-    bars_ = builder.GetBarMap();
+    lrtbars_ = builder_.GetLrtBarMap();
+    bars_ = builder_.GetBarMap();
 
     double resolution = 2;
     double offset = 1500;
@@ -63,8 +63,6 @@ bool DssdProcessor::Process(RawEvent &event) {
     if (!EventProcessor::Process(event))
         return false;
 
-    static Correlator corr;
-
     //some kind of magic number that correlates to some kind of useful value.
     static double cutoffEnergy = 4800;
 
@@ -113,7 +111,7 @@ bool DssdProcessor::Process(RawEvent &event) {
         } else {
             corEvent.type = EventInfo::UNKNOWN_EVENT;
         }
-        corr.Correlate(corEvent, frontPos, backPos);
+        correlator_.Correlate(corEvent, frontPos, backPos);
     } else if (hasFront) {
         if (frontEnergy > cutoffEnergy) {
             corEvent.type = EventInfo::IMPLANT_EVENT;
@@ -140,13 +138,13 @@ bool DssdProcessor::Process(RawEvent &event) {
             plot(DD_DECAY_BACK_ENERGY__POSITION, backEnergy, backPos);
         if (hasFront && hasBack)
             plot(DD_DECAY_POSITION, backPos, frontPos);
-        if (corr.GetCondition() == Correlator::VALID_DECAY) {
+        if (correlator_.GetCondition() == Correlator::VALID_DECAY) {
             const unsigned int NumGranularities = 8;
             // time resolution in seconds per bin
             const double timeResolution[NumGranularities] = {10e-9, 100e-9, 400e-9, 1e-6, 100e-6, 1e-3, 10e-3, 100e-3};
 
             for (unsigned int i = 0; i < NumGranularities; i++) {
-                int timeBin = int(corr.GetDecayTime() * Globals::get()->GetFilterClockInSeconds() / timeResolution[i]);
+                int timeBin = int(correlator_.GetDecayTime() * Globals::get()->GetFilterClockInSeconds() / timeResolution[i]);
 
                 plot(DD_ENERGY__DECAY_TIME_GRANX + i, frontEnergy, timeBin);
             }
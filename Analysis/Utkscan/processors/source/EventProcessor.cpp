@@ -23,15 +23,15 @@
 using namespace std;
 
 EventProcessor::EventProcessor() :
-        name("generic"), initDone(false), didProcess(false),
+        name("generic"), initDone(false), didProcess(false), stateless(false),
         histo(0, 0, "generic"),
-        userTime(0.), systemTime(0.) {
+        userTime(0.), systemTime(0.), warnedState(false) {
     clocksPerSecond = sysconf(_SC_CLK_TCK);
 }
 
 EventProcessor::EventProcessor(int offset, int range, std::string proc_name) :
-        name(proc_name), initDone(false), didProcess(false),
-        histo(offset, range, proc_name), userTime(0.), systemTime(0.) {
+        name(proc_name), initDone(false), didProcess(false), stateless(false),
+        histo(offset, range, proc_name), userTime(0.), systemTime(0.), warnedState(false) {
     clocksPerSecond = sysconf(_SC_CLK_TCK);
 }
 
@@ -108,3 +108,19 @@ void EventProcessor::EndProcess(void) {
 }
 
 
+
+void EventProcessor::SaveState(StateWriter &writer) const {
+    if (stateless || warnedState)
+        return;
+    warnedState = true;
+    Messenger m;
+    m.warning(name + " does not save its state in the checkpoints, what it keeps between events starts over "
+                     "when the scan is resumed.");
+}
+
+void EventProcessor::LoadState(StateReader &reader) {
+    if (stateless)
+        return;
+    Messenger m;
+    m.warning(name + " starts over, its state was not saved in the checkpoint.");
+}
@@ -44,6 +44,10 @@ namespace dammIds {
 using namespace std;
 using namespace dammIds::gscint;
 
+namespace {
+    const string ADDBACK_TYPES[] = {"nai", "smallhag", "bighag"}; //!< The subtypes that are added back, see addback_
+}
+
 GammaScintProcessor::~GammaScintProcessor()=default;
 
 void GammaScintProcessor::DeclarePlots() {
@@ -124,6 +128,7 @@ GammaScintProcessor::GammaScintProcessor(const std::map<std::string,std::string>
 
     Theader = GSArgs;
     associatedTypes.insert("gscint");
+    AddDependency("DoubleBetaProcessor");
 
     ISOL_=false;
     FacilType_ = GSArgs.find("FacilityType")->second;
@@ -162,11 +167,7 @@ GammaScintProcessor::GammaScintProcessor(const std::map<std::string,std::string>
     MRBetaWindow_.first=strtod(MRBetaWindow_.second.c_str(), nullptr)*Globals::get()->GetClockInSeconds() *1.e9;
 
     //Loads addback thresholds and Sub Event Windows (parsed in DetectorDriverXmlParser, with defaults)
-    // initializing  Addback Parameter maps
-    // map structure <subtype , <parameter , value > >
-    // Parameters are "thresh" , "subEvtWin", "refTime".
-    // ref times need to be in ns because the Gtime is in ns
-
+    // The sub event windows need to be in ticks because the addback uses GetTimeSansCfd
     double NgammaThreshold_ =  strtod(GSArgs.find("NaI_Thresh")->second.c_str(), nullptr);
     double NsubEventWin_ =  strtod(GSArgs.find("NaI_SubWin")->second.c_str(), nullptr)/(Globals::get()->GetClockInSeconds());
     double LHgammaThreshold_ =  strtod(GSArgs.find("LH_Thresh")->second.c_str(), nullptr);
@@ -174,33 +175,10 @@ GammaScintProcessor::GammaScintProcessor(const std::map<std::string,std::string>
     double BHgammaThreshold_ =  strtod(GSArgs.find("BH_Thresh")->second.c_str(), nullptr);
     double BHsubEventWin_ =  strtod(GSArgs.find("BH_SubWin")->second.c_str(), nullptr)/(Globals::get()->GetClockInSeconds());
 
-    std::map <std::string,double > paraData ;
-    paraData.insert(make_pair("thresh",NgammaThreshold_));
-    paraData.insert(make_pair("subEvtWin",NsubEventWin_));
-    paraData.insert(make_pair("refTime",-2.0*NsubEventWin_));
-    ParameterMap.emplace("nai",paraData);
-    paraData.clear();
-
-    paraData.insert(make_pair("thresh",LHgammaThreshold_));
-    paraData.insert(make_pair("subEvtWin",LHsubEventWin_));
-    paraData.insert(make_pair("refTime",-2.0*LHsubEventWin_));
-    ParameterMap.emplace("smallhag",paraData);
-    paraData.clear();
-
-    paraData.insert(make_pair("thresh",BHgammaThreshold_));
-    paraData.insert(make_pair("subEvtWin",BHsubEventWin_));
-    paraData.insert(make_pair("refTime",-2.0*BHsubEventWin_));
-    ParameterMap.emplace("bighag",paraData);
-    paraData.clear();
-
-    // initalize addback event structs
-    LHaddBack_ = new GSAddback(0.,0.,0.,0);
-    NaddBack_ = new GSAddback(0.,0.,0.,0);
-    BHaddBack_ = new GSAddback(0.,0.,0.,0);
-    FAILEDaddback_ = new GSAddback(numeric_limits<double>::max(),numeric_limits<double>::max(),
-                                   numeric_limits<double>::max(),numeric_limits<unsigned>::max());
-
-
+    // One addback group per subtype, in the order of ADDBACK_TYPES
+    addback_.emplace_back(AddbackEngine(1, NsubEventWin_, NgammaThreshold_));
+    addback_.emplace_back(AddbackEngine(1, LHsubEventWin_, LHgammaThreshold_));
+    addback_.emplace_back(AddbackEngine(1, BHsubEventWin_, BHgammaThreshold_));
 }
 
 bool GammaScintProcessor::PreProcess(RawEvent &event) {
@@ -359,40 +337,23 @@ bool GammaScintProcessor::Process(RawEvent &event) {
             //on a vector<> and then reset the structure. and we will at the end or Process()
         } //end sysroot_
 
-       //Starting Rough (TypeWide) Addback
-    // (TYPEWIDE ADDBACK MUST BE THE LAST THING IN THE FOR LOOP due to the energy check below)
-
-    if (Genergy < (GetAddbackPara(subType, "thresh")) || ((*it)->GetChanID().HasTag("dy")) ) { ;
-        continue;
-    }
-    //double abTdiff = abs(Gtime - (GetAddbackPara(subType, "refTime")));
-    double abTdiff = abs((*it)->GetTimeSansCfd()-GetAddbackPara(subType,"refTime"));
-
-    if (abTdiff > (GetAddbackPara(subType, "subEvtWin"))) {
-        //if we are outside of the sub event window for a given subtype
-        // then fill the tree then zero the correct struc.
+        //Starting Rough (TypeWide) Addback, the dynodes are not added back
+        unsigned int addbackIndex = AddbackIndex(subType);
+        if (addbackIndex < addback_.size() && !(*it)->GetChanID().HasTag("dy"))
+            addback_[addbackIndex].AddHit(Genergy, (*it)->GetTimeSansCfd(), 0);
+    } //End GSEvents for loop
 
-        plot(D_ENERGY + subTypeOffset + ADDBACKOFFSET, GetAddbackStruct(subType)->energy);
-        if (hasLowResBeta_) {
-            plot(D_BGENERGY + subTypeOffset + ADDBACKOFFSET, GetAddbackStruct(subType)->energy);
+    //The addback events are closed at the end of the pixie event
+    for (unsigned int i = 0; i < addback_.size(); i++) {
+        addback_[i].Build();
+        unsigned int subTypeOffset = ReturnOffset(ADDBACK_TYPES[i]);
+        for (unsigned int ev = 0; ev < addback_[i].GetNumSubEvents(); ev++) {
+            plot(D_ENERGY + subTypeOffset + ADDBACKOFFSET, addback_[i].GetSum(ev).energy);
+            if (hasLowResBeta_)
+                plot(D_BGENERGY + subTypeOffset + ADDBACKOFFSET, addback_[i].GetSum(ev).energy);
         }
-        //reset the correct addback struct to 0s
-        (*GetAddbackStruct(subType)) = GSAddback(0.,0.,0.,0);
-
-
+        addback_[i].Clear();
     }
-    if (GetAddbackStruct(subType)->multiplicity == 0) {
-        //only count as "beta gated" if the first addback event has a beta. (a catch incase the addback event
-            //crosses pixie events, which it shouldn't because process is closed at an event boundary )
-        GetAddbackStruct(subType)->ftime = (*it)->GetTimeSansCfd();
-    }
-        //Gets last entry in the addback vector for the correct subtype, and increments it with the current values
-        GetAddbackStruct(subType)->energy += (*it)->GetCalibratedEnergy();
-        GetAddbackStruct(subType)->time = (*it)->GetTimeSansCfd();
-        GetAddbackStruct(subType)->multiplicity += 1;
-
-        SetAddbackRefTime(subType, (*it)->GetTimeSansCfd());
-    } //End GSEvents for loop
 
     //now that we have processed every det event in the Pixie Event list. We wait for the DD to ask for the vector
     //the vector is cleared at the beginning of Process() so we dont need to do it here.
@@ -413,49 +374,11 @@ unsigned int GammaScintProcessor::ReturnOffset(const std::string &subtype) {
     return (numeric_limits<unsigned int>::max());
 }
 
-void GammaScintProcessor::SetAddbackRefTime(const std::string &subtype, const double &newRefTime) {
-    auto ito = ParameterMap.find(subtype);
-    if (ito == ParameterMap.end()) {
-        stringstream ss;
-        ss<<"Error in looking up Addback Parameters for "<<subtype <<" (Unknown Type)";
-        throw GeneralException(ss.str());
-    }else{
-        auto iti = ito->second.find("refTime");
-        if (iti == ParameterMap.find(subtype)->second.end()) {
-            stringstream ss;
-            ss << "Error in looking up Addback Reference Time for " << subtype << " (Unknown Parameter)";
-            throw GeneralException(ss.str());
-        }
-        iti->second = newRefTime;
-    }
-}
-
-double GammaScintProcessor::GetAddbackPara(const std::string &subtype, const std::string &option) {
-    auto ito = ParameterMap.find(subtype);
-    if (ito == ParameterMap.end()) {
-        stringstream ss;
-        ss<<"Error in looking up Addback Parameters for "<<subtype <<" (Unknown Type)";
-        throw GeneralException(ss.str());
-    }else {
-        auto iti = ito->second.find(option);
-        if (iti == ito->second.end()) {
-            stringstream ss;
-            ss << "Error in looking up Addback Parameter for " << subtype << " (Unknown Parameter)";
-            throw GeneralException(ss.str());
-        }
-        return iti->second;
-    }
-}
-
-GSAddback* GammaScintProcessor::GetAddbackStruct(const std::string &subtype) {
-    if (subtype == "nai")
-        return (NaddBack_);
-    else if (subtype == "bighag")
-        return (BHaddBack_);
-    else if (subtype == "smallhag")
-        return (LHaddBack_);
-    else
-        return (FAILEDaddback_);
+unsigned int GammaScintProcessor::AddbackIndex(const std::string &subtype) {
+    for (unsigned int i = 0; i < addback_.size(); i++)
+        if (subtype == ADDBACK_TYPES[i])
+            return (i);
+    return (addback_.size());
 }
 
 /**
@@ -31,6 +31,7 @@ using namespace dammIds::ge;
 
 GeProcessor::GeProcessor() : EventProcessor(OFFSET, RANGE, "GeProcessor") {
     associatedTypes.insert("ge");  // associate with germanium detectors
+    DeclareStateless();
 }
 
 void GeProcessor::DeclarePlots(void) {
@@ -60,8 +60,10 @@ namespace dammIds {
 }
 
 ImplantSsdProcessor::ImplantSsdProcessor() :
-        EventProcessor(OFFSET, RANGE, "ImplantSsdProcessor") {
+        EventProcessor(OFFSET, RANGE, "ImplantSsdProcessor"), fastTracesWritten(0), highTracesWritten(0),
+        prevVeto_(0) {
     associatedTypes.insert("ssd");
+    AddDependency("LogicProcessor");
 }
 
 void ImplantSsdProcessor::DeclarePlots(void) {
@@ -157,7 +159,6 @@ bool ImplantSsdProcessor::Process(RawEvent &event) {
     static bool firstTime = true;
     static LogicProcessor *logProc = NULL;
 
-    static Correlator corr;
     static const DetectorSummary *tacSummary = event.GetSummary("generic:tac", true);
     static DetectorSummary *impSummary = event.GetSummary("ssd:sum", true);
     static const DetectorSummary *mcpSummary = event.GetSummary("logic:mcp", true);
@@ -284,7 +285,7 @@ bool ImplantSsdProcessor::Process(RawEvent &event) {
     }
 
     SetType(info);
-    Correlate(corr, info, location);
+    Correlate(correlator_, info, location);
 
     // TOF spectra update
     if (tacSummary) {
@@ -331,12 +332,12 @@ bool ImplantSsdProcessor::Process(RawEvent &event) {
         //info.time = trigTime + trace.GetValue("filterTime2") - trace.GetValue("filterTime");
 
         SetType(info);
-        Correlate(corr, info, location);
+        Correlate(correlator_, info, location);
 
         int numPulses = trace.GetTriggerPositions().size();
 
         if (numPulses > 2) {
-            corr.Flag(location, 1);
+            correlator_.Flag(location, 1);
             cout << "Flagging triple event" << endl;
             for (int i = 3; i <= numPulses; i++) {
                 stringstream str;
@@ -347,7 +348,7 @@ bool ImplantSsdProcessor::Process(RawEvent &event) {
                 //info.time = trigTime + trace.GetValue(str.str()) - trace.GetValue("filterTime");
 
                 SetType(info);
-                Correlate(corr, info, location);
+                Correlate(correlator_, info, location);
             }
         }
         // corr.Flag(location, 1);
@@ -367,7 +368,7 @@ bool ImplantSsdProcessor::Process(RawEvent &event) {
     }
 
     if (info.energy > 10000 && !ch->IsSaturated() && !std::isnan(info.position)) {
-        corr.Flag(location, info.position);
+        correlator_.Flag(location, info.position);
     }
 
     if (info.energy > 8000 && !trace.empty()) {
@@ -390,6 +391,20 @@ bool ImplantSsdProcessor::Process(RawEvent &event) {
     return true;
 }
 
+void ImplantSsdProcessor::SaveState(StateWriter &writer) const {
+    writer.Write(fastTracesWritten);
+    writer.Write(highTracesWritten);
+    writer.Write(prevVeto_);
+    correlator_.SaveState(writer);
+}
+
+void ImplantSsdProcessor::LoadState(StateReader &reader) {
+    reader.Read(fastTracesWritten);
+    reader.Read(highTracesWritten);
+    reader.Read(prevVeto_);
+    correlator_.LoadState(reader);
+}
+
 EventInfo::EEventTypes ImplantSsdProcessor::SetType(EventInfo &info) const {
     if (info.hasVeto) {
         return (info.type = EventInfo::PROTON_EVENT);
@@ -447,8 +462,6 @@ void ImplantSsdProcessor::PlotType(EventInfo &info, int loc,
 
     double clockInSeconds = Globals::get()->GetFilterClockInSeconds();
 
-    static double prevVeto = 0;
-
     plot(DD_ALL_ENERGY__LOCATION, info.energy, loc);
 
     switch (info.type) {
@@ -485,11 +498,11 @@ void ImplantSsdProcessor::PlotType(EventInfo &info, int loc,
         case EventInfo::PROTON_EVENT:
             plot(DD_ENERGY__LOCATION_VETO, info.energy, loc);
             for (unsigned int i = 0; i < numGranularities; i++) {
-                double dt = info.time - prevVeto; // time to previous veto
+                double dt = info.time - prevVeto_; // time to previous veto
                 int timeBin = int(dt * clockInSeconds / timeResolution[i]);
                 plot(DD_VETO_ENERGY__TX + i, info.energy, timeBin);
             }
-            prevVeto = info.time;
+            prevVeto_ = info.time;
             break;
         case EventInfo::UNKNOWN_EVENT:
         default:
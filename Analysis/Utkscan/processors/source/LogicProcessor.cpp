@@ -11,9 +11,11 @@
 #include <vector>
 
 #include "DammPlotIds.hpp"
+#include "Exceptions.hpp"
 #include "Globals.hpp"
 #include "RawEvent.hpp"
 #include "LogicProcessor.hpp"
+#include "StateArchive.hpp"
 
 using namespace std;
 using namespace dammIds::logic;
@@ -61,7 +63,7 @@ namespace dammIds {
 
 LogicProcessor::LogicProcessor(void) : EventProcessor(dammIds::logic::OFFSET, dammIds::logic::RANGE, "LogicProcessor"),
         lastStartTime(MAX_LOGIC, NAN), lastStopTime(MAX_LOGIC, NAN), logicStatus(MAX_LOGIC), stopCount(MAX_LOGIC),
-                                       startCount(MAX_LOGIC) {
+                                       startCount(MAX_LOGIC), t0_(NAN) {
     associatedTypes.insert("logic");
     associatedTypes.insert("timeclass"); // old detector type
     associatedTypes.insert("mtc");
@@ -69,7 +71,7 @@ LogicProcessor::LogicProcessor(void) : EventProcessor(dammIds::logic::OFFSET, da
 
 LogicProcessor::LogicProcessor(bool doubleStop/*=false*/, bool doubleStart/*=false*/) :
         EventProcessor(dammIds::logic::OFFSET, dammIds::logic::RANGE, "LogicProcessor"), lastStartTime(MAX_LOGIC, NAN), lastStopTime(MAX_LOGIC, NAN),
-        logicStatus(MAX_LOGIC), stopCount(MAX_LOGIC), startCount(MAX_LOGIC) {
+        logicStatus(MAX_LOGIC), stopCount(MAX_LOGIC), startCount(MAX_LOGIC), t0_(NAN) {
     associatedTypes.insert("logic");
     associatedTypes.insert("timeclass"); // old detector type
     associatedTypes.insert("mtc");
@@ -130,7 +132,8 @@ bool LogicProcessor::PreProcess(RawEvent &event) {
         unsigned int loc = chan->GetChanID().GetLocation();
         double time = chan->GetTimeSansCfd();
 
-        static double t0 = time;
+        if (std::isnan(t0_))
+            t0_ = time;
 
         // for 2d plot of events 100ms / bin
         const double eventsResolution = 100e-3 / clockInSeconds;
@@ -143,7 +146,7 @@ bool LogicProcessor::PreProcess(RawEvent &event) {
         const unsigned BEAM_TOGGLE = 0;
         const unsigned BEAM_ANALOG = 1;
         const unsigned BEAM_NONE = 2;
-        double time_x = int((time - t0) / eventsResolution);
+        double time_x = int((time - t0_) / eventsResolution);
 
         if (subtype == "start") {
             if (!std::isnan(lastStartTime.at(loc))) {
@@ -269,6 +272,31 @@ bool LogicProcessor::Process(RawEvent &event) {
     return (true);
 }
 
+///The levels are written as bytes since a vector<bool> has no block of
+/// data to write.
+void LogicProcessor::SaveState(StateWriter &writer) const {
+    writer.Write(lastStartTime);
+    writer.Write(lastStopTime);
+    writer.Write(vector<unsigned char>(logicStatus.begin(), logicStatus.end()));
+    writer.Write(stopCount);
+    writer.Write(startCount);
+    writer.Write(t0_);
+}
+
+void LogicProcessor::LoadState(StateReader &reader) {
+    reader.Read(lastStartTime);
+    reader.Read(lastStopTime);
+    vector<unsigned char> status;
+    reader.Read(status);
+    logicStatus.assign(status.begin(), status.end());
+    reader.Read(stopCount);
+    reader.Read(startCount);
+    reader.Read(t0_);
+    if (lastStartTime.size() != MAX_LOGIC || lastStopTime.size() != MAX_LOGIC || logicStatus.size() != MAX_LOGIC ||
+        stopCount.size() != MAX_LOGIC || startCount.size() != MAX_LOGIC)
+        throw IOException("LogicProcessor::LoadState - The saved state has a different number of logic signals.");
+}
+
 /* // Came from TriggerLogicProcessor.cpp
 bool LogicProcessor::NiftyGraph(RawEvent &event) {
     const double logicPlotResolution = 1e-3 / Globals::get()->clockInSeconds();
@@ -35,6 +35,7 @@ void McpProcessor::McpData::Clear(void) {
 
 McpProcessor::McpProcessor(void) : EventProcessor(OFFSET, RANGE, "McpProcessor") {
     associatedTypes.insert("mcp");
+    DeclareStateless();
 }
 
 void McpProcessor::DeclarePlots(void) {
@@ -10,6 +10,7 @@
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <limits>
 #include <sstream>
 
 #include "DetectorDriver.hpp"
@@ -278,6 +279,16 @@ MtasProcessor::MtasProcessor(bool HasBeta,double BetaMinEnergy,double BetaMaxEne
 	IonMax = IonMaxEnergy;
 	HasBetaInfo = HasBeta;
 	IsPrevBetaTriggered = false;
+
+	//! the segments and the multiplicity map are reset in place every event
+	MtasSegVec.resize(24);
+	MtasSegMulti.resize(48);
+
+	//! the rings are summed as one sub event, segment i is in ring i / 6
+	MtasRings.SetNumberOfGroups(4);
+	MtasRings.SetWindow(numeric_limits<double>::max());
+	for (unsigned int ii = 0; ii < MtasSegVec.size(); ++ii)
+		MtasRings.SetGroup(ii, ii / 6);
 	if( HasBetaInfo ){
 		if( !TreeCorrelator::get()->checkPlace("MTASBeta") ){
 			string errormsg = "MtasProcessor::Error You need to add the following lines to the xml";
@@ -296,8 +307,8 @@ bool MtasProcessor::PreProcess(RawEvent &event) {
 
 	static const auto &chanEvents = event.GetSummary("mtas", true)->GetList();
 
-	MtasSegVec = vector<MtasSegment>(24, MtasSegment());
-	vector<short> MtasSegMulti(48,0); // MTAS segment multiplicity "map"
+	fill(MtasSegVec.begin(), MtasSegVec.end(), MtasSegment());
+	fill(MtasSegMulti.begin(), MtasSegMulti.end(), 0);
 
 	for (auto chanEvtIter = chanEvents.begin(); chanEvtIter != chanEvents.end(); ++chanEvtIter){
 
@@ -359,42 +370,29 @@ bool MtasProcessor::PreProcess(RawEvent &event) {
 		}
 	}  //! end loop over chanEvents.
 
-	//! begin loop over segments for sums
+	//! sum the segments of every ring
+	MtasRings.Clear();
+	for (auto segIter = MtasSegVec.begin(); segIter != MtasSegVec.end(); ++segIter) {
+		if( segIter->IsValidSegment() ){
+			double firstTime = min(segIter->GetSegFront()->GetTimeSansCfd(), segIter->GetSegBack()->GetTimeSansCfd());
+			MtasRings.AddHit(segIter->GetSegAvgEnergy(), firstTime, segIter->gMtasSegID_);
+		}
+	}
+	MtasRings.Build();
+
 	MTASCenter = 0;
 	MTASInner = 0;
 	MTASMiddle = 0;
 	MTASOuter = 0;
 	MTASTotal = 0;
 	MTASFirstTime = 1.0e99;
-
-	//!USE LAMBDA FUNCTION FOR THIS. MAKES TYPOS LESS LIKELY
-	//auto energyfunc = [](double a, double b) { return (a + b) / 2.0; };
-	//auto tdiffFunc = [](double a, double b) { return a - b; };
-	for (auto segIter = MtasSegVec.begin(); segIter != MtasSegVec.end(); ++segIter) {
-		int segmentID = segIter->gMtasSegID_;
-		if( segIter->IsValidSegment() ){
-			if( segIter->GetSegFront()->GetTimeSansCfd() < MTASFirstTime )
-				MTASFirstTime = segIter->GetSegFront()->GetTimeSansCfd();
-			if( segIter->GetSegBack()->GetTimeSansCfd() < MTASFirstTime )
-				MTASFirstTime = segIter->GetSegBack()->GetTimeSansCfd();
-			if (segmentID >= 0 && segmentID <= 5 ){
-				double segmentAvg = segIter->GetSegAvgEnergy();
-				MTASTotal += segmentAvg;
-				MTASCenter += segmentAvg;
-			} else if (segmentID >= 6 && segmentID <= 11 ){
-				double segmentAvg = segIter->GetSegAvgEnergy();
-				MTASTotal += segmentAvg;
-				MTASInner += segmentAvg;
-			} else if (segmentID >= 12 && segmentID <= 17 ){
-				double segmentAvg = segIter->GetSegAvgEnergy();
-				MTASTotal += segmentAvg;
-				MTASMiddle += segmentAvg;
-			} else if (segmentID >= 18 && segmentID <= 23 ){
-				double segmentAvg = segIter->GetSegAvgEnergy();
-				MTASTotal += segmentAvg;
-				MTASOuter += segmentAvg;
-			}
-		}
+	if( MtasRings.GetNumSubEvents() > 0 ){
+		MTASCenter = MtasRings.GetCluster(0, 0).energy;
+		MTASInner = MtasRings.GetCluster(0, 1).energy;
+		MTASMiddle = MtasRings.GetCluster(0, 2).energy;
+		MTASOuter = MtasRings.GetCluster(0, 3).energy;
+		MTASTotal = MtasRings.GetSum(0).energy;
+		MTASFirstTime = MtasRings.GetSum(0).firstTime;
 	}
 	//! loop over segments for ploting
 	if( DetectorDriver::get()->GetSysRootOutput() ){
@@ -404,7 +402,7 @@ bool MtasProcessor::PreProcess(RawEvent &event) {
 		MtasTotalsstruct.Middle = MTASMiddle;
 		MtasTotalsstruct.Outer = MTASOuter;	
 		pixie_tree_event_->mtastotals_vec_.emplace_back(MtasTotalsstruct);
-		MtasTotalsstruct = 
+		MtasTotalsstruct = processor_struct::MTASTOTALS_DEFAULT_STRUCT;
 	}
 	for (auto segIter = MtasSegVec.begin(); segIter != MtasSegVec.end(); ++segIter) {
 		int segmentID = segIter->gMtasSegID_;
@@ -32,6 +32,7 @@ namespace dammIds {
 NeutronScintProcessor::NeutronScintProcessor() :
         EventProcessor(OFFSET, RANGE, "NeutronScintProcessor") {
     associatedTypes.insert("neutron_scint");
+    DeclareStateless();
 }
 
 void NeutronScintProcessor::DeclarePlots(void) {
@@ -20,6 +20,7 @@ using namespace dammIds::singlebeta;
 
 SingleBetaProcessor::SingleBetaProcessor() : EventProcessor(OFFSET, RANGE, "SingleBetaProcessor") {
     associatedTypes.insert("beta");
+    DeclareStateless();
 }
 
 void SingleBetaProcessor::DeclarePlots(void) {
@@ -32,6 +32,7 @@ TeenyVandleProcessor::TeenyVandleProcessor() :
                        dammIds::teenyvandle::RANGE,
                        "TeenyVandleProcessor") {
     associatedTypes.insert("tvandle");
+    DeclareStateless();
 }
 
 void TeenyVandleProcessor::DeclarePlots(void) {
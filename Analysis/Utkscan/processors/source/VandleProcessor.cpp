@@ -53,6 +53,8 @@ using namespace dammIds::vandle;
 
 VandleProcessor::VandleProcessor() : EventProcessor(OFFSET, RANGE, "VandleProcessor") {
     associatedTypes.insert("vandle");
+    DeclareStateless();
+    AddDependency("DoubleBetaProcessor");
 }
 
 VandleProcessor::VandleProcessor(const std::vector<std::string> &typeList, const double &res, const double &offset,
@@ -60,6 +62,8 @@ VandleProcessor::VandleProcessor(const std::vector<std::string> &typeList, const
                                  const double &tofcut, const double &idealFP) :
         EventProcessor(OFFSET,RANGE,"VandleProcessor") {
     associatedTypes.insert("vandle");
+    DeclareStateless();
+    AddDependency("DoubleBetaProcessor");
     plotMult_ = res;
     plotOffset_ = offset;
     numStarts_ = numStarts;
@@ -116,9 +120,9 @@ bool VandleProcessor::PreProcess(RawEvent &event) {
         return false;
     }
 
-    BarBuilder billy(events);
-    billy.BuildBars();
-    bars_ = billy.GetBarMap();
+    barBuilder_.SetChannelList(events);
+    barBuilder_.BuildBars();
+    bars_ = barBuilder_.GetBarMap();
 
     if (bars_.empty()) {
         plot(D_DEBUGGING, 25);
@@ -155,9 +159,9 @@ bool VandleProcessor::Process(RawEvent &event) {
     starts_ = bldStarts.GetMap();
 
     static const vector<ChanEvent *> &doubleBetaStarts = event.GetSummary("beta:double:start")->GetList();
-    BarBuilder startBars(doubleBetaStarts);
-    startBars.BuildBars();
-    barStarts_ = startBars.GetBarMap();
+    startBuilder_.SetChannelList(doubleBetaStarts);
+    startBuilder_.BuildBars();
+    barStarts_ = startBuilder_.GetBarMap();
 
     if (DetectorDriver::get()->GetSysRootOutput()){
         vandles.vMulti = (int)bars_.size();
@@ -186,6 +190,11 @@ bool VandleProcessor::Process(RawEvent &event) {
     return true;
 }
 
+const BarMap &VandleProcessor::GetBars(void) const {
+    static const BarMap empty;
+    return HasEvent() ? bars_ : empty;
+}
+
 void VandleProcessor::AnalyzeBarStarts(const BarDetector &bar, unsigned int &barLoc) {
         for (BarMap::iterator itStart = barStarts_.begin(); itStart != barStarts_.end(); itStart++) {
             unsigned int startLoc = (*itStart).first.first;
@@ -0,0 +1,166 @@
+/** \file AsyncFileWriter.h
+  *
+  * \brief Asynchronous, block-aligned output file backend for poll2
+  *
+  * AsyncFileWriter is a std::streambuf which collects the data written to it
+  * into a pool of 4 kB aligned blocks. Full blocks are handed to a small pool
+  * of writer threads which issue pwrite calls against the file (optionally
+  * opened with O_DIRECT). The thread producing the data only ever blocks when
+  * every block in the pool is waiting to be written. Disk space is reserved
+  * ahead of the write position with fallocate so that the file system does
+  * not need to allocate extents in the write path.
+  *
+  * The buffer supports random positioning (seekp) so that headers may be
+  * rewritten when a file is closed. Repositioning drains all pending writes
+  * and reloads the target block from disk before continuing.
+  *
+  * \date Oct. 19th, 2026
+*/
+
+#ifndef ASYNC_FILE_WRITER_H
+#define ASYNC_FILE_WRITER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/types.h>
+
+class AsyncFileWriter : public std::streambuf {
+public:
+    /// Alignment of the blocks and of every write issued to the file (bytes)
+    static const size_t kAlignment = 4096;
+
+    /** Constructor
+      * \param[in] blockSize_ The size of each block in bytes, rounded up to a multiple of kAlignment
+      * \param[in] numBlocks_ The total number of blocks in the pool (at least 2)
+      * \param[in] numThreads_ The number of writer threads, i.e. the maximum number of writes in flight */
+    AsyncFileWriter(const size_t &blockSize_ = 1048576,
+                    const unsigned int &numBlocks_ = 16,
+                    const unsigned int &numThreads_ = 2);
+
+    /// Destructor. Closes the file if it is still open.
+    ~AsyncFileWriter();
+
+    /** Open a file for writing, truncating it if it exists. If directIo_ is
+      * true the file is opened with O_DIRECT, falling back to buffered I/O if
+      * the file system does not support it.
+      * \return True if the file was opened successfully. */
+    bool Open(const std::string &filename_, const bool &directIo_ = false);
+
+    /** Flush every pending block, trim the file to its logical size, and
+      * close it. \return False if any write to the file failed. */
+    bool Close();
+
+    /// Return true if a file is currently open.
+    bool IsOpen() const { return fd_ >= 0; }
+
+    /// Return true if the open file is using O_DIRECT.
+    bool IsDirectIo() const { return isDirect_; }
+
+    /// Return true if a write to the file has failed since it was opened.
+    bool HasFailed() const { return failed_; }
+
+    /// Set the number of bytes to reserve ahead of the write position (0 disables fallocate).
+    void SetPreallocationSize(const size_t &bytes_) { preallocStep_ = bytes_; }
+
+    /// Return the number of blocks currently queued for or being written to disk.
+    unsigned int GetQueueDepth();
+
+    /// Return the largest queue depth seen since the statistics were reset.
+    unsigned int GetMaxQueueDepth();
+
+    /// Return the mean time to write a block to disk in seconds.
+    double GetMeanWriteLatency();
+
+    /// Return the longest time to write a block to disk in seconds.
+    double GetMaxWriteLatency();
+
+    /// Return the total time the producer waited on a free block in seconds.
+    double GetStallTime();
+
+    /// Reset the queue depth and latency statistics.
+    void ResetStatistics();
+
+protected:
+    /// Called when the current block is full.
+    virtual int_type overflow(int_type ch_);
+
+    /// Copy a sequence of characters into the block pool.
+    virtual std::streamsize xsputn(const char *s_, std::streamsize n_);
+
+    /// Write out all data and wait for it to reach the file.
+    virtual int sync();
+
+    virtual pos_type seekoff(off_type off_, std::ios_base::seekdir dir_,
+                             std::ios_base::openmode which_);
+
+    virtual pos_type seekpos(pos_type pos_, std::ios_base::openmode which_);
+
+private:
+    /// A single aligned block of data destined for the file.
+    struct Block {
+        char *data; ///< Aligned storage of blockSize_ bytes.
+        off_t offset; ///< Offset of data[0] in the file, always aligned.
+        size_t length; ///< Number of valid bytes in the block.
+    };
+
+    size_t blockSize_; ///< The size of each block in bytes.
+    unsigned int numThreads_; ///< The number of writer threads.
+    size_t preallocStep_; ///< The number of bytes to reserve ahead of the writes.
+
+    int fd_; ///< The file descriptor of the open file.
+    bool isDirect_; ///< True if the file was opened with O_DIRECT.
+    std::atomic<bool> failed_; ///< True if a write failed since the file was opened.
+    bool stop_; ///< Tells the writer threads to exit.
+
+    off_t size_; ///< The logical size of the file in bytes.
+    off_t preallocated_; ///< The number of bytes reserved with fallocate.
+
+    Block *current_; ///< The block currently being filled.
+    size_t valid_; ///< Bytes in the current block which were reloaded from disk.
+
+    std::vector<Block> blocks_; ///< Storage for all blocks in the pool.
+    std::vector<Block *> free_; ///< Blocks available to the producer.
+    std::deque<Block *> queue_; ///< Blocks waiting to be written.
+    unsigned int inFlight_; ///< Blocks currently being written.
+
+    std::vector<std::thread> writers_; ///< The writer threads.
+    std::mutex mutex_; ///< Protects the queue, free list and statistics.
+    std::condition_variable queueCondition_; ///< Signals the writers that work is available.
+    std::condition_variable freeCondition_; ///< Signals the producer that a block was released.
+
+    unsigned int maxQueueDepth_; ///< Largest number of queued + in flight blocks.
+    unsigned long long numWrites_; ///< Number of blocks written.
+    double totalLatency_; ///< Total time spent writing blocks in seconds.
+    double maxLatency_; ///< Longest time spent writing a single block in seconds.
+    double stallTime_; ///< Total time spent waiting for a free block in seconds.
+
+    /// Hand the current block to the writers and clear the put area.
+    void submit();
+
+    /// Wait for a block to be released and return it.
+    Block *acquire();
+
+    /// Wait until every queued block has been written.
+    void drain();
+
+    /// Make the block containing pos_ current and position the put pointer at pos_.
+    bool load(const off_t &pos_);
+
+    /// Return the current write position in the file.
+    off_t position() const;
+
+    /// Main loop of the writer threads.
+    void writer();
+
+    /// Write a single block to disk. Return false on an error.
+    bool write_block(Block *block_);
+};
+
+#endif
@@ -24,6 +24,8 @@
 #include <fstream>
 #include <vector>
 
+#include "AsyncFileWriter.h"
+
 #define HRIBF_BUFFERS_VERSION "1.3.00"
 #define HRIBF_BUFFERS_DATE "Sept. 19th, 2016"
 
@@ -43,7 +45,7 @@ protected:
                unsigned int buffend_ = 0xFFFFFFFF);
 
     /// Returns only false if not overloaded
-    virtual bool Write(std::ofstream *file_);
+    virtual bool Write(std::ostream *file_);
 
     /// Returns only false if not overloaded
     virtual bool Read(std::ifstream *file_);
@@ -122,7 +124,7 @@ public:
 
     /** HEAD buffer (1 word buffer type, 1 word run number, 1 word maximum spill size, 4 word format,
       * 2 word facility, 6 word date, 1 word title length (x in bytes), x/4 word title, 1 word end of buffer*/
-    virtual bool Write(std::ofstream *file_);
+    virtual bool Write(std::ostream *file_);
 
     /// Read a HEAD buffer from a pld format file. Return false if buffer has the wrong header and return true otherwise
     virtual bool Read(std::ifstream *file_);
@@ -145,7 +147,7 @@ public:
     PLD_data(); /// 0x41544144 "DATA"
 
     /// Write a data spill to file
-    virtual bool Write(std::ofstream *file_, char *data_, unsigned int nWords_);
+    virtual bool Write(std::ostream *file_, char *data_, unsigned int nWords_);
 
     /// Read a data spill from a file
     virtual bool Read(std::ifstream *file_, char *data_, unsigned int &nBytes,
@@ -175,7 +177,7 @@ public:
     /* DIR buffer (1 word buffer type, 1 word buffer size, 1 word for total buffer length,
        1 word for total number of buffers, 2 unknown words, 1 word for run number, 1 unknown word,
        and 8186 zeros) */
-    virtual bool Write(std::ofstream *file_);
+    virtual bool Write(std::ostream *file_);
 
     /// Read a DIR buffer from a file. Return false if buffer has the wrong header and return true otherwise
     virtual bool Read(std::ifstream *file_);
@@ -225,7 +227,7 @@ public:
     /** HEAD buffer (1 word buffer type, 1 word buffer size, 2 words for facility, 2 for format,
       * 3 for type, 1 word separator, 4 word date, 20 word title [80 character], 1 word run number,
       * 30 words of padding, and 8129 end of buffer words) */
-    virtual bool Write(std::ofstream *file_);
+    virtual bool Write(std::ostream *file_);
 
     /// Read a HEAD buffer from a file. Return false if buffer has the wrong header and return true otherwise
     virtual bool Read(std::ifstream *file_);
@@ -260,7 +262,7 @@ private:
     unsigned int buff_pos; /// The actual position in the current ldf buffer.
 
     /// DATA buffer (1 word buffer type, 1 word buffer size)
-    bool open_(std::ofstream *file_);
+    bool open_(std::ostream *file_);
 
     bool read_next_buffer(std::ifstream *f_, bool force_ = false);
 
@@ -268,7 +270,7 @@ public:
     DATA_buffer(); /// 0x41544144 "DATA"
 
     /// Close a data buffer by padding with 0xFFFFFFFF
-    bool Close(std::ofstream *file_);
+    bool Close(std::ostream *file_);
 
     /** Get the standard data spill size for a given data file. This number is set at runtime by poll
       * and should be the same for each and every spill in the file. Returns the spill size in words
@@ -293,7 +295,7 @@ public:
     unsigned int GetNumMissing() { return missing_chunks; }
 
     /// Write a data spill to file
-    virtual bool Write(std::ofstream *file_, char *data_, unsigned int nWords_,
+    virtual bool Write(std::ostream *file_, char *data_, unsigned int nWords_,
                        int &buffs_written);
 
     /// Read a data spill from a file
@@ -311,7 +313,7 @@ public:
     EOF_buffer(); /// 0x20464F45 "EOF "
 
     /// EOF buffer (1 word buffer type, 1 word buffer size, and 8192 end of buffer words)
-    virtual bool Write(std::ofstream *file_);
+    virtual bool Write(std::ostream *file_);
 
     /// Read an EOF buffer from a file. Return false if buffer has the wrong header and return true otherwise
     virtual bool Read(std::ifstream *file_);
@@ -322,7 +324,8 @@ public:
 
 class PollOutputFile {
 private:
-    std::ofstream output_file;
+    AsyncFileWriter output_buffer; /// Asynchronous, aligned writer backing output_file
+    std::ostream output_file;
     std::string fname_prefix;
     std::string current_filename;
     std::string current_full_filename;
@@ -338,6 +341,7 @@ private:
     unsigned int number_spills;
     unsigned int run_num;
     bool debug_mode;
+    bool direct_io; /// Open new files with O_DIRECT
 
     unsigned int current_depth;
     std::string current_directory;
@@ -401,7 +405,31 @@ public:
     void SetFilenamePrefix(std::string filename_);
 
     /// Return true if an output file is open and writable and false otherwise
-    bool IsOpen() { return (output_file.is_open() && output_file.good()); }
+    bool IsOpen() { return (output_buffer.IsOpen() && output_file.good()); }
+
+    /// Open new files with O_DIRECT when the file system supports it
+    void SetDirectIO(bool direct_ = true) { direct_io = direct_; }
+
+    /// Return true if new files are opened with O_DIRECT
+    bool GetDirectIO() { return direct_io; }
+
+    /// Return true if the current file was opened with O_DIRECT
+    bool IsDirectIO() { return output_buffer.IsDirectIo(); }
+
+    /// Return the number of data blocks waiting to be written to disk
+    unsigned int GetWriteQueueDepth() { return output_buffer.GetQueueDepth(); }
+
+    /// Return the deepest write queue seen since the current file was opened
+    unsigned int GetMaxWriteQueueDepth() { return output_buffer.GetMaxQueueDepth(); }
+
+    /// Return the mean time to write a data block to disk (in seconds)
+    double GetWriteLatency() { return output_buffer.GetMeanWriteLatency(); }
+
+    /// Return the longest time to write a data block to disk (in seconds)
+    double GetMaxWriteLatency() { return output_buffer.GetMaxWriteLatency(); }
+
+    /// Return the time the readout spent waiting on the disk (in seconds)
+    double GetWriteStallTime() { return output_buffer.GetStallTime(); }
 
     /// Write nWords_ of data to the file
     int Write(char *data_, unsigned int nWords_);
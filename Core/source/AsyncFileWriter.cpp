@@ -0,0 +1,371 @@
+/** \file AsyncFileWriter.cpp
+  *
+  * \brief Asynchronous, block-aligned output file backend for poll2
+  *
+  * \date Oct. 19th, 2026
+*/
+
+#include <algorithm>
+#include <chrono>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "AsyncFileWriter.h"
+
+const size_t AsyncFileWriter::kAlignment;
+
+/// Return the time elapsed since start_ in seconds.
+static double elapsed_since(const std::chrono::steady_clock::time_point &start_) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                         start_).count();
+}
+
+AsyncFileWriter::AsyncFileWriter(const size_t &blockSize_/*=1048576*/,
+                                 const unsigned int &numBlocks_/*=16*/,
+                                 const unsigned int &numThreads_/*=2*/) {
+    this->blockSize_ = blockSize_ + (kAlignment - blockSize_ % kAlignment) % kAlignment;
+    if (this->blockSize_ == 0)
+        this->blockSize_ = kAlignment;
+    this->numThreads_ = std::max(1u, numThreads_);
+    preallocStep_ = 67108864;
+
+    fd_ = -1;
+    isDirect_ = false;
+    failed_ = false;
+    stop_ = false;
+    size_ = 0;
+    preallocated_ = 0;
+    current_ = NULL;
+    valid_ = 0;
+    inFlight_ = 0;
+
+    blocks_.resize(std::max(2u, numBlocks_));
+    for (std::vector<Block>::iterator it = blocks_.begin(); it != blocks_.end(); ++it) {
+        void *ptr = NULL;
+        if (posix_memalign(&ptr, kAlignment, this->blockSize_) != 0)
+            ptr = NULL;
+        it->data = (char *) ptr;
+        it->offset = 0;
+        it->length = 0;
+    }
+
+    ResetStatistics();
+}
+
+AsyncFileWriter::~AsyncFileWriter() {
+    Close();
+    for (std::vector<Block>::iterator it = blocks_.begin(); it != blocks_.end(); ++it)
+        free(it->data);
+}
+
+bool AsyncFileWriter::Open(const std::string &filename_, const bool &directIo_/*=false*/) {
+    if (IsOpen())
+        Close();
+
+    for (std::vector<Block>::iterator it = blocks_.begin(); it != blocks_.end(); ++it)
+        if (!it->data)
+            return false;
+
+    int flags = O_RDWR | O_CREAT | O_TRUNC;
+    isDirect_ = false;
+#ifdef O_DIRECT
+    if (directIo_) {
+        fd_ = open(filename_.c_str(), flags | O_DIRECT, 0644);
+        isDirect_ = fd_ >= 0;
+    }
+#endif
+    // tmpfs and several network file systems refuse O_DIRECT with EINVAL.
+    if (fd_ < 0)
+        fd_ = open(filename_.c_str(), flags, 0644);
+    if (fd_ < 0)
+        return false;
+
+    failed_ = false;
+    stop_ = false;
+    size_ = 0;
+    preallocated_ = 0;
+    queue_.clear();
+    free_.clear();
+    for (std::vector<Block>::iterator it = blocks_.begin(); it != blocks_.end(); ++it)
+        free_.push_back(&(*it));
+
+    for (unsigned int i = 0; i < numThreads_; i++)
+        writers_.push_back(std::thread(&AsyncFileWriter::writer, this));
+
+    return load(0);
+}
+
+bool AsyncFileWriter::Close() {
+    if (!IsOpen())
+        return true;
+
+    submit();
+    drain();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    queueCondition_.notify_all();
+    for (std::vector<std::thread>::iterator it = writers_.begin(); it != writers_.end(); ++it)
+        it->join();
+    writers_.clear();
+
+    // Drops the O_DIRECT padding of the last block and any unused preallocation.
+    if (ftruncate(fd_, size_) != 0)
+        failed_ = true;
+    close(fd_);
+    fd_ = -1;
+    setp(NULL, NULL);
+
+    return !failed_;
+}
+
+unsigned int AsyncFileWriter::GetQueueDepth() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queue_.size() + inFlight_;
+}
+
+unsigned int AsyncFileWriter::GetMaxQueueDepth() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return maxQueueDepth_;
+}
+
+double AsyncFileWriter::GetMeanWriteLatency() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return numWrites_ == 0 ? 0.0 : totalLatency_ / numWrites_;
+}
+
+double AsyncFileWriter::GetMaxWriteLatency() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return maxLatency_;
+}
+
+double AsyncFileWriter::GetStallTime() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stallTime_;
+}
+
+void AsyncFileWriter::ResetStatistics() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    maxQueueDepth_ = 0;
+    numWrites_ = 0;
+    totalLatency_ = 0.0;
+    maxLatency_ = 0.0;
+    stallTime_ = 0.0;
+}
+
+AsyncFileWriter::int_type AsyncFileWriter::overflow(int_type ch_) {
+    if (!IsOpen() || failed_)
+        return traits_type::eof();
+
+    off_t next = position();
+    submit();
+    if (!load(next))
+        return traits_type::eof();
+
+    if (!traits_type::eq_int_type(ch_, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(ch_);
+        pbump(1);
+    }
+    return traits_type::not_eof(ch_);
+}
+
+std::streamsize AsyncFileWriter::xsputn(const char *s_, std::streamsize n_) {
+    std::streamsize written = 0;
+    while (written < n_) {
+        if (pptr() == epptr() &&
+            traits_type::eq_int_type(overflow(traits_type::eof()), traits_type::eof()))
+            break;
+        std::streamsize count = std::min<std::streamsize>(epptr() - pptr(), n_ - written);
+        memcpy(pptr(), s_ + written, count);
+        pbump(count);
+        written += count;
+    }
+    return written;
+}
+
+int AsyncFileWriter::sync() {
+    if (!IsOpen())
+        return 0;
+
+    off_t pos = position();
+    submit();
+    drain();
+    return (load(pos) && !failed_) ? 0 : -1;
+}
+
+AsyncFileWriter::pos_type AsyncFileWriter::seekoff(off_type off_, std::ios_base::seekdir dir_,
+                                                   std::ios_base::openmode which_) {
+    if (!IsOpen() || !(which_ & std::ios_base::out))
+        return pos_type(off_type(-1));
+
+    off_t base = 0;
+    if (dir_ == std::ios_base::cur) {
+        base = position();
+    } else if (dir_ == std::ios_base::end) {
+        base = std::max(size_, (off_t) (current_->offset +
+                                        std::max(valid_, (size_t) (pptr() - pbase()))));
+    }
+
+    // tellp() lands here, it must not disturb the pending blocks.
+    if (dir_ == std::ios_base::cur && off_ == 0)
+        return pos_type(base);
+
+    return seekpos(pos_type(base + off_), which_);
+}
+
+AsyncFileWriter::pos_type AsyncFileWriter::seekpos(pos_type pos_, std::ios_base::openmode which_) {
+    if (!IsOpen() || !(which_ & std::ios_base::out) || off_t(pos_) < 0)
+        return pos_type(off_type(-1));
+
+    if (off_t(pos_) == position())
+        return pos_;
+
+    submit();
+    if (!load(pos_))
+        return pos_type(off_type(-1));
+    return pos_;
+}
+
+void AsyncFileWriter::submit() {
+    if (!current_)
+        return;
+
+    current_->length = std::max(valid_, (size_t) (pptr() - pbase()));
+    setp(NULL, NULL);
+    valid_ = 0;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (current_->length == 0) {
+            free_.push_back(current_);
+        } else {
+            size_ = std::max(size_, (off_t) (current_->offset + current_->length));
+            queue_.push_back(current_);
+            maxQueueDepth_ = std::max(maxQueueDepth_, (unsigned int) queue_.size() + inFlight_);
+        }
+    }
+    current_ = NULL;
+    queueCondition_.notify_one();
+    freeCondition_.notify_all();
+}
+
+AsyncFileWriter::Block *AsyncFileWriter::acquire() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (free_.empty()) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        freeCondition_.wait(lock, [this] { return !free_.empty(); });
+        stallTime_ += elapsed_since(start);
+    }
+    Block *block = free_.back();
+    free_.pop_back();
+    return block;
+}
+
+void AsyncFileWriter::drain() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    freeCondition_.wait(lock, [this] { return queue_.empty() && inFlight_ == 0; });
+}
+
+bool AsyncFileWriter::load(const off_t &pos_) {
+    Block *block = acquire();
+    block->offset = pos_ - pos_ % kAlignment;
+    block->length = 0;
+    valid_ = 0;
+
+    // Writing into a region that already exists, read back what is on disk
+    // so that the block can be written out whole.
+    if (block->offset < size_) {
+        drain();
+        ssize_t nRead = pread(fd_, block->data, blockSize_, block->offset);
+        if (nRead < 0) {
+            failed_ = true;
+            std::lock_guard<std::mutex> lock(mutex_);
+            free_.push_back(block);
+            return false;
+        }
+        valid_ = std::min((off_t) nRead, size_ - block->offset);
+    }
+
+    current_ = block;
+    setp(block->data, block->data + blockSize_);
+    pbump(pos_ - block->offset);
+    return true;
+}
+
+off_t AsyncFileWriter::position() const {
+    if (!current_)
+        return size_;
+    return current_->offset + (pptr() - pbase());
+}
+
+void AsyncFileWriter::writer() {
+    while (true) {
+        Block *block;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            queueCondition_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+            if (queue_.empty())
+                return;
+            block = queue_.front();
+            queue_.pop_front();
+            inFlight_++;
+        }
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        bool success = write_block(block);
+        double latency = elapsed_since(start);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            inFlight_--;
+            free_.push_back(block);
+            numWrites_++;
+            totalLatency_ += latency;
+            maxLatency_ = std::max(maxLatency_, latency);
+            if (!success)
+                failed_ = true;
+        }
+        freeCondition_.notify_all();
+    }
+}
+
+bool AsyncFileWriter::write_block(Block *block_) {
+    size_t length = block_->length;
+    if (isDirect_)
+        length += (kAlignment - length % kAlignment) % kAlignment;
+
+#ifdef FALLOC_FL_KEEP_SIZE
+    if (preallocStep_ > 0) {
+        off_t start = 0, reserve = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (block_->offset + (off_t) length > preallocated_) {
+                start = preallocated_;
+                preallocated_ = block_->offset + length + preallocStep_;
+                reserve = preallocated_ - start;
+            }
+        }
+        // Failure only means the file system will allocate on demand.
+        if (reserve > 0)
+            fallocate(fd_, FALLOC_FL_KEEP_SIZE, start, reserve);
+    }
+#endif
+
+    size_t done = 0;
+    while (done < length) {
+        ssize_t nWritten = pwrite(fd_, block_->data + done, length - done,
+                                  block_->offset + done);
+        if (nWritten < 0 && errno == EINTR)
+            continue;
+        if (nWritten <= 0)
+            return false;
+        done += nWritten;
+    }
+    return true;
+}
@@ -78,7 +78,7 @@ BufferType::BufferType(unsigned int bufftype_, unsigned int buffsize_,
 }
 
 /// Returns only false if not overwritten
-bool BufferType::Write(std::ofstream *file_) {
+bool BufferType::Write(std::ostream *file_) {
     return false;
 }
 
@@ -151,8 +151,8 @@ void PLD_header::SetTitle(std::string input_) {
 }
 
 /// Write a pld style header to a file.
-bool PLD_header::Write(std::ofstream *file_) {
-    if (!file_ || !file_->is_open() || !file_->good()) { return false; }
+bool PLD_header::Write(std::ostream *file_) {
+    if (!file_ || !file_->good()) { return false; }
 
     unsigned int len_of_title = strlen(run_title);
     unsigned int padding_bytes = 0;
@@ -274,8 +274,8 @@ PLD_data::PLD_data() : BufferType(DATA, 0) { // 0x41544144 "DATA"
 }
 
 /// Write a pld style data buffer to file.
-bool PLD_data::Write(std::ofstream *file_, char *data_, unsigned int nWords_) {
-    if (!file_ || !file_->is_open() || !file_->good() ||
+bool PLD_data::Write(std::ostream *file_, char *data_, unsigned int nWords_) {
+    if (!file_ || !file_->good() ||
         nWords_ == 0) { return false; }
 
     if (debug_mode) {
@@ -360,8 +360,8 @@ DIR_buffer::DIR_buffer() : BufferType(DIR,
   * 1 word for total number of buffers, 2 unknown words, 1 word for run number, 1 unknown word,
   * and 8186 zeros).
   */
-bool DIR_buffer::Write(std::ofstream *file_) {
-    if (!file_ || !file_->is_open() || !file_->good()) { return false; }
+bool DIR_buffer::Write(std::ostream *file_) {
+    if (!file_ || !file_->good()) { return false; }
 
     if (debug_mode) {
         std::cout << "debug: writing " << ACTUAL_BUFF_SIZE * 4
@@ -482,8 +482,8 @@ bool HEAD_buffer::SetTitle(std::string input_) {
   * 3 for type, 1 word separator, 4 word date, 20 word title [80 character], 1 word run number,
   * 30 words of padding, and 8129 end of buffer words).
   */
-bool HEAD_buffer::Write(std::ofstream *file_) {
-    if (!file_ || !file_->is_open() || !file_->good()) { return false; }
+bool HEAD_buffer::Write(std::ostream *file_) {
+    if (!file_ || !file_->good()) { return false; }
 
     if (debug_mode) {
         std::cout << "debug: writing " << ACTUAL_BUFF_SIZE * 4
@@ -575,8 +575,8 @@ void HEAD_buffer::PrintDelimited(const char &delimiter_/*='\t'*/) {
 }
 
 /// Write a ldf data buffer header (2 words).
-bool DATA_buffer::open_(std::ofstream *file_) {
-    if (!file_ || !file_->is_open() || !file_->good()) { return false; }
+bool DATA_buffer::open_(std::ostream *file_) {
+    if (!file_ || !file_->good()) { return false; }
 
     if (debug_mode) { std::cout << "debug: writing 2 word DATA header\n"; }
     file_->write((char *) &bufftype, 4); // write buffer header type
@@ -646,8 +646,8 @@ DATA_buffer::DATA_buffer() : BufferType(DATA,
 }
 
 /// Close a ldf data buffer by padding with 0xFFFFFFFF.
-bool DATA_buffer::Close(std::ofstream *file_) {
-    if (!file_ || !file_->is_open() || !file_->good()) { return false; }
+bool DATA_buffer::Close(std::ostream *file_) {
+    if (!file_ || !file_->good()) { return false; }
 
     if (buff_pos < ACTUAL_BUFF_SIZE) {
         if (debug_mode)
@@ -663,13 +663,13 @@ bool DATA_buffer::Close(std::ofstream *file_) {
 }
 
 /// Write a ldf data buffer to disk.
-bool DATA_buffer::Write(std::ofstream *file_, char *data_, unsigned int nWords_,
+bool DATA_buffer::Write(std::ostream *file_, char *data_, unsigned int nWords_,
                         int &buffs_written) {
-    if (!file_ || !file_->is_open() || !file_->good() || !data_ ||
+    if (!file_ || !file_->good() || !data_ ||
         nWords_ == 0) {
         if (debug_mode) {
             std::cout
-                    << "debug: !file_ || !file_->is_open() || !data_ || nWords_ == 0\n";
+                    << "debug: !file_ || !data_ || nWords_ == 0\n";
         }
         return false;
     }
@@ -1011,8 +1011,8 @@ EOF_buffer::EOF_buffer() : BufferType(ENDFILE,
                                       NO_HEADER_SIZE) {} // 0x20464F45 "EOF "
 
 /// Write an end-of-file buffer (1 word buffer type, 1 word buffer size, and 8192 end of file words).
-bool EOF_buffer::Write(std::ofstream *file_) {
-    if (!file_ || !file_->is_open() || !file_->good()) { return false; }
+bool EOF_buffer::Write(std::ostream *file_) {
+    if (!file_ || !file_->good()) { return false; }
 
     if (debug_mode) {
         std::cout << "debug: writing " << ACTUAL_BUFF_SIZE * 4
@@ -1112,7 +1112,7 @@ bool PollOutputFile::get_full_filename(std::string &output) {
   * evenly divisible by the number of words in a buffer.
   */
 bool PollOutputFile::overwrite_dir(int total_buffers_/*=-1*/) {
-    if (!output_file.is_open() || !output_file.good()) { return false; }
+    if (!output_buffer.IsOpen() || !output_file.good()) { return false; }
 
     // Set the buffer count in the "DIR " buffer
     if (total_buffers_ == -1) { // Set with the internal buffer count
@@ -1138,7 +1138,7 @@ bool PollOutputFile::overwrite_dir(int total_buffers_/*=-1*/) {
         }
 
         if (overflow != 0) {
-            output_file.close();
+            output_buffer.Close();
             return false;
         }
     } else { // Set with an external buffer count
@@ -1149,8 +1149,7 @@ bool PollOutputFile::overwrite_dir(int total_buffers_/*=-1*/) {
         }
     }
 
-    output_file.close();
-    return true;
+    return output_buffer.Close();
 }
 
 /// Initialize the output file with initial parameters
@@ -1159,6 +1158,7 @@ void PollOutputFile::initialize() {
     current_file_num = 0;
     output_format = 0;
     number_spills = 0;
+    direct_io = false;
     fname_prefix = "poll_data";
     current_filename = "unknown";
     current_full_filename = "unknown";
@@ -1186,12 +1186,13 @@ void PollOutputFile::initialize() {
 }
 
 /// Default constructor.
-PollOutputFile::PollOutputFile() {
+PollOutputFile::PollOutputFile() : output_file(&output_buffer) {
     initialize();
 }
 
 /// Constructor to set the output filename prefix.
-PollOutputFile::PollOutputFile(std::string filename_) {
+PollOutputFile::PollOutputFile(std::string filename_) :
+        output_file(&output_buffer) {
     initialize();
     fname_prefix = filename_;
 }
@@ -1226,7 +1227,7 @@ void PollOutputFile::SetFilenamePrefix(std::string filename_) {
 int PollOutputFile::Write(char *data_, unsigned int nWords_) {
     if (!data_ || nWords_ == 0) { return -1; }
 
-    if (!output_file.is_open() || !output_file.good()) { return -1; }
+    if (!output_buffer.IsOpen() || !output_file.good()) { return -1; }
 
     if (nWords_ > max_spill_size) { max_spill_size = nWords_; }
 
@@ -1269,7 +1270,7 @@ int PollOutputFile::SendPacket(Client *cli_) {
 
     char *packet = NULL;
 
-    if (!output_file.is_open() || !output_file.good()) {
+    if (!output_buffer.IsOpen() || !output_file.good()) {
         // Below is the packet packet structure
         // ------------------------------------
         // 1 byte size of integer (may not be the same on a different machine)
@@ -1342,11 +1343,11 @@ bool PollOutputFile::OpenNewFile(std::string title_, unsigned int &run_num_,
 
     std::string filename = GetNextFileName(run_num_, prefix, output_directory,
                                            continueRun);
-    output_file.open(filename.c_str(), std::ios::binary);
-    if (!output_file.is_open() || !output_file.good()) {
-        output_file.close();
+    output_file.clear();
+    if (!output_buffer.Open(filename, direct_io)) {
         return false;
     }
+    output_buffer.ResetStatistics();
 
     current_filename = filename;
     get_full_filename(current_full_filename);
@@ -1428,7 +1429,11 @@ unsigned int PollOutputFile::GetRunNumber() {
 
 /// Write the footer and close the file.
 void PollOutputFile::CloseFile(float total_run_time_/*=0.0*/) {
-    if (!output_file.is_open() || !output_file.good()) { return; }
+    if (!output_buffer.IsOpen()) { return; }
+    if (!output_file.good()) {
+        output_buffer.Close();
+        return;
+    }
 
     if (output_format == 0) {
         dataBuff.Close(
@@ -1451,7 +1456,7 @@ void PollOutputFile::CloseFile(float total_run_time_/*=0.0*/) {
         pldHead.SetEndDateTime();
         pldHead.SetMaxSpillSize(max_spill_size);
         pldHead.Write(&output_file);
-        output_file.close();
+        output_buffer.Close();
     } else if (debug_mode) {
         std::cout
                 << "debug: invalid output format for PollOutputFile::CloseFile!\n";
@@ -0,0 +1,150 @@
+///@brief Writes synthetic spills through PollOutputFile and reads them back.
+///
+/// Usage: PollOutputFileTest [output directory] [number of spills] [direct]
+/// Point the output directory at a tmpfs (/dev/shm/) or a local disk to
+/// compare the two. Passing "direct" as the third argument opens the files
+/// with O_DIRECT.
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include <stdlib.h>
+
+#include "hribf_buffers.h"
+
+static const unsigned int maxSpillWords = 150000;
+
+/// Fill a spill with a pattern that depends on the spill number.
+void fill_spill(std::vector<unsigned int> &spill, const unsigned int &num) {
+    spill.resize(1000 + (num * 7919) % (maxSpillWords - 1000));
+    for (unsigned int i = 0; i < spill.size(); i++)
+        spill[i] = num * 2654435761u + i;
+}
+
+/// Write the spills and return the number of seconds it took.
+double write_file(PollOutputFile &file, const unsigned int &format,
+                  const std::string &dir, const unsigned int &numSpills,
+                  std::string &filename) {
+    unsigned int runNum = 1;
+    std::vector<unsigned int> spill;
+
+    file.SetFileFormat(format);
+    if (!file.OpenNewFile("PollOutputFileTest", runNum, "async_test", dir)) {
+        std::cout << "Failed to open an output file in '" << dir << "'\n";
+        exit(EXIT_FAILURE);
+    }
+    filename = file.GetCurrentFilename();
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (unsigned int i = 0; i < numSpills; i++) {
+        fill_spill(spill, i);
+        if (file.Write((char *) spill.data(), spill.size()) < 0) {
+            std::cout << "Failed to write spill " << i << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+    double elapsed = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "  " << filename << (file.IsDirectIO() ? " (O_DIRECT)" : "")
+              << ": " << file.GetFilesize() / elapsed / 1048576.0 << " MB/s, "
+              << "max queue depth " << file.GetMaxWriteQueueDepth()
+              << ", write latency " << file.GetWriteLatency() * 1e3
+              << " ms (max " << file.GetMaxWriteLatency() * 1e3 << " ms), "
+              << "stalled " << file.GetWriteStallTime() * 1e3 << " ms\n";
+
+    file.CloseFile();
+    return elapsed;
+}
+
+/// Compare the spill read from the file with the one that was written.
+bool check_spill(const std::vector<unsigned int> &data, const unsigned int &nBytes,
+                 const unsigned int &num) {
+    std::vector<unsigned int> spill;
+    fill_spill(spill, num);
+    if (nBytes < 4 * spill.size()) {
+        std::cout << "Spill " << num << " has " << nBytes << " bytes, expected "
+                  << 4 * spill.size() << std::endl;
+        return false;
+    }
+    for (unsigned int i = 0; i < spill.size(); i++) {
+        if (data[i] != spill[i]) {
+            std::cout << "Spill " << num << " differs at word " << i << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool check_pld(const std::string &filename, const unsigned int &numSpills) {
+    std::ifstream input(filename.c_str(), std::ios::binary);
+    PLD_header header;
+    PLD_data data;
+    std::vector<unsigned int> buffer(maxSpillWords);
+    unsigned int nBytes;
+
+    if (!header.Read(&input) || header.GetMaxSpillSize() == 0) {
+        std::cout << "Invalid pld header in " << filename << std::endl;
+        return false;
+    }
+    for (unsigned int i = 0; i < numSpills; i++) {
+        if (!data.Read(&input, (char *) buffer.data(), nBytes, 4 * maxSpillWords) ||
+            !check_spill(buffer, nBytes, i))
+            return false;
+    }
+    return true;
+}
+
+bool check_ldf(const std::string &filename, const unsigned int &numSpills) {
+    std::ifstream input(filename.c_str(), std::ios::binary | std::ios::ate);
+    if (input.tellg() % (4 * ACTUAL_BUFF_SIZE) != 0) {
+        std::cout << filename << " is not a whole number of ldf buffers\n";
+        return false;
+    }
+    input.seekg(0);
+
+    DIR_buffer dir;
+    HEAD_buffer head;
+    DATA_buffer data;
+    std::vector<unsigned int> buffer(maxSpillWords + 10);
+    unsigned int nBytes;
+    bool fullSpill, badSpill;
+
+    if (!dir.Read(&input) || !head.Read(&input)) {
+        std::cout << "Invalid DIR or HEAD buffer in " << filename << std::endl;
+        return false;
+    }
+    for (unsigned int i = 0; i < numSpills; i++) {
+        if (!data.Read(&input, (char *) buffer.data(), nBytes, 4 * buffer.size(),
+                       fullSpill, badSpill) || badSpill ||
+            !check_spill(buffer, nBytes, i))
+            return false;
+    }
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    std::string dir = argc > 1 ? argv[1] : "./";
+    if (dir[dir.size() - 1] != '/')
+        dir += '/';
+    unsigned int numSpills = argc > 2 ? atoi(argv[2]) : 500;
+
+    PollOutputFile file;
+    file.SetDirectIO(argc > 3 && std::string(argv[3]) == "direct");
+
+    bool success = true;
+    std::string filename;
+
+    std::cout << "Writing " << numSpills << " spills\n";
+    write_file(file, 1, dir, numSpills, filename);
+    success &= check_pld(filename, numSpills);
+    remove(filename.c_str());
+
+    write_file(file, 0, dir, numSpills, filename);
+    success &= check_ldf(filename, numSpills);
+    remove(filename.c_str());
+
+    std::cout << (success ? "PASSED" : "FAILED") << std::endl;
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,55 @@
+/** \file CounterRandom.hpp
+ * \brief A counter-based random number generator (Philox4x32-10)
+ * \date October 19, 2026
+ */
+#ifndef __COUNTERRANDOM_HPP__
+#define __COUNTERRANDOM_HPP__
+
+#include <cstddef>
+#include <stdint.h>
+
+/// A counter-based generator following the Philox4x32-10 of Salmon et al.
+/// (SC11, "Parallel random numbers: as easy as 1, 2, 3"). The number is a
+/// pure function of the key and of a 128 bit counter, there is no state. A
+/// hit that is always given the same counter gets the same number no matter
+/// which thread processes it, in which order or in which part of a file, so
+/// the generator may be shared between threads without a lock.
+class CounterRandom {
+public:
+    /** Constructor
+     * \param [in] key : the key of the stream of numbers */
+    CounterRandom(const uint64_t &key = 0) { SetKey(key); }
+
+    /** Default destructor */
+    ~CounterRandom() {}
+
+    /** \param [in] key : the key of the stream of numbers */
+    void SetKey(const uint64_t &key) {
+        key_[0] = (uint32_t) key;
+        key_[1] = (uint32_t) (key >> 32);
+    }
+
+    /** \return A number in [0, 1) with 52 random bits
+     * \param [in] a : the first half of the counter
+     * \param [in] b : the second half of the counter */
+    double Uniform(const uint64_t &a, const uint64_t &b) const;
+
+    /** Fills out[i] with Uniform(a[i], b[i]). The counters are processed in
+     * blocks of lanes so that the compiler vectorizes the rounds.
+     * \param [in] a : the first halves of the counters
+     * \param [in] b : the second halves of the counters
+     * \param [in] size : the number of counters
+     * \param [out] out : receives the numbers */
+    void Fill(const uint64_t *a, const uint64_t *b, const size_t &size, double *out) const;
+
+    /** Runs the ten Philox rounds on a counter
+     * \param [in] counter : the four words of the counter
+     * \param [in] key : the two words of the key
+     * \param [out] out : the four random words */
+    static void Philox(const uint32_t counter[4], const uint32_t key[2], uint32_t out[4]);
+
+private:
+    uint32_t key_[2]; //!< The two words of the key
+};
+
+#endif //__COUNTERRANDOM_HPP__
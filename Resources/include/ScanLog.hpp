@@ -0,0 +1,164 @@
+/** \file ScanLog.hpp
+ * \brief Rate limited diagnostic messages that are written by a background
+ * thread so that the scan never waits on the terminal
+ * \date October 19, 2026
+ */
+#ifndef __SCANLOG_HPP__
+#define __SCANLOG_HPP__
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/** Posts a message from the scan. The first argument after the level is a
+ * printf format whose conversions take doubles (%f, %g, %e, %.0f, ...), up to
+ * three numbers can follow. A disabled level costs one comparison, an enabled
+ * one copies the numbers into a queue, the formatting and the output are done
+ * by the writer thread. Every call site is registered once with its own
+ * counters and rate limit. The format is part of the variable arguments so
+ * that a message without numbers is standard C++. */
+#define SCAN_LOG(level, ...) \
+    do { \
+        if (ScanLog::IsEnabled(level)) { \
+            static ScanLog::Site *scanLogSite_ = ScanLog::get()->Register(level, SCAN_LOG_TEXT_(__VA_ARGS__, 0)); \
+            ScanLog::get()->Post(*scanLogSite_, __VA_ARGS__); \
+        } \
+    } while (0)
+
+//! The format of the arguments of SCAN_LOG
+#define SCAN_LOG_TEXT_(text, ...) text
+
+//! A singleton that writes the diagnostic messages of the scan through a
+//! Messenger from a background thread. The messages go through a fixed size
+//! lock-free queue; when it is full they are counted as dropped instead of
+//! blocking the scan. At most MAX_PER_SECOND messages of a site are written
+//! per second, the others are counted and reported with the next one that
+//! is written and in the summary at the end of the program.
+class ScanLog {
+public:
+    //! The levels of the messages
+    enum Level {
+        DEBUG = 0, INFO = 1, WARNING = 2, ERROR = 3, NONE = 4
+    };
+
+    //! A call site, with the preformatted text and its counters. The sites
+    //! are owned by the log so that they outlive the static pointers of the
+    //! call sites and can be summarized at the end of the program.
+    class Site {
+    public:
+        /** Constructor
+         * \param [in] level : the level of the messages
+         * \param [in] text : the printf format of the messages
+         * \param [in] id : the number of the site in the log */
+        Site(const Level &level, const char *text, const unsigned int &id) :
+                level(level), text(text), id(id), count(0), suppressed(0), second(-1), inSecond(0) {}
+
+        const Level level; //!< The level of the messages
+        const char *text; //!< The printf format of the messages
+        const unsigned int id; //!< The number of the site in the log
+        std::atomic<unsigned long> count; //!< The number of times the site was reached
+        std::atomic<unsigned long> suppressed; //!< The messages not written because of the rate limit or a full queue
+        std::atomic<long> second; //!< The second of the current rate limit window
+        std::atomic<unsigned int> inSecond; //!< The messages posted in the current window
+    };
+
+    /** \return only instance of the ScanLog class. */
+    static ScanLog *get();
+
+    /** \return True if messages of this level are written
+     * \param [in] level : the level of the message */
+    static bool IsEnabled(const Level &level) { return level >= minimumLevel_; }
+
+    /** Sets the lowest level that is written, the default is WARNING
+     * \param [in] level : the lowest level */
+    static void SetLevel(const Level &level) { minimumLevel_ = level; }
+
+    /** Registers a call site, done once per site by SCAN_LOG
+     * \param [in] level : the level of the messages
+     * \param [in] text : the printf format of the messages, it must be a
+     * string literal
+     * \return The site, owned by the log */
+    Site *Register(const Level &level, const char *text);
+
+    /** \return The first registered site with this format, NULL if there is
+     * none
+     * \param [in] text : the printf format of the site */
+    const Site *FindSite(const std::string &text);
+
+    /** Queues a message of a site, never blocks
+     * \param [in] site : the call site
+     * \param [in] a : the first number of the message
+     * \param [in] b : the second number of the message
+     * \param [in] c : the third number of the message */
+    void Post(Site &site, const double &a = 0, const double &b = 0, const double &c = 0);
+
+    /** Queues a message of a site, the format was given to Register. This is
+     * the form used by SCAN_LOG.
+     * \param [in] site : the call site
+     * \param [in] text : the format of the site, ignored
+     * \param [in] a : the first number of the message
+     * \param [in] b : the second number of the message
+     * \param [in] c : the third number of the message */
+    void Post(Site &site, const char */*text*/, const double &a = 0, const double &b = 0, const double &c = 0) {
+        Post(site, a, b, c);
+    }
+
+    /** Waits until the writer emptied the queue */
+    void Flush();
+
+    /** \return The number of messages that did not fit in the queue */
+    unsigned long GetNumDropped() const { return dropped_; }
+
+    /** Writes the messages left in the queue and the number of times every
+     * site was reached, then stops the writer */
+    ~ScanLog();
+
+    static const unsigned int MAX_PER_SECOND = 10; //!< The messages of a site written per second
+    static const unsigned int QUEUE_SIZE = 1024; //!< The number of messages the queue holds, a power of 2
+
+private:
+    ScanLog(); //!< Default constructor
+    ScanLog(ScanLog const &); //!< Overload of the constructor
+    void operator=(ScanLog const &); //!< the copy constructor
+
+    //! A message in the queue
+    struct Entry {
+        std::atomic<unsigned long> sequence; //!< The turn of the slot, see Post
+        Site *site; //!< The call site
+        double values[3]; //!< The numbers of the message
+        unsigned long suppressed; //!< The messages of the site suppressed before this one
+    };
+
+    /** Takes the next message from the queue
+     * \param [out] entry : receives the message
+     * \return False if the queue is empty */
+    bool Pop(Entry &entry);
+
+    /** Formats and writes a message
+     * \param [in] entry : the message */
+    void Write(const Entry &entry);
+
+    /** The loop of the writer thread */
+    void WriterLoop();
+
+    static std::atomic<int> minimumLevel_; //!< The lowest level that is written
+
+    std::vector<Entry> queue_; //!< The ring buffer of messages
+    std::atomic<unsigned long> head_; //!< The next slot written by Post
+    std::atomic<unsigned long> tail_; //!< The next slot read by the writer
+    std::atomic<unsigned long> dropped_; //!< The messages that did not fit in the queue
+
+    std::mutex sitesMutex_; //!< Guards sites_
+    std::deque<Site> sites_; //!< The registered call sites, a deque keeps their addresses
+
+    std::mutex wakeMutex_; //!< Used by the writer to sleep
+    std::condition_variable wake_; //!< Wakes the writer for Flush and at the end
+    std::atomic<bool> stop_; //!< Set to end the writer
+    std::thread writer_; //!< The writer thread
+};
+
+#endif //__SCANLOG_HPP__
@@ -0,0 +1,212 @@
+/** \file StateArchive.hpp
+ * \brief Binary archives of the state of a scan, used to write and read the
+ * checkpoints of long scans
+ * \date October 19, 2026
+ */
+#ifndef __STATEARCHIVE_HPP__
+#define __STATEARCHIVE_HPP__
+
+#include <deque>
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <stdint.h>
+
+#include "Exceptions.hpp"
+
+//! Writes the state of a scan to a stream. Numbers and other trivially
+//! copyable types are written as they are in memory, strings, vectors and
+//! deques are preceded by their length. The archive is only meant to be read
+//! back by the same build on the same machine, there is no conversion of the
+//! byte order. Objects that may be missing when the state is read (e.g. a
+//! processor that was removed from the configuration) should be written as
+//! a name followed by a string holding their state, see ToString.
+class StateWriter {
+public:
+    /** Constructor
+     * \param [in] out : the stream that receives the state */
+    explicit StateWriter(std::ostream &out) : out_(out), numBytes_(0) {}
+
+    /** Default destructor */
+    ~StateWriter() {}
+
+    /** Writes raw bytes
+     * \param [in] data : the bytes to write
+     * \param [in] size : the number of bytes
+     * \throw IOException if the stream failed */
+    void WriteBytes(const void *data, const size_t &size) {
+        out_.write((const char *) data, size);
+        if (!out_.good())
+            throw IOException("StateWriter::WriteBytes - Could not write the state after "
+                              + std::to_string(numBytes_) + " bytes.");
+        numBytes_ += size;
+    }
+
+    /** Writes a number or another trivially copyable value
+     * \param [in] value : the value to write */
+    template<typename T>
+    void Write(const T &value) {
+        static_assert(std::is_trivially_copyable<T>::value, "StateWriter::Write - T must be trivially copyable");
+        WriteBytes(&value, sizeof(T));
+    }
+
+    /** Writes a string
+     * \param [in] value : the string to write */
+    void Write(const std::string &value) {
+        Write((uint64_t) value.size());
+        WriteBytes(value.data(), value.size());
+    }
+
+    /** Writes a C string as a string, not as a pointer
+     * \param [in] value : the string to write */
+    void Write(const char *value) { Write(std::string(value)); }
+
+    /** Writes a vector of trivially copyable values in one block
+     * \param [in] value : the vector to write */
+    template<typename T>
+    void Write(const std::vector<T> &value) {
+        static_assert(std::is_trivially_copyable<T>::value, "StateWriter::Write - T must be trivially copyable");
+        Write((uint64_t) value.size());
+        if (!value.empty())
+            WriteBytes(value.data(), value.size() * sizeof(T));
+    }
+
+    /** Writes a deque, element after element
+     * \param [in] value : the deque to write */
+    template<typename T>
+    void Write(const std::deque<T> &value) {
+        Write((uint64_t) value.size());
+        for (typename std::deque<T>::const_iterator it = value.begin(); it != value.end(); it++)
+            Write(*it);
+    }
+
+    /** \return The number of bytes written so far */
+    uint64_t GetNumBytes() const { return numBytes_; }
+
+    /** Writes the state of an object into a string, so that it can be
+     * written after the name of the object and skipped by a reader that
+     * does not know it.
+     * \param [in] object : an object with a SaveState(StateWriter &) method
+     * \return The state of the object */
+    template<typename T>
+    static std::string ToString(const T &object);
+
+private:
+    std::ostream &out_; //!< The stream that receives the state
+    uint64_t numBytes_; //!< The number of bytes written
+};
+
+//! Reads the state written by a StateWriter. Every read throws an
+//! IOException if the archive ends early, so that a truncated checkpoint is
+//! never half loaded without notice.
+class StateReader {
+public:
+    /** Constructor
+     * \param [in] in : the stream holding the state */
+    explicit StateReader(std::istream &in) : in_(in), numBytes_(0) {}
+
+    /** Default destructor */
+    ~StateReader() {}
+
+    /** Reads raw bytes
+     * \param [out] data : receives the bytes
+     * \param [in] size : the number of bytes
+     * \throw IOException if the archive ended */
+    void ReadBytes(void *data, const size_t &size) {
+        in_.read((char *) data, size);
+        if ((size_t) in_.gcount() != size)
+            throw IOException("StateReader::ReadBytes - The state ended after "
+                              + std::to_string(numBytes_ + in_.gcount()) + " bytes.");
+        numBytes_ += size;
+    }
+
+    /** Reads a number or another trivially copyable value
+     * \param [out] value : receives the value */
+    template<typename T>
+    void Read(T &value) {
+        static_assert(std::is_trivially_copyable<T>::value, "StateReader::Read - T must be trivially copyable");
+        ReadBytes(&value, sizeof(T));
+    }
+
+    /** Reads a string
+     * \param [out] value : receives the string */
+    void Read(std::string &value) {
+        value.resize(ReadSize());
+        if (!value.empty())
+            ReadBytes(&value[0], value.size());
+    }
+
+    /** Reads a vector of trivially copyable values
+     * \param [out] value : receives the vector */
+    template<typename T>
+    void Read(std::vector<T> &value) {
+        static_assert(std::is_trivially_copyable<T>::value, "StateReader::Read - T must be trivially copyable");
+        value.resize(ReadSize());
+        if (!value.empty())
+            ReadBytes(value.data(), value.size() * sizeof(T));
+    }
+
+    /** Reads a deque
+     * \param [out] value : receives the deque */
+    template<typename T>
+    void Read(std::deque<T> &value) {
+        value.resize(ReadSize());
+        for (typename std::deque<T>::iterator it = value.begin(); it != value.end(); it++)
+            Read(*it);
+    }
+
+    /** \return A value read from the archive */
+    template<typename T>
+    T Get() {
+        T value;
+        Read(value);
+        return value;
+    }
+
+    /** \return The number of bytes read so far */
+    uint64_t GetNumBytes() const { return numBytes_; }
+
+    /** Loads the state of an object from a string written by
+     * StateWriter::ToString
+     * \param [in] state : the state of the object
+     * \param [in,out] object : an object with a LoadState(StateReader &)
+     * method
+     * \throw IOException if the object did not read all of the state */
+    template<typename T>
+    static void FromString(const std::string &state, T &object);
+
+private:
+    std::istream &in_; //!< The stream holding the state
+    uint64_t numBytes_; //!< The number of bytes read
+
+    /** \return The length of a string, vector or deque */
+    size_t ReadSize() {
+        uint64_t size;
+        Read(size);
+        return (size_t) size;
+    }
+};
+
+template<typename T>
+std::string StateWriter::ToString(const T &object) {
+    std::ostringstream out(std::ios::binary);
+    StateWriter writer(out);
+    object.SaveState(writer);
+    return out.str();
+}
+
+template<typename T>
+void StateReader::FromString(const std::string &state, T &object) {
+    std::istringstream in(state, std::ios::binary);
+    StateReader reader(in);
+    object.LoadState(reader);
+    if (reader.GetNumBytes() != state.size())
+        throw IOException("StateReader::FromString - " + std::to_string(state.size() - reader.GetNumBytes())
+                          + " bytes of the state were not read.");
+}
+
+#endif //__STATEARCHIVE_HPP__
@@ -34,16 +34,16 @@ public:
     ~TrapFilterParameters() {};
 
     //! Returns the value of the flattop
-    double GetFlattop(void) { return g_; }
+    double GetFlattop(void) const { return g_; }
 
     //! Returns the value of the risetime
-    double GetRisetime(void) { return l_; }
+    double GetRisetime(void) const { return l_; }
 
     //! Returns the value of tau/threhsold
-    double GetT(void) { return t_; }
+    double GetT(void) const { return t_; }
 
     //! Returns the size of the filter
-    double GetSize(void) { return 2 * l_ + g_; }
+    double GetSize(void) const { return 2 * l_ + g_; }
 
     //! Sets the value of the flattop
     void SetFlattop(const double &a) { g_ = a; }
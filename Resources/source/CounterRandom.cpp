@@ -0,0 +1,97 @@
+/** \file CounterRandom.cpp
+ * \brief A counter-based random number generator (Philox4x32-10)
+ * \date October 19, 2026
+ */
+#include <cstring>
+
+#include "CounterRandom.hpp"
+
+namespace {
+    const uint32_t PHILOX_M0 = 0xD2511F53; //!< The multiplier of the first pair of words
+    const uint32_t PHILOX_M1 = 0xCD9E8D57; //!< The multiplier of the second pair of words
+    const uint32_t PHILOX_W0 = 0x9E3779B9; //!< The Weyl increment of the first key word
+    const uint32_t PHILOX_W1 = 0xBB67AE85; //!< The Weyl increment of the second key word
+    const unsigned int PHILOX_ROUNDS = 10; //!< The number of rounds
+    const size_t LANES = 16; //!< The number of counters processed together by Fill
+
+    ///One Philox round on LANES counters held word by word
+    void PhiloxRound(uint32_t *x0, uint32_t *x1, uint32_t *x2, uint32_t *x3, const uint32_t &k0,
+                     const uint32_t &k1) {
+        for (size_t l = 0; l < LANES; l++) {
+            uint64_t p0 = (uint64_t) PHILOX_M0 * x0[l];
+            uint64_t p1 = (uint64_t) PHILOX_M1 * x2[l];
+            uint32_t y0 = (uint32_t) (p1 >> 32) ^ x1[l] ^ k0;
+            uint32_t y2 = (uint32_t) (p0 >> 32) ^ x3[l] ^ k1;
+            x0[l] = y0;
+            x1[l] = (uint32_t) p1;
+            x2[l] = y2;
+            x3[l] = (uint32_t) p0;
+        }
+    }
+
+    ///@return The 52 upper bits of two words as a number in [0, 1). The bits
+    /// are the mantissa of a number in [1, 2), which avoids an integer to
+    /// floating point conversion that does not vectorize.
+    inline double ToUniform(const uint32_t &high, const uint32_t &low) {
+        uint64_t bits = 0x3FF0000000000000ull | ((uint64_t) high << 20) | (low >> 12);
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        return value - 1.0;
+    }
+}
+
+void CounterRandom::Philox(const uint32_t counter[4], const uint32_t key[2], uint32_t out[4]) {
+    uint32_t x0 = counter[0], x1 = counter[1], x2 = counter[2], x3 = counter[3];
+    uint32_t k0 = key[0], k1 = key[1];
+    for (unsigned int round = 0; round < PHILOX_ROUNDS; round++) {
+        uint64_t p0 = (uint64_t) PHILOX_M0 * x0;
+        uint64_t p1 = (uint64_t) PHILOX_M1 * x2;
+        x0 = (uint32_t) (p1 >> 32) ^ x1 ^ k0;
+        x1 = (uint32_t) p1;
+        x2 = (uint32_t) (p0 >> 32) ^ x3 ^ k1;
+        x3 = (uint32_t) p0;
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+    out[0] = x0;
+    out[1] = x1;
+    out[2] = x2;
+    out[3] = x3;
+}
+
+double CounterRandom::Uniform(const uint64_t &a, const uint64_t &b) const {
+    uint32_t counter[4] = {(uint32_t) a, (uint32_t) (a >> 32), (uint32_t) b, (uint32_t) (b >> 32)};
+    uint32_t out[4];
+    Philox(counter, key_, out);
+    return ToUniform(out[0], out[1]);
+}
+
+///The words of LANES counters are kept in separate arrays so that every step
+/// of a round is the same operation on LANES independent values, which the
+/// compiler turns into vector multiplies and xors. The counters that do not
+/// fill a whole block are done one by one.
+void CounterRandom::Fill(const uint64_t *a, const uint64_t *b, const size_t &size, double *out) const {
+    size_t i = 0;
+    for (; i + LANES <= size; i += LANES) {
+        uint32_t x0[LANES], x1[LANES], x2[LANES], x3[LANES];
+        for (size_t l = 0; l < LANES; l++) {
+            x0[l] = (uint32_t) a[i + l];
+            x1[l] = (uint32_t) (a[i + l] >> 32);
+            x2[l] = (uint32_t) b[i + l];
+            x3[l] = (uint32_t) (b[i + l] >> 32);
+        }
+
+        uint32_t k0 = key_[0], k1 = key_[1];
+        for (unsigned int round = 0; round < PHILOX_ROUNDS; round++) {
+            PhiloxRound(x0, x1, x2, x3, k0, k1);
+            k0 += PHILOX_W0;
+            k1 += PHILOX_W1;
+        }
+
+        for (size_t l = 0; l < LANES; l++)
+            out[i + l] = ToUniform(x0[l], x1[l]);
+    }
+
+    for (; i < size; i++)
+        out[i] = Uniform(a[i], b[i]);
+}
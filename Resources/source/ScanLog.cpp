@@ -0,0 +1,161 @@
+/** \file ScanLog.cpp
+ * \brief Rate limited diagnostic messages that are written by a background
+ * thread so that the scan never waits on the terminal
+ * \date October 19, 2026
+ */
+#include <chrono>
+#include <sstream>
+
+#include <cstdio>
+
+#include "Messenger.hpp"
+#include "ScanLog.hpp"
+
+using namespace std;
+
+std::atomic<int> ScanLog::minimumLevel_(ScanLog::WARNING);
+
+ScanLog *ScanLog::get() {
+    static ScanLog instance;
+    return &instance;
+}
+
+ScanLog::Site *ScanLog::Register(const Level &level, const char *text) {
+    lock_guard<mutex> lock(sitesMutex_);
+    sites_.emplace_back(level, text, (unsigned int) sites_.size());
+    return &sites_.back();
+}
+
+const ScanLog::Site *ScanLog::FindSite(const std::string &text) {
+    lock_guard<mutex> lock(sitesMutex_);
+    for (deque<Site>::iterator it = sites_.begin(); it != sites_.end(); it++)
+        if (text == it->text)
+            return &(*it);
+    return NULL;
+}
+
+ScanLog::ScanLog() : queue_(QUEUE_SIZE), head_(0), tail_(0), dropped_(0), stop_(false) {
+    for (unsigned long i = 0; i < queue_.size(); i++)
+        queue_[i].sequence = i;
+    writer_ = thread(&ScanLog::WriterLoop, this);
+}
+
+ScanLog::~ScanLog() {
+    stop_ = true;
+    wake_.notify_one();
+    writer_.join();
+
+    Messenger m;
+    lock_guard<mutex> lock(sitesMutex_);
+    for (deque<Site>::iterator it = sites_.begin(); it != sites_.end(); it++) {
+        if (it->suppressed == 0)
+            continue;
+        stringstream ss;
+        ss << "ScanLog : \"" << it->text << "\" occurred " << it->count << " times, "
+           << it->suppressed << " of them were not shown.";
+        m.detail(ss.str());
+    }
+    if (dropped_ > 0) {
+        stringstream ss;
+        ss << "ScanLog : " << dropped_ << " messages did not fit in the queue.";
+        m.detail(ss.str());
+    }
+}
+
+///The queue is the bounded queue of D. Vyukov : every slot holds the turn
+/// at which it may be written (sequence == position) or read (sequence ==
+/// position + 1). Producers claim a position with a compare and swap, so
+/// several threads may post at the same time without a lock.
+void ScanLog::Post(Site &site, const double &a, const double &b, const double &c) {
+    site.count.fetch_add(1, memory_order_relaxed);
+
+    long second = (long) chrono::duration_cast<chrono::seconds>(
+            chrono::steady_clock::now().time_since_epoch()).count();
+    if (site.second.load(memory_order_relaxed) != second) {
+        site.second.store(second, memory_order_relaxed);
+        site.inSecond.store(0, memory_order_relaxed);
+    }
+    if (site.inSecond.fetch_add(1, memory_order_relaxed) >= MAX_PER_SECOND) {
+        site.suppressed.fetch_add(1, memory_order_relaxed);
+        return;
+    }
+
+    unsigned long position = head_.load(memory_order_relaxed);
+    Entry *entry;
+    while (true) {
+        entry = &queue_[position & (QUEUE_SIZE - 1)];
+        unsigned long sequence = entry->sequence.load(memory_order_acquire);
+        long difference = (long) sequence - (long) position;
+        if (difference == 0) {
+            if (head_.compare_exchange_weak(position, position + 1, memory_order_relaxed))
+                break;
+        } else if (difference < 0) {
+            dropped_.fetch_add(1, memory_order_relaxed);
+            site.suppressed.fetch_add(1, memory_order_relaxed);
+            return;
+        } else
+            position = head_.load(memory_order_relaxed);
+    }
+
+    entry->site = &site;
+    entry->values[0] = a;
+    entry->values[1] = b;
+    entry->values[2] = c;
+    entry->suppressed = site.suppressed.load(memory_order_relaxed);
+    entry->sequence.store(position + 1, memory_order_release);
+}
+
+bool ScanLog::Pop(Entry &entry) {
+    unsigned long position = tail_.load(memory_order_relaxed);
+    Entry &slot = queue_[position & (QUEUE_SIZE - 1)];
+    if (slot.sequence.load(memory_order_acquire) != position + 1)
+        return false;
+
+    entry.site = slot.site;
+    entry.suppressed = slot.suppressed;
+    for (unsigned int i = 0; i < 3; i++)
+        entry.values[i] = slot.values[i];
+    slot.sequence.store(position + QUEUE_SIZE, memory_order_release);
+    tail_.store(position + 1, memory_order_relaxed);
+    return true;
+}
+
+void ScanLog::Write(const Entry &entry) {
+    char text[512];
+    snprintf(text, sizeof(text), entry.site->text, entry.values[0], entry.values[1], entry.values[2]);
+
+    stringstream ss;
+    ss << text;
+    if (entry.suppressed > 0)
+        ss << " (" << entry.suppressed << " similar messages not shown so far)";
+
+    Messenger m;
+    if (entry.site->level >= WARNING)
+        m.warning(ss.str());
+    else
+        m.detail(ss.str());
+}
+
+void ScanLog::WriterLoop() {
+    Entry entry;
+    while (true) {
+        bool stop = stop_;
+        while (Pop(entry))
+            Write(entry);
+        if (stop)
+            break;
+        wake_.notify_all();
+
+        unique_lock<mutex> lock(wakeMutex_);
+        wake_.wait_for(lock, chrono::milliseconds(50));
+    }
+    wake_.notify_all();
+}
+
+void ScanLog::Flush() {
+    unique_lock<mutex> lock(wakeMutex_);
+    while (tail_.load() != head_.load() && !stop_) {
+        wake_.notify_all();
+        wake_.wait_for(lock, chrono::milliseconds(10));
+    }
+}
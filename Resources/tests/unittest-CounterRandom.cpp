@@ -0,0 +1,63 @@
+///@file unittest-CounterRandom.cpp
+///@brief Tests the counter-based random number generator
+///@date October 19, 2026
+#include <vector>
+
+#include <UnitTest++.h>
+
+#include "CounterRandom.hpp"
+
+using namespace std;
+
+///This tests the Philox4x32-10 rounds against the known answers published
+/// with Random123
+TEST(TestPhiloxKnownAnswers) {
+    uint32_t out[4];
+
+    const uint32_t zeroCounter[4] = {0, 0, 0, 0};
+    const uint32_t zeroKey[2] = {0, 0};
+    CounterRandom::Philox(zeroCounter, zeroKey, out);
+    CHECK_EQUAL(0x6627e8d5u, out[0]);
+    CHECK_EQUAL(0xe169c58du, out[1]);
+    CHECK_EQUAL(0xbc57ac4cu, out[2]);
+    CHECK_EQUAL(0x9b00dbd8u, out[3]);
+
+    const uint32_t piCounter[4] = {0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344};
+    const uint32_t piKey[2] = {0xa4093822, 0x299f31d0};
+    CounterRandom::Philox(piCounter, piKey, out);
+    CHECK_EQUAL(0xd16cfe09u, out[0]);
+    CHECK_EQUAL(0x94fdccebu, out[1]);
+    CHECK_EQUAL(0x5001e420u, out[2]);
+    CHECK_EQUAL(0x24126ea1u, out[3]);
+}
+
+///This tests that the batch gives the same numbers as single calls, for
+/// sizes that are and are not multiples of the lanes, and that they are in
+/// [0, 1)
+TEST(TestFill) {
+    CounterRandom random(12345);
+    static const size_t size = 67;
+    vector<uint64_t> a(size), b(size);
+    for (size_t i = 0; i < size; i++) {
+        a[i] = 1000000007ull * i;
+        b[i] = i % 13;
+    }
+
+    vector<double> out(size);
+    random.Fill(a.data(), b.data(), size, out.data());
+    double sum = 0;
+    for (size_t i = 0; i < size; i++) {
+        CHECK_EQUAL(random.Uniform(a[i], b[i]), out[i]);
+        CHECK(out[i] >= 0 && out[i] < 1);
+        sum += out[i];
+    }
+    CHECK_CLOSE(0.5, sum / size, 0.15);
+
+    //A different key gives a different stream
+    CounterRandom other(54321);
+    CHECK(other.Uniform(a[1], b[1]) != random.Uniform(a[1], b[1]));
+}
+
+int main(int argv, char *argc[]) {
+    return (UnitTest::RunAllTests());
+}
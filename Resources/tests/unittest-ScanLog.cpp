@@ -0,0 +1,60 @@
+///@file unittest-ScanLog.cpp
+///@brief Tests the rate limiting and the counters of the ScanLog
+///@date October 19, 2026
+#include <UnitTest++.h>
+
+#include "ScanLog.hpp"
+
+using namespace std;
+
+///This tests that the levels below the minimum level are disabled
+TEST(TestIsEnabled) {
+    ScanLog::SetLevel(ScanLog::WARNING);
+    CHECK(!ScanLog::IsEnabled(ScanLog::DEBUG));
+    CHECK(!ScanLog::IsEnabled(ScanLog::INFO));
+    CHECK(ScanLog::IsEnabled(ScanLog::WARNING));
+    CHECK(ScanLog::IsEnabled(ScanLog::ERROR));
+
+    ScanLog::SetLevel(ScanLog::NONE);
+    CHECK(!ScanLog::IsEnabled(ScanLog::ERROR));
+    ScanLog::SetLevel(ScanLog::WARNING);
+}
+
+///This tests that a site counts every message and only writes
+/// MAX_PER_SECOND of them in a burst
+TEST(TestRateLimit) {
+    ScanLog *log = ScanLog::get();
+    ScanLog::Site *site = log->Register(ScanLog::INFO, "Message %.0f of %.0f");
+
+    static const unsigned int numMessages = 1000;
+    for (unsigned int i = 0; i < numMessages; i++)
+        log->Post(*site, i, numMessages);
+    log->Flush();
+
+    CHECK_EQUAL(numMessages, site->count);
+    //The burst may straddle two seconds
+    CHECK(site->suppressed >= numMessages - 2 * ScanLog::MAX_PER_SECOND);
+    CHECK_EQUAL(0u, log->GetNumDropped());
+}
+
+///This tests that the macro registers its site once and skips disabled levels
+TEST(TestMacro) {
+    ScanLog::SetLevel(ScanLog::WARNING);
+    for (unsigned int i = 0; i < 5; i++) {
+        SCAN_LOG(ScanLog::DEBUG, "Never shown %.0f", i);
+        SCAN_LOG(ScanLog::WARNING, "Shown at iteration %.0f", i);
+    }
+    ScanLog::get()->Flush();
+
+    CHECK(ScanLog::get()->FindSite("Never shown %.0f") == NULL);
+    const ScanLog::Site *site = ScanLog::get()->FindSite("Shown at iteration %.0f");
+    CHECK(site != NULL);
+    if (site) {
+        CHECK_EQUAL(5u, site->count);
+        CHECK_EQUAL(ScanLog::WARNING, site->level);
+    }
+}
+
+int main(int argv, char *argc[]) {
+    return (UnitTest::RunAllTests());
+}
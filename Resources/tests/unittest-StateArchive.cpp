@@ -0,0 +1,99 @@
+///@file unittest-StateArchive.cpp
+///@brief Tests the archives used for the checkpoints of a scan
+///@date October 19, 2026
+#include <deque>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <UnitTest++.h>
+
+#include "StateArchive.hpp"
+
+using namespace std;
+
+///A small object that saves and loads its state
+struct Counter {
+    unsigned long count;
+    vector<double> times;
+
+    void SaveState(StateWriter &writer) const {
+        writer.Write(count);
+        writer.Write(times);
+    }
+
+    void LoadState(StateReader &reader) {
+        reader.Read(count);
+        reader.Read(times);
+    }
+};
+
+///Everything that is written is read back unchanged
+TEST(TestStateArchiveRoundTrip) {
+    stringstream stream(ios::in | ios::out | ios::binary);
+    StateWriter writer(stream);
+
+    vector<unsigned int> bins = {0, 3, 0xFFFFFFFF};
+    deque<string> names = {"beam", "", "implant"};
+    writer.Write(42.5);
+    writer.Write("utkscan");
+    writer.Write(bins);
+    writer.Write(names);
+    writer.Write(vector<double>());
+    CHECK_EQUAL(8u + 8u + 7u + 8u + 12u + 8u + 3 * 8u + 4u + 7u + 8u, writer.GetNumBytes());
+
+    StateReader reader(stream);
+    CHECK_CLOSE(42.5, reader.Get<double>(), 1e-12);
+    CHECK_EQUAL("utkscan", reader.Get<string>());
+
+    vector<unsigned int> readBins;
+    reader.Read(readBins);
+    CHECK_ARRAY_EQUAL(bins, readBins, 3);
+
+    deque<string> readNames;
+    reader.Read(readNames);
+    CHECK_EQUAL(3u, readNames.size());
+    CHECK_EQUAL("", readNames.at(1));
+    CHECK_EQUAL("implant", readNames.at(2));
+
+    vector<double> empty(5, 1.0);
+    reader.Read(empty);
+    CHECK(empty.empty());
+    CHECK_EQUAL(writer.GetNumBytes(), reader.GetNumBytes());
+}
+
+///The state of an object goes through a string, which must be read entirely
+TEST(TestStateArchiveObjects) {
+    Counter counter;
+    counter.count = 7;
+    counter.times = {1.0, 2.0};
+    string state = StateWriter::ToString(counter);
+
+    Counter loaded;
+    StateReader::FromString(state, loaded);
+    CHECK_EQUAL(7u, loaded.count);
+    CHECK_EQUAL(2u, loaded.times.size());
+
+    CHECK_THROW(StateReader::FromString(state + "x", loaded), IOException);
+}
+
+///A truncated archive throws instead of returning garbage
+TEST(TestStateArchiveTruncated) {
+    stringstream stream(ios::in | ios::out | ios::binary);
+    StateWriter writer(stream);
+    writer.Write(string(100, 'a'));
+
+    string truncated = stream.str().substr(0, 50);
+    istringstream in(truncated, ios::binary);
+    StateReader reader(in);
+    string value;
+    CHECK_THROW(reader.Read(value), IOException);
+
+    istringstream none("", ios::binary);
+    StateReader emptyReader(none);
+    CHECK_THROW(emptyReader.Get<unsigned int>(), IOException);
+}
+
+int main(int argv, char *argc[]) {
+    return (UnitTest::RunAllTests());
+}